@@ -0,0 +1,682 @@
+/*
+ * Micro and macro benchmarks of the hot paths of the emulator.
+ *
+ * Each benchmark is calibrated: the number of iterations grows until a run lasts at least the minimum time
+ * (this also warms up the caches and the branch predictors). Then the benchmark is repeated with that number of
+ * iterations, and the median of the repetitions is reported with a 95% confidence interval.
+ * The results are printed as a table, and optionally written as JSON with the CPU model and the compiler flags,
+ * so that they can be tracked over time and compared between commits.
+ *
+ * With --baseline, the results are compared with a JSON file written by a previous run: the program fails (exit code 2)
+ * if a benchmark is slower than the baseline by more than the threshold, and its confidence interval does not
+ * overlap the one of the baseline (so that the noise alone does not fail the comparison).
+ *
+ * With --perf, the benchmarks are not run: the ROM is emulated for the given number of frames with the hardware
+ * performance counters of the host (Linux perf_event_open), and the cycles, instructions, branch misses and cache misses
+ * are reported per emulated frame for the whole frame, the rendering of the PPU and the rest (mostly the CPU dispatch loop).
+ *
+ * Usage: gbemu_bench [--filter text] [--json file] [--min-time ms] [--rom file]
+ *                    [--repetitions n] [--cpu core] [--baseline file] [--threshold percent] [--perf frames]
+ */
+
+#include "cartridge.h" // Cartridge
+#include "cpu.h" // CPU
+#include "emulator.h" // Emulator
+#include "memory.h" // Memory
+#include "perf_counters.h" // PerfCounters, PerfSample
+#include "ppu.h" // PPU
+#include "timer.h" // Timer
+
+#include <algorithm> // std::copy, std::min, std::max
+#include <chrono> // std::chrono::steady_clock, std::chrono::duration
+#include <cmath> // std::sqrt, std::floor, std::ceil
+#include <cstring> // std::strcmp
+#include <fstream> // std::ifstream, std::ofstream
+#include <functional> // std::function
+#include <iomanip> // std::setw
+#include <iostream> // std::cout, std::endl
+#include <map> // std::map
+#include <memory> // std::shared_ptr, std::make_shared
+#include <sched.h> // sched_setaffinity, cpu_set_t
+#include <string> // std::string, std::getline, std::stod, std::stoi
+#include <vector> // std::vector
+
+#ifndef GBEMU_DEFAULT_ROM
+#define GBEMU_DEFAULT_ROM "data/roms/cpu_instrs.gb"
+#endif
+
+#ifndef GBEMU_COMPILER_FLAGS
+#define GBEMU_COMPILER_FLAGS "unknown"
+#endif
+
+namespace
+{
+    using namespace gameboy;
+
+    volatile uint32_t sink; ///< Receives the results of the benchmarks, so that they are not optimized away
+
+    /**
+     * @brief A benchmark
+     */
+    struct Benchmark
+    {
+        std::string name; ///< The name of the benchmark (group.case)
+        std::string unit; ///< The unit of the result ("ns/op" or "frames/s")
+        std::function<void(uint64_t)> run; ///< Run the given number of iterations
+    };
+
+    /**
+     * @brief The result of a benchmark
+     */
+    struct Result
+    {
+        std::string name; ///< The name of the benchmark
+        std::string unit; ///< The unit of the value
+        double value = 0; ///< The median of the repetitions
+        double low = 0; ///< The lower bound of the 95% confidence interval of the median
+        double high = 0; ///< The upper bound of the 95% confidence interval of the median
+        uint64_t iterations = 0; ///< The number of iterations of each repetition
+        uint32_t repetitions = 0; ///< The number of repetitions
+
+        /**
+         * @brief Check whether a greater value is better (a rate, not a duration)
+         */
+        [[nodiscard]] bool higherIsBetter() const
+        {
+            return unit != "ns/op";
+        }
+    };
+
+    /**
+     * @brief The machine and the build that produced the results
+     */
+    struct Context
+    {
+        std::string cpu; ///< The model of the CPU
+        std::string compiler; ///< The version of the compiler
+        std::string flags; ///< The compiler flags
+    };
+
+    /**
+     * @brief Create a ROM that executes a block of instructions in a loop
+     * @details The block is repeated to fill 1 KB (the cost of the final jump is negligible).
+     *          HL points to the WRAM and a RET is at 0x1000, so the blocks can use (HL) and CALL 0x1000.
+     *
+     * @param block The instructions
+     * @return The ROM (32 KB, no MBC)
+     */
+    std::vector<uint8_t> makeLoopROM(const std::vector<uint8_t> &block)
+    {
+        std::vector<uint8_t> rom(0x8000, 0x00);
+        const uint8_t entry[] = {0x21, 0x00, 0xC0, 0xC3, 0x50, 0x01}; // LD HL,0xC000; JP 0x0150
+        std::copy(std::begin(entry), std::end(entry), rom.begin() + 0x100);
+
+        size_t address = 0x150;
+        while (address + block.size() <= 0x150 + 1024)
+        {
+            std::copy(block.begin(), block.end(), rom.begin() + static_cast<std::ptrdiff_t>(address));
+            address += block.size();
+        }
+        const uint8_t loop[] = {0xC3, 0x50, 0x01}; // JP 0x0150
+        std::copy(std::begin(loop), std::end(loop), rom.begin() + static_cast<std::ptrdiff_t>(address));
+
+        rom[0x1000] = 0xC9; // RET
+        return rom;
+    }
+
+    /**
+     * @brief The components needed by the micro benchmarks
+     */
+    struct Fixture
+    {
+        Cartridge cartridge; ///< The cartridge
+        Memory memory; ///< The memory
+        CPU cpu; ///< The CPU
+        PPU ppu; ///< The PPU
+        Timer timer; ///< The timer
+
+        explicit Fixture(const std::vector<uint8_t> &block)
+            : memory(cartridge),
+              cpu(memory),
+              ppu(memory),
+              timer(memory)
+        {
+            if (!cartridge.loadROMData(makeLoopROM(block)))
+                std::cout << "\x1B[31mError!\033[0m Invalid benchmark ROM" << std::endl;
+        }
+    };
+
+    /**
+     * @brief Create a benchmark of the reads of a memory region
+     */
+    Benchmark memoryRead(const std::string &region, const uint16_t start, const uint16_t size)
+    {
+        auto fixture = std::make_shared<Fixture>(std::vector<uint8_t>{0x00});
+        return {"memory.read." + region, "ns/op", [fixture, start, size](uint64_t iterations) {
+                    uint32_t sum = 0;
+                    for (uint64_t i = 0; i < iterations; i++)
+                        sum += fixture->memory.read(static_cast<uint16_t>(start + i % size));
+                    sink = sum;
+                }};
+    }
+
+    /**
+     * @brief Create a benchmark of the writes to a memory region
+     */
+    Benchmark memoryWrite(const std::string &region, const uint16_t start, const uint16_t size)
+    {
+        auto fixture = std::make_shared<Fixture>(std::vector<uint8_t>{0x00});
+        return {"memory.write." + region, "ns/op", [fixture, start, size](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; i++)
+                        fixture->memory.write(static_cast<uint16_t>(start + i % size), static_cast<uint8_t>(i));
+                }};
+    }
+
+    /**
+     * @brief Create a benchmark of the execution of a class of opcodes (one iteration = one instruction)
+     */
+    Benchmark cpuOpcodes(const std::string &opcodeClass, const std::vector<uint8_t> &block)
+    {
+        auto fixture = std::make_shared<Fixture>(block);
+        return {"cpu." + opcodeClass, "ns/op", [fixture](uint64_t iterations) {
+                    uint32_t cycles = 0;
+                    for (uint64_t i = 0; i < iterations; i++)
+                        cycles += fixture->cpu.cycle();
+                    sink = cycles;
+                }};
+    }
+
+    /**
+     * @brief Create a benchmark of the PPU (one iteration = one scanline, rendering included)
+     *
+     * @param name The name of the case
+     * @param lcdc The value of the LCD control register
+     * @param sprites The number of sprites on each line
+     */
+    Benchmark ppuScanline(const std::string &name, const uint8_t lcdc, const int sprites)
+    {
+        auto fixture = std::make_shared<Fixture>(std::vector<uint8_t>{0x00});
+        Memory &memory = fixture->memory;
+        for (uint16_t address = 0x8000; address < 0x9800; address++) // Tiles with all the colours
+            memory.write(address, static_cast<uint8_t>(address * 37));
+        for (uint16_t address = 0x9800; address < 0xA000; address++) // Tile maps
+            memory.write(address, static_cast<uint8_t>(address));
+        for (int sprite = 0; sprite < 40; sprite++) // Sprites: the first ones on all the lines, the others hidden
+        {
+            auto address = static_cast<uint16_t>(ppu_registers::OAM_ADDRESS + sprite * 4);
+            memory.write(address, sprite < sprites ? 16 : 0);
+            memory.write(address + 1, static_cast<uint8_t>(8 + sprite * 8));
+            memory.write(address + 2, static_cast<uint8_t>(sprite));
+            memory.write(address + 3, static_cast<uint8_t>(sprite % 2 == 0 ? 0x00 : 0x20));
+        }
+        memory.write(ppu_registers::WY_REG_ADDRESS, 0);
+        memory.write(ppu_registers::WX_REG_ADDRESS, 87);
+        memory.write(ppu_registers::LCDC_REG_ADDRESS, lcdc);
+
+        return {"ppu.scanline." + name, "ns/op", [fixture](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; i++)
+                        for (uint32_t cycles = 0; cycles < ppu_timing::CYCLES_PER_SCANLINE; cycles += 4)
+                            fixture->ppu.cycle(4);
+                }};
+    }
+
+    /**
+     * @brief Create a benchmark of the timer (one iteration = one call of Timer::cycle)
+     */
+    Benchmark timerCycle(const std::string &name, const uint8_t tac, const uint32_t cycles)
+    {
+        auto fixture = std::make_shared<Fixture>(std::vector<uint8_t>{0x00});
+        fixture->memory.write(timer_registers::TAC_REG_ADDRESS, tac);
+        return {"timer.cycle." + name, "ns/op", [fixture, cycles](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; i++)
+                        fixture->timer.cycle(cycles);
+                }};
+    }
+
+    /**
+     * @brief Create a benchmark of the whole emulator running a ROM (one iteration = one frame)
+     */
+    Benchmark romFrames(const std::string &name, const std::string &rom, const Accuracy accuracy)
+    {
+        std::shared_ptr<Emulator> emulator = Emulator::createFromFile(rom);
+        if (emulator)
+            emulator->setAccuracy(accuracy);
+        return {name, "frames/s", [emulator](uint64_t iterations) {
+                    for (uint64_t i = 0; emulator && i < iterations; i++)
+                        emulator->runFrame();
+                }};
+    }
+
+    /**
+     * @brief Run a benchmark once
+     *
+     * @return The value of the run (in the unit of the benchmark)
+     */
+    double measure(const Benchmark &benchmark, const uint64_t iterations, double &elapsed)
+    {
+        auto start = std::chrono::steady_clock::now();
+        benchmark.run(iterations);
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return benchmark.unit == "ns/op" ? elapsed * 1e9 / static_cast<double>(iterations)
+                                         : static_cast<double>(iterations) / elapsed;
+    }
+
+    /**
+     * @brief Run a benchmark
+     * @details The number of iterations grows until a run lasts at least minTime (warm-up),
+     *          then the benchmark is repeated with that number of iterations
+     */
+    Result runBenchmark(const Benchmark &benchmark, const double minTime, const uint32_t repetitions)
+    {
+        Result result{benchmark.name, benchmark.unit};
+        result.iterations = 1;
+        while (true)
+        {
+            double elapsed = 0;
+            measure(benchmark, result.iterations, elapsed);
+            if (elapsed >= minTime)
+                break;
+
+            // Aim a bit above the minimum time, growing by at most 10x per step
+            double factor = elapsed > 0 ? minTime * 1.2 / elapsed : 10;
+            result.iterations = static_cast<uint64_t>(static_cast<double>(result.iterations) * std::min(std::max(factor, 2.0), 10.0));
+        }
+
+        std::vector<double> values;
+        for (uint32_t i = 0; i < repetitions; i++)
+        {
+            double elapsed = 0;
+            values.push_back(measure(benchmark, result.iterations, elapsed));
+        }
+        std::sort(values.begin(), values.end());
+
+        // Distribution-free confidence interval of the median: the order statistics n/2 -+ 1.96 * sqrt(n) / 2
+        auto n = static_cast<double>(values.size());
+        auto lowRank = static_cast<int64_t>(std::floor(n / 2 - 0.98 * std::sqrt(n)));
+        auto highRank = static_cast<int64_t>(std::ceil(n / 2 + 1 + 0.98 * std::sqrt(n)));
+        auto last = static_cast<int64_t>(values.size());
+        result.low = values[static_cast<size_t>(std::max<int64_t>(lowRank, 1) - 1)];
+        result.high = values[static_cast<size_t>(std::min(highRank, last) - 1)];
+        result.value = values.size() % 2 == 1 ? values[values.size() / 2]
+                                              : (values[values.size() / 2 - 1] + values[values.size() / 2]) / 2;
+        result.repetitions = repetitions;
+        return result;
+    }
+
+    /**
+     * @brief Pin the process to a core, so that it is not migrated during the measures
+     */
+    bool pinToCore(const int core)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not pin the process to the core " << core << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Print a row of the hardware counters report
+     */
+    void printPerfRow(const char *name, const PerfSample &total, const uint64_t frames, const PerfCounters &counters)
+    {
+        std::cout << std::left << std::setw(16) << name << std::right;
+        for (size_t i = 0; i < static_cast<size_t>(PerfEvent::COUNT); i++)
+        {
+            auto event = static_cast<PerfEvent>(i);
+            if (counters.isAvailable(event))
+                std::cout << std::setw(16) << total[event] / frames;
+            else
+                std::cout << std::setw(16) << "n/a";
+        }
+
+        // Instructions of the host per cycle of the host
+        if (counters.isAvailable(PerfEvent::INSTRUCTIONS) && total[PerfEvent::CYCLES] > 0)
+            std::cout << std::setw(8) << std::fixed << std::setprecision(2)
+                      << static_cast<double>(total[PerfEvent::INSTRUCTIONS]) / static_cast<double>(total[PerfEvent::CYCLES]);
+        std::cout << std::endl;
+    }
+
+    /**
+     * @brief Emulate a ROM with the hardware performance counters, and print the counts per frame of each subsystem
+     *
+     * @return The exit code of the program
+     */
+    int runPerfCounters(const std::string &rom, const uint64_t frames)
+    {
+        std::unique_ptr<Emulator> emulator = Emulator::createFromFile(rom);
+        if (!emulator)
+            return 1;
+
+        PerfCounters counters;
+        if (!counters.open())
+            return 1;
+
+        // Warm up the caches and the branch predictors (and skip the boot of the ROM) before measuring
+        for (uint32_t i = 0; i < 60; i++)
+            emulator->runFrame();
+
+        emulator->setPerfCounters(&counters);
+        for (uint64_t i = 0; i < frames; i++)
+            emulator->runFrame();
+        emulator->setPerfCounters(nullptr);
+
+        const PerfSample &frame = counters.getTotal(PerfSubsystem::FRAME);
+        const PerfSample &rendering = counters.getTotal(PerfSubsystem::PPU_RENDERING);
+        std::cout << "Hardware counters per frame (" << frames << " frames, " << counters.getCount(PerfSubsystem::PPU_RENDERING)
+                  << " scanlines rendered)\n"
+                  << std::left << std::setw(16) << "subsystem" << std::right << std::setw(16) << "cycles" << std::setw(16)
+                  << "instructions" << std::setw(16) << "branch-misses" << std::setw(16) << "cache-misses" << std::setw(8)
+                  << "IPC" << std::endl;
+        printPerfRow("frame", frame, frames, counters);
+        printPerfRow("ppu.rendering", rendering, frames, counters);
+        printPerfRow("cpu+other", frame - rendering, frames, counters);
+        return 0;
+    }
+
+    /**
+     * @brief Get the machine and the build that produce the results
+     */
+    Context getContext()
+    {
+        Context context{"unknown", __VERSION__, GBEMU_COMPILER_FLAGS};
+
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+        {
+            if (line.compare(0, 10, "model name") == 0 && line.find(':') != std::string::npos)
+            {
+                context.cpu = line.substr(line.find(':') + 2);
+                break;
+            }
+        }
+        return context;
+    }
+
+    /**
+     * @brief Escape a string for JSON
+     */
+    std::string escape(const std::string &text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    /**
+     * @brief Get the value of a field in a line of a JSON file written by writeJSON
+     * @details Only the files written by this program are read, so the fields of an object are always on the same line
+     *
+     * @param line The line
+     * @param key The name of the field
+     * @return The value of the field (without the quotes for the strings), empty if the field is not in the line
+     */
+    std::string getField(const std::string &line, const std::string &key)
+    {
+        size_t position = line.find("\"" + key + "\": ");
+        if (position == std::string::npos)
+            return "";
+
+        position += key.size() + 4;
+        if (line[position] == '"')
+        {
+            std::string value;
+            for (position++; position < line.size() && line[position] != '"'; position++)
+            {
+                if (line[position] == '\\')
+                    position++;
+                value += line[position];
+            }
+            return value;
+        }
+        return line.substr(position, line.find_first_of(",}", position) - position);
+    }
+
+    /**
+     * @brief Write the results as JSON
+     */
+    bool writeJSON(const std::string &filename, const Context &context, const std::vector<Result> &results)
+    {
+        std::ofstream file(filename);
+        if (!file.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not write " << filename << std::endl;
+            return false;
+        }
+
+        file << "{\n  \"context\": {\"cpu\": \"" << escape(context.cpu) << "\", \"compiler\": \"" << escape(context.compiler)
+             << "\", \"flags\": \"" << escape(context.flags) << "\"},\n";
+        file << "  \"benchmarks\": [\n" << std::setprecision(10);
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result &result = results[i];
+            file << "    {\"name\": \"" << result.name << "\", \"unit\": \"" << result.unit << "\", \"value\": " << result.value
+                 << ", \"low\": " << result.low << ", \"high\": " << result.high << ", \"iterations\": " << result.iterations
+                 << ", \"repetitions\": " << result.repetitions
+                 << ", \"higher_is_better\": " << (result.higherIsBetter() ? "true" : "false") << "}"
+                 << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "  ]\n}\n";
+        return static_cast<bool>(file);
+    }
+
+    /**
+     * @brief Read the results written by writeJSON
+     *
+     * @return True if the file has been read, false otherwise
+     */
+    bool readJSON(const std::string &filename, Context &context, std::map<std::string, Result> &results)
+    {
+        std::ifstream file(filename);
+        if (!file.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not read " << filename << std::endl;
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.find("\"context\"") != std::string::npos)
+                context = {getField(line, "cpu"), getField(line, "compiler"), getField(line, "flags")};
+
+            std::string name = getField(line, "name");
+            if (name.empty())
+                continue;
+
+            Result result{name, getField(line, "unit")};
+            try
+            {
+                result.value = std::stod(getField(line, "value"));
+                result.low = std::stod(getField(line, "low"));
+                result.high = std::stod(getField(line, "high"));
+            }
+            catch (const std::exception &)
+            {
+                // A baseline written before the repetitions: no confidence interval
+                result.low = result.high = result.value;
+            }
+            results[name] = result;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Compare the results with a baseline, and print a report
+     *
+     * @param baseline The name of the file of the baseline
+     * @param context The machine and the build that produced the results
+     * @param results The results
+     * @param threshold The maximum slowdown (e.g. 0.05 for 5%)
+     * @return The number of regressions, -1 if the baseline cannot be read
+     */
+    int compare(const std::string &baseline, const Context &context, const std::vector<Result> &results, const double threshold)
+    {
+        Context baselineContext;
+        std::map<std::string, Result> baselineResults;
+        if (!readJSON(baseline, baselineContext, baselineResults))
+            return -1;
+
+        std::cout << "\nComparison with " << baseline << " (threshold " << threshold * 100 << "%)" << std::endl;
+        if (baselineContext.cpu != context.cpu)
+            std::cout << "\x1B[33m!!!\033[0m Different CPU: " << baselineContext.cpu << " (baseline), " << context.cpu << std::endl;
+        if (baselineContext.compiler != context.compiler || baselineContext.flags != context.flags)
+            std::cout << "\x1B[33m!!!\033[0m Different compiler or flags: " << baselineContext.compiler << " " << baselineContext.flags
+                      << " (baseline), " << context.compiler << " " << context.flags << std::endl;
+
+        int regressions = 0;
+        for (const Result &result : results)
+        {
+            auto it = baselineResults.find(result.name);
+            if (it == baselineResults.end())
+            {
+                std::cout << std::left << std::setw(28) << result.name << " not in the baseline" << std::endl;
+                continue;
+            }
+
+            // The slowdown is positive when the benchmark is slower than the baseline
+            const Result &base = it->second;
+            double slowdown = result.higherIsBetter() ? base.value / result.value - 1 : result.value / base.value - 1;
+            bool overlap = result.low <= base.high && base.low <= result.high;
+
+            std::string status = "ok";
+            if (slowdown > threshold && !overlap)
+            {
+                status = "\x1B[31mREGRESSION\033[0m";
+                regressions++;
+            }
+            else if (slowdown > threshold)
+                status = "\x1B[33mnoisy\033[0m";
+            else if (slowdown < -threshold && !overlap)
+                status = "\x1B[32mfaster\033[0m";
+
+            std::cout << std::left << std::setw(28) << result.name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << base.value << " -> " << std::setw(12) << result.value << " " << std::left
+                      << std::setw(9) << result.unit << std::right << std::showpos << std::setw(8) << (result.value / base.value - 1) * 100
+                      << std::noshowpos << "% " << status << std::endl;
+        }
+
+        if (regressions > 0)
+            std::cout << "\x1B[31mError!\033[0m " << regressions << " benchmark(s) slower than the baseline" << std::endl;
+        else
+            std::cout << "No regression" << std::endl;
+        return regressions;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::string filter;
+    std::string jsonFile;
+    std::string baseline;
+    std::string rom = GBEMU_DEFAULT_ROM;
+    double minTime = 0.2;
+    double threshold = 0.05;
+    uint32_t repetitions = 5;
+    int core = -1;
+    uint64_t perfFrames = 0;
+    bool usage = argc % 2 == 0; // The options all have a value
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--filter") == 0)
+            filter = argv[i + 1];
+        else if (std::strcmp(argv[i], "--json") == 0)
+            jsonFile = argv[i + 1];
+        else if (std::strcmp(argv[i], "--min-time") == 0)
+            minTime = std::stod(argv[i + 1]) / 1000;
+        else if (std::strcmp(argv[i], "--rom") == 0)
+            rom = argv[i + 1];
+        else if (std::strcmp(argv[i], "--repetitions") == 0)
+            repetitions = static_cast<uint32_t>(std::max(std::stoi(argv[i + 1]), 1));
+        else if (std::strcmp(argv[i], "--cpu") == 0)
+            core = std::stoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--baseline") == 0)
+            baseline = argv[i + 1];
+        else if (std::strcmp(argv[i], "--threshold") == 0)
+            threshold = std::stod(argv[i + 1]) / 100;
+        else if (std::strcmp(argv[i], "--perf") == 0)
+            perfFrames = static_cast<uint64_t>(std::max(std::stoi(argv[i + 1]), 1));
+        else
+            usage = true;
+    }
+    if (usage)
+    {
+        std::cout << "Usage: " << argv[0] << " [--filter text] [--json file] [--min-time ms] [--rom file]\n"
+                  << "       [--repetitions n] [--cpu core] [--baseline file] [--threshold percent] [--perf frames]" << std::endl;
+        return 1;
+    }
+
+    if (core >= 0 && !pinToCore(core))
+        return 1;
+
+    if (perfFrames > 0)
+        return runPerfCounters(rom, perfFrames);
+
+    Context context = getContext();
+    std::cout << "CPU: " << context.cpu << "\nCompiler: " << context.compiler << " " << context.flags << std::endl;
+
+    std::vector<Benchmark> benchmarks = {
+        memoryRead("rom", 0x0000, 0x8000),
+        memoryRead("vram", 0x8000, 0x2000),
+        memoryRead("wram", 0xC000, 0x2000),
+        memoryRead("oam", 0xFE00, 0xA0),
+        memoryRead("io", 0xFF40, 0x0C),
+        memoryRead("hram", 0xFF80, 0x7F),
+        memoryWrite("vram", 0x8000, 0x2000),
+        memoryWrite("wram", 0xC000, 0x2000),
+        memoryWrite("oam", 0xFE00, 0xA0),
+        memoryWrite("hram", 0xFF80, 0x7F),
+        cpuOpcodes("nop", {0x00}),
+        cpuOpcodes("ld_r_r", {0x41, 0x4A, 0x53, 0x5C, 0x78}), // LD B,C; LD C,D; LD D,E; LD E,H; LD A,B
+        cpuOpcodes("ld_r_hl", {0x7E, 0x77}), // LD A,(HL); LD (HL),A
+        cpuOpcodes("alu", {0x80, 0xA9, 0xB2, 0x93, 0xBB}), // ADD A,B; XOR C; OR D; SUB E; CP E
+        cpuOpcodes("alu16", {0x03, 0x09, 0x1B, 0x01, 0x34, 0x12}), // INC BC; ADD HL,BC; DEC DE; LD BC,0x1234
+        cpuOpcodes("cb", {0xCB, 0x11, 0xCB, 0x7C, 0xCB, 0x37}), // RL C; BIT 7,H; SWAP A
+        cpuOpcodes("jump", {0xAF, 0x18, 0x00, 0x20, 0x00, 0xC2, 0x00, 0x00}), // XOR A; JR +0; JR NZ,+0 and JP NZ,0x0000 (not taken)
+        cpuOpcodes("call_ret", {0xCD, 0x00, 0x10}), // CALL 0x1000 (RET)
+        ppuScanline("background", 0x91, 0),
+        ppuScanline("window", 0xF1, 0),
+        ppuScanline("sprites", 0x93, 10),
+        ppuScanline("all", 0xF3, 10),
+        timerCycle("div", 0x00, 4),
+        timerCycle("tima", 0x05, 4),
+        timerCycle("tima.frame", 0x05, ppu_timing::CYCLES_PER_FRAME),
+        romFrames("emulator.frames", rom, Accuracy::INSTRUCTION),
+        romFrames("emulator.frames.m_cycle", rom, Accuracy::MACHINE_CYCLE),
+    };
+
+    std::vector<Result> results;
+    for (const Benchmark &benchmark : benchmarks)
+    {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+            continue;
+
+        Result result = runBenchmark(benchmark, minTime, repetitions);
+        std::cout << std::left << std::setw(28) << result.name << std::right << std::setw(14) << std::fixed
+                  << std::setprecision(2) << result.value << " " << std::left << std::setw(9) << result.unit << std::right
+                  << "[" << result.low << ", " << result.high << "]" << std::endl;
+        results.push_back(result);
+    }
+
+    if (!jsonFile.empty() && !writeJSON(jsonFile, context, results))
+        return 1;
+
+    if (!baseline.empty())
+    {
+        int regressions = compare(baseline, context, results, threshold);
+        if (regressions != 0)
+            return regressions < 0 ? 1 : 2;
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Benchmark of the synchronization of the link cable.
+ * Two serial ports (one per thread) connected with a link cable exchange bytes continuously:
+ * the first one provides the clock, the second one waits for the transfers with the external clock.
+ * Only the serial ports are emulated, so the benchmark measures the cost of the synchronization protocol.
+ */
+
+#include "cpu.h" // cpu_cycles::CLOCK_FREQUENCY
+#include "link_cable.h" // LinkCable
+#include "serial.h" // Serial
+
+#include <chrono> // std::chrono::steady_clock, std::chrono::duration
+#include <functional> // std::ref
+#include <cstdint> // uint8_t, uint64_t
+#include <iostream> // std::cout, std::endl
+#include <string> // std::stoull
+#include <thread> // std::thread
+
+namespace
+{
+    using namespace gameboy;
+
+    /**
+     * @brief The result of one end of the link
+     */
+    struct EndResult
+    {
+        uint64_t transfers = 0; ///< The number of bytes received
+        uint64_t errors = 0; ///< The number of bytes received different from the expected ones
+        LinkStats stats; ///< The statistics of the link cable
+    };
+
+    /**
+     * @brief Emulate the serial port of one end of the link
+     *
+     * @param link The link cable
+     * @param internalClock True if this end provides the clock
+     * @param cycles The number of cycles to emulate
+     * @param result The result of this end
+     */
+    void runEnd(LinkCable &link, const bool internalClock, const uint64_t cycles, EndResult &result)
+    {
+        Cartridge cartridge;
+        Memory memory(cartridge);
+        Serial serial(memory);
+        serial.setSink(&link);
+
+        // Each end sends a counter, offset so that the two sequences are different
+        uint8_t sent = internalClock ? 0x00 : 0x80;
+        uint8_t expected = internalClock ? 0x80 : 0x00;
+        bool waiting = false;
+        for (uint64_t cycle = 0; cycle < cycles; cycle += 4)
+        {
+            uint8_t control = memory.read(serial_registers::SC_ADDRESS);
+            if (waiting && (control & 0x80) == 0)
+            {
+                // Transfer completed
+                result.transfers++;
+                if (memory.read(serial_registers::SB_ADDRESS) != expected)
+                    result.errors++;
+                expected++;
+                sent++;
+                waiting = false;
+            }
+            if (!waiting)
+            {
+                memory.write(serial_registers::SB_ADDRESS, sent);
+                memory.write(serial_registers::SC_ADDRESS, internalClock ? 0x81 : 0x80);
+                waiting = true;
+            }
+            serial.cycle(4);
+        }
+
+        result.stats = link.getStats();
+        link.disconnect(); // Do not keep the other end waiting for this one
+
+    }
+
+    /**
+     * @brief Print the result of one end of the link
+     *
+     * @param name The name of the end
+     * @param result The result
+     * @param seconds The wall-clock duration of the benchmark
+     */
+    void printEnd(const char *name, const EndResult &result, const double seconds)
+    {
+        double waitMs = std::chrono::duration<double, std::milli>(result.stats.waitTime).count();
+        std::cout << name << ":\n";
+        std::cout << "  Bytes received: " << result.transfers << " (" << result.errors << " errors)\n";
+        std::cout << "  Throughput: " << static_cast<double>(result.transfers) / seconds << " bytes/s\n";
+        std::cout << "  Messages sent / received: " << result.stats.messagesSent << " / " << result.stats.messagesReceived << "\n";
+        std::cout << "  Time waiting for the other end: " << waitMs << " ms";
+        if (result.transfers > 0)
+            std::cout << " (" << waitMs * 1000 / static_cast<double>(result.transfers) << " us per byte)";
+        std::cout << std::endl;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Emulated seconds (default: 60 s, about 61k bytes at 8192 Hz)
+    uint64_t seconds = argc > 1 ? std::stoull(argv[1]) : 60;
+    uint64_t cycles = seconds * cpu_cycles::CLOCK_FREQUENCY;
+
+    LinkCable master;
+    LinkCable slave;
+    if (!LinkCable::connectPair(master, slave))
+        return 1;
+
+    EndResult masterResult;
+    EndResult slaveResult;
+    auto start = std::chrono::steady_clock::now();
+    std::thread slaveThread(runEnd, std::ref(slave), false, cycles, std::ref(slaveResult));
+    runEnd(master, true, cycles, masterResult);
+    slaveThread.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Emulated " << seconds << " s in " << elapsed << " s (" << static_cast<double>(seconds) / elapsed << "x real time)\n";
+    std::cout << "Mean latency of a byte: " << elapsed * 1e6 / static_cast<double>(masterResult.transfers) << " us\n";
+    printEnd("Clock provider", masterResult, elapsed);
+    printEnd("External clock", slaveResult, elapsed);
+
+    return masterResult.errors + slaveResult.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+/*
+ * Benchmark of the vectorised environment.
+ * Steps a batch of emulators with random actions and reports the aggregate number of frames emulated per second
+ * for an increasing number of threads (up to the number of cores).
+ */
+
+#include "vec_env.h" // VecEnv
+
+#include <algorithm> // std::max
+#include <chrono> // std::chrono::steady_clock, std::chrono::duration
+#include <fstream> // std::ifstream
+#include <iostream> // std::cout, std::endl
+#include <iterator> // std::istreambuf_iterator
+#include <random> // std::mt19937
+#include <string> // std::string, std::stoul
+#include <thread> // std::thread::hardware_concurrency
+#include <vector> // std::vector
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " rom.gb [environments] [steps]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    std::vector<uint8_t> rom(std::istreambuf_iterator<char>(file), {});
+    size_t environments = argc > 2 ? std::stoul(argv[2]) : 64;
+    size_t steps = argc > 3 ? std::stoul(argv[3]) : 100;
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+    // Powers of 2, then all the cores
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < cores; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(cores);
+
+    double singleThreadFps = 0;
+    for (size_t threads : threadCounts)
+    {
+        gameboy::VecEnvOptions options;
+        options.environments = environments;
+        options.threads = threads;
+        auto env = gameboy::VecEnv::create(rom, options);
+        if (!env)
+            return 1;
+
+        std::vector<uint8_t> observations(env->getEnvironmentCount() * env->getObservationSize());
+        std::vector<uint8_t> actions(env->getEnvironmentCount());
+        std::mt19937 random(0);
+        env->reset(observations.data());
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t step = 0; step < steps; step++)
+        {
+            for (auto &action : actions)
+                action = static_cast<uint8_t>(random());
+            if (!env->step(actions.data(), observations.data()))
+                return 1;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double fps = static_cast<double>(environments * steps * options.frameSkip) / seconds;
+        if (threads == 1)
+            singleThreadFps = fps;
+        std::cout << threads << " threads: " << static_cast<uint64_t>(fps) << " frames/s ("
+                  << fps / singleThreadFps << "x)" << std::endl;
+    }
+
+    return 0;
+}
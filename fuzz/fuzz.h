@@ -0,0 +1,30 @@
+/**
+ * @file fuzz.h
+ * @brief This file contains the helpers shared by the fuzz targets.
+ *        Each target defines LLVMFuzzerTestOneInput, and is linked with libFuzzer (Clang) or with standalone_main.cpp.
+ */
+
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t
+#include <iostream> // std::cout
+
+/**
+ * @brief Run the emulator on an input
+ *
+ * @param data The input
+ * @param size The size of the input
+ * @return 0 (the input can be added to the corpus)
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+namespace gameboyFuzz
+{
+    /**
+     * @brief Discard the messages of the emulator (e.g. the warnings of the writes to the ROM): they slow down the fuzzing
+     */
+    inline const bool silenced = (std::cout.rdbuf(nullptr), true);
+
+    inline volatile uint32_t sink; ///< Receives the bytes read, so that the reads are not optimized away
+} // namespace gameboyFuzz
@@ -0,0 +1,28 @@
+/*
+ * Fuzz the loading of a cartridge: the input is the content of the ROM.
+ */
+
+#include "cartridge.h" // Cartridge
+#include "fuzz.h" // LLVMFuzzerTestOneInput
+
+#include <vector> // std::vector
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    gameboy::Cartridge cartridge;
+    cartridge.loadROMData(std::vector<uint8_t>(data, data + size));
+
+    // Read the ROM banks and the RAM (the reads must stay in the ROM and the RAM, whatever the header says)
+    uint32_t sum = 0;
+    for (uint32_t address = 0x0000; address < 0x8000; address += 0x100)
+        sum += cartridge.read(static_cast<uint16_t>(address));
+    cartridge.write(0x0000, 0x0A); // Enable the RAM
+    for (uint32_t address = 0xA000; address < 0xC000; address += 0x100)
+        sum += cartridge.read(static_cast<uint16_t>(address));
+    gameboyFuzz::sink = sum;
+
+    std::vector<uint8_t> state;
+    gameboy::StateWriter writer(state);
+    cartridge.saveState(writer);
+    return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * Fuzz the CPU (and the memory map, the PPU, the timer...) with random instruction streams.
+ * The input is the ROM: a short input is the code executed from the entry point (0x0100) of an empty ROM,
+ * a longer one is a whole ROM. The emulation stops after a budget of cycles, or at the first unexpected opcode.
+ */
+
+#include "emulator.h" // Emulator
+#include "fuzz.h" // LLVMFuzzerTestOneInput
+
+#include <algorithm> // std::copy, std::min
+#include <vector> // std::vector
+
+namespace
+{
+    constexpr uint64_t CYCLES_BUDGET = 4 * gameboy::ppu_timing::CYCLES_PER_FRAME; ///< The number of cycles emulated per input
+    constexpr uint16_t ENTRY_POINT = 0x0100; ///< The address of the first instruction executed
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    std::vector<uint8_t> rom;
+    if (size > gameboy::cartridge_info::CARTRIDGE_HEADER_END_ADDRESS)
+        rom.assign(data, data + size);
+    else
+    {
+        rom.assign(0x8000, 0x00);
+        std::copy(data, data + size, rom.begin() + ENTRY_POINT);
+    }
+
+    auto emulator = gameboy::Emulator::create(rom);
+    if (!emulator)
+    {
+        // Unsupported cartridge type: run the code without MBC
+        rom[gameboy::cartridge_info::CARTRIDGE_TYPE_ADDRESS] = 0x00;
+        emulator = gameboy::Emulator::create(std::move(rom));
+    }
+    if (emulator)
+        emulator->runCycles(CYCLES_BUDGET);
+    return 0;
+}
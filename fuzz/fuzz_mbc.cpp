@@ -0,0 +1,62 @@
+/*
+ * Fuzz the registers of the MBCs: the input selects the MBC and the sizes of the ROM and of the RAM,
+ * then it is a sequence of writes (address, value), each one followed by reads of the switchable banks.
+ */
+
+#include "fuzz.h" // LLVMFuzzerTestOneInput
+#include "mbc.h" // ROMOnly, MBC1, MBC2, MBC3, MBC5
+
+#include <memory> // std::unique_ptr, std::make_unique
+#include <utility> // std::move
+#include <vector> // std::vector
+
+namespace
+{
+    constexpr size_t HEADER_SIZE = 3; ///< MBC, ROM size, RAM size
+    constexpr size_t RAM_SIZES[] = {0, 0x800, 0x2000, 0x8000, 0x20000}; ///< The RAM sizes of the cartridges
+
+    /**
+     * @brief Create an MBC
+     *
+     * @param type The type of the MBC (any value)
+     * @param rom The ROM
+     * @param ram The RAM
+     */
+    std::unique_ptr<gameboy::MBC> createMBC(const uint8_t type, std::vector<uint8_t> rom, std::vector<uint8_t> ram)
+    {
+        switch (type % 5)
+        {
+            case 0: return std::make_unique<gameboy::ROMOnly>(std::move(rom), std::move(ram));
+            case 1: return std::make_unique<gameboy::MBC1>(std::move(rom), std::move(ram));
+            case 2: return std::make_unique<gameboy::MBC2>(std::move(rom), std::move(ram));
+            case 3: return std::make_unique<gameboy::MBC3>(std::move(rom), std::move(ram));
+            default: return std::make_unique<gameboy::MBC5>(std::move(rom), std::move(ram));
+        }
+    }
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < HEADER_SIZE)
+        return 0;
+
+    // The ROM size is any multiple of 4 KB (up to 1 MB), not only a power of 2
+    std::vector<uint8_t> rom(static_cast<size_t>(data[1]) * 0x1000);
+    for (size_t i = 0; i < rom.size(); i++)
+        rom[i] = static_cast<uint8_t>(i >> 12);
+    std::vector<uint8_t> ram(RAM_SIZES[data[2] % 5], 0x00);
+    std::unique_ptr<gameboy::MBC> mbc = createMBC(data[0], std::move(rom), std::move(ram));
+
+    for (size_t i = HEADER_SIZE; i + 3 <= size; i += 3)
+    {
+        auto address = static_cast<uint16_t>(data[i] << 8 | data[i + 1]);
+        uint8_t value = data[i + 2];
+        if (address < 0x8000 || (address >= 0xA000 && address < 0xC000))
+            mbc->write(address, value);
+
+        gameboyFuzz::sink = mbc->read(static_cast<uint16_t>(0x0000 + value * 0x40)) +
+                            mbc->read(static_cast<uint16_t>(0x4000 + value * 0x40)) +
+                            mbc->read(static_cast<uint16_t>(0xA000 + value * 0x20));
+    }
+    return 0;
+}
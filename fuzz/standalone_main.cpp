@@ -0,0 +1,68 @@
+/*
+ * Driver of the fuzz targets for the compilers without libFuzzer (e.g. GCC): run the target on the files given
+ * as arguments (or on all the files of the directories given as arguments), e.g. to check a corpus or a crash.
+ * The options of libFuzzer (-runs=0, ...) are ignored.
+ */
+
+#include "fuzz.h" // LLVMFuzzerTestOneInput
+
+#include <filesystem> // std::filesystem
+#include <fstream> // std::ifstream
+#include <iostream> // std::cerr, std::endl
+#include <iterator> // std::istreambuf_iterator
+#include <string> // std::string
+#include <vector> // std::vector
+
+namespace
+{
+    /**
+     * @brief Run the target on a file
+     *
+     * @param path The file
+     * @return True if the file has been read, false otherwise
+     */
+    bool runFile(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not read " << path.string() << std::endl;
+            return false;
+        }
+
+        std::vector<uint8_t> input(std::istreambuf_iterator<char>(file), {});
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+        return true;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    size_t inputs = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument.empty() || argument[0] == '-')
+            continue;
+
+        std::error_code error;
+        if (std::filesystem::is_directory(argument, error))
+        {
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(argument, error))
+            {
+                if (!entry.is_regular_file())
+                    continue;
+                if (!runFile(entry.path()))
+                    return 1;
+                inputs++;
+            }
+        }
+        else if (runFile(argument))
+            inputs++;
+        else
+            return 1;
+    }
+
+    std::cerr << "Ran " << inputs << " inputs" << std::endl;
+    return 0;
+}
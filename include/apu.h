@@ -0,0 +1,304 @@
+/**
+ * @file apu.h
+ * @brief This file contains the declaration of the APU class.
+ *        It emulates the audio processing unit of the Game Boy (the 4 sound channels).
+ */
+
+/*
+ * See https://gbdev.io/pandocs/Audio.html
+ * See https://gbdev.gg8.se/wiki/articles/Gameboy_sound_hardware
+ */
+
+#pragma once
+
+#include "blip_buffer.h" // BlipBuffer
+#include "memory.h" // Memory
+#include "ring_buffer.h" // RingBuffer
+
+#include <array> // std::array
+#include <memory> // std::unique_ptr
+
+namespace gameboy
+{
+    namespace apu_registers
+    {
+        constexpr uint16_t FIRST_REGISTER_ADDRESS = 0xFF10; ///< The address of the first register of the APU (NR10)
+        constexpr uint16_t LAST_REGISTER_ADDRESS = 0xFF3F; ///< The address of the last register of the APU (end of the wave RAM)
+        constexpr uint16_t NR52_ADDRESS = 0xFF26; ///< The address of the Sound on/off register
+        constexpr uint16_t WAVE_RAM_ADDRESS = 0xFF30; ///< The address of the wave pattern RAM
+    } // namespace apu_registers
+
+    /**
+     * @brief The APU class emulates the audio processing unit of the Game Boy.
+     * @details The APU is driven lazily: cycle only counts the elapsed cycles, and the channels are emulated
+     *          when a register is accessed or when a batch of cycles is due. The channels are emulated from
+     *          one change of their output to the next (not cycle by cycle), and each change is added to a
+     *          band-limited synthesizer. The samples of a batch are then pushed to the audio output.
+     *
+     *          Memory forwards the accesses to the registers 0xFF10-0xFF3F to the APU (see Memory::setAPU).
+     */
+    class APU
+    {
+    public:
+        /**
+         * @brief Construct a new APU object
+         * @details Take the initial values of the registers from the memory and attach the APU to the memory
+         *
+         * @param memory The memory
+         */
+        explicit APU(Memory &memory);
+
+        /**
+         * @brief Detach the APU from the memory
+         */
+        ~APU();
+
+        /// APU cannot be copied
+        APU(const APU &) = delete;
+
+        /// APU cannot be assigned
+        APU &operator=(const APU &) = delete;
+
+        /**
+         * @brief Set where the samples are written
+         * @details Without an output, the channels are emulated but no samples are produced
+         *
+         * @param output The buffer receiving the interleaved stereo samples (nullptr to remove the output)
+         * @param sampleRate The sample rate of the output (Hz)
+         */
+        void setOutput(RingBuffer<int16_t> *output, uint32_t sampleRate);
+
+        /**
+         * @brief Adjust the sample rate of the output
+         * @details Used to produce a bit more or less samples when the emulation and the audio device drift apart
+         *
+         * @param ratio The ratio applied to the sample rate of the output (0.99-1.01)
+         * @see FramePacer::setAudioSync
+         */
+        void setRateAdjustment(double ratio);
+
+        /**
+         * @brief Mute/Unmute the output
+         * @details The muted cycles are emulated but do not produce samples.
+         *          Used for the frames that are emulated but not displayed (e.g. the run-ahead frames)
+         *
+         * @param muted True if the output should be muted, false otherwise
+         */
+        void setMuted(bool muted);
+
+        /**
+         * @brief Count the cycles elapsed
+         * @details The channels are emulated only when a batch of cycles is due
+         *
+         * @param cycles The number of cycles elapsed
+         */
+        void cycle(uint8_t cycles);
+
+        /**
+         * @brief Emulate the pending cycles and push their samples to the output
+         */
+        void flush();
+
+        /**
+         * @brief Read a register of the APU
+         *
+         * @param address The address of the register (0xFF10-0xFF3F)
+         * @return The value of the register (the write-only bits read as 1)
+         */
+        uint8_t readRegister(uint16_t address);
+
+        /**
+         * @brief Write a register of the APU
+         * @details The pending cycles are emulated before the write, so that it happens at the right time
+         *
+         * @param address The address of the register (0xFF10-0xFF3F)
+         * @param value The value to write
+         */
+        void writeRegister(uint16_t address, uint8_t value);
+
+        /**
+         * @brief Save the state of the APU (registers and channels)
+         * @details The pending cycles must be flushed before saving the state
+         *
+         * @param writer The state writer
+         * @see flush
+         */
+        void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the APU
+         *
+         * @param reader The state reader
+         * @see saveState
+         */
+        void loadState(StateReader &reader);
+
+    private:
+        /**
+         * @brief The state of the volume envelope (channels 1, 2 and 4)
+         */
+        struct Envelope
+        {
+            uint8_t volume = 0; ///< The current volume (0-15)
+            uint8_t period = 0; ///< The number of frame sequencer ticks between two volume changes (0 = disabled)
+            uint8_t timer = 0; ///< The number of ticks until the next volume change
+            bool increase = false; ///< True if the volume increases, false if it decreases
+        };
+
+        /**
+         * @brief The state of a square channel (channels 1 and 2)
+         */
+        struct SquareChannel
+        {
+            bool enabled = false; ///< Whether the channel is playing
+            bool dacEnabled = false; ///< Whether the DAC of the channel is on
+            bool lengthEnabled = false; ///< Whether the channel stops when the length counter reaches 0
+            uint16_t length = 0; ///< The length counter
+            uint16_t frequency = 0; ///< The 11 bit frequency
+            uint32_t timer = 0; ///< The number of cycles until the next step of the duty cycle
+            uint8_t duty = 0; ///< The duty cycle (0-3)
+            uint8_t dutyStep = 0; ///< The position in the duty cycle (0-7)
+            Envelope envelope; ///< The volume envelope
+
+            // Frequency sweep (channel 1 only)
+            bool sweepEnabled = false; ///< Whether the sweep is active
+            bool sweepDecrease = false; ///< True if the frequency decreases, false if it increases
+            uint8_t sweepPeriod = 0; ///< The number of frame sequencer ticks between two sweeps
+            uint8_t sweepShift = 0; ///< The shift applied to the frequency at each sweep
+            uint8_t sweepTimer = 0; ///< The number of ticks until the next sweep
+            uint16_t shadowFrequency = 0; ///< The frequency used by the sweep
+        };
+
+        /**
+         * @brief The state of the wave channel (channel 3)
+         */
+        struct WaveChannel
+        {
+            bool enabled = false; ///< Whether the channel is playing
+            bool dacEnabled = false; ///< Whether the DAC of the channel is on
+            bool lengthEnabled = false; ///< Whether the channel stops when the length counter reaches 0
+            uint16_t length = 0; ///< The length counter
+            uint16_t frequency = 0; ///< The 11 bit frequency
+            uint32_t timer = 0; ///< The number of cycles until the next sample
+            uint8_t volumeShift = 4; ///< The shift applied to the samples (4 = mute)
+            uint8_t position = 0; ///< The position in the wave RAM (0-31)
+            uint8_t sample = 0; ///< The current sample (0-15)
+        };
+
+        /**
+         * @brief The state of the noise channel (channel 4)
+         */
+        struct NoiseChannel
+        {
+            bool enabled = false; ///< Whether the channel is playing
+            bool dacEnabled = false; ///< Whether the DAC of the channel is on
+            bool lengthEnabled = false; ///< Whether the channel stops when the length counter reaches 0
+            uint16_t length = 0; ///< The length counter
+            uint32_t timer = 0; ///< The number of cycles until the next shift of the LFSR
+            uint16_t lfsr = 0x7FFF; ///< The linear feedback shift register
+            Envelope envelope; ///< The volume envelope
+        };
+
+        static constexpr uint32_t BATCH_CYCLES = 8192; ///< The number of cycles emulated at once when no register is accessed
+        static constexpr uint32_t FRAME_SEQUENCER_CYCLES = 8192; ///< The period of the frame sequencer (512 Hz)
+        static constexpr int32_t AMPLITUDE_SCALE = 32; ///< The scale applied to the output of the mixer (max 4 * 15 * 8)
+
+        std::array<uint8_t, apu_registers::LAST_REGISTER_ADDRESS - apu_registers::FIRST_REGISTER_ADDRESS + 1> m_registers{}; ///< The registers
+        Memory &m_memory; ///< The memory
+
+        bool m_powered = true; ///< Whether the APU is on (bit 7 of NR52)
+        SquareChannel m_channel1; ///< Square channel with sweep
+        SquareChannel m_channel2; ///< Square channel
+        WaveChannel m_channel3; ///< Wave channel
+        NoiseChannel m_channel4; ///< Noise channel
+        uint32_t m_frameSequencerTimer = FRAME_SEQUENCER_CYCLES; ///< The number of cycles until the next tick of the frame sequencer
+        uint8_t m_frameSequencerStep = 0; ///< The step of the frame sequencer (0-7)
+        uint32_t m_pendingCycles = 0; ///< The number of cycles not emulated yet
+
+        // Output (not part of the state)
+        RingBuffer<int16_t> *m_output = nullptr; ///< The buffer receiving the samples
+        uint32_t m_sampleRate = 0; ///< The sample rate of the output
+        std::unique_ptr<BlipBuffer> m_left; ///< The synthesizer of the left output
+        std::unique_ptr<BlipBuffer> m_right; ///< The synthesizer of the right output
+        bool m_muted = false; ///< Whether the output is muted
+        std::array<std::array<int32_t, 2>, 4> m_amplitudes{}; ///< The amplitude of each channel (left, right) in the synthesizers
+
+        /**
+         * @brief Emulate the pending cycles
+         */
+        void catchUp();
+
+        /**
+         * @brief Emulate the channels until the specified time
+         *
+         * @param start The current time (cycles since the beginning of the batch)
+         * @param end The time to reach
+         */
+        void runChannels(uint32_t start, uint32_t end);
+
+        /**
+         * @brief Clock the length counters, the sweep and the envelopes
+         */
+        void clockFrameSequencer();
+
+        /**
+         * @brief Compute the digital output (0-15) of a channel
+         *
+         * @param channel The channel (0-3)
+         * @return The output of the channel
+         */
+        [[nodiscard]] uint8_t getChannelOutput(int channel) const;
+
+        /**
+         * @brief Add the change of the output of a channel to the synthesizers
+         *
+         * @param channel The channel (0-3)
+         * @param time The time of the change (cycles since the beginning of the batch)
+         */
+        void updateAmplitude(int channel, uint32_t time);
+
+        /**
+         * @brief Add the change of the output of all the channels to the synthesizers
+         *
+         * @param time The time of the change (cycles since the beginning of the batch)
+         */
+        void updateAmplitudes(uint32_t time);
+
+        /**
+         * @brief Compute the frequency of the next sweep of the channel 1 and disable it on overflow
+         *
+         * @return The new frequency
+         */
+        uint16_t computeSweepFrequency();
+
+        /**
+         * @brief Restart a channel (bit 7 of NRx4)
+         *
+         * @param channel The channel (0-3)
+         */
+        void trigger(int channel);
+
+        /**
+         * @brief Clock the volume envelope
+         *
+         * @param envelope The envelope
+         */
+        static void clockEnvelope(Envelope &envelope);
+
+        /**
+         * @brief Load the volume envelope from the NRx2 register
+         *
+         * @param envelope The envelope
+         * @param value The value of the register
+         */
+        static void loadEnvelope(Envelope &envelope, uint8_t value);
+
+        /**
+         * @brief Get the value of a register
+         *
+         * @param address The address of the register
+         * @return A reference to the value of the register
+         */
+        uint8_t &reg(uint16_t address);
+    };
+} // namespace gameboy
@@ -0,0 +1,104 @@
+/**
+ * @file blip_buffer.h
+ * @brief This file contains the declaration of the BlipBuffer class.
+ *        It converts the amplitude changes of a signal clocked at the CPU frequency into band-limited samples.
+ */
+
+#pragma once
+
+#include <array> // std::array
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t, uint64_t, int16_t, int32_t, int64_t
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The BlipBuffer class synthesizes a band-limited signal from its amplitude changes (deltas).
+     * @details Instead of generating the signal cycle by cycle and resampling it, each change of amplitude
+     *          adds a band-limited step (a windowed sinc, stored in a table for 32 sub-sample phases)
+     *          to the output samples. The samples are integrated when they are read.
+     *          This removes the aliasing of the square waves and the cost only depends on the number of changes.
+     *
+     *          The time of the deltas is relative to the beginning of the current frame (in clock cycles).
+     *          A frame is closed by endFrame, which makes its samples available.
+     */
+    class BlipBuffer
+    {
+    public:
+        /**
+         * @brief Construct a new BlipBuffer object
+         *
+         * @param clockRate The frequency of the clock used for the time of the deltas (Hz)
+         * @param sampleRate The frequency of the output samples (Hz)
+         * @param maxFrameCycles The maximum duration of a frame (clock cycles)
+         */
+        BlipBuffer(uint32_t clockRate, uint32_t sampleRate, uint32_t maxFrameCycles);
+
+        /**
+         * @brief Change the frequency of the output samples
+         * @details Must be called between two frames. Used to make small adjustments to the sample rate,
+         *          so it cannot be higher than the sample rate used to construct the buffer (+1%)
+         *
+         * @param sampleRate The new frequency of the output samples (Hz)
+         */
+        void setSampleRate(double sampleRate);
+
+        /**
+         * @brief Add a change of amplitude
+         *
+         * @param time The time of the change, relative to the beginning of the frame (clock cycles)
+         * @param delta The change of amplitude
+         */
+        void addDelta(uint32_t time, int32_t delta);
+
+        /**
+         * @brief Close the current frame and make its samples available
+         *
+         * @param duration The duration of the frame (clock cycles)
+         */
+        void endFrame(uint32_t duration);
+
+        /**
+         * @brief Get the number of samples that can be read
+         *
+         * @return The number of samples available
+         */
+        [[nodiscard]] size_t samplesAvailable() const;
+
+        /**
+         * @brief Read and remove the available samples
+         *
+         * @param out The destination of the samples
+         * @param count The maximum number of samples to read
+         * @param stride The distance between two samples in out (2 to interleave a stereo signal)
+         * @return The number of samples read
+         */
+        size_t readSamples(int16_t *out, size_t count, size_t stride);
+
+    private:
+        static constexpr int PHASE_BITS = 5; ///< The number of bits of the sub-sample phase
+        static constexpr int PHASE_COUNT = 1 << PHASE_BITS; ///< The number of sub-sample phases of the steps
+        static constexpr int KERNEL_WIDTH = 16; ///< The number of samples touched by a step
+        static constexpr int KERNEL_BITS = 15; ///< The precision of the kernel (the taps of a phase sum to 1 << KERNEL_BITS)
+        static constexpr int HIGH_PASS_SHIFT = 9; ///< The strength of the high-pass filter that removes the DC offset
+        static constexpr int TIME_BITS = 32; ///< The fractional bits of the position of the samples
+
+        /// The band-limited impulses for each phase (integrated when the samples are read, they become steps)
+        static const std::array<std::array<int32_t, KERNEL_WIDTH>, PHASE_COUNT> KERNEL;
+
+        uint32_t m_clockRate; ///< The frequency of the clock used for the time of the deltas
+        uint64_t m_factor; ///< The number of samples per clock cycle (fixed point, TIME_BITS fractional bits)
+        uint64_t m_offset = 0; ///< The position of the beginning of the frame (fixed point, TIME_BITS fractional bits)
+        size_t m_available = 0; ///< The number of complete samples
+        int64_t m_integrator = 0; ///< The current amplitude (sum of the deltas, KERNEL_BITS fractional bits)
+        std::vector<int32_t> m_samples; ///< The deltas spread by the kernel
+
+        /**
+         * @brief Create the table of the band-limited impulses
+         *
+         * @return The kernel (a Blackman-windowed sinc for each phase)
+         */
+        static std::array<std::array<int32_t, KERNEL_WIDTH>, PHASE_COUNT> createKernel();
+    };
+} // namespace gameboy
@@ -0,0 +1,47 @@
+/**
+ * @file bus.h
+ * @brief This file contains the description of the memory bus concept of the CPU (see BasicCPU),
+ *        and a trait to check at compile time that a type models it.
+ */
+
+#pragma once
+
+#include <cstdint> // uint8_t, uint16_t
+#include <type_traits> // std::true_type, std::false_type, std::void_t, std::is_convertible
+
+namespace gameboy
+{
+    /**
+     * @brief Check whether a type can be used as the memory bus of the CPU.
+     * @details A bus provides (the calls are resolved at compile time, there is no virtual call):
+     *              - uint8_t read(uint16_t address)
+     *              - void write(uint16_t address, uint8_t value)
+     *              - uint16_t readWord(uint16_t address) (little endian)
+     *              - void writeWord(uint16_t address, uint16_t value) (little endian)
+     *              - void tick(uint8_t cycles), called by the CPU with the machine cycles of each instruction
+     *
+     *          The implementations are Memory (the Game Boy), FlatMemory (64 KB of RAM, for the tests),
+     *          TracingBus (records the accesses of another bus)
+     *          DebugBus (checks the accesses of another bus for the watchpoints of a debugger)
+     *          and TimedBus (clocks the other components before each access to another bus).
+     *
+     * @tparam T The type to check
+     */
+    template <typename T, typename = void>
+    struct is_bus : std::false_type
+    {};
+
+    /// @copydoc is_bus
+    template <typename T>
+    struct is_bus<T, std::void_t<decltype(std::declval<T &>().write(uint16_t(), uint8_t())),
+                                decltype(std::declval<T &>().writeWord(uint16_t(), uint16_t())),
+                                decltype(std::declval<T &>().tick(uint8_t()))>>
+        : std::integral_constant<bool,
+                                 std::is_convertible_v<decltype(std::declval<T &>().read(uint16_t())), uint8_t> &&
+                                     std::is_convertible_v<decltype(std::declval<T &>().readWord(uint16_t())), uint16_t>>
+    {};
+
+    /// True if T can be used as the memory bus of the CPU (see is_bus)
+    template <typename T>
+    constexpr bool is_bus_v = is_bus<T>::value;
+} // namespace gameboy
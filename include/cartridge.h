@@ -28,6 +28,7 @@ namespace gameboy
         constexpr uint16_t CARTRIDGE_ROM_SIZE_ADDRESS = 0x0148; ///< The address of the ROM size in the header
         constexpr uint16_t CARTRIDGE_RAM_SIZE_ADDRESS = 0x0149; ///< The address of the RAM size in the header
         constexpr uint16_t CARTRIDGE_OLD_LICENSEE_CODE_ADDRESS = 0x014B; ///< The address of the old licensee code in the header
+        constexpr uint16_t CARTRIDGE_HEADER_END_ADDRESS = 0x014F; ///< The address of the last byte of the header
     } // namespace cartridge_info
 
     /**
@@ -55,18 +56,37 @@ namespace gameboy
          */
         bool loadROM(const std::string &filename);
 
+        /**
+         * @brief Load a ROM from memory into the cartridge
+         * @details Nothing is printed, and the RAM is never written to a file (see saveRAMData)
+         *
+         * @param rom The content of the ROM
+         * @param ram The content of the RAM (empty to initialize it to 0)
+         * @return true if the ROM is valid (complete header and supported cartridge type), false otherwise
+         * @see checkCartridge
+         */
+        bool loadROMData(std::vector<uint8_t> rom, std::vector<uint8_t> ram = {});
+
+        /**
+         * @brief Get the hash of the ROM (used to check that a movie or a state matches the ROM)
+         *
+         * @return The hash of the content of the ROM
+         * @see hash64
+         */
+        [[nodiscard]] uint64_t getROMHash() const;
+
         /**
          * @brief Read a byte from the cartridge
          * @details Read a byte from the cartridge at the specified address and return it
          *
          * @param address The address of the byte to read
-         * @return The byte read
+         * @return The byte read, 0xFF if no valid ROM has been loaded
          */
         [[nodiscard]] uint8_t read(uint16_t address) const;
 
         /**
          * @brief Write a byte to the cartridge
-         * @details Write a byte to the cartridge at the given address
+         * @details Write a byte to the cartridge at the given address (ignored if no valid ROM has been loaded)
          *
          * @param address The address of the byte to write
          * @param value The value to write
@@ -75,13 +95,31 @@ namespace gameboy
 
         /**
          * @brief Save the current content of the RAM to a file
+         * @details Nothing is saved if the ROM has not been loaded from a file
          *
          * @see MBC::saveRAMData
          */
         void saveRAMData() const;
 
+        /**
+         * @brief Save the state of the cartridge
+         *
+         * @param writer The state writer
+         * @see MBC::saveState
+         */
+        void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the cartridge
+         *
+         * @param reader The state reader
+         * @see MBC::loadState
+         */
+        void loadState(StateReader &reader);
+
     private:
         std::string m_ROMFilename; ///< The filename of the ROM
+        uint64_t m_ROMHash = 0; ///< The hash of the ROM
         std::unique_ptr<MBC> m_MBC; ///< The MBC of the cartridge
 
         std::string m_title; ///< The title of the cartridge (used for printing)
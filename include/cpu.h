@@ -12,98 +12,116 @@
 
 #pragma once
 
+#include "bus.h" // is_bus_v
+#include "debug_bus.h" // DebugBus
+#include "flat_memory.h" // FlatMemory
 #include "memory.h" // Memory
+#include "opcodes.h" // cpu_cycles::OPCODE_CYCLES, cpu_cycles::OPCODE_CYCLES_BRANCHED, cpu_cycles::OPCODE_CB_CYCLES
 #include "registers.h" // Registers
+#include "savestate.h" // StateWriter, StateReader
+#include "tracing_bus.h" // TracingBus
 
 namespace gameboy
 {
     namespace cpu_cycles
     {
-        // clang-format off
-        constexpr uint8_t OPCODE_CYCLES[256] =
-        {// 0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F
-            1, 3, 2, 2, 1, 1, 2, 1, 5, 2, 2, 2, 1, 1, 2, 1, // 0
-            1, 3, 2, 2, 1, 1, 2, 1, 3, 2, 2, 2, 1, 1, 2, 1, // 1
-            2, 3, 2, 2, 1, 1, 2, 1, 2, 2, 2, 2, 1, 1, 2, 1, // 2
-            2, 3, 2, 2, 3, 3, 3, 1, 2, 2, 2, 2, 1, 1, 2, 1, // 3
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 4
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 5
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 6
-            2, 2, 2, 2, 2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 2, 1, // 7
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 8
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 9
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // A
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // B
-            2, 3, 3, 4, 3, 4, 2, 4, 2, 4, 3, 0, 3, 6, 2, 4, // C
-            2, 3, 3, 0, 3, 4, 2, 4, 2, 4, 3, 0, 3, 0, 2, 4, // D
-            3, 3, 2, 0, 0, 4, 2, 4, 4, 1, 4, 0, 0, 0, 2, 4, // E
-            3, 3, 2, 1, 0, 4, 2, 4, 3, 2, 4, 1, 0, 0, 2, 4  // F
-        }; ///< Opcodes machine cycles
-
-        constexpr uint8_t OPCODE_CYCLES_BRANCHED[256] =
-        {// 0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F
-            1, 3, 2, 2, 1, 1, 2, 1, 5, 2, 2, 2, 1, 1, 2, 1, // 0
-            1, 3, 2, 2, 1, 1, 2, 1, 3, 2, 2, 2, 1, 1, 2, 1, // 1
-            3, 3, 2, 2, 1, 1, 2, 1, 3, 2, 2, 2, 1, 1, 2, 1, // 2
-            3, 3, 2, 2, 3, 3, 3, 1, 3, 2, 2, 2, 1, 1, 2, 1, // 3
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 4
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 5
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 6
-            2, 2, 2, 2, 2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 2, 1, // 7
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 8
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // 9
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // A
-            1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, // B
-            5, 3, 4, 4, 6, 4, 2, 4, 5, 4, 4, 0, 6, 6, 2, 4, // C
-            5, 3, 4, 0, 6, 4, 2, 4, 5, 4, 4, 0, 6, 0, 2, 4, // D
-            3, 3, 2, 0, 0, 4, 2, 4, 4, 1, 4, 0, 0, 0, 2, 4, // E
-            3, 3, 2, 1, 0, 4, 2, 4, 3, 2, 4, 1, 0, 0, 2, 4  // F
-        }; ///< Opcodes machine cycles when branched (jump, call, return)
-
-        constexpr uint8_t OPCODE_CB_CYCLES[256] =
-        {// 0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // 0
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // 1
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // 2
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // 3
-            2, 2, 2, 2, 2, 2, 3, 2, 2, 2, 2, 2, 2, 2, 3, 2, // 4
-            2, 2, 2, 2, 2, 2, 3, 2, 2, 2, 2, 2, 2, 2, 3, 2, // 5
-            2, 2, 2, 2, 2, 2, 3, 2, 2, 2, 2, 2, 2, 2, 3, 2, // 6
-            2, 2, 2, 2, 2, 2, 3, 2, 2, 2, 2, 2, 2, 2, 3, 2, // 7
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // 8
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // 9
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // A
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // B
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // C
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // D
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2, // E
-            2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 4, 2  // F
-        }; ///< Opcodes cb-prefixed machine cycles
-        // clang-format on
+        constexpr uint32_t CLOCK_FREQUENCY = 4194304; ///< The number of clock cycles (T-cycles) per second
     } // namespace cpu_cycles
 
     /**
      * @brief CPU class that emulates the behavior of the CPU (logic and arithmetic).
+     * @details The CPU is generic over its memory bus (see is_bus), so that the bus can be replaced without virtual calls
+     *          (e.g. FlatMemory for the CPU tests, TracingBus to record the accesses, DebugBus for the watchpoints,
+     *          TimedBus for the timing of the accesses).
+     *          The definitions are in cpu_impl.h. cpu.cpp instantiates the CPU for the buses listed at the end of this file
+     *          (a new bus must be added there); the CPU on the TimedBus of the Emulator is instantiated in emulator_timed.cpp.
+     *
+     * @tparam Bus The memory bus
      */
-    class CPU
+    template <typename Bus>
+    class BasicCPU
     {
+        static_assert(is_bus_v<Bus>, "The CPU needs a bus (see is_bus)");
+
     public:
         /**
          * @brief Initialize the CPU.
          *
-         * @param memory The memory
+         * @param bus The memory bus
          */
-        explicit CPU(Memory &memory);
+        explicit BasicCPU(Bus &bus);
 
         /**
          * @brief Get the opcode of the next instruction, increment the program counter and execute the instruction.
+         * @details The machine cycles of the instruction are then ticked on the bus.
          *
          * @return The number of cycles used by the instruction, 0 if the instruction does not exist.
          */
         uint8_t cycle();
 
+        /**
+         * @brief Save the state of the CPU (registers, halt and IME flags)
+         *
+         * @param writer The state writer
+         */
+        void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the CPU
+         *
+         * @param reader The state reader
+         * @see saveState
+         */
+        void loadState(StateReader &reader);
+
+        /**
+         * @brief Get the registers (e.g. to set up or check a test)
+         *
+         * @return The registers
+         */
+        [[nodiscard]] Registers &getRegisters()
+        {
+            return m_registers;
+        }
+
+        /// @copydoc getRegisters
+        [[nodiscard]] const Registers &getRegisters() const
+        {
+            return m_registers;
+        }
+
+        /**
+         * @brief Check whether the interrupts are enabled (IME flag)
+         *
+         * @return True if the interrupts are enabled, false otherwise
+         */
+        [[nodiscard]] bool getIME() const
+        {
+            return m_ime;
+        }
+
+        /**
+         * @brief Enable/Disable the interrupts (IME flag)
+         *
+         * @param ime True to enable the interrupts, false to disable them
+         */
+        void setIME(const bool ime)
+        {
+            m_ime = ime;
+        }
+
+        /**
+         * @brief Check whether the CPU is halted (waiting for an interrupt)
+         *
+         * @return True if the CPU is halted, false otherwise
+         */
+        [[nodiscard]] bool isHalted() const
+        {
+            return m_halted;
+        }
+
     private:
-        Memory &m_memory; ///< The memory
+        Bus &m_bus; ///< The memory bus
         Registers m_registers; ///< The registers
 
         bool m_halted = false; ///< True if the cpu is halted
@@ -741,4 +759,13 @@ namespace gameboy
          */
         void reti();
     };
+
+    // Instantiated in cpu.cpp
+    extern template class BasicCPU<Memory>;
+    extern template class BasicCPU<FlatMemory>;
+    extern template class BasicCPU<TracingBus<Memory>>;
+    extern template class BasicCPU<TracingBus<FlatMemory>>;
+    extern template class BasicCPU<DebugBus<Memory>>;
+
+    using CPU = BasicCPU<Memory>; ///< The CPU of the Game Boy
 } // namespace gameboy
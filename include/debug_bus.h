@@ -0,0 +1,91 @@
+/**
+ * @file debug_bus.h
+ * @brief This file contains the declaration of the DebugBus class.
+ *        It checks the accesses of the CPU to the pages watched by a debugger before forwarding them to another bus.
+ */
+
+#pragma once
+
+#include "bus.h" // is_bus_v
+#include "debugger.h" // Debugger, WatchType
+
+#include <cstdint> // uint8_t, uint16_t
+
+namespace gameboy
+{
+    /**
+     * @brief DebugBus forwards the accesses to another bus, and reports the accesses to the watched pages to a debugger.
+     * @details The CPU only uses this bus while a debugger is attached (see Emulator::setDebugger), so the watchpoints
+     *          cost nothing otherwise. The words are checked as two bytes (low byte first), like the accesses of the hardware.
+     *
+     * @tparam Bus The bus that receives the accesses
+     */
+    template <typename Bus>
+    class DebugBus
+    {
+        static_assert(is_bus_v<Bus>, "DebugBus needs a bus (see is_bus)");
+
+    public:
+        /**
+         * @brief Construct a debug bus (without debugger, the accesses are only forwarded)
+         *
+         * @param bus The bus that receives the accesses
+         */
+        explicit DebugBus(Bus &bus)
+            : m_bus(bus)
+        {}
+
+        // The bus (see is_bus)
+        uint8_t read(const uint16_t address)
+        {
+            check(address, WatchType::READ);
+            return m_bus.read(address);
+        }
+
+        void write(const uint16_t address, const uint8_t value)
+        {
+            check(address, WatchType::WRITE);
+            m_bus.write(address, value);
+        }
+
+        uint16_t readWord(const uint16_t address)
+        {
+            uint8_t low = read(address);
+            return static_cast<uint16_t>(low | (read(static_cast<uint16_t>(address + 1)) << 8));
+        }
+
+        void writeWord(const uint16_t address, const uint16_t value)
+        {
+            write(address, static_cast<uint8_t>(value & 0xFF));
+            write(static_cast<uint16_t>(address + 1), static_cast<uint8_t>(value >> 8));
+        }
+
+        void tick(const uint8_t cycles)
+        {
+            m_bus.tick(cycles);
+        }
+
+        /**
+         * @brief Set the debugger that receives the accesses to the watched pages
+         *
+         * @param debugger The debugger (nullptr to only forward the accesses)
+         */
+        void setDebugger(Debugger *debugger)
+        {
+            m_debugger = debugger;
+        }
+
+    private:
+        Bus &m_bus; ///< The bus that receives the accesses
+        Debugger *m_debugger = nullptr; ///< The debugger (nullptr if none)
+
+        /**
+         * @brief Report an access to the debugger if its page is watched
+         */
+        void check(const uint16_t address, const WatchType access)
+        {
+            if (m_debugger && (m_debugger->getPageFlags(address) & static_cast<uint8_t>(access)))
+                m_debugger->onAccess(address, access);
+        }
+    };
+} // namespace gameboy
@@ -0,0 +1,216 @@
+/**
+ * @file debugger.h
+ * @brief This file contains the declaration of the Debugger class.
+ *        It stops the emulation on the breakpoints, the watchpoints and the single steps (see GDBStub for the front end).
+ */
+
+#pragma once
+
+#include <array> // std::array
+#include <bitset> // std::bitset
+#include <cstdint> // uint8_t, uint16_t
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The accesses that trigger a watchpoint
+     */
+    enum class WatchType : uint8_t
+    {
+        READ = 0x01, ///< The reads of the watched bytes
+        WRITE = 0x02, ///< The writes to the watched bytes
+        ACCESS = 0x03 ///< The reads and the writes (bitwise or of READ and WRITE)
+    };
+
+    /**
+     * @brief Why the emulation stopped
+     */
+    enum class StopReason
+    {
+        NONE, ///< The emulation is running (or has never been resumed)
+        BREAKPOINT, ///< The next instruction is on a breakpoint
+        WATCHPOINT, ///< The last instruction accessed a watched byte (see getWatchHit)
+        STEP, ///< A single instruction has been executed
+        INTERRUPT, ///< The user interrupted the emulation (e.g. Ctrl-C in the debugger)
+        ERROR ///< The CPU encountered an unexpected opcode
+    };
+
+    /**
+     * @brief The access that triggered a watchpoint
+     */
+    struct WatchHit
+    {
+        uint16_t address = 0; ///< The address accessed
+        WatchType type = WatchType::WRITE; ///< The type of the watchpoint that has been triggered
+    };
+
+    /**
+     * @brief Debugger decides when the emulation stops.
+     * @details The emulator only checks the debugger when one is attached (see Emulator::setDebugger): the loop is then
+     *          instantiated with the check of shouldStop before each instruction, and the CPU accesses the memory through
+     *          a DebugBus. Without debugger, the loop and the bus of the CPU are unchanged.
+     *          The breakpoints are a bitmap of the address space, so the check is a single lookup.
+     *
+     *          The watchpoints mark the pages of 256 bytes they cover: only the accesses to these pages reach onAccess,
+     *          which compares the address with the watchpoints. A watchpoint stops the emulation after the instruction
+     *          that triggered it, like the hardware watchpoints of most CPUs.
+     *          The accesses are only checked while running, so the reads of the front end do not trigger them.
+     */
+    class Debugger
+    {
+    public:
+        /**
+         * @brief Add a breakpoint (the emulation stops before the instruction at the address)
+         *
+         * @param address The address of the instruction
+         */
+        void addBreakpoint(uint16_t address);
+
+        /**
+         * @brief Remove a breakpoint
+         *
+         * @param address The address of the instruction
+         * @return False if there was no breakpoint at the address, true otherwise
+         */
+        bool removeBreakpoint(uint16_t address);
+
+        /**
+         * @brief Check whether there is a breakpoint at an address
+         *
+         * @param address The address
+         * @return True if there is a breakpoint, false otherwise
+         */
+        [[nodiscard]] bool hasBreakpoint(uint16_t address) const;
+
+        /**
+         * @brief Add a watchpoint on a range of addresses
+         *
+         * @param address The first address of the range
+         * @param length The number of bytes of the range (at least 1)
+         * @param type The accesses that trigger the watchpoint
+         */
+        void addWatchpoint(uint16_t address, uint16_t length, WatchType type);
+
+        /**
+         * @brief Remove a watchpoint
+         *
+         * @param address The first address of the range
+         * @param length The number of bytes of the range
+         * @param type The accesses that trigger the watchpoint
+         * @return False if there was no such watchpoint, true otherwise
+         */
+        bool removeWatchpoint(uint16_t address, uint16_t length, WatchType type);
+
+        /**
+         * @brief Let the emulation run until the next stop
+         * @details The instruction at the current address is executed even if it has a breakpoint,
+         *          otherwise the emulation could not leave a breakpoint
+         *
+         * @param singleStep True to stop after one instruction, false to run until a breakpoint or a watchpoint
+         */
+        void resume(bool singleStep);
+
+        /**
+         * @brief Stop the emulation before the next instruction
+         *
+         * @param reason The reason of the stop (e.g. StopReason::INTERRUPT)
+         */
+        void stop(StopReason reason);
+
+        /**
+         * @brief Check whether the emulation is running
+         *
+         * @return True between resume and the next stop, false otherwise
+         */
+        [[nodiscard]] bool isRunning() const;
+
+        /**
+         * @brief Get the reason of the last stop
+         *
+         * @return The reason (StopReason::NONE while running)
+         */
+        [[nodiscard]] StopReason getStopReason() const;
+
+        /**
+         * @brief Get the access that triggered the last watchpoint
+         *
+         * @return The access (only meaningful if the reason of the stop is StopReason::WATCHPOINT)
+         */
+        [[nodiscard]] WatchHit getWatchHit() const;
+
+        /**
+         * @brief Check whether the emulation must stop before the next instruction (called by the emulation loop)
+         *
+         * @param pc The address of the next instruction
+         * @param halted True if the CPU is halted (it does not execute the instruction)
+         * @return True to stop, false to execute the instruction
+         */
+        [[nodiscard]] bool shouldStop(const uint16_t pc, const bool halted)
+        {
+            if (!m_running)
+                return true;
+            if (m_firstStep)
+            {
+                m_firstStep = false;
+                return false;
+            }
+            if (m_singleStep)
+            {
+                stop(StopReason::STEP);
+                return true;
+            }
+            if (!halted && m_breakpoints[pc])
+            {
+                stop(StopReason::BREAKPOINT);
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Get the accesses that are checked for the page of an address
+         *
+         * @param address The address
+         * @return The flags of the page (bitwise or of WatchType values)
+         */
+        [[nodiscard]] uint8_t getPageFlags(const uint16_t address) const
+        {
+            return m_pages[address >> 8];
+        }
+
+        /**
+         * @brief Check an access to a watched page (called by DebugBus before the access)
+         *
+         * @param address The address accessed
+         * @param access WatchType::READ or WatchType::WRITE
+         */
+        void onAccess(uint16_t address, WatchType access);
+
+    private:
+        /**
+         * @brief A watched range of addresses
+         */
+        struct Watchpoint
+        {
+            uint16_t address; ///< The first address of the range
+            uint16_t length; ///< The number of bytes of the range
+            WatchType type; ///< The accesses that trigger the watchpoint
+        };
+
+        std::bitset<0x10000> m_breakpoints; ///< The addresses of the breakpoints
+        std::vector<Watchpoint> m_watchpoints; ///< The watchpoints
+        std::array<uint8_t, 0x100> m_pages{}; ///< The accesses checked on each page of 256 bytes (see getPageFlags)
+
+        bool m_running = false; ///< True between resume and the next stop
+        bool m_singleStep = false; ///< True to stop after one instruction
+        bool m_firstStep = false; ///< True until the first instruction after resume is executed
+        StopReason m_stopReason = StopReason::NONE; ///< The reason of the last stop
+        WatchHit m_watchHit; ///< The access that triggered the last watchpoint
+
+        /**
+         * @brief Compute the flags of the pages from the watchpoints
+         */
+        void updatePages();
+    };
+} // namespace gameboy
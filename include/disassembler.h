@@ -0,0 +1,247 @@
+/**
+ * @file disassembler.h
+ * @brief This file contains the declaration of the SymbolTable and Disassembler classes.
+ *        They print the instructions of a ROM with the names of an RGBDS symbol file, and, from an instruction
+ *        trace, an annotated listing of the executed code with its hottest routines.
+ */
+
+/*
+ * See https://rgbds.gbdev.io/docs/rgblink.1 (the symbol file, option -n)
+ */
+
+#pragma once
+
+#include <array> // std::array
+#include <cstdint> // uint8_t, uint16_t, uint32_t, uint64_t
+#include <istream> // std::istream
+#include <map> // std::map
+#include <ostream> // std::ostream
+#include <string> // std::string
+#include <unordered_map> // std::unordered_map
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    namespace rom_banks
+    {
+        constexpr uint16_t BANK_SIZE = 0x4000; ///< The size of a ROM bank
+        constexpr uint16_t SWITCHABLE_BANK_START = 0x4000; ///< The first address of the switchable ROM bank
+        constexpr uint16_t ROM_END = 0x8000; ///< The first address after the ROM
+    } // namespace rom_banks
+
+    /**
+     * @brief SymbolTable stores the names of the addresses, as written by the linker of RGBDS.
+     * @details Each line of a symbol file is "BB:AAAA Name", where BB is the bank and AAAA the address (in hexadecimal),
+     *          and everything after a ';' is a comment.
+     */
+    class SymbolTable
+    {
+    public:
+        /**
+         * @brief Read the symbols of a symbol file
+         *
+         * @param stream The symbol file
+         * @return The number of lines that are neither a symbol nor a comment (they are skipped)
+         */
+        size_t load(std::istream &stream);
+
+        /**
+         * @brief Add a symbol
+         *
+         * @param bank The bank of the address
+         * @param address The address
+         * @param name The name of the address (a second name for the same address is ignored)
+         */
+        void add(uint16_t bank, uint16_t address, const std::string &name);
+
+        /**
+         * @brief Find the name of an address
+         * @details The bank only matters for the switchable ROM bank (0x4000-0x7FFF): for the other addresses,
+         *          a symbol of any bank matches (e.g. WRAMX symbols are in bank 1)
+         *
+         * @param bank The bank of the address
+         * @param address The address
+         * @return The name, nullptr if the address has no name
+         */
+        [[nodiscard]] const std::string *find(uint16_t bank, uint16_t address) const;
+
+        /**
+         * @brief Find the closest symbol at or before an address of the ROM, in the same bank
+         *
+         * @param bank The bank of the address
+         * @param address The address (less than 0x8000)
+         * @param symbolAddress The address of the symbol found
+         * @return The name, nullptr if there is no symbol before the address in the bank
+         */
+        [[nodiscard]] const std::string *findContaining(uint16_t bank, uint16_t address, uint16_t &symbolAddress) const;
+
+        /**
+         * @brief Get the number of symbols
+         *
+         * @return The number of symbols
+         */
+        [[nodiscard]] size_t size() const
+        {
+            return m_symbols.size();
+        }
+
+    private:
+        std::map<uint32_t, std::string> m_symbols; ///< The symbols, by bank then address (see makeKey)
+        std::unordered_map<uint16_t, uint32_t> m_byAddress; ///< The key of the first symbol of each address
+
+        /**
+         * @brief Make the key of a symbol, ordered by bank then address
+         */
+        [[nodiscard]] static uint32_t makeKey(uint16_t bank, uint16_t address)
+        {
+            return static_cast<uint32_t>(bank) << 16 | address;
+        }
+    };
+
+    /**
+     * @brief A decoded instruction of the ROM
+     */
+    struct Instruction
+    {
+        uint16_t bank = 0; ///< The ROM bank of the instruction (0 for 0x0000-0x3FFF)
+        uint16_t address = 0; ///< The address of the instruction
+        uint8_t length = 0; ///< The length in bytes (0 while the entry of the cache is not decoded)
+        std::array<uint8_t, 3> bytes{}; ///< The bytes of the instruction (only the first length bytes are meaningful)
+        std::string text; ///< The instruction, with the names of the symbols as operands (e.g. "CALL UpdateSprites")
+    };
+
+    /**
+     * @brief Disassembler decodes the instructions of a ROM.
+     * @details The mnemonics, the lengths and the cycles of the instructions come from the tables of the CPU
+     *          (see opcodes.h), so the disassembly cannot disagree with the emulation.
+     *          The decoded instructions are cached per ROM bank (the cache of a bank is allocated the first time
+     *          one of its instructions is decoded), so the listings decode each address only once.
+     *
+     *          The hits of the instructions are counted from an instruction trace (see TraceWriter). A trace only
+     *          has the address of the instructions: an address of the switchable bank is assigned to the first
+     *          bank whose byte at this address is the opcode of the record.
+     */
+    class Disassembler
+    {
+    public:
+        /**
+         * @brief Construct a disassembler for a ROM
+         *
+         * @param rom The content of the ROM
+         * @param symbols The names of the addresses (nullptr for none), it must outlive the disassembler
+         */
+        explicit Disassembler(std::vector<uint8_t> rom, const SymbolTable *symbols = nullptr);
+
+        /**
+         * @brief Decode the instruction at an address of the ROM
+         *
+         * @param bank The ROM bank (ignored for 0x0000-0x3FFF)
+         * @param address The address of the instruction (less than 0x8000)
+         * @return The instruction (it stays in the cache as long as the disassembler)
+         */
+        const Instruction &decode(uint16_t bank, uint16_t address);
+
+        /**
+         * @brief Get the number of ROM banks
+         *
+         * @return The number of banks of 16 KiB (at least 2)
+         */
+        [[nodiscard]] uint16_t getBankCount() const;
+
+        /**
+         * @brief Count the instruction of a trace record
+         *
+         * @param pc The address of the instruction
+         * @param opcode The first byte of the instruction
+         */
+        void addHit(uint16_t pc, uint8_t opcode);
+
+        /**
+         * @brief Count the instructions of a trace
+         *
+         * @param stream The trace (opened in binary mode)
+         * @return False if the trace is not valid, true otherwise
+         */
+        bool loadHits(std::istream &stream);
+
+        /**
+         * @brief Get the number of times an instruction of the ROM has been executed
+         *
+         * @param bank The ROM bank (ignored for 0x0000-0x3FFF)
+         * @param address The address of the instruction
+         * @return The number of hits
+         */
+        [[nodiscard]] uint64_t getHits(uint16_t bank, uint16_t address) const;
+
+        /**
+         * @brief Get the total number of instructions counted
+         *
+         * @return The number of hits, including the instructions outside the ROM
+         */
+        [[nodiscard]] uint64_t getTotalHits() const
+        {
+            return m_totalHits;
+        }
+
+        /**
+         * @brief Print all the instructions of the ROM, bank by bank, with the labels of the symbols
+         *
+         * @param output The stream on which the listing is printed
+         */
+        void writeListing(std::ostream &output);
+
+        /**
+         * @brief Print the executed instructions of the ROM with their hits, after a summary of the hottest routines
+         * @details A routine starts at a symbol of the ROM or at the target of an executed CALL or RST
+         *
+         * @param output The stream on which the listing is printed
+         * @param routines The maximum number of routines of the summary
+         */
+        void writeHotListing(std::ostream &output, size_t routines);
+
+    private:
+        std::vector<uint8_t> m_rom; ///< The content of the ROM
+        const SymbolTable *m_symbols; ///< The names of the addresses (nullptr for none)
+        std::vector<std::vector<Instruction>> m_cache; ///< The decoded instructions, by bank then offset in the bank
+        std::vector<uint64_t> m_hits; ///< The hits of the instructions, by offset in the ROM
+        uint64_t m_totalHits = 0; ///< The number of instructions counted
+        uint64_t m_outsideHits = 0; ///< The number of instructions counted outside the ROM (e.g. HRAM)
+
+        /**
+         * @brief Get the offset in the ROM of an address
+         */
+        [[nodiscard]] size_t getOffset(uint16_t bank, uint16_t address) const;
+
+        /**
+         * @brief Read a byte of the ROM (0xFF past the end)
+         */
+        [[nodiscard]] uint8_t readROM(size_t offset) const;
+
+        /**
+         * @brief Format an address as an operand: the name of its symbol, or its value (e.g. "$C000")
+         */
+        [[nodiscard]] std::string formatAddress(uint16_t bank, uint16_t address) const;
+
+        /**
+         * @brief Format an instruction
+         */
+        [[nodiscard]] std::string format(const Instruction &instruction) const;
+
+        /**
+         * @brief Print an instruction on one line, with its bytes, its cycles and its hits
+         */
+        void writeInstruction(std::ostream &output, const Instruction &instruction, uint64_t hits) const;
+    };
+
+    /**
+     * @brief Print the disassembly of a ROM file (used by the --disassemble option)
+     *
+     * @param romFile The ROM file
+     * @param symbolFile The RGBDS symbol file (empty for none)
+     * @param traceFile The trace file whose hits annotate the executed instructions (empty to print the whole ROM)
+     * @param output The stream on which the disassembly is printed
+     * @return 0 on success, 1 if a file cannot be read
+     */
+    int disassembleFile(const std::string &romFile, const std::string &symbolFile, const std::string &traceFile,
+                        std::ostream &output);
+} // namespace gameboy
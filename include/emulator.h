@@ -0,0 +1,421 @@
+/**
+ * @file emulator.h
+ * @brief This file contains the declaration of the Emulator class.
+ *        It is the embeddable core of the emulator: it owns all the components and has no dependency on SDL.
+ */
+
+#pragma once
+
+#include "apu.h" // APU
+#include "cartridge.h" // Cartridge
+#include "cpu.h" // CPU
+#include "debug_bus.h" // DebugBus, Debugger
+#include "input.h" // Input
+#include "memory.h" // Memory
+#include "perf_counters.h" // PerfCounters
+#include "ppu.h" // PPU
+#include "serial.h" // Serial, SerialSink
+#include "timed_bus.h" // TimedBus
+#include "timer.h" // Timer
+#include "trace.h" // TraceSink, TraceRecord
+
+#include <memory> // std::unique_ptr
+#include <string> // std::string
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief A read-only view of the frame buffer
+     * @details The pixels are stored row by row, from the top-left corner
+     */
+    struct FrameBufferView
+    {
+        const Colour *pixels; ///< The pixels (width * height)
+        uint32_t width; ///< The width of the screen in pixels
+        uint32_t height; ///< The height of the screen in pixels
+
+        /**
+         * @brief Get a pixel
+         *
+         * @param x The column of the pixel
+         * @param y The row of the pixel
+         * @return The colour of the pixel
+         */
+        [[nodiscard]] const Colour &at(uint32_t x, uint32_t y) const
+        {
+            return pixels[y * width + x];
+        }
+    };
+
+    /**
+     * @brief When the memory accesses of the CPU happen (see Emulator::setAccuracy)
+     */
+    enum class Accuracy
+    {
+        INSTRUCTION, ///< All the accesses of an instruction happen before the components are clocked for its cycles (fastest)
+        MACHINE_CYCLE ///< Each access happens at its machine cycle, after the components are clocked for the cycles before it
+    };
+
+    /**
+     * @brief The Emulator class is the embeddable core of the emulator.
+     * @details It owns the cartridge and all the components, and emulates them on demand: nothing is displayed
+     *          or played, and the emulation never blocks. The front ends (e.g. the SDL one, see GB) read the
+     *          frame buffer after each frame and give the state of the buttons.
+     *
+     *          The components keep references to each other, so an Emulator cannot be copied nor moved:
+     *          it is created on the heap by create or createFromFile.
+     */
+    class Emulator
+    {
+    public:
+        /// Emulator cannot be copied
+        Emulator(const Emulator &) = delete;
+
+        /// Emulator cannot be assigned
+        Emulator &operator=(const Emulator &) = delete;
+
+        /**
+         * @brief Create an emulator from a ROM in memory
+         * @details The RAM of the cartridge starts empty and is never written to a file
+         *
+         * @param rom The content of the ROM
+         * @return The emulator, nullptr if the ROM is not valid
+         */
+        static std::unique_ptr<Emulator> create(std::vector<uint8_t> rom);
+
+        /**
+         * @brief Create an emulator from a ROM file
+         * @details The RAM of the cartridge is loaded from the save file (ROM name with the .sav extension), if any
+         *
+         * @param filename The name of the ROM file
+         * @return The emulator, nullptr if the file cannot be read or the ROM is not valid
+         * @see Cartridge::loadROM
+         */
+        static std::unique_ptr<Emulator> createFromFile(const std::string &filename);
+
+        /**
+         * @brief Emulate the components until the PPU has a frame ready
+         * @details If the LCD is disabled no frame is produced, so the emulation stops after the cycles of a frame
+         *
+         * @return False if the CPU encountered an error (unexpected opcode), true otherwise
+         * @see isFrameReady
+         */
+        bool runFrame();
+
+        /**
+         * @brief Emulate the components for a number of cycles
+         * @details The emulation stops at the end of the instruction that reaches the number of cycles,
+         *          so a few more cycles can be emulated (see getCycles)
+         *
+         * @param cycles The number of cycles to emulate
+         * @return False if the CPU encountered an error (unexpected opcode), true otherwise
+         */
+        bool runCycles(uint64_t cycles);
+
+        /**
+         * @brief Set the state of all the buttons of the joypad
+         * @details The joypad interrupt is requested if a button has been pressed since the last call
+         *
+         * @param mask The pressed buttons (bitwise or of JoypadButton values)
+         */
+        void setInput(uint8_t mask);
+
+        /**
+         * @brief Get the state of all the buttons of the joypad
+         *
+         * @return The pressed buttons (bitwise or of JoypadButton values)
+         * @see setInput
+         */
+        [[nodiscard]] uint8_t getInputMask() const;
+
+        /**
+         * @brief Check if the last call of runFrame produced a frame
+         *
+         * @return False if the LCD is disabled, true otherwise
+         */
+        [[nodiscard]] bool isFrameReady() const;
+
+        /**
+         * @brief Get the last frame produced by the PPU
+         *
+         * @return A view of the frame buffer (valid as long as the emulator)
+         */
+        [[nodiscard]] FrameBufferView frameBuffer() const;
+
+        /**
+         * @brief Read a byte of the memory (e.g. a variable of the game)
+         *
+         * @param address The address of the byte
+         * @return The byte read
+         */
+        [[nodiscard]] uint8_t readMemory(uint16_t address) const;
+
+        /**
+         * @brief Write a byte to the memory, like the CPU does (e.g. to change a variable of the game)
+         * @details The writes to the ROM area go to the registers of the MBC
+         *
+         * @param address The address of the byte
+         * @param value The byte to write
+         */
+        void writeMemory(uint16_t address, uint8_t value);
+
+        /**
+         * @brief Get the registers of the CPU (e.g. to inspect or change them in a debugger)
+         *
+         * @return The registers
+         */
+        [[nodiscard]] Registers &getRegisters();
+
+        /**
+         * @brief Get the hash of the ROM
+         *
+         * @return The hash of the ROM
+         * @see Cartridge::getROMHash
+         */
+        [[nodiscard]] uint64_t getROMHash() const;
+
+        /**
+         * @brief Get the number of cycles emulated since the creation of the emulator
+         *
+         * @return The number of cycles
+         */
+        [[nodiscard]] uint64_t getCycles() const;
+
+        /**
+         * @brief Get the number of instructions executed since the creation of the emulator
+         * @details The steps of the halted CPU are not counted (they are not restored by loadState either)
+         *
+         * @return The number of instructions
+         */
+        [[nodiscard]] uint64_t getInstructions() const;
+
+        /**
+         * @brief Save the state of all the components
+         *
+         * @param state The buffer that receives the state (cleared first, its capacity is reused)
+         * @see loadState
+         */
+        void saveState(std::vector<uint8_t> &state) const;
+
+        /**
+         * @brief Restore the state of all the components
+         * @details The state must have been saved by an emulator running the same ROM.
+         *          If the state is not valid (e.g. truncated) the emulator is left unchanged
+         *
+         * @param state The state
+         * @return True if the state has been restored, false otherwise
+         * @see saveState
+         */
+        bool loadState(const std::vector<uint8_t> &state);
+
+        /**
+         * @brief Connect something to the serial port (e.g. a link cable)
+         *
+         * @param sink The other end of the serial port (nullptr to disconnect it)
+         */
+        void setSerialSink(SerialSink *sink);
+
+        /**
+         * @brief Record the state of the CPU before each instruction (e.g. to compare two versions of the emulator)
+         * @details Without tracer, the emulation loop does not check for one (see emulate)
+         *
+         * @param tracer The receiver of the records, e.g. an open TraceWriter (nullptr to stop tracing)
+         * @see diffTraces
+         */
+        void setTracer(TraceSink *tracer);
+
+        /**
+         * @brief Get the state of the CPU before the next instruction
+         *
+         * @return The PC, the opcode at PC, the registers and the number of cycles emulated
+         */
+        [[nodiscard]] TraceRecord getCPUState() const;
+
+        /**
+         * @brief Measure the frames and the rendering with the hardware performance counters
+         * @details Each runFrame is accumulated in PerfSubsystem::FRAME, the scanlines drawn by the PPU in
+         *          PerfSubsystem::PPU_RENDERING (the CPU dispatch loop and the other components are the difference)
+         *
+         * @param counters The open counters (nullptr to stop measuring)
+         * @see PerfCounters::open
+         */
+        void setPerfCounters(PerfCounters *counters);
+
+        /**
+         * @brief Attach a debugger, which decides when the emulation stops
+         * @details runFrame and runCycles return early when the debugger stops the emulation (they return at once while
+         *          it is stopped). Without debugger, the emulation loop does not check for one (see emulate).
+         *          The watchpoints are checked by a DebugBus on top of the bus of the accuracy (see setAccuracy)
+         *
+         * @param debugger The debugger (nullptr to detach it)
+         * @see Debugger::resume
+         */
+        void setDebugger(Debugger *debugger);
+
+        /**
+         * @brief Choose when the memory accesses of the CPU happen
+         * @details With Accuracy::MACHINE_CYCLE, the CPU accesses the memory through a TimedBus, so the registers
+         *          read during an instruction (e.g. LY, TIMA) have advanced by the cycles of the instruction before the access.
+         *          The loop is instantiated for each accuracy, and the timed one is compiled in its own translation unit
+         *          (emulator_timed.cpp), so Accuracy::INSTRUCTION keeps its speed.
+         *          With a debugger attached, the watchpoints are checked on the timed bus (see setDebugger)
+         *
+         * @param accuracy The accuracy (Accuracy::INSTRUCTION by default)
+         */
+        void setAccuracy(Accuracy accuracy);
+
+        /**
+         * @brief Get when the memory accesses of the CPU happen
+         *
+         * @return The accuracy
+         * @see setAccuracy
+         */
+        [[nodiscard]] Accuracy getAccuracy() const;
+
+        /**
+         * @brief Skip/Do the rendering of the frames (the frame buffer is not updated when skipped)
+         *
+         * @param skip True if the rendering should be skipped, false otherwise
+         * @see PPU::setSkipRendering
+         */
+        void setSkipRendering(bool skip);
+
+        /**
+         * @brief Save the current content of the RAM to the save file (only for the ROMs loaded from a file)
+         *
+         * @see Cartridge::saveRAMData
+         */
+        void saveRAMData() const;
+
+        /**
+         * @brief Get the APU (to connect the audio output)
+         *
+         * @return The APU
+         */
+        APU &getAPU();
+
+        /**
+         * @brief Get the input (for the front ends that handle the buttons one by one)
+         *
+         * @return The input
+         */
+        Input &getInput();
+
+    private:
+        /// The timed bus clocks the components with advance
+        friend class TimedBus<Memory, Emulator>;
+
+        Cartridge m_cartridge; ///< The cartridge
+        Memory m_memory; ///< The memory
+        CPU m_cpu; ///< The CPU
+        DebugBus<Memory> m_debugBus; ///< The bus of the CPU while a debugger is attached (it checks the watchpoints)
+        BasicCPU<DebugBus<Memory>> m_debugCPU; ///< The CPU while a debugger is attached (its state is copied from m_cpu)
+        PPU m_ppu; ///< The PPU
+        Timer m_timer; ///< The timer
+        APU m_apu; ///< The APU
+        Serial m_serial; ///< The serial port
+        Input m_input; ///< The joypad
+
+        TraceSink *m_tracer = nullptr; ///< The instruction trace (nullptr if not traced)
+        PerfCounters *m_perfCounters = nullptr; ///< The hardware performance counters (nullptr if not measured)
+        Debugger *m_debugger = nullptr; ///< The debugger (nullptr if not debugged)
+        Accuracy m_accuracy = Accuracy::INSTRUCTION; ///< When the memory accesses of the CPU happen
+
+        uint64_t m_cycles = 0; ///< The number of cycles emulated
+        uint64_t m_instructions = 0; ///< The number of instructions executed
+        std::vector<uint8_t> m_cpuState; ///< The buffer used to copy the state of a CPU to the other one
+
+        // The timed core is kept after the components, so that it does not move them in the memory
+        TimedBus<Memory, Emulator> m_timedBus; ///< The bus of the CPU with Accuracy::MACHINE_CYCLE (it clocks the components)
+        BasicCPU<TimedBus<Memory, Emulator>> m_timedCPU; ///< The CPU with Accuracy::MACHINE_CYCLE (its state is copied from m_cpu)
+        DebugBus<TimedBus<Memory, Emulator>> m_timedDebugBus; ///< The bus of the CPU with Accuracy::MACHINE_CYCLE while a debugger is attached
+        BasicCPU<DebugBus<TimedBus<Memory, Emulator>>> m_timedDebugCPU; ///< The CPU with Accuracy::MACHINE_CYCLE while a debugger is attached
+
+        static constexpr uint32_t STATE_MAGIC = 0x33534247; ///< The first bytes of a state ("GBS3")
+
+        /**
+         * @brief Construct the components (the cartridge is loaded afterward)
+         */
+        Emulator();
+
+        /**
+         * @brief Emulate the components (all but the CPU) for a number of cycles
+         * @details Defined in emulator_impl.h, so that it is inlined into the emulation loops and into the TimedBus
+         *
+         * @param cycles The number of cycles
+         */
+        void advance(uint8_t cycles);
+
+        /**
+         * @brief Emulate an instruction and the components for its duration
+         *
+         * @tparam Traced True to record the instruction in the trace
+         * @tparam Timed True if the bus of the CPU clocks the components (see TimedBus)
+         * @tparam Core The type of the CPU (see getCore)
+         * @param cpu The CPU that executes the instruction
+         * @return The number of cycles emulated, 0 if the CPU encountered an error (unexpected opcode)
+         */
+        template <bool Traced, bool Timed, typename Core>
+        uint8_t step(Core &cpu);
+
+        /**
+         * @brief Get the CPU that runs the emulation loop
+         *
+         * @tparam Debugged True while a debugger is attached
+         * @tparam Timed True with Accuracy::MACHINE_CYCLE
+         * @return m_timedDebugCPU if debugged and timed, m_debugCPU if debugged, m_timedCPU if timed, m_cpu otherwise
+         */
+        template <bool Debugged, bool Timed>
+        auto &getCore();
+
+        /**
+         * @brief Copy the state of a CPU to another one (e.g. from m_cpu to m_debugCPU)
+         *
+         * @param from The CPU to copy
+         * @param to The CPU that receives the state
+         */
+        template <typename From, typename To>
+        void copyCPUState(const From &from, To &to);
+
+        /**
+         * @brief Get the state of a CPU before its next instruction
+         *
+         * @param registers The registers of the CPU
+         * @return The PC, the opcode at PC, the registers and the number of cycles emulated
+         */
+        [[nodiscard]] TraceRecord makeTraceRecord(const Registers &registers) const;
+
+        /**
+         * @brief Emulate the instructions until the end of a frame or until a number of cycles is reached
+         * @details The tracer, the debugger and the accuracy are checked once per call instead of once per instruction.
+         *          While debugged, the instructions are executed by a CPU whose bus checks the watchpoints.
+         *          When timed, they are executed by a CPU whose bus clocks the components before each access (see getCore).
+         *          The timed instances are defined in emulator_timed.cpp, the others in emulator.cpp.
+         *          Each instance stays a function of its own (not inlined into dispatch), so the loop of the common case
+         *          is optimized alone instead of being merged with the traced and debugged ones
+         *
+         * @tparam Traced True to record the instructions in the trace
+         * @tparam Debugged True to ask the debugger before each instruction whether to stop
+         * @tparam Timed True to clock the components at each memory access (Accuracy::MACHINE_CYCLE)
+         * @param maxCycles The maximum number of cycles to emulate (a bit more, see runCycles)
+         * @param untilFrame True to stop when the PPU has a frame ready, false to run all the cycles
+         * @return False if the CPU encountered an error (unexpected opcode), true otherwise
+         */
+        template <bool Traced, bool Debugged, bool Timed>
+        [[gnu::noinline]] bool emulate(uint64_t maxCycles, bool untilFrame);
+
+        /**
+         * @brief Call the instance of emulate that matches the tracer, the debugger and the accuracy
+         *
+         * @param maxCycles The maximum number of cycles to emulate
+         * @param untilFrame True to stop when the PPU has a frame ready, false to run all the cycles
+         * @return False if the CPU encountered an error (unexpected opcode), true otherwise
+         */
+        bool dispatch(uint64_t maxCycles, bool untilFrame);
+    };
+
+    // Instantiated in emulator_timed.cpp
+    extern template class BasicCPU<TimedBus<Memory, Emulator>>;
+    extern template class BasicCPU<DebugBus<TimedBus<Memory, Emulator>>>;
+} // namespace gameboy
@@ -0,0 +1,98 @@
+/**
+ * @file emulator_impl.h
+ * @brief This file contains the definition of the emulation loop of the Emulator class (advance, step, emulate).
+ *        It is only included by the translation units that instantiate the loop: emulator.cpp for
+ *        Accuracy::INSTRUCTION, emulator_timed.cpp for Accuracy::MACHINE_CYCLE (with the CPU on the TimedBus).
+ *        The fast loop is then compiled without the timed CPU, which would change how the compiler inlines it.
+ */
+
+#pragma once
+
+#include "emulator.h" // Emulator
+
+namespace gameboy
+{
+    inline void Emulator::advance(const uint8_t cycles)
+    {
+        m_timer.cycle(cycles);
+        m_ppu.cycle(cycles);
+        m_apu.cycle(cycles);
+        m_serial.cycle(cycles);
+    }
+
+    template <bool Traced, bool Timed, typename Core>
+    uint8_t Emulator::step(Core &cpu)
+    {
+        // The halted CPU executes no instruction
+        bool halted = cpu.isHalted();
+        if constexpr (Traced)
+        {
+            if (!halted)
+                m_tracer->record(makeTraceRecord(cpu.getRegisters()));
+        }
+        m_instructions += halted ? 0 : 1;
+
+        uint8_t cycles = cpu.cycle() * 4;
+        if (cycles == 0) // An unexpected opcode was encountered
+            return 0;
+
+        // The timed bus has clocked the components during the instruction
+        if constexpr (!Timed)
+            advance(cycles);
+        m_cycles += cycles;
+        return cycles;
+    }
+
+    template <bool Debugged, bool Timed>
+    auto &Emulator::getCore()
+    {
+        if constexpr (Debugged && Timed)
+            return m_timedDebugCPU;
+        else if constexpr (Debugged)
+            return m_debugCPU;
+        else if constexpr (Timed)
+            return m_timedCPU;
+        else
+            return m_cpu;
+    }
+
+    template <typename From, typename To>
+    void Emulator::copyCPUState(const From &from, To &to)
+    {
+        StateWriter writer(m_cpuState);
+        from.saveState(writer);
+        StateReader reader(m_cpuState);
+        to.loadState(reader);
+    }
+
+    template <bool Traced, bool Debugged, bool Timed>
+    bool Emulator::emulate(const uint64_t maxCycles, const bool untilFrame)
+    {
+        auto &cpu = getCore<Debugged, Timed>();
+        if constexpr (Debugged || Timed)
+            copyCPUState(m_cpu, cpu);
+
+        bool result = true;
+        uint64_t end = m_cycles + maxCycles;
+        while (m_cycles < end && !(untilFrame && m_ppu.isRenderingEnabled()))
+        {
+            if constexpr (Debugged)
+            {
+                if (m_debugger->shouldStop(cpu.getRegisters().pc, cpu.isHalted()))
+                    break;
+            }
+
+            if (step<Traced, Timed>(cpu) == 0)
+            {
+                if constexpr (Debugged)
+                    m_debugger->stop(StopReason::ERROR);
+                result = false;
+                break;
+            }
+        }
+
+        if constexpr (Debugged || Timed)
+            copyCPUState(cpu, m_cpu);
+        return result;
+    }
+} // namespace gameboy
@@ -0,0 +1,100 @@
+/**
+ * @file flat_memory.h
+ * @brief This file contains the declaration of the FlatMemory class.
+ *        It is a plain 64 KB memory bus for the CPU, without cartridge nor I/O registers (e.g. for the CPU tests).
+ */
+
+#pragma once
+
+#include <array> // std::array
+#include <cstdint> // uint8_t, uint16_t, uint64_t
+
+namespace gameboy
+{
+    /**
+     * @brief FlatMemory is a memory bus where every address is a plain byte of RAM.
+     * @details It can replace Memory as the bus of the CPU (see is_bus): nothing is mapped (no cartridge, no MBC,
+     *          no I/O registers, no echo RAM), so the CPU can be tested on its own.
+     */
+    class FlatMemory
+    {
+    public:
+        /**
+         * @brief Read a byte
+         *
+         * @param address The address of the byte
+         * @return The byte read
+         */
+        [[nodiscard]] uint8_t read(const uint16_t address) const
+        {
+            return m_memory[address];
+        }
+
+        /**
+         * @brief Write a byte
+         *
+         * @param address The address of the byte
+         * @param value The byte to write
+         */
+        void write(const uint16_t address, const uint8_t value)
+        {
+            m_memory[address] = value;
+        }
+
+        /**
+         * @brief Read a word (little endian)
+         *
+         * @param address The address of the low byte
+         * @return The word read
+         */
+        [[nodiscard]] uint16_t readWord(const uint16_t address) const
+        {
+            return static_cast<uint16_t>(read(address) | (read(static_cast<uint16_t>(address + 1)) << 8));
+        }
+
+        /**
+         * @brief Write a word (little endian)
+         *
+         * @param address The address of the low byte
+         * @param value The word to write
+         */
+        void writeWord(const uint16_t address, const uint16_t value)
+        {
+            write(address, static_cast<uint8_t>(value & 0xFF));
+            write(static_cast<uint16_t>(address + 1), static_cast<uint8_t>(value >> 8));
+        }
+
+        /**
+         * @brief Count the machine cycles (called by the CPU after each instruction)
+         *
+         * @param cycles The number of machine cycles of the instruction
+         */
+        void tick(const uint8_t cycles)
+        {
+            m_cycles += cycles;
+        }
+
+        /**
+         * @brief Get the number of machine cycles ticked since the last call of clear
+         *
+         * @return The number of machine cycles
+         */
+        [[nodiscard]] uint64_t getCycles() const
+        {
+            return m_cycles;
+        }
+
+        /**
+         * @brief Set all the bytes and the number of cycles to 0
+         */
+        void clear()
+        {
+            m_memory.fill(0);
+            m_cycles = 0;
+        }
+
+    private:
+        std::array<uint8_t, 0x10000> m_memory{}; ///< The 64 KB of the address space
+        uint64_t m_cycles = 0; ///< The number of machine cycles ticked
+    };
+} // namespace gameboy
@@ -0,0 +1,72 @@
+/**
+ * @file frame_hash.h
+ * @brief This file contains the functions that hash the frames produced by an emulator.
+ *        The sequences of hashes detect the rendering regressions without storing images (golden hashes).
+ */
+
+#pragma once
+
+#include "emulator.h" // Emulator
+#include "movie.h" // Movie
+
+#include <cstdint> // uint32_t, uint64_t
+#include <string> // std::string
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The hash of a frame
+     */
+    struct FrameHash
+    {
+        uint32_t frame; ///< The index of the frame (0 = first frame)
+        uint64_t hash; ///< The hash of the frame buffer
+
+        bool operator==(const FrameHash &other) const
+        {
+            return frame == other.frame && hash == other.hash;
+        }
+    };
+
+    /**
+     * @brief Compute the hash of the last frame of an emulator
+     *
+     * @param emulator The emulator
+     * @return The hash of the visible part of the frame buffer
+     * @see hash64
+     */
+    uint64_t hashFrame(const Emulator &emulator);
+
+    /**
+     * @brief Emulate frames and hash them at each VBLANK
+     *
+     * @param emulator The emulator (just created, or prepared with Movie::start)
+     * @param movie The movie that gives the input of each frame (nullptr to not press any button)
+     * @param frames The number of frames to emulate
+     * @param interval The hash of one frame every interval frames is kept (the frames interval - 1, 2 * interval - 1, ...)
+     * @param hashes The hashes of the kept frames
+     * @return False if the CPU encountered an error (unexpected opcode), true otherwise
+     */
+    bool hashFrames(Emulator &emulator, const Movie *movie, uint32_t frames, uint32_t interval, std::vector<FrameHash> &hashes);
+
+    /**
+     * @brief Write a sequence of frame hashes to a file
+     * @details One line per frame ("frame hash", the hash in hexadecimal). The lines starting with '#' are comments
+     *
+     * @param filename The name of the file ("-" for the standard output)
+     * @param hashes The hashes
+     * @return True if the file has been written, false otherwise
+     */
+    bool saveFrameHashes(const std::string &filename, const std::vector<FrameHash> &hashes);
+
+    /**
+     * @brief Read a sequence of frame hashes from a file
+     *
+     * @param filename The name of the file
+     * @param hashes The hashes read
+     * @return True if the file has been read, false if it cannot be read or a line is not valid
+     * @see saveFrameHashes
+     */
+    bool loadFrameHashes(const std::string &filename, std::vector<FrameHash> &hashes);
+} // namespace gameboy
@@ -0,0 +1,149 @@
+/**
+ * @file frame_pacer.h
+ * @brief This file contains the declaration of the FramePacer class.
+ *        It is responsible for presenting the frames at the rate of the real hardware.
+ */
+
+/*
+ * The Game Boy does not run at 60 Hz: a frame lasts 70224 clock cycles and the clock runs at 4194304 Hz,
+ * so the real refresh rate is 4194304 / 70224 = ~59.73 Hz (~16.74 ms per frame).
+ *
+ * See https://gbdev.io/pandocs/Rendering.html
+ */
+
+#pragma once
+
+#include "ring_buffer.h" // RingBuffer
+
+#include <array> // std::array
+#include <chrono> // std::chrono::steady_clock, std::chrono::nanoseconds
+#include <cstdint> // uint8_t, uint64_t, int16_t
+
+namespace gameboy
+{
+    /**
+     * @brief The source used to pace the frames
+     */
+    enum class PacingMode : uint8_t
+    {
+        TIMER = 0, ///< Sleep until the deadline of the frame using the monotonic clock
+        VSYNC = 1, ///< Let the display (vsync) pace the frames, only measure the frame times
+        AUDIO = 2 ///< Wait until the audio device has consumed enough samples (see FramePacer::setAudioSync)
+    };
+
+    /**
+     * @brief Statistics about the last frames presented
+     */
+    struct FrameTimeStats
+    {
+        double fps = 0; ///< The measured number of frames per second
+        double meanMs = 0; ///< The mean frame time (milliseconds)
+        double jitterMs = 0; ///< The standard deviation of the frame time (milliseconds)
+        double maxErrorMs = 0; ///< The biggest distance between a frame time and the target frame time (milliseconds)
+        double rateAdjustment = 1; ///< The current ratio applied to the audio sample rate (AUDIO mode only)
+    };
+
+    /**
+     * @brief The FramePacer class waits for the deadline of each frame.
+     * @details The deadlines are computed from the start time with exact integer arithmetic,
+     *          so the rounding error of a single frame does not accumulate over time.
+     *          The waiting is done sleeping coarsely and then spinning until the deadline.
+     */
+    class FramePacer
+    {
+    public:
+        /**
+         * @brief Construct a new FramePacer object
+         *
+         * @param clockFrequency The number of clock cycles per second
+         * @param cyclesPerFrame The number of clock cycles in a frame
+         * @param mode The source used to pace the frames
+         */
+        FramePacer(uint64_t clockFrequency, uint64_t cyclesPerFrame, PacingMode mode);
+
+        /**
+         * @brief Wait until the deadline of the next frame
+         * @details In TIMER mode sleep until the deadline is near, then spin until it is reached.
+         *          If the emulator is too far behind (e.g. the window was dragged), the deadline is reset to now
+         *          instead of running fast to catch up.
+         *          In VSYNC mode only record the frame time.
+         *          In AUDIO mode wait until the audio buffer is filled below the target, then compute the new
+         *          rate adjustment from the fill level measured before waiting.
+         */
+        void waitForNextFrame();
+
+        /**
+         * @brief Pace the frames with the consumption of the audio samples (AUDIO mode)
+         * @details The emulation is throttled when the audio buffer contains more samples than the target.
+         *          Since the audio device and the emulation clocks drift, the sample rate of the emulator is
+         *          adjusted a bit (dynamic rate control) to keep the buffer near the target, so that the throttle
+         *          rarely has to block for long (which would make the video stutter) and the buffer never
+         *          underruns (which would make the audio crackle).
+         *
+         * @param buffer The audio buffer (read only to get its size)
+         * @param targetSize The number of samples the buffer should contain after each frame
+         * @see getRateAdjustment
+         */
+        void setAudioSync(const RingBuffer<int16_t> *buffer, size_t targetSize);
+
+        /**
+         * @brief Get the ratio to apply to the sample rate of the emulated audio
+         *
+         * @return The ratio (1 - MAX_RATE_ADJUSTMENT to 1 + MAX_RATE_ADJUSTMENT), always 1 if the mode is not AUDIO
+         */
+        [[nodiscard]] double getRateAdjustment() const;
+
+        /**
+         * @brief Get the statistics about the last frames presented
+         *
+         * @return The frame time statistics
+         */
+        [[nodiscard]] FrameTimeStats getStats() const;
+
+        /**
+         * @brief Get the pacing mode
+         *
+         * @return The source used to pace the frames
+         */
+        [[nodiscard]] PacingMode getMode() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        PacingMode m_mode; ///< The source used to pace the frames
+
+        uint64_t m_periodNs; ///< The integer part of the frame period (nanoseconds)
+        uint64_t m_periodRemainder; ///< The fractional part of the frame period (numerator, denominator is m_clockFrequency)
+        uint64_t m_clockFrequency; ///< The denominator of the fractional part of the frame period
+        uint64_t m_remainder = 0; ///< The accumulated fractional part of the deadline
+
+        Clock::time_point m_deadline; ///< The deadline of the next frame
+        Clock::time_point m_lastFrame; ///< The time at which the last frame was released
+
+        const RingBuffer<int16_t> *m_audioBuffer = nullptr; ///< The audio buffer (AUDIO mode)
+        size_t m_audioTarget = 0; ///< The number of samples the audio buffer should contain (AUDIO mode)
+        double m_rateAdjustment = 1; ///< The ratio to apply to the sample rate of the emulated audio
+
+        static constexpr size_t FRAME_TIMES_SIZE = 128; ///< The number of frame times used to compute the statistics
+        std::array<int64_t, FRAME_TIMES_SIZE> m_frameTimes{}; ///< The last frame times (nanoseconds)
+        size_t m_frameTimesIndex = 0; ///< The position of the next frame time in m_frameTimes
+        size_t m_frameTimesCount = 0; ///< The number of valid frame times in m_frameTimes
+
+        static constexpr std::chrono::nanoseconds SPIN_THRESHOLD = std::chrono::microseconds(1500); ///< Spin (instead of sleeping) when the deadline is closer than this
+        static constexpr uint64_t MAX_LATE_FRAMES = 3; ///< Reset the deadline when the emulator is late by more than this number of frames
+        static constexpr double MAX_RATE_ADJUSTMENT = 0.005; ///< The maximum change of the audio sample rate (0.5%, not audible)
+        static constexpr std::chrono::nanoseconds AUDIO_POLL_INTERVAL = std::chrono::microseconds(500); ///< The interval between two checks of the audio buffer
+
+        /**
+         * @brief Move the deadline forward by one frame period
+         */
+        void advanceDeadline();
+
+        /**
+         * @brief Record the time elapsed since the last frame
+         *
+         * @param now The time at which the current frame is released
+         */
+        void recordFrameTime(Clock::time_point now);
+    };
+} // namespace gameboy
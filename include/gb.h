@@ -1,21 +1,48 @@
 /**
  * @file gb.h
  * @brief This file contains the declaration of the GB class.
- *        It includes all the other classes and is responsible for the emulator to run.
+ *        It is the SDL front end of the emulator: it runs the Emulator in a window, with sound and input.
  */
 
 #pragma once
 
-#include "cartridge.h" // Cartridge
-#include "cpu.h" // CPU
-#include "input.h" // Input
-#include "memory.h" // Memory
+#include "emulator.h" // Emulator
+#include "frame_hash.h" // FrameHash
+#include "frame_pacer.h" // FramePacer
+#include "latency_meter.h" // LatencyMeter
+#include "link_cable.h" // LinkCable
+#include "movie.h" // Movie
 #include "platform.h" // Platform
-#include "ppu.h" // PPU
-#include "timer.h" // Timer
+#include "stats.h" // StatsCollector, StatsSnapshot
+
+#include <chrono> // std::chrono::steady_clock
+#include <fstream> // std::ofstream
+#include <vector> // std::vector
 
 namespace gameboy
 {
+    /**
+     * @brief The options used to create the emulator
+     */
+    struct GBOptions
+    {
+        int scale = 1; ///< The scale of the window
+        bool maximize = false; ///< True if the window should be maximized
+        bool vsync = false; ///< True if the frames should be paced by the display (vsync) instead of the timer
+        bool showStats = false; ///< True if the frame time statistics should be drawn on top of the screen
+        std::string inputMappingFile; ///< The file containing the input mapping (empty to use the default mapping)
+        bool measureLatency = false; ///< True if the input-to-photon latency should be measured
+        int runAhead = 0; ///< The number of frames emulated ahead of the displayed one (0 to disable the run-ahead)
+        bool audio = false; ///< True if the sound should be played
+        bool audioSync = false; ///< True if the frames should be paced by the audio device (implies audio)
+        std::string linkListen; ///< The socket on which another emulator connects with the link cable (empty if not used)
+        std::string linkConnect; ///< The socket of another emulator to connect to with the link cable (empty if not used)
+        std::string recordFile; ///< The file in which the movie of the game is written at exit (empty to not record)
+        std::string statsFile; ///< The file in which the runtime statistics are written as JSON lines (empty to not write them)
+        uint32_t statsInterval = 60; ///< The number of frames between two lines of statistics
+        Accuracy accuracy = Accuracy::INSTRUCTION; ///< When the memory accesses of the CPU happen (see Emulator::setAccuracy)
+    };
+
     /**
      * @brief The GB class is responsible for the emulator to run.
      */
@@ -25,43 +52,183 @@ namespace gameboy
         /**
          * @brief Create and initialize the emulator
          *
-         * @param scale The scale of the window
-         * @param maximize True if the window should be maximized, false otherwise
+         * @param options The options of the emulator (window and pacing)
          */
-        explicit GB(int scale, bool maximize);
+        explicit GB(const GBOptions &options);
 
         /**
          * @brief Run the emulator
-         * @details Do the steps of the CPU, PPU, Timer and Input
+         * @details Emulate the frames, present them and handle the inputs until the user quits.
+         *          With the run-ahead enabled, each frame is emulated without rendering, then the state is saved,
+         *          the next frames are emulated with the current input, the last one is displayed and the state is
+         *          restored. The game reacts to the input on screen run-ahead frames earlier.
          *
          * @param filename The name of the ROM file
          * @return 1 if there are no file with name filename or the CPU encountered an error (unexpected opcode), 0 otherwise
          */
         int run(const std::string &filename);
 
+        /**
+         * @brief Run a test ROM without opening a window
+         * @details The bytes sent on the serial port are printed. The emulation stops when the test ROM
+         *          prints its verdict ("Passed" or "Failed", followed by the end of the line) or when the cycle budget
+         *          is exhausted.
+         *
+         * @param filename The name of the ROM file
+         * @param maxCycles The maximum number of cycles to emulate
+         * @param traceFile The file in which the instruction trace is written (empty to not trace)
+         * @param accuracy When the memory accesses of the CPU happen
+         * @return 0 if the test passed, 1 if it failed, timed out or the ROM could not be run
+         * @see TraceWriter, Emulator::setAccuracy
+         */
+        static int runTest(const std::string &filename, uint64_t maxCycles, const std::string &traceFile, Accuracy accuracy);
+
+        /**
+         * @brief Play a movie without opening a window
+         * @details The hashes of the frames are chained (each hash is the seed of the next one), and the number
+         *          of frames and the last hash are printed. The same ROM and movie always give the same hash.
+         *
+         * @param filename The name of the ROM file
+         * @param movieFile The name of the movie file
+         * @param traceFile The file in which the instruction trace is written (empty to not trace)
+         * @param statsFile The file in which the runtime statistics are written as JSON lines (empty to not write them)
+         * @param statsInterval The number of frames between two lines of statistics
+         * @param accuracy When the memory accesses of the CPU happen
+         * @return 0 if the movie has been played, 1 if it cannot be played with the ROM or the CPU encountered an error
+         * @see Movie, TraceWriter, StatsCollector, Emulator::setAccuracy
+         */
+        static int playMovie(const std::string &filename, const std::string &movieFile, const std::string &traceFile,
+                             const std::string &statsFile, uint32_t statsInterval, Accuracy accuracy);
+
+        /**
+         * @brief Print the hashes of the frames of a ROM without opening a window
+         *
+         * @param filename The name of the ROM file
+         * @param movieFile The movie that gives the inputs (empty to not press any button)
+         * @param frames The number of frames (0 for the length of the movie, or DEFAULT_HASH_FRAMES without movie)
+         * @param interval The hash of one frame every interval frames is printed
+         * @param output The file in which the hashes are written ("-" for the standard output)
+         * @return 0 if the hashes have been written, 1 otherwise
+         * @see hashFrames, saveFrameHashes
+         */
+        static int printFrameHashes(const std::string &filename, const std::string &movieFile, uint32_t frames,
+                                    uint32_t interval, const std::string &output);
+
+        /**
+         * @brief Check the hashes of the frames of a ROM against golden hashes, without opening a window
+         * @details The frames and the interval are the ones of the golden file
+         *
+         * @param filename The name of the ROM file
+         * @param movieFile The movie that gives the inputs (empty to not press any button)
+         * @param goldenFile The file of the expected hashes (written by printFrameHashes)
+         * @return 0 if all the hashes match, 1 otherwise (the first mismatch is printed)
+         */
+        static int verifyFrameHashes(const std::string &filename, const std::string &movieFile, const std::string &goldenFile);
+
+        /**
+         * @brief Run a reference core and a candidate core side by side, without opening a window
+         * @details Both cores are currently the same interpreter, so the run checks that the emulation is
+         *          deterministic; an optimised path is selected on the candidate to check it against the reference.
+         *          The first divergence is printed with the states of both cores.
+         *
+         * @param filename The name of the ROM file
+         * @param movieFile The movie that gives the inputs (empty to not press any button)
+         * @param frames The number of frames (0 for the length of the movie, or DEFAULT_HASH_FRAMES without movie)
+         * @return 0 if the cores never diverged, 1 otherwise
+         * @see runLockstep
+         */
+        static int runLockstep(const std::string &filename, const std::string &movieFile, uint32_t frames);
+
+        /**
+         * @brief Run a ROM under the control of a debugger (GDB remote serial protocol), without opening a window
+         * @details The emulator waits for the debugger on a local TCP port, stopped before the first instruction
+         *
+         * @param filename The name of the ROM file
+         * @param port The TCP port on 127.0.0.1
+         * @param accuracy When the memory accesses of the CPU happen (the watchpoints are checked at the same time)
+         * @return 0 if a debugger connected and the session ended, 1 otherwise
+         * @see GDBStub
+         */
+        static int runDebugger(const std::string &filename, uint16_t port, Accuracy accuracy);
+
     private:
         Platform m_platform; ///< The platform
+        FramePacer m_pacer; ///< The frame pacer
+        bool m_showStats; ///< True if the frame time statistics are drawn on top of the screen
+        Accuracy m_accuracy; ///< When the memory accesses of the CPU happen
+        uint32_t m_frames = 0; ///< The number of frames presented
+
+        bool m_measureLatency; ///< True if the input-to-photon latency is measured
+        LatencyMeter m_latencyMeter; ///< The input-to-photon latency meter
+
+        int m_runAhead; ///< The number of frames emulated ahead of the displayed one
+        std::vector<uint8_t> m_snapshot; ///< The state restored after the run-ahead frames (reused to avoid allocations)
+        uint64_t m_runAheadCount = 0; ///< The number of times the run-ahead frames have been emulated
+        double m_runAheadTotalMs = 0; ///< The time spent emulating the run-ahead frames, saving and restoring the state (milliseconds)
+        double m_runAheadLastMs = 0; ///< The time spent in the last run-ahead (milliseconds)
+
+        LinkCable m_link; ///< The link cable connected to another emulator (if any)
+
+        std::string m_recordFile; ///< The file in which the movie is written (empty to not record)
+        Movie m_movie; ///< The movie being recorded
+
+        StatsCollector m_stats; ///< The runtime statistics, updated once per frame
+        StatsSnapshot m_statsSnapshot; ///< The statistics of the last interval (shown by the overlay)
+        std::ofstream m_statsFile; ///< The JSON lines of the statistics (not open if they are not written)
+        uint32_t m_statsInterval; ///< The number of frames between two snapshots of the statistics
+        uint64_t m_statsFrames = 0; ///< The number of frames added to the statistics
+        uint64_t m_statsCycles = 0; ///< The number of cycles of the emulator at the previous frame
+        uint64_t m_statsInstructions = 0; ///< The number of instructions of the emulator at the previous frame
+        double m_emulateSeconds = 0; ///< The time spent emulating since the previous frame
+        double m_sleepSeconds = 0; ///< The time spent waiting for the deadline since the previous frame
+        std::chrono::steady_clock::time_point m_statsTime; ///< The time of the previous frame
+
+        static constexpr uint32_t DEFAULT_HASH_FRAMES = 600; ///< The number of frames hashed without movie (~10 seconds)
+        static constexpr uint32_t STATS_REFRESH_FRAMES = 30; ///< The number of frames between two updates of the statistics overlay
+        static constexpr int AUDIO_SAMPLE_RATE = 48000; ///< The sample rate requested to the audio device
+        static constexpr size_t AUDIO_SYNC_TARGET = 3072; ///< The number of samples in the audio buffer targeted by the audio sync (1536 stereo samples, 32 ms)
 
-        static constexpr int FPS = 60; ///< The number of frames per second
-        static constexpr int FRAMERATE = 1000 / FPS; ///< The number of milliseconds per frame
+        /**
+         * @brief Wait for the deadline of the frame and update the screen
+         *
+         * @param emulator The emulator
+         * @see FramePacer::waitForNextFrame
+         */
+        void presentFrame(const Emulator &emulator);
 
         /**
-         * @brief Update the screen and handle the inputs
-         * @details If the PPU is rendering, update the screen and handle the inputs
+         * @brief Handle the inputs (all the events received since the last frame)
          *
-         * @param lastCycleTime The last time the screen was updated
-         * @param ppu The PPU
-         * @param input The Input
+         * @param emulator The emulator
          * @return False if the user wants to quit, true otherwise
          */
-        bool updatePlatform(uint32_t &lastCycleTime, PPU &ppu, Input &input);
+        bool processInput(Emulator &emulator);
+
+        /**
+         * @brief Add the previous iteration of the main loop to the runtime statistics
+         * @details A snapshot is taken every m_statsInterval frames, and written to the statistics file if any
+         *
+         * @param emulator The emulator
+         */
+        void updateStats(const Emulator &emulator);
 
         /**
-         * @brief Save the current content of the RAM to a file
+         * @brief Update the text of the statistics overlay
          *
-         * @param cartridge The cartridge
-         * @see Cartridge::saveRAMData, MBC::saveRAMData
+         * @see FramePacer::getStats, LatencyMeter::getStats, StatsCollector::takeSnapshot
+         */
+        void updateStatsOverlay();
+
+        /**
+         * @brief Print the input-to-photon latency statistics
+         *
+         * @see LatencyMeter::getStats
+         */
+        void printLatencyStats() const;
+
+        /**
+         * @brief Print the CPU time spent in the run-ahead frames
          */
-        static void saveRAMData(const Cartridge &cartridge);
+        void printRunAheadStats() const;
     };
 } // namespace gameboy
@@ -0,0 +1,151 @@
+/**
+ * @file gdb_stub.h
+ * @brief This file contains the declaration of the GDBStub class.
+ *        It lets a debugger that speaks the GDB remote serial protocol (e.g. gdb-multiarch) control an emulator
+ *        through a local TCP port: registers, memory, breakpoints, watchpoints, continue, single step and Ctrl-C.
+ */
+
+/*
+ * See https://sourceware.org/gdb/current/onlinedocs/gdb.html/Remote-Protocol.html
+ */
+
+#pragma once
+
+#include "debugger.h" // Debugger
+#include "emulator.h" // Emulator
+
+#include <cstdint> // uint16_t
+#include <string> // std::string
+
+namespace gameboy
+{
+    /**
+     * @brief GDBStub serves the GDB remote serial protocol for an emulator.
+     * @details The SM83 is presented as a Z80 with only the registers af, bc, de, hl, sp and pc (the target
+     *          description is sent with qXfer:features:read).
+     *          The stub owns the emulation loop: the emulator only runs between a continue (or a step) and the next stop,
+     *          in chunks of a frame, and the connection is checked for a Ctrl-C between two chunks.
+     *          The breakpoints (Z0, Z1) and the watchpoints (Z2 write, Z3 read, Z4 access) are the ones of the Debugger.
+     *          The stub listens on 127.0.0.1 only, and serves a single connection.
+     */
+    class GDBStub
+    {
+    public:
+        /**
+         * @brief Attach the debugger of the stub to an emulator
+         *
+         * @param emulator The emulator (it must outlive the stub)
+         */
+        explicit GDBStub(Emulator &emulator);
+
+        /**
+         * @brief Detach the debugger and close the sockets
+         */
+        ~GDBStub();
+
+        /// GDBStub cannot be copied
+        GDBStub(const GDBStub &) = delete;
+
+        /// GDBStub cannot be assigned
+        GDBStub &operator=(const GDBStub &) = delete;
+
+        /**
+         * @brief Listen on a local TCP port
+         *
+         * @param port The port (0 to let the system choose one, see getPort)
+         * @return True if the stub is listening, false otherwise
+         */
+        bool listen(uint16_t port);
+
+        /**
+         * @brief Get the port on which the stub is listening
+         *
+         * @return The port, 0 if not listening
+         */
+        [[nodiscard]] uint16_t getPort() const;
+
+        /**
+         * @brief Wait for a debugger to connect, then serve its requests until it detaches, kills or disconnects
+         *
+         * @return False if no connection could be accepted, true otherwise
+         */
+        bool serve();
+
+        /**
+         * @brief Handle the content of a packet (without the framing), e.g. "m100,4"
+         * @details A continue or a step runs the emulator until the next stop
+         *
+         * @param packet The content of the packet
+         * @return The content of the reply (empty for an unsupported packet)
+         */
+        std::string handlePacket(const std::string &packet);
+
+    private:
+        static constexpr uint32_t MAX_PACKET_SIZE = 0x1000; ///< The maximum size of a packet (sent in qSupported)
+        static constexpr uint64_t CYCLES_PER_POLL = ppu_timing::CYCLES_PER_FRAME; ///< The cycles emulated between two checks of the connection
+
+        Emulator &m_emulator; ///< The emulator
+        Debugger m_debugger; ///< The breakpoints and watchpoints of the session
+
+        int m_listener = -1; ///< The listening socket (-1 if not listening)
+        int m_socket = -1; ///< The connection with the debugger (-1 if not connected)
+        uint16_t m_port = 0; ///< The port on which the stub is listening
+        std::string m_received; ///< The bytes received that do not form a complete packet yet
+        bool m_noAck = false; ///< True once the debugger has disabled the acknowledgments (QStartNoAckMode)
+        bool m_attached = false; ///< False once the debugger has detached or killed the session
+
+        /**
+         * @brief Wait for the next packet of the debugger (the acknowledgments and the Ctrl-C are skipped)
+         *
+         * @param packet The content of the packet
+         * @return False if the connection is closed, true otherwise
+         */
+        bool receivePacket(std::string &packet);
+
+        /**
+         * @brief Send a packet to the debugger
+         *
+         * @param data The content of the packet
+         * @return False if the connection is closed, true otherwise
+         */
+        bool sendPacket(const std::string &data);
+
+        /**
+         * @brief Send raw bytes to the debugger
+         *
+         * @param data The bytes
+         * @return False if the connection is closed, true otherwise
+         */
+        bool sendRaw(const std::string &data);
+
+        /**
+         * @brief Check (without waiting) whether the debugger sent a Ctrl-C
+         *
+         * @return True if a Ctrl-C has been received, false otherwise
+         */
+        bool interruptReceived();
+
+        /**
+         * @brief Run the emulator until the debugger stops it
+         *
+         * @param singleStep True to execute a single instruction
+         * @return The stop reply
+         */
+        std::string resume(bool singleStep);
+
+        /**
+         * @brief Describe the last stop of the debugger (T or S packet)
+         *
+         * @return The stop reply
+         */
+        [[nodiscard]] std::string stopReply() const;
+
+        /**
+         * @brief Handle a Z or z packet (insert or remove a breakpoint or a watchpoint)
+         *
+         * @param packet The content of the packet, e.g. "Z0,150,1"
+         * @return The reply ("OK", an error, or empty if the type is not supported)
+         */
+        std::string handleBreakpoint(const std::string &packet);
+    };
+} // namespace gameboy
@@ -0,0 +1,24 @@
+/**
+ * @file hash.h
+ * @brief This file contains the declaration of the hash function used to identify the ROMs and the frames.
+ */
+
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+
+namespace gameboy
+{
+    /**
+     * @brief Compute the 64-bit hash of a buffer
+     * @details The algorithm is XXH64 (https://github.com/Cyan4973/xxHash): it is fast, not cryptographic,
+     *          and its results are the same on all the (little-endian) hosts, so they can be stored in files.
+     *
+     * @param data The buffer
+     * @param size The size of the buffer in bytes
+     * @param seed The seed of the hash
+     * @return The hash
+     */
+    uint64_t hash64(const void *data, size_t size, uint64_t seed = 0);
+} // namespace gameboy
@@ -45,6 +45,8 @@ namespace gameboy
 
         /**
          * @brief Set/Reset the bit of the joypad state
+         * @details A button that goes from released to pressed is recorded for sendInterrupt,
+         *          so the interrupt is requested even if the button is released before the next call
          *
          * @param button The button to set/reset
          * @param pressed True if the button is pressed, false otherwise
@@ -52,14 +54,33 @@ namespace gameboy
         void setButton(JoypadButton button, bool pressed);
 
         /**
-         * @brief Send an interrupt.
-         *
-         * @param memory The memory
+         * @brief Send an interrupt if a button has been pressed.
+         * @details The joypad interrupt is requested only when at least one button went from released to pressed
+         *          since the last call (like the real hardware, that raises it on the high to low transition of P10-P13).
+         *          Holding or releasing buttons does not request the interrupt, a button pressed and released between
+         *          two calls does.
          */
         void sendInterrupt();
 
+        /**
+         * @brief Save the state of the input
+         * @details The joypad state is saved by the memory, only the presses not yet sent are saved here
+         *
+         * @param writer The state writer
+         */
+        void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the input
+         *
+         * @param reader The state reader
+         * @see saveState
+         */
+        void loadState(StateReader &reader);
+
     private:
         Memory &m_memory; ///< The memory
+        uint8_t m_pressedButtons = 0; ///< The buttons pressed since the last call of sendInterrupt (1 = pressed)
 
         static constexpr uint8_t JOYPAD_INTERRUPT_FLAG_VALUE = 0x10; ///< The bitmask of the joypad interrupt flag
     };
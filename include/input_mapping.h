@@ -0,0 +1,85 @@
+/**
+ * @file input_mapping.h
+ * @brief This file contains the declaration of the InputMapping class.
+ *        It maps the keys of the keyboard and the buttons of the gamepads to the buttons of the joypad.
+ */
+
+#pragma once
+
+#include "input.h" // JoypadButton
+
+#include <SDL2/SDL.h> // SDL_Keycode, SDL_GameControllerButton
+
+#include <optional> // std::optional
+#include <string> // std::string
+#include <unordered_map> // std::unordered_map
+
+namespace gameboy
+{
+    /**
+     * @brief The InputMapping class maps the host keys and gamepad buttons to the buttons of the joypad.
+     * @details The default mapping is:
+     *          | Game Boy | Keyboard | Gamepad    |
+     *          |----------|----------|------------|
+     *          | A        | A        | A          |
+     *          | B        | S        | B          |
+     *          | Arrows   | Arrows   | D-pad      |
+     *          | Start    | Space    | Start      |
+     *          | Select   | Enter    | Back       |
+     *
+     *          A mapping file contains one line per Game Boy button, with the list of keys and gamepad buttons
+     *          (prefixed by "pad:") separated by commas. Lines starting with '#' are comments. For example:
+     *          @code
+     *          A = A, Z, pad:a
+     *          START = Space, pad:start
+     *          @endcode
+     *          The key names are the ones used by SDL_GetKeyFromName, the gamepad button names are the ones
+     *          used by SDL_GameControllerGetButtonFromString.
+     */
+    class InputMapping
+    {
+    public:
+        /**
+         * @brief Construct a new InputMapping object with the default mapping
+         */
+        InputMapping();
+
+        /**
+         * @brief Load the mapping from a file
+         * @details The buttons that are present in the file replace the default mapping,
+         *          the other buttons keep the default mapping
+         *
+         * @param filename The name of the mapping file
+         * @return true if the file was loaded successfully, false otherwise
+         */
+        bool loadFromFile(const std::string &filename);
+
+        /**
+         * @brief Get the joypad button mapped to a key
+         *
+         * @param key The key of the keyboard
+         * @return The joypad button, or std::nullopt if the key is not mapped
+         */
+        [[nodiscard]] std::optional<JoypadButton> getKeyButton(SDL_Keycode key) const;
+
+        /**
+         * @brief Get the joypad button mapped to a gamepad button
+         *
+         * @param button The button of the gamepad
+         * @return The joypad button, or std::nullopt if the gamepad button is not mapped
+         */
+        [[nodiscard]] std::optional<JoypadButton> getGamepadButton(uint8_t button) const;
+
+    private:
+        std::unordered_map<SDL_Keycode, JoypadButton> m_keys; ///< The keys of the keyboard
+        std::unordered_map<uint8_t, JoypadButton> m_gamepadButtons; ///< The buttons of the gamepads
+
+        /**
+         * @brief Get the joypad button from its name
+         *
+         * @param name The name of the button (A, B, SELECT, START, RIGHT, LEFT, UP, DOWN)
+         * @return The joypad button, or std::nullopt if the name is not valid
+         */
+        static std::optional<JoypadButton> getButtonFromName(const std::string &name);
+    };
+} // namespace gameboy
@@ -0,0 +1,85 @@
+/**
+ * @file latency_meter.h
+ * @brief This file contains the declaration of the LatencyMeter class.
+ *        It measures the time between a button press and the first frame on screen that changed after it.
+ */
+
+#pragma once
+
+#include <chrono> // std::chrono::steady_clock
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <optional> // std::optional
+
+namespace gameboy
+{
+    /**
+     * @brief Statistics about the measured input-to-photon latencies
+     */
+    struct LatencyStats
+    {
+        uint64_t samples = 0; ///< The number of measured latencies
+        double meanMs = 0; ///< The mean latency (milliseconds)
+        double minMs = 0; ///< The minimum latency (milliseconds)
+        double maxMs = 0; ///< The maximum latency (milliseconds)
+        double lastMs = 0; ///< The last measured latency (milliseconds)
+    };
+
+    /**
+     * @brief The LatencyMeter class measures the input-to-photon latency.
+     * @details When a button is pressed, the meter waits for the first presented frame that is different from
+     *          the frame on screen at the time of the press. The latency is the time between the press (as
+     *          timestamped by the event queue) and the presentation of that frame.
+     *          It includes the time spent in the event queue, the emulation, the reaction time of the game
+     *          (usually 1-2 frames) and the presentation, but not the latency of the display itself.
+     */
+    class LatencyMeter
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Record a button press
+         * @details If a press is already waiting for a frame change, the new press is ignored
+         *
+         * @param time The time of the press
+         */
+        void buttonPressed(Clock::time_point time);
+
+        /**
+         * @brief Record the presentation of a frame
+         *
+         * @param buffer The frame buffer that has been presented
+         * @param size The size of the frame buffer in bytes
+         * @param time The time of the presentation
+         */
+        void framePresented(const void *buffer, size_t size, Clock::time_point time);
+
+        /**
+         * @brief Get the statistics about the measured latencies
+         *
+         * @return The latency statistics
+         */
+        [[nodiscard]] LatencyStats getStats() const;
+
+    private:
+        std::optional<Clock::time_point> m_pressTime; ///< The time of the press waiting for a frame change
+        uint64_t m_pressFrameHash = 0; ///< The hash of the frame on screen when the button was pressed
+        uint64_t m_lastFrameHash = 0; ///< The hash of the last presented frame
+
+        uint64_t m_samples = 0; ///< The number of measured latencies
+        double m_totalMs = 0; ///< The sum of the measured latencies (milliseconds)
+        double m_minMs = 0; ///< The minimum latency (milliseconds)
+        double m_maxMs = 0; ///< The maximum latency (milliseconds)
+        double m_lastMs = 0; ///< The last measured latency (milliseconds)
+
+        /**
+         * @brief Hash the frame buffer (FNV-1a)
+         *
+         * @param buffer The frame buffer
+         * @param size The size of the frame buffer in bytes
+         * @return The hash of the frame buffer
+         */
+        static uint64_t hashFrame(const void *buffer, size_t size);
+    };
+} // namespace gameboy
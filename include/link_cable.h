@@ -0,0 +1,179 @@
+/**
+ * @file link_cable.h
+ * @brief This file contains the declaration of the LinkCable class.
+ *        It connects the serial ports of two emulators (threads or processes on the same host) through a Unix socket.
+ */
+
+/*
+ * See https://gbdev.io/pandocs/Serial_Data_Transfer_(Link_Cable).html
+ */
+
+#pragma once
+
+#include "serial.h" // SerialSink
+
+#include <chrono> // std::chrono::nanoseconds
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint64_t
+#include <optional> // std::optional
+#include <string> // std::string
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief Statistics about the synchronization of the link cable
+     */
+    struct LinkStats
+    {
+        uint64_t messagesSent = 0; ///< The number of messages sent to the other end
+        uint64_t messagesReceived = 0; ///< The number of messages received from the other end
+        uint64_t transfers = 0; ///< The number of bytes exchanged
+        std::chrono::nanoseconds waitTime{0}; ///< The time spent waiting for the other end
+    };
+
+    /**
+     * @brief The LinkCable class connects the serial port to the serial port of another emulator.
+     * @details The two emulators run freely, but they are synchronized on their emulated time (cycles) with a
+     *          bounded lookahead: each emulator sends its time every SYNC_QUANTUM cycles, and waits if it is more than
+     *          LOOKAHEAD cycles ahead of the last time received from the other end.
+     *          When a transfer starts, its byte and completion time are sent at once. Since the lookahead is
+     *          shorter than a transfer, the other end receives the byte before reaching the completion time,
+     *          so the transfer completes at the same emulated time on both ends, without a round trip per bit.
+     *          Only the Game Boy that provides the clock waits for the reply of the other end, at the end of the transfer.
+     *
+     *          If the other end disconnects, the link behaves like an unplugged cable (the bytes received are 0xFF).
+     */
+    class LinkCable final : public SerialSink
+    {
+    public:
+        LinkCable() = default;
+
+        /**
+         * @brief Close the connection
+         */
+        ~LinkCable() override;
+
+        /// LinkCable cannot be copied
+        LinkCable(const LinkCable &) = delete;
+
+        /// LinkCable cannot be assigned
+        LinkCable &operator=(const LinkCable &) = delete;
+
+        /**
+         * @brief Connect two link cables with each other (two emulators in the same process)
+         *
+         * @param first The first end of the cable
+         * @param second The second end of the cable
+         * @return True if the cables have been connected, false otherwise
+         */
+        static bool connectPair(LinkCable &first, LinkCable &second);
+
+        /**
+         * @brief Wait for another emulator to connect to a Unix socket
+         *
+         * @param path The path of the socket
+         * @return True if the other emulator has connected, false otherwise
+         */
+        bool listen(const std::string &path);
+
+        /**
+         * @brief Connect to another emulator waiting on a Unix socket
+         *
+         * @param path The path of the socket
+         * @return True if the connection has been established, false otherwise
+         */
+        bool connect(const std::string &path);
+
+        /**
+         * @brief Check whether the cable is connected to another emulator
+         *
+         * @return True if the cable is connected, false otherwise
+         */
+        [[nodiscard]] bool isConnected() const;
+
+        /**
+         * @brief Close the connection
+         * @details The other end then behaves as if the cable was unplugged
+         */
+        void disconnect();
+
+        /**
+         * @brief Get the statistics about the synchronization
+         *
+         * @return The statistics
+         */
+        [[nodiscard]] LinkStats getStats() const;
+
+        uint8_t transfer(uint8_t byte) override;
+        void transferStarted(uint8_t byte, uint64_t completionTime) override;
+        std::optional<uint8_t> update(uint64_t time, uint8_t data) override;
+
+    private:
+        /**
+         * @brief The types of the messages exchanged by the two ends
+         */
+        enum class MessageType : uint8_t
+        {
+            TIME = 0, ///< The sender reached the time of the message
+            DATA = 1, ///< The sender started a transfer that completes at the time of the message
+            REPLY = 2 ///< The byte of the receiver of a DATA message
+        };
+
+        /**
+         * @brief A message exchanged by the two ends
+         * @details It is sent as MESSAGE_SIZE bytes with a fixed layout (see send), not as the raw struct,
+         *          so that its padding is never sent and both ends agree on the byte order
+         */
+        struct Message
+        {
+            uint64_t time; ///< The time of the sender (cycles)
+            uint64_t completionTime; ///< The time at which the transfer completes (DATA only)
+            MessageType type; ///< The type of the message
+            uint8_t data; ///< The byte transferred (DATA and REPLY only)
+        };
+
+        static constexpr size_t MESSAGE_SIZE = 18; ///< The size of a message on the socket (time, completion time, type, data)
+        static constexpr uint64_t SYNC_QUANTUM = 512; ///< The number of cycles between two TIME messages
+        static constexpr uint64_t LOOKAHEAD = 2048; ///< How far (cycles) an emulator can be ahead of the other one (less than a transfer)
+
+        int m_socket = -1; ///< The connected socket (-1 if not connected)
+        std::vector<uint8_t> m_received; ///< The bytes received that do not form a complete message yet
+
+        uint64_t m_time = 0; ///< The current time of the emulator
+        uint64_t m_peerTime = 0; ///< The last time received from the other end
+        uint64_t m_lastSentTime = 0; ///< The last time sent to the other end
+        std::optional<Message> m_incoming; ///< The transfer started by the other end (DATA message)
+        std::optional<uint8_t> m_reply; ///< The reply of the other end to the transfer started by the emulator
+
+        LinkStats m_stats; ///< The statistics about the synchronization
+
+        /**
+         * @brief Send a message to the other end
+         *
+         * @param type The type of the message
+         * @param data The byte transferred
+         * @param completionTime The time at which the transfer completes (DATA only)
+         */
+        void send(MessageType type, uint8_t data = 0xFF, uint64_t completionTime = 0);
+
+        /**
+         * @brief Receive the messages sent by the other end
+         *
+         * @param wait True to wait until at least a message is received, false to only read the pending messages
+         */
+        void receive(bool wait);
+
+        /**
+         * @brief Handle a message received from the other end
+         *
+         * @param message The message
+         */
+        void handleMessage(const Message &message);
+
+        /**
+         * @brief Send the current time (if the other end does not know it yet), then wait for a message
+         */
+        void waitForPeer();
+    };
+} // namespace gameboy
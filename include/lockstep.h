@@ -0,0 +1,43 @@
+/**
+ * @file lockstep.h
+ * @brief This file contains the differential execution of two emulator cores.
+ *        A reference core and a candidate core (e.g. an optimised path) run side by side on the same ROM and inputs,
+ *        and the emulation stops at the first difference of their state.
+ */
+
+#pragma once
+
+#include "emulator.h" // Emulator
+#include "movie.h" // Movie
+
+#include <cstdint> // uint32_t, uint64_t
+#include <string> // std::string
+
+namespace gameboy
+{
+    /**
+     * @brief The result of a differential execution
+     */
+    struct LockstepResult
+    {
+        bool diverged = false; ///< True if the cores diverged
+        bool error = false; ///< True if both cores encountered an error (unexpected opcode) at the same point
+        uint32_t frames = 0; ///< The number of frames emulated by both cores without divergence
+        uint64_t instructions = 0; ///< The number of instructions compared
+        std::string report; ///< The description of the divergence (the states of both cores), empty if none
+    };
+
+    /**
+     * @brief Run two cores frame by frame and compare them
+     * @details The state of the CPU (registers, opcode and number of cycles) is compared before every instruction,
+     *          from the traces of the frame (see TraceSink). After each frame, the 64 KB address space and the frame
+     *          buffer are compared too. The tracers of the cores are used by the comparison (none is set afterward).
+     *
+     * @param reference The reference core (just created, or prepared with Movie::start)
+     * @param candidate The core under test, in the same state as the reference
+     * @param movie The movie that gives the input of each frame (nullptr to not press any button)
+     * @param frames The number of frames to emulate
+     * @return The result
+     */
+    [[nodiscard]] LockstepResult runLockstep(Emulator &reference, Emulator &candidate, const Movie *movie, uint32_t frames);
+} // namespace gameboy
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include "savestate.h" // StateWriter, StateReader
+
 #include <cstdint> // uint8_t, uint16_t
 #include <string> // std::string
 #include <vector> // std::vector
@@ -67,9 +69,53 @@ namespace gameboy
          */
         void saveRAMData(const std::string &filename) const;
 
+        /**
+         * @brief Save the state of the MBC
+         * @details The ROM is not saved, since it cannot change
+         *
+         * @param writer The state writer
+         */
+        virtual void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the MBC
+         *
+         * @param reader The state reader
+         * @see saveState
+         */
+        virtual void loadState(StateReader &reader);
+
     protected:
         std::vector<uint8_t> m_rom; ///< The ROM of the cartridge
         std::vector<uint8_t> m_ram; ///< The RAM of the cartridge
+
+        /**
+         * @brief Read a byte of the ROM
+         * @details The offsets past the end of the ROM wrap around, like the unused address lines of the chips
+         *          (e.g. a bank number greater than the number of banks, or a truncated ROM)
+         *
+         * @param offset The offset of the byte in the ROM
+         * @return The byte read, 0xFF if the ROM is empty
+         */
+        [[nodiscard]] uint8_t readROM(size_t offset) const;
+
+        /**
+         * @brief Read a byte of the RAM
+         * @details The offsets past the end of the RAM wrap around (see readROM)
+         *
+         * @param offset The offset of the byte in the RAM
+         * @return The byte read, 0xFF if there is no RAM
+         */
+        [[nodiscard]] uint8_t readRAM(size_t offset) const;
+
+        /**
+         * @brief Write a byte of the RAM
+         * @details The offsets past the end of the RAM wrap around (see readROM), nothing is written if there is no RAM
+         *
+         * @param offset The offset of the byte in the RAM
+         * @param value The value to write
+         */
+        void writeRAM(size_t offset, uint8_t value);
     };
 
     /**
@@ -146,6 +192,20 @@ namespace gameboy
          */
         void write(uint16_t address, uint8_t value) override;
 
+        /**
+         * @brief Save the state of the MBC (RAM and banking registers)
+         *
+         * @param writer The state writer
+         */
+        void saveState(StateWriter &writer) const final;
+
+        /**
+         * @brief Restore the state of the MBC (RAM and banking registers)
+         *
+         * @param reader The state reader
+         */
+        void loadState(StateReader &reader) final;
+
     protected:
         bool m_ramEnabled = false; ///< Whether the RAM is enabled or not
         uint8_t m_romBank = 1; ///< The ROM bank to read from
@@ -17,6 +17,9 @@
 
 namespace gameboy
 {
+    class APU;
+    class Timer;
+
     namespace interrupt_registers
     {
         constexpr uint16_t INTERRUPT_FLAG_ADDRESS = 0xFF0F; ///< The address of the Interrupt Flag Register
@@ -127,6 +130,18 @@ namespace gameboy
          */
         void writeWord(uint16_t address, uint16_t value);
 
+        /**
+         * @brief Called by the CPU after each instruction (see is_bus)
+         * @details Nothing to do: the other components are clocked by the Emulator with the cycles returned by the CPU
+         *          (or by a TimedBus, see Emulator::setAccuracy)
+         *
+         * @param cycles The number of machine cycles of the instruction
+         */
+        void tick(uint8_t cycles)
+        {
+            (void) cycles;
+        }
+
         /**
          * @brief Get the joypad state
          *
@@ -151,9 +166,43 @@ namespace gameboy
          */
         [[nodiscard]] uint8_t &operator[](uint16_t address);
 
+        /**
+         * @brief Set the APU that handles the sound registers
+         * @details The reads and writes of the addresses 0xFF10-0xFF3F are forwarded to the APU
+         *
+         * @param apu The APU (nullptr to store the sound registers in the memory)
+         */
+        void setAPU(APU *apu);
+
+        /**
+         * @brief Set the timer that handles the timer registers
+         * @details The reads and writes of the addresses 0xFF04-0xFF07 are forwarded to the timer
+         *
+         * @param timer The timer (nullptr to store the timer registers in the memory)
+         */
+        void setTimer(Timer *timer);
+
+        /**
+         * @brief Save the state of the memory
+         * @details Only the areas that are not handled by the cartridge are saved (0x8000-0x9FFF and 0xC000-0xFFFF)
+         *
+         * @param writer The state writer
+         */
+        void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the memory
+         *
+         * @param reader The state reader
+         * @see saveState
+         */
+        void loadState(StateReader &reader);
+
     private:
         std::array<uint8_t, 0x10000> m_memory{}; ///< The memory of the Game Boy
         Cartridge &m_cartridge; ///< The cartridge
+        APU *m_apu = nullptr; ///< The APU handling the sound registers
+        Timer *m_timer = nullptr; ///< The timer handling the timer registers
 
         /**
          * @brief The current state of the joypad
@@ -0,0 +1,118 @@
+/**
+ * @file movie.h
+ * @brief This file contains the declaration of the Movie class.
+ *        A movie is the sequence of the joypad states of each frame, used to replay a game deterministically.
+ */
+
+#pragma once
+
+#include "emulator.h" // Emulator
+
+#include <cstdint> // uint8_t, uint32_t, uint64_t
+#include <string> // std::string
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The Movie class stores the joypad state of each frame of a game.
+     * @details The emulation is deterministic: starting from the same state (power on, or the start state of the
+     *          movie) and applying the same joypad state before each call of Emulator::runFrame produces the same
+     *          frames. The movie also stores the hash of the ROM, to refuse to play it with another ROM.
+     *
+     *          The file contains, in little-endian order:
+     *          | Field            | Size             |
+     *          |------------------|------------------|
+     *          | Magic ("GBMV")   | 4                |
+     *          | Version          | 4                |
+     *          | ROM hash         | 8                |
+     *          | Start state size | 4 (0 = power on) |
+     *          | Start state      | Start state size |
+     *          | Frames           | 4                |
+     *          | Joypad states    | 1 per frame      |
+     */
+    class Movie
+    {
+    public:
+        /// Default constructor (empty movie, to load from a file)
+        Movie() = default;
+
+        /**
+         * @brief Construct an empty movie for a ROM
+         *
+         * @param romHash The hash of the ROM (see Emulator::getROMHash)
+         */
+        explicit Movie(uint64_t romHash);
+
+        /**
+         * @brief Set the state from which the movie starts (instead of the power on)
+         * @details The recording of GB::run starts from the state at the power on, to keep the cartridge RAM of the .sav file
+         *
+         * @param state The state (see Emulator::saveState)
+         */
+        void setStartState(std::vector<uint8_t> state);
+
+        /**
+         * @brief Append a frame to the movie
+         *
+         * @param input The joypad state applied before the frame (see Emulator::getInputMask)
+         */
+        void addFrame(uint8_t input);
+
+        /**
+         * @brief Get the number of frames of the movie
+         *
+         * @return The number of frames
+         */
+        [[nodiscard]] size_t getFrameCount() const;
+
+        /**
+         * @brief Get the joypad state of a frame
+         *
+         * @param frame The index of the frame
+         * @return The joypad state applied before the frame
+         */
+        [[nodiscard]] uint8_t getFrameInput(size_t frame) const;
+
+        /**
+         * @brief Get the hash of the ROM of the movie
+         *
+         * @return The hash of the ROM
+         */
+        [[nodiscard]] uint64_t getROMHash() const;
+
+        /**
+         * @brief Prepare an emulator to play the movie
+         * @details Check the hash of the ROM and restore the start state (if any).
+         *          The emulator must have just been created if the movie starts from the power on
+         *
+         * @param emulator The emulator
+         * @return True if the movie can be played, false otherwise
+         */
+        bool start(Emulator &emulator) const;
+
+        /**
+         * @brief Write the movie to a file
+         *
+         * @param filename The name of the file
+         * @return True if the movie has been written, false otherwise
+         */
+        bool saveToFile(const std::string &filename) const;
+
+        /**
+         * @brief Read a movie from a file
+         *
+         * @param filename The name of the file
+         * @return True if the movie has been read, false if the file cannot be read or is not a valid movie
+         */
+        bool loadFromFile(const std::string &filename);
+
+    private:
+        uint64_t m_romHash = 0; ///< The hash of the ROM
+        std::vector<uint8_t> m_startState; ///< The state from which the movie starts (empty = power on)
+        std::vector<uint8_t> m_inputs; ///< The joypad state of each frame
+
+        static constexpr uint32_t MAGIC = 0x564D4247; ///< The first bytes of a movie file ("GBMV")
+        static constexpr uint32_t VERSION = 1; ///< The version of the format of the file
+    };
+} // namespace gameboy
@@ -0,0 +1,184 @@
+/**
+ * @file perf_counters.h
+ * @brief This file contains the declaration of the PerfCounters class.
+ *        It reads the hardware performance counters of the CPU of the host (Linux perf_event_open) around the
+ *        subsystems of the emulator, to see where the time of a frame goes without an external profiler.
+ */
+
+#pragma once
+
+#include <array> // std::array
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+
+namespace gameboy
+{
+    /**
+     * @brief The hardware events that are counted
+     */
+    enum class PerfEvent
+    {
+        CYCLES, ///< The cycles of the host CPU
+        INSTRUCTIONS, ///< The instructions retired
+        BRANCH_MISSES, ///< The mispredicted branches
+        CACHE_MISSES, ///< The last level cache misses
+        COUNT ///< The number of events
+    };
+
+    /**
+     * @brief The parts of the emulation that are measured
+     */
+    enum class PerfSubsystem
+    {
+        FRAME, ///< A whole frame (Emulator::runFrame: CPU dispatch loop, PPU, APU, timer...)
+        PPU_RENDERING, ///< The rendering of the scanlines (PPU::draw)
+        COUNT ///< The number of subsystems
+    };
+
+    /**
+     * @brief The values of the counters (at a point in time, or the difference between two points)
+     */
+    struct PerfSample
+    {
+        std::array<uint64_t, static_cast<size_t>(PerfEvent::COUNT)> values{}; ///< The value of each event
+
+        /**
+         * @brief Get the value of an event
+         *
+         * @param event The event
+         * @return The value
+         */
+        [[nodiscard]] uint64_t operator[](PerfEvent event) const;
+
+        /**
+         * @brief Add the values of another sample
+         *
+         * @param other The other sample
+         * @return This sample
+         */
+        PerfSample &operator+=(const PerfSample &other);
+
+        /**
+         * @brief Subtract the values of another sample
+         *
+         * @param other The other sample (e.g. the sample at the start of the measure)
+         * @return This sample
+         */
+        PerfSample &operator-=(const PerfSample &other);
+    };
+
+    /**
+     * @brief Add two samples
+     *
+     * @param a The first sample
+     * @param b The second sample
+     * @return The sum of the values
+     */
+    [[nodiscard]] PerfSample operator+(PerfSample a, const PerfSample &b);
+
+    /**
+     * @brief Subtract two samples
+     *
+     * @param a The sample at the end of the measure
+     * @param b The sample at the start of the measure
+     * @return The difference of the values
+     */
+    [[nodiscard]] PerfSample operator-(PerfSample a, const PerfSample &b);
+
+    /**
+     * @brief PerfCounters counts the hardware events of the calling thread and accumulates them per subsystem.
+     * @details The events are opened as a single group, so they are scheduled together and read with one system call.
+     *          Only the user space is counted, so the system call itself is mostly excluded from the measures.
+     *          The events that the host does not support (e.g. in a virtual machine) stay at 0.
+     *          The counters are only available on Linux, and require perf_event_paranoid <= 2 (or CAP_PERFMON).
+     */
+    class PerfCounters
+    {
+    public:
+        /**
+         * @brief Construct the counters (they are not opened)
+         */
+        PerfCounters() = default;
+
+        /**
+         * @brief Close the counters
+         */
+        ~PerfCounters();
+
+        /// PerfCounters cannot be copied
+        PerfCounters(const PerfCounters &) = delete;
+
+        /// PerfCounters cannot be assigned
+        PerfCounters &operator=(const PerfCounters &) = delete;
+
+        /**
+         * @brief Open and start the counters for the calling thread
+         *
+         * @return False if the cycles cannot be counted (a message is printed), true otherwise
+         */
+        bool open();
+
+        /**
+         * @brief Check whether the counters are open
+         *
+         * @return True if open succeeded, false otherwise
+         */
+        [[nodiscard]] bool isOpen() const;
+
+        /**
+         * @brief Check whether an event is counted by the host
+         *
+         * @param event The event
+         * @return True if the event is counted, false if it is always 0
+         */
+        [[nodiscard]] bool isAvailable(PerfEvent event) const;
+
+        /**
+         * @brief Read the current values of the counters
+         *
+         * @return The values (all 0 if the counters are not open)
+         */
+        [[nodiscard]] PerfSample read() const;
+
+        /**
+         * @brief Add a measure to the total of a subsystem
+         *
+         * @param subsystem The subsystem
+         * @param sample The difference of the counters around the subsystem
+         */
+        void add(PerfSubsystem subsystem, const PerfSample &sample);
+
+        /**
+         * @brief Get the total of a subsystem
+         *
+         * @param subsystem The subsystem
+         * @return The sum of the measures
+         */
+        [[nodiscard]] const PerfSample &getTotal(PerfSubsystem subsystem) const;
+
+        /**
+         * @brief Get the number of measures of a subsystem (e.g. the number of frames for PerfSubsystem::FRAME)
+         *
+         * @param subsystem The subsystem
+         * @return The number of calls to add
+         */
+        [[nodiscard]] uint64_t getCount(PerfSubsystem subsystem) const;
+
+        /**
+         * @brief Reset the totals of all the subsystems (the counters stay open)
+         */
+        void reset();
+
+    private:
+        static constexpr size_t EVENTS = static_cast<size_t>(PerfEvent::COUNT); ///< The number of events
+        static constexpr size_t SUBSYSTEMS = static_cast<size_t>(PerfSubsystem::COUNT); ///< The number of subsystems
+
+        int m_leader = -1; ///< The file descriptor of the group leader (the cycles), -1 if not open
+        std::array<int, EVENTS> m_fds{-1, -1, -1, -1}; ///< The file descriptor of each event (-1 if not available)
+        std::array<size_t, EVENTS> m_slots{}; ///< The position of each available event in the values read from the group
+        size_t m_opened = 0; ///< The number of events in the group
+
+        std::array<PerfSample, SUBSYSTEMS> m_totals{}; ///< The totals of each subsystem
+        std::array<uint64_t, SUBSYSTEMS> m_counts{}; ///< The number of measures of each subsystem
+    };
+} // namespace gameboy
@@ -7,8 +7,16 @@
 #pragma once
 
 #include "input.h" // Input
+#include "input_mapping.h" // InputMapping
+#include "ring_buffer.h" // RingBuffer
 
-#include <SDL2/SDL.h> // SDL_Window, SDL_Renderer, SDL_Texture
+#include <SDL2/SDL.h> // SDL_Window, SDL_Renderer, SDL_Texture, SDL_GameController
+
+#include <chrono> // std::chrono::steady_clock
+#include <memory> // std::unique_ptr
+#include <optional> // std::optional
+#include <string> // std::string
+#include <unordered_map> // std::unordered_map
 
 namespace gameboy
 {
@@ -23,8 +31,9 @@ namespace gameboy
          *
          * @param scale The scale of the window
          * @param maximize True if the window should be maximized, false otherwise
+         * @param vsync True if the presentation of the frames should be synchronized with the display refresh rate
          */
-        explicit Platform(int scale, bool maximize);
+        explicit Platform(int scale, bool maximize, bool vsync);
 
         /**
          * @brief Destroy the window
@@ -40,22 +49,117 @@ namespace gameboy
 
         /**
          * @brief Update the window with the new frame buffer
+         * @details If the overlay text is not empty, draw it on top of the frame
          *
          * @param buffer The new frame buffer
+         * @see drawOverlay
          */
         void update(const void *buffer);
 
+        /**
+         * @brief Set the text drawn on top of the screen
+         *
+         * @param text The text to draw (lines are separated by '\n'), an empty string hides the overlay
+         */
+        void setOverlayText(const std::string &text);
+
+        /**
+         * @brief Set the mapping between the keys/gamepad buttons and the buttons of the joypad
+         *
+         * @param mapping The input mapping
+         */
+        void setInputMapping(InputMapping mapping);
+
         /**
          * @brief Get the input from the user
+         * @details Drain all the pending events, so that a burst of events does not add frames of latency,
+         *          then send the joypad interrupt if a button has been pressed.
+         *          A button pressed and released by the same call stays pressed until the next call,
+         *          so that the game sees the tap for at least a frame
          *
          * @param input The input object
          * @return False if the user wants to quit, true otherwise
+         * @see Input::sendInterrupt
+         */
+        bool processInput(Input &input);
+
+        /**
+         * @brief Get the time of the first button press handled by the last call of processInput
+         *
+         * @return The time of the press (taken from the timestamp of the event), or std::nullopt if no button was pressed
+         */
+        [[nodiscard]] std::optional<std::chrono::steady_clock::time_point> getFirstPressTime() const;
+
+        /**
+         * @brief Open the audio device
+         * @details The device plays the interleaved stereo samples of the audio buffer, if the buffer does not
+         *          contain enough samples the missing ones are replaced by silence
+         *
+         * @param sampleRate The requested sample rate (Hz)
+         * @return True if the device has been opened, false otherwise
+         * @see getAudioBuffer
+         */
+        bool openAudio(int sampleRate);
+
+        /**
+         * @brief Get the buffer of the samples played by the audio device
+         *
+         * @return The audio buffer, or nullptr if the audio device is not open
          */
-        static bool processInput(Input &input);
+        [[nodiscard]] RingBuffer<int16_t> *getAudioBuffer();
+
+        /**
+         * @brief Get the sample rate of the audio device
+         *
+         * @return The sample rate (Hz), 0 if the audio device is not open
+         */
+        [[nodiscard]] int getAudioSampleRate() const;
 
     private:
         SDL_Window *window;
         SDL_Renderer *renderer;
         SDL_Texture *texture;
+        std::unordered_map<SDL_JoystickID, SDL_GameController *> m_gamepads; ///< The opened gamepads, by instance id
+
+        std::string m_overlayText; ///< The text drawn on top of the screen
+
+        InputMapping m_inputMapping; ///< The mapping between the keys/gamepad buttons and the buttons of the joypad
+        std::optional<std::chrono::steady_clock::time_point> m_firstPressTime; ///< The time of the first press of the last processInput call
+        uint8_t m_pressedButtons = 0; ///< The buttons pressed by the current processInput call (JoypadButton bits)
+        uint8_t m_tappedButtons = 0; ///< The buttons pressed and released by the last processInput call, released by the next one
+
+        SDL_AudioDeviceID m_audioDevice = 0; ///< The audio device (0 if not open)
+        int m_audioSampleRate = 0; ///< The sample rate of the audio device
+        std::unique_ptr<RingBuffer<int16_t>> m_audioBuffer; ///< The samples waiting to be played
+
+        static constexpr int AUDIO_DEVICE_SAMPLES = 512; ///< The number of samples (per channel) requested by the audio callback
+        static constexpr size_t AUDIO_BUFFER_SAMPLES = 8192; ///< The capacity of the audio buffer (4096 stereo samples)
+
+        /**
+         * @brief Fill the buffer of the audio device (called by SDL in the audio thread)
+         *
+         * @param userdata The platform
+         * @param stream The buffer to fill
+         * @param length The size of the buffer in bytes
+         */
+        static void audioCallback(void *userdata, Uint8 *stream, int length);
+
+        /**
+         * @brief Press or release a button of the joypad
+         * @details The release of a button pressed by the same processInput call is delayed to the next call
+         *
+         * @param input The input object
+         * @param button The button of the joypad, std::nullopt if the key is not mapped
+         * @param pressed True if the button is pressed, false otherwise
+         * @param timestamp The timestamp of the event (milliseconds, SDL_GetTicks)
+         */
+        void handleButton(Input &input, std::optional<JoypadButton> button, bool pressed, uint32_t timestamp);
+
+        /**
+         * @brief Draw the overlay text on top of the screen
+         * @details The text is drawn with a 3x5 bitmap font on a translucent background,
+         *          in the coordinates of the Game Boy screen (so it scales with the window)
+         */
+        void drawOverlay();
     };
 } // namespace gameboy
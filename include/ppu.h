@@ -15,6 +15,7 @@
 #pragma once
 
 #include "memory.h" // Memory
+#include "perf_counters.h" // PerfCounters
 
 #include <array> // std::array
 
@@ -26,6 +27,13 @@ namespace gameboy
         constexpr uint8_t SCREEN_HEIGHT = 144; ///< The height of the screen in pixels
     } // namespace screen_size
 
+    namespace ppu_timing
+    {
+        constexpr uint32_t CYCLES_PER_SCANLINE = 456; ///< The number of clock cycles needed to draw a scanline (including HBLANK)
+        constexpr uint32_t SCANLINES_PER_FRAME = 154; ///< The number of scanlines in a frame (including VBLANK)
+        constexpr uint32_t CYCLES_PER_FRAME = CYCLES_PER_SCANLINE * SCANLINES_PER_FRAME; ///< The number of clock cycles in a frame (70224)
+    } // namespace ppu_timing
+
     namespace ppu_registers
     {
         constexpr uint16_t OAM_ADDRESS = 0xFE00; ///< The start address of the OAM (Object Attribute Memory)
@@ -80,6 +88,13 @@ namespace gameboy
          */
         Colour *getFrameBuffer();
 
+        /**
+         * @brief Get the frame buffer (read-only)
+         *
+         * @return The frame buffer
+         */
+        [[nodiscard]] const Colour *getFrameBuffer() const;
+
         /**
          * @brief Return whether the rendering is enabled
          *
@@ -94,11 +109,45 @@ namespace gameboy
          */
         void setRenderingEnabled(bool enabled);
 
+        /**
+         * @brief Skip/Do the rendering of the scanlines
+         * @details When the rendering is skipped the PPU keeps updating its registers and requesting the interrupts,
+         *          but the frame buffer is not updated (used to emulate frames that are not displayed)
+         *
+         * @param skip True if the rendering should be skipped, false otherwise
+         */
+        void setSkipRendering(bool skip);
+
+        /**
+         * @brief Measure the rendering of the scanlines with the hardware performance counters
+         *
+         * @param counters The counters, in which PerfSubsystem::PPU_RENDERING is accumulated (nullptr to stop measuring)
+         */
+        void setPerfCounters(PerfCounters *counters);
+
+        /**
+         * @brief Save the state of the PPU (visible part of the frame buffer and current mode)
+         * @details The registers are saved by the memory
+         *
+         * @param writer The state writer
+         */
+        void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the PPU
+         *
+         * @param reader The state reader
+         * @see saveState
+         */
+        void loadState(StateReader &reader);
+
     private:
         Memory &m_memory; ///< The memory
 
         std::array<Colour, screen_size::SCREEN_WIDTH *(screen_size::SCREEN_HEIGHT + 9)> m_frameBuffer{}; ///< The frame buffer
         bool m_renderingEnabled = false; ///< Whether the PPU can render the screen
+        bool m_skipRendering = false; ///< Whether the scanlines are not drawn in the frame buffer
+        PerfCounters *m_perfCounters = nullptr; ///< The hardware performance counters (nullptr if not measured)
 
         uint16_t m_cycles = 0; ///< The number of cycles since the last frame
         Mode m_mode = Mode::HBLANK; ///< The current mode of the PPU
@@ -0,0 +1,121 @@
+/**
+ * @file profiler.h
+ * @brief This file contains the scoped instrumentation of the emulation loop.
+ *        The durations of the instrumented scopes are written as Chrome trace events (JSON), which can be opened
+ *        in a timeline viewer (chrome://tracing or https://ui.perfetto.dev).
+ */
+
+#pragma once
+
+#include <chrono> // std::chrono::steady_clock
+#include <string> // std::string
+
+/*
+ * The instrumentation is compiled only with the PROFILE option of CMake (GBEMU_PROFILE is defined),
+ * otherwise the macros expand to nothing.
+ */
+#ifdef GBEMU_PROFILE
+#define GBEMU_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GBEMU_PROFILE_CONCAT(a, b) GBEMU_PROFILE_CONCAT_IMPL(a, b)
+/// Record the duration of the enclosing scope (name must be a string literal)
+#define GBEMU_PROFILE_SCOPE(name) ::gameboy::profiler::Scope GBEMU_PROFILE_CONCAT(profileScope, __LINE__)(name)
+/// Name the current thread in the trace (name must be a string literal)
+#define GBEMU_PROFILE_THREAD(name) ::gameboy::profiler::setThreadName(name)
+#else
+#define GBEMU_PROFILE_SCOPE(name) ((void) 0)
+#define GBEMU_PROFILE_THREAD(name) ((void) 0)
+#endif
+
+namespace gameboy
+{
+    namespace profiler
+    {
+        /**
+         * @brief Start recording the scopes
+         * @details Each thread appends its events to its own buffer, the buffers are only merged by stop
+         *
+         * @param filename The file in which the trace is written by stop
+         * @return False if a recording is already started, true otherwise
+         */
+        bool start(const std::string &filename);
+
+        /**
+         * @brief Stop recording the scopes and write the trace file
+         *
+         * @return False if no recording was started or the file cannot be written, true otherwise
+         */
+        bool stop();
+
+        /**
+         * @brief Check whether the scopes are recorded
+         *
+         * @return True between start and stop, false otherwise
+         */
+        [[nodiscard]] bool isRecording();
+
+        /**
+         * @brief Name the current thread in the trace
+         *
+         * @param name The name of the thread (a string literal, it is not copied)
+         */
+        void setThreadName(const char *name);
+
+        /**
+         * @brief Session records the scopes during its lifetime (e.g. the whole run of the program).
+         */
+        class Session
+        {
+        public:
+            /**
+             * @brief Start recording (see start)
+             *
+             * @param filename The file in which the trace is written (empty to not record)
+             */
+            explicit Session(const std::string &filename);
+
+            /**
+             * @brief Stop recording and write the trace file (see stop)
+             */
+            ~Session();
+
+            /// Session cannot be copied
+            Session(const Session &) = delete;
+
+            /// Session cannot be assigned
+            Session &operator=(const Session &) = delete;
+
+        private:
+            bool m_started; ///< True if this session started the recording
+        };
+
+        /**
+         * @brief Scope records its duration as a complete event ("ph": "X") of the current thread.
+         * @details Nothing is recorded if the recording is not started when the scope is entered.
+         */
+        class Scope
+        {
+        public:
+            /**
+             * @brief Enter the scope
+             *
+             * @param name The name of the event (a string literal, it is not copied)
+             */
+            explicit Scope(const char *name);
+
+            /**
+             * @brief Leave the scope and record the event
+             */
+            ~Scope();
+
+            /// Scope cannot be copied
+            Scope(const Scope &) = delete;
+
+            /// Scope cannot be assigned
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            const char *m_name; ///< The name of the event (nullptr if not recorded)
+            std::chrono::steady_clock::time_point m_start; ///< The time at which the scope has been entered
+        };
+    } // namespace profiler
+} // namespace gameboy
@@ -0,0 +1,110 @@
+/**
+ * @file ring_buffer.h
+ * @brief This file contains the declaration and the implementation of the RingBuffer class template.
+ *        It is a lock-free queue used to pass the audio samples from the emulator to the audio callback.
+ */
+
+#pragma once
+
+#include <algorithm> // std::min
+#include <atomic> // std::atomic
+#include <cstddef> // size_t
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief Lock-free single-producer single-consumer ring buffer
+     * @details One thread (the producer) can call push while another thread (the consumer) calls pop.
+     *          The indexes grow indefinitely and are wrapped with a mask, so the capacity is a power of 2.
+     *
+     * @tparam T The type of the elements (copied with the assignment operator)
+     */
+    template<typename T>
+    class RingBuffer
+    {
+    public:
+        /**
+         * @brief Construct a new RingBuffer object
+         *
+         * @param capacity The minimum number of elements the buffer can contain (rounded up to a power of 2)
+         */
+        explicit RingBuffer(size_t capacity)
+        {
+            size_t size = 1;
+            while (size < capacity)
+                size <<= 1;
+            m_buffer.resize(size);
+            m_mask = size - 1;
+        }
+
+        /**
+         * @brief Append elements to the buffer (producer only)
+         * @details If there is not enough space, only the elements that fit are written
+         *
+         * @param data The elements to append
+         * @param count The number of elements
+         * @return The number of elements written
+         */
+        size_t push(const T *data, size_t count)
+        {
+            size_t write = m_write.load(std::memory_order_relaxed);
+            size_t read = m_read.load(std::memory_order_acquire);
+            count = std::min(count, m_buffer.size() - (write - read));
+
+            for (size_t i = 0; i < count; i++)
+                m_buffer[(write + i) & m_mask] = data[i];
+
+            m_write.store(write + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief Remove elements from the buffer (consumer only)
+         *
+         * @param data The destination of the elements
+         * @param count The maximum number of elements to remove
+         * @return The number of elements removed
+         */
+        size_t pop(T *data, size_t count)
+        {
+            size_t read = m_read.load(std::memory_order_relaxed);
+            size_t write = m_write.load(std::memory_order_acquire);
+            count = std::min(count, write - read);
+
+            for (size_t i = 0; i < count; i++)
+                data[i] = m_buffer[(read + i) & m_mask];
+
+            m_read.store(read + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief Get the number of elements in the buffer
+         * @details The value can be out of date as soon as it is returned, if the other thread is working on the buffer
+         *
+         * @return The number of elements in the buffer
+         */
+        [[nodiscard]] size_t size() const
+        {
+            return m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Get the capacity of the buffer
+         *
+         * @return The maximum number of elements in the buffer
+         */
+        [[nodiscard]] size_t capacity() const
+        {
+            return m_buffer.size();
+        }
+
+    private:
+        std::vector<T> m_buffer; ///< The elements
+        size_t m_mask = 0; ///< The mask used to wrap the indexes (capacity - 1)
+
+        alignas(64) std::atomic<size_t> m_write{0}; ///< The number of elements written (only modified by the producer)
+        alignas(64) std::atomic<size_t> m_read{0}; ///< The number of elements read (only modified by the consumer)
+    };
+} // namespace gameboy
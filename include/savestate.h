@@ -0,0 +1,110 @@
+/**
+ * @file savestate.h
+ * @brief This file contains the declaration of the StateWriter and StateReader classes.
+ *        They are used to capture and restore the state of the emulator in memory.
+ */
+
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t
+#include <type_traits> // std::is_trivially_copyable_v
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The StateWriter class appends the raw bytes of the state of the components to a buffer.
+     * @details The buffer is cleared but its capacity is kept, so that writing a state in a buffer that has
+     *          already been used does not allocate memory.
+     *          The format is not portable: it is meant to be read by the same build on the same machine.
+     */
+    class StateWriter
+    {
+    public:
+        /**
+         * @brief Construct a new StateWriter object
+         *
+         * @param buffer The buffer to write to (it is cleared)
+         */
+        explicit StateWriter(std::vector<uint8_t> &buffer);
+
+        /**
+         * @brief Write a value
+         *
+         * @tparam T The type of the value (must be trivially copyable)
+         * @param value The value to write
+         */
+        template<typename T>
+        void write(const T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written");
+            writeBytes(&value, sizeof(T));
+        }
+
+        /**
+         * @brief Write a block of bytes
+         *
+         * @param data The bytes to write
+         * @param size The number of bytes to write
+         */
+        void writeBytes(const void *data, size_t size);
+
+    private:
+        std::vector<uint8_t> &m_buffer; ///< The buffer to write to
+    };
+
+    /**
+     * @brief The StateReader class reads back the state written by a StateWriter.
+     * @details Reading past the end of the buffer does not modify the destination and marks the reader as invalid.
+     */
+    class StateReader
+    {
+    public:
+        /**
+         * @brief Construct a new StateReader object
+         *
+         * @param buffer The buffer to read from
+         */
+        explicit StateReader(const std::vector<uint8_t> &buffer);
+
+        /**
+         * @brief Read a value
+         *
+         * @tparam T The type of the value (must be trivially copyable)
+         * @param value The value to read into
+         */
+        template<typename T>
+        void read(T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read");
+            readBytes(&value, sizeof(T));
+        }
+
+        /**
+         * @brief Read a block of bytes
+         *
+         * @param data The destination of the bytes
+         * @param size The number of bytes to read
+         */
+        void readBytes(void *data, size_t size);
+
+        /**
+         * @brief Mark the state as invalid
+         * @details Used by the components when the state does not match them (e.g. a RAM of a different size)
+         */
+        void invalidate();
+
+        /**
+         * @brief Return whether the state has been read correctly
+         *
+         * @return true if all the reads were inside the buffer and the state matched the components, false otherwise
+         */
+        [[nodiscard]] bool isValid() const;
+
+    private:
+        const std::vector<uint8_t> &m_buffer; ///< The buffer to read from
+        size_t m_position = 0; ///< The position of the next byte to read
+        bool m_valid = true; ///< False if a read went past the end of the buffer
+    };
+} // namespace gameboy
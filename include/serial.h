@@ -0,0 +1,159 @@
+/**
+ * @file serial.h
+ * @brief This file contains the declaration of the Serial class and of the sinks of the transferred bytes.
+ *        It emulates the serial port of the Game Boy (used by the link cable).
+ */
+
+/*
+ * See https://gbdev.io/pandocs/Serial_Data_Transfer_(Link_Cable).html
+ */
+
+#pragma once
+
+#include "memory.h" // Memory
+
+#include <optional> // std::optional
+#include <string> // std::string
+
+namespace gameboy
+{
+    namespace serial_registers
+    {
+        constexpr uint16_t SB_ADDRESS = 0xFF01; ///< The address of the Serial transfer data register
+        constexpr uint16_t SC_ADDRESS = 0xFF02; ///< The address of the Serial transfer control register
+    } // namespace serial_registers
+
+    /**
+     * @brief The SerialSink class is the other end of the serial port (what is plugged to the link port).
+     */
+    class SerialSink
+    {
+    public:
+        virtual ~SerialSink() = default;
+
+        /**
+         * @brief Exchange a byte with the other end
+         * @details Called when the Game Boy completes the transfer of a byte using its internal clock
+         *
+         * @param byte The byte sent by the Game Boy
+         * @return The byte received by the Game Boy
+         */
+        virtual uint8_t transfer(uint8_t byte) = 0;
+
+        /**
+         * @brief Notify the start of a transfer using the internal clock
+         * @details Used by the sinks that need to know the byte before the end of the transfer (e.g. the link cable)
+         *
+         * @param byte The byte sent by the Game Boy
+         * @param completionTime The time at which the transfer will complete (cycles since the start of the emulation)
+         */
+        virtual void transferStarted(uint8_t byte, uint64_t completionTime);
+
+        /**
+         * @brief Give the current time to the sink and check if the other end clocked a transfer
+         * @details Called at each step of the serial port. If the other end completed a transfer using its clock,
+         *          the sink returns the received byte and sends the byte of the Game Boy to the other end.
+         *
+         * @param time The current time (cycles since the start of the emulation)
+         * @param data The current content of SB (sent if a transfer is clocked by the other end)
+         * @return The byte received, std::nullopt if the other end did not clock a transfer
+         */
+        virtual std::optional<uint8_t> update(uint64_t time, uint8_t data);
+    };
+
+    /**
+     * @brief The CaptureSink class buffers the bytes sent by the Game Boy.
+     * @details Nothing is connected on the other end, so the Game Boy receives 0xFF.
+     *          Used to read the results printed by the test ROMs.
+     */
+    class CaptureSink final : public SerialSink
+    {
+    public:
+        /**
+         * @brief Append the byte to the captured data
+         *
+         * @param byte The byte sent by the Game Boy
+         * @return 0xFF (nothing connected)
+         */
+        uint8_t transfer(uint8_t byte) override;
+
+        /**
+         * @brief Get the bytes sent by the Game Boy
+         *
+         * @return The captured bytes
+         */
+        [[nodiscard]] const std::string &getData() const;
+
+        /**
+         * @brief Remove the captured bytes
+         */
+        void clear();
+
+    private:
+        std::string m_data; ///< The captured bytes
+    };
+
+    /**
+     * @brief The Serial class emulates the serial port of the Game Boy.
+     * @details A transfer starts when bits 7 (transfer start) and 0 (internal clock) of SC are set.
+     *          After 8 bits (at 8192 Hz) the byte of SB is exchanged with the sink, bit 7 of SC is reset
+     *          and the serial interrupt is requested.
+     *          The transfers using the external clock complete only when the other end of the sink (e.g. another
+     *          Game Boy connected with a link cable) clocks them.
+     */
+    class Serial
+    {
+    public:
+        /**
+         * @brief Construct a new Serial object
+         *
+         * @param memory The memory
+         */
+        explicit Serial(Memory &memory);
+
+        /**
+         * @brief Set the other end of the serial port
+         *
+         * @param sink The sink (nullptr if nothing is connected, the Game Boy receives 0xFF)
+         */
+        void setSink(SerialSink *sink);
+
+        /**
+         * @brief Advance the transfer in progress (if any)
+         *
+         * @param cycles The number of cycles elapsed
+         */
+        void cycle(uint8_t cycles);
+
+        /**
+         * @brief Save the state of the serial port (transfer in progress)
+         *
+         * @param writer The state writer
+         */
+        void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the serial port
+         *
+         * @param reader The state reader
+         * @see saveState
+         */
+        void loadState(StateReader &reader);
+
+    private:
+        Memory &m_memory; ///< The memory
+        SerialSink *m_sink = nullptr; ///< The other end of the serial port
+
+        uint64_t m_time = 0; ///< The number of cycles since the start of the emulation
+        bool m_transferring = false; ///< Whether a transfer is in progress
+        uint32_t m_transferCycles = 0; ///< The number of cycles since the beginning of the transfer
+
+        static constexpr uint32_t TRANSFER_CYCLES = 4096; ///< The duration of the transfer of a byte (8 bits at 8192 Hz)
+        static constexpr uint8_t SERIAL_INTERRUPT_FLAG_VALUE = 0x08; ///< The bit of the serial interrupt in the IF register
+
+        /**
+         * @brief Request the serial interrupt
+         */
+        void requestInterrupt();
+    };
+} // namespace gameboy
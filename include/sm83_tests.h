@@ -0,0 +1,164 @@
+/**
+ * @file sm83_tests.h
+ * @brief This file contains the harness of the SM83 single-step tests.
+ *        Each test sets the registers and the memory, executes one instruction on a CPU with a FlatMemory bus,
+ *        and compares the registers, the memory and the number of machine cycles with the expected ones.
+ */
+
+/*
+ * See https://github.com/SingleStepTests/sm83
+ */
+
+#pragma once
+
+#include "cpu.h" // BasicCPU
+#include "flat_memory.h" // FlatMemory
+
+#include <cstdint> // uint8_t, uint16_t, uint64_t
+#include <istream> // std::istream
+#include <string> // std::string
+#include <utility> // std::pair
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The state of the CPU and of the memory before or after a test
+     */
+    struct SM83State
+    {
+        uint16_t pc = 0; ///< The program counter
+        uint16_t sp = 0; ///< The stack pointer
+        uint8_t a = 0; ///< The A register
+        uint8_t f = 0; ///< The F register
+        uint8_t b = 0; ///< The B register
+        uint8_t c = 0; ///< The C register
+        uint8_t d = 0; ///< The D register
+        uint8_t e = 0; ///< The E register
+        uint8_t h = 0; ///< The H register
+        uint8_t l = 0; ///< The L register
+        bool ime = false; ///< The IME flag
+        std::vector<std::pair<uint16_t, uint8_t>> ram; ///< The bytes of the memory used by the test (address, value)
+    };
+
+    /**
+     * @brief A single-step test
+     */
+    struct SM83Test
+    {
+        std::string name; ///< The name of the test (opcode and index)
+        SM83State initial; ///< The state before the instruction
+        SM83State final; ///< The expected state after the instruction
+        size_t cycles = 0; ///< The expected number of machine cycles of the instruction
+    };
+
+    /**
+     * @brief The results of a set of tests
+     */
+    struct SM83Results
+    {
+        uint64_t passed = 0; ///< The number of tests passed
+        uint64_t failed = 0; ///< The number of tests failed
+        std::vector<std::string> failures; ///< The description of the first failures (see MAX_FAILURES)
+        bool valid = true; ///< False if a file cannot be read or is not valid JSON
+
+        static constexpr size_t MAX_FAILURES = 5; ///< The number of failures described
+
+        /**
+         * @brief Add the results of another set of tests
+         *
+         * @param other The other results
+         */
+        void add(const SM83Results &other);
+    };
+
+    /**
+     * @brief SM83TestReader reads the tests of a JSON file one by one.
+     * @details A file contains an array of tests (about 1000 per opcode), so the tests are parsed while the
+     *          stream is read instead of loading the whole document. Only the fields of the tests are understood,
+     *          the other ones are skipped.
+     */
+    class SM83TestReader
+    {
+    public:
+        /**
+         * @brief Construct a reader
+         *
+         * @param stream The stream containing the JSON array of tests
+         */
+        explicit SM83TestReader(std::istream &stream);
+
+        /**
+         * @brief Read the next test
+         *
+         * @param test The test to fill
+         * @return True if a test has been read, false at the end of the array or if the JSON is not valid
+         * @see isValid
+         */
+        bool next(SM83Test &test);
+
+        /**
+         * @brief Check whether the JSON read so far is valid
+         *
+         * @return True if valid, false otherwise
+         */
+        [[nodiscard]] bool isValid() const;
+
+    private:
+        std::istream &m_stream; ///< The stream
+        bool m_started = false; ///< True once the opening bracket of the array has been read
+        bool m_finished = false; ///< True once the closing bracket of the array has been read
+        bool m_valid = true; ///< False once an error has been found
+
+        /**
+         * @brief Skip the whitespaces and get the next character, without extracting it
+         *
+         * @return The next character, EOF at the end of the stream
+         */
+        int peek();
+
+        /**
+         * @brief Extract the next character (after the whitespaces) if it is the expected one
+         *
+         * @param expected The expected character
+         * @return True if the character has been extracted, false otherwise (the JSON is not valid)
+         */
+        bool expect(char expected);
+
+        bool readString(std::string &value); ///< Read a string (the escaped characters are kept as is)
+        bool readNumber(uint64_t &value); ///< Read a non-negative integer
+        bool readState(SM83State &state); ///< Read the object of an initial or final state
+        bool readRAM(std::vector<std::pair<uint16_t, uint8_t>> &ram); ///< Read an array of [address, value]
+        bool readArrayLength(size_t &length); ///< Read an array, only counting its elements
+        bool skipValue(); ///< Read any value, ignoring it
+    };
+
+    /**
+     * @brief Run a test on a new CPU
+     *
+     * @param test The test
+     * @param memory The memory bus (cleared first)
+     * @param error The description of the first difference with the expected state, if any
+     * @return True if the test passed, false otherwise
+     */
+    bool runSM83Test(const SM83Test &test, FlatMemory &memory, std::string &error);
+
+    /**
+     * @brief Run all the tests of a stream
+     *
+     * @param stream The JSON array of tests
+     * @param source The name of the stream (for the failures)
+     * @return The results
+     */
+    SM83Results runSM83Tests(std::istream &stream, const std::string &source);
+
+    /**
+     * @brief Run the tests of a file, or of all the .json files of a directory (on several threads)
+     * @details The results are printed, with the first failures of each file
+     *
+     * @param path The file or the directory
+     * @param threads The number of threads (0 for one per core)
+     * @return 0 if all the tests passed, 1 otherwise
+     */
+    int runSM83TestFiles(const std::string &path, size_t threads = 0);
+} // namespace gameboy
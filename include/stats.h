@@ -0,0 +1,98 @@
+/**
+ * @file stats.h
+ * @brief This file contains the declaration of the StatsCollector class.
+ *        It collects the runtime statistics of the emulation (speed, frame times, time spent emulating and sleeping)
+ *        once per frame, for the overlay of the front end and for the JSON lines of the headless runs.
+ */
+
+#pragma once
+
+#include <array> // std::array
+#include <atomic> // std::atomic
+#include <chrono> // std::chrono::steady_clock
+#include <cstdint> // uint32_t, uint64_t
+#include <string> // std::string
+
+namespace gameboy
+{
+    /**
+     * @brief The statistics of the frames since the previous snapshot
+     */
+    struct StatsSnapshot
+    {
+        uint64_t frame = 0; ///< The number of frames since the creation of the collector
+        double seconds = 0; ///< The duration of the interval in seconds
+        uint32_t frames = 0; ///< The number of frames in the interval
+        double cyclesPerSecond = 0; ///< The number of emulated cycles per second
+        double instructionsPerSecond = 0; ///< The number of emulated instructions per second
+        double speed = 0; ///< The speed compared to the real Game Boy (1 = real time)
+        double frameP50Ms = 0; ///< The median of the frame times in milliseconds
+        double frameP95Ms = 0; ///< The 95th percentile of the frame times in milliseconds
+        double frameP99Ms = 0; ///< The 99th percentile of the frame times in milliseconds
+        double emulateRatio = 0; ///< The part of the interval spent emulating (0 to 1)
+        double sleepRatio = 0; ///< The part of the interval spent waiting for the next frame (0 to 1)
+    };
+
+    /**
+     * @brief Format a snapshot as a line of JSON (without end of line)
+     *
+     * @param snapshot The snapshot
+     * @return The JSON object
+     */
+    [[nodiscard]] std::string formatStatsJSON(const StatsSnapshot &snapshot);
+
+    /**
+     * @brief StatsCollector accumulates the statistics of the frames.
+     * @details The emulation thread calls addFrame once per frame. The counters are atomic (relaxed, no lock),
+     *          so takeSnapshot can be called by another thread; it returns the statistics since the previous
+     *          snapshot. The frame times are counted in a histogram of HISTOGRAM_BUCKETS buckets of
+     *          BUCKET_MS milliseconds (the last bucket also counts the longer frames), which gives the percentiles.
+     */
+    class StatsCollector
+    {
+    public:
+        /**
+         * @brief Construct a collector (the first interval starts now)
+         */
+        StatsCollector();
+
+        /**
+         * @brief Add a frame
+         *
+         * @param cycles The number of cycles emulated for the frame
+         * @param instructions The number of instructions emulated for the frame
+         * @param frameSeconds The time since the previous frame in seconds
+         * @param emulateSeconds The time spent emulating the frame in seconds
+         * @param sleepSeconds The time spent waiting for the next frame in seconds
+         */
+        void addFrame(uint64_t cycles, uint64_t instructions, double frameSeconds, double emulateSeconds, double sleepSeconds);
+
+        /**
+         * @brief Get the statistics since the previous snapshot, and start a new interval
+         *
+         * @return The statistics
+         */
+        StatsSnapshot takeSnapshot();
+
+        static constexpr double BUCKET_MS = 0.25; ///< The width of a bucket of the frame time histogram in milliseconds
+        static constexpr size_t HISTOGRAM_BUCKETS = 400; ///< The number of buckets (up to 100 ms)
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        std::atomic<uint64_t> m_frames{0}; ///< The number of frames
+        std::atomic<uint64_t> m_cycles{0}; ///< The number of cycles emulated
+        std::atomic<uint64_t> m_instructions{0}; ///< The number of instructions emulated
+        std::atomic<uint64_t> m_emulateNs{0}; ///< The time spent emulating in nanoseconds
+        std::atomic<uint64_t> m_sleepNs{0}; ///< The time spent waiting in nanoseconds
+        std::array<std::atomic<uint32_t>, HISTOGRAM_BUCKETS> m_histogram{}; ///< The frame times of the interval
+
+        // The totals at the previous snapshot (only used by takeSnapshot)
+        Clock::time_point m_lastSnapshot; ///< The time of the previous snapshot
+        uint64_t m_lastFrames = 0; ///< The number of frames at the previous snapshot
+        uint64_t m_lastCycles = 0; ///< The number of cycles at the previous snapshot
+        uint64_t m_lastInstructions = 0; ///< The number of instructions at the previous snapshot
+        uint64_t m_lastEmulateNs = 0; ///< The time spent emulating at the previous snapshot
+        uint64_t m_lastSleepNs = 0; ///< The time spent waiting at the previous snapshot
+    };
+} // namespace gameboy
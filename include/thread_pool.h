@@ -0,0 +1,87 @@
+/**
+ * @file thread_pool.h
+ * @brief This file contains the declaration of the ThreadPool class.
+ *        It runs the iterations of a loop on a fixed set of threads (used to step many emulators in parallel).
+ */
+
+#pragma once
+
+#include <atomic> // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <cstddef> // size_t
+#include <functional> // std::function
+#include <mutex> // std::mutex
+#include <thread> // std::thread
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The ThreadPool class runs the iterations of a loop on a fixed set of threads.
+     * @details The threads are created once and sleep between two loops. The calling thread also runs
+     *          iterations, so a pool of N threads creates N - 1 workers. The iterations are distributed
+     *          dynamically (each thread takes the next one), so iterations of different durations are balanced.
+     */
+    class ThreadPool
+    {
+    public:
+        /**
+         * @brief Create the worker threads
+         *
+         * @param threads The number of threads running the loops (including the calling thread, at least 1)
+         */
+        explicit ThreadPool(size_t threads);
+
+        /**
+         * @brief Stop and join the worker threads
+         */
+        ~ThreadPool();
+
+        /// ThreadPool cannot be copied
+        ThreadPool(const ThreadPool &) = delete;
+
+        /// ThreadPool cannot be assigned
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * @brief Run a loop on the threads and wait for its end
+         * @details The function is called once for each index in [0, count), from any thread of the pool.
+         *          It must not call run.
+         *
+         * @param count The number of iterations
+         * @param function The body of the loop
+         */
+        void run(size_t count, const std::function<void(size_t)> &function);
+
+        /**
+         * @brief Get the number of threads running the loops
+         *
+         * @return The number of threads (including the calling thread)
+         */
+        [[nodiscard]] size_t getThreadCount() const;
+
+    private:
+        std::vector<std::thread> m_workers; ///< The worker threads
+
+        std::mutex m_mutex; ///< Protects the fields below
+        std::condition_variable m_start; ///< Signaled when a loop starts (or the pool stops)
+        std::condition_variable m_done; ///< Signaled when a worker finishes a loop
+        const std::function<void(size_t)> *m_function = nullptr; ///< The body of the current loop
+        size_t m_count = 0; ///< The number of iterations of the current loop
+        size_t m_generation = 0; ///< The number of loops started (the workers wait for the next one)
+        size_t m_busyWorkers = 0; ///< The number of workers that have not finished the current loop
+        bool m_stop = false; ///< True when the workers must exit
+
+        std::atomic<size_t> m_next{0}; ///< The next iteration to run
+
+        /**
+         * @brief Run the iterations of the loops until the pool stops (body of the workers)
+         */
+        void workerLoop();
+
+        /**
+         * @brief Run the remaining iterations of the current loop
+         */
+        void runIterations();
+    };
+} // namespace gameboy
@@ -0,0 +1,112 @@
+/**
+ * @file timed_bus.h
+ * @brief This file contains the declaration of the TimedBus class.
+ *        It clocks the other components of the Game Boy before each memory access of the CPU, so that the accesses
+ *        happen at their machine cycle instead of at the start of the instruction.
+ */
+
+/*
+ * See https://gbdev.io/pandocs/CPU_Instruction_Set.html (the timing of the memory accesses of each instruction)
+ */
+
+#pragma once
+
+#include "bus.h" // is_bus_v
+#include "memory.h" // interrupt_registers::INTERRUPT_FLAG_ADDRESS, interrupt_registers::INTERRUPT_ENABLE_ADDRESS
+
+#include <cstdint> // uint8_t, uint16_t, int32_t
+
+namespace gameboy
+{
+    /**
+     * @brief TimedBus forwards the accesses to another bus, after clocking the components for the machine cycle of the access.
+     * @details Each read or write is a machine cycle of the instruction: the components are clocked for 4 cycles
+     *          before the access, so the CPU sees (and changes) their state at the end of that machine cycle
+     *          (e.g. the timer read by the last cycle of LD A, (nn) has advanced by 16 cycles).
+     *          At the end of the instruction (tick), the components are clocked for the cycles without access
+     *          (e.g. the internal cycles of CALL).
+     *
+     *          The CPU checks IF and IE before each instruction without a machine cycle on the hardware,
+     *          so the accesses to these two registers are not clocked.
+     *          If an instruction has more accesses than machine cycles, the extra cycles are taken from the
+     *          next instructions, so the total number of cycles is the same as without this bus.
+     *
+     *          The clock is a template parameter, like the bus: the components are clocked without a virtual call,
+     *          and the compiler can inline them into the accesses.
+     *
+     * @tparam Bus The bus that receives the accesses
+     * @tparam Clock The clock of the other components, it provides void advance(uint8_t cycles) (e.g. Emulator)
+     */
+    template <typename Bus, typename Clock>
+    class TimedBus
+    {
+        static_assert(is_bus_v<Bus>, "TimedBus needs a bus (see is_bus)");
+
+    public:
+        /**
+         * @brief Construct a timed bus
+         *
+         * @param bus The bus that receives the accesses
+         * @param clock The clock of the other components
+         */
+        TimedBus(Bus &bus, Clock &clock)
+            : m_bus(bus),
+              m_clock(clock)
+        {}
+
+        // The bus (see is_bus)
+        uint8_t read(const uint16_t address)
+        {
+            sync(address);
+            return m_bus.read(address);
+        }
+
+        void write(const uint16_t address, const uint8_t value)
+        {
+            sync(address);
+            m_bus.write(address, value);
+        }
+
+        uint16_t readWord(const uint16_t address)
+        {
+            uint8_t low = read(address);
+            return static_cast<uint16_t>(low | (read(static_cast<uint16_t>(address + 1)) << 8));
+        }
+
+        void writeWord(const uint16_t address, const uint16_t value)
+        {
+            write(address, static_cast<uint8_t>(value & 0xFF));
+            write(static_cast<uint16_t>(address + 1), static_cast<uint8_t>(value >> 8));
+        }
+
+        void tick(const uint8_t cycles)
+        {
+            // The cycles of the instruction that have not been clocked by its accesses
+            int32_t remaining = cycles * 4 - m_ahead;
+            if (remaining > 0)
+            {
+                m_clock.advance(static_cast<uint8_t>(remaining));
+                m_ahead = 0;
+            }
+            else
+                m_ahead = -remaining;
+            m_bus.tick(cycles);
+        }
+
+    private:
+        Bus &m_bus; ///< The bus that receives the accesses
+        Clock &m_clock; ///< The clock of the other components
+        int32_t m_ahead = 0; ///< The number of cycles clocked by the accesses of the current instruction
+
+        /**
+         * @brief Clock the components for the machine cycle of an access
+         */
+        void sync(const uint16_t address)
+        {
+            if (address == interrupt_registers::INTERRUPT_FLAG_ADDRESS || address == interrupt_registers::INTERRUPT_ENABLE_ADDRESS)
+                return;
+            m_clock.advance(4);
+            m_ahead += 4;
+        }
+    };
+} // namespace gameboy
@@ -27,35 +27,87 @@ namespace gameboy
 
     /**
      * @brief The Timer class emulates the behavior of the system timer of a Gameboy.
+     * @details The timer is a 16-bit system counter incremented every cycle, DIV is its upper byte.
+     *          TIMA is incremented on each falling edge of a bit of the counter (selected by TAC) while the timer is enabled,
+     *          so writing DIV (which resets the counter) or TAC can also increment TIMA.
+     *          When TIMA overflows, it reads 0 for 4 cycles, then it is reloaded with TMA and the interrupt is requested
+     *          (writing TIMA during these 4 cycles cancels the reload).
+     *
+     *          The edges of a span of cycles are counted with arithmetic on the counter (not cycle by cycle),
+     *          so a span costs the same whatever its length (the whole periods between two overflows are skipped).
+     *          Memory forwards the accesses to the registers 0xFF04-0xFF07 to the timer (see Memory::setTimer).
      */
     class Timer
     {
     public:
         /**
          * @brief Construct a new Timer object
-         * @details Initialize all registers to 0
+         * @details Take the initial values of the registers from the memory and attach the timer to the memory
          *
          * @param memory The memory
          */
         explicit Timer(Memory &memory);
 
         /**
-         * @brief Increment and manipulate the timer registers
-         * @details Manipulate the timer registers and set the interrupt flag if necessary.
-         *          At the end save the new value of the registers in memory.
+         * @brief Detach the timer from the memory
+         */
+        ~Timer();
+
+        /// Timer cannot be copied
+        Timer(const Timer &) = delete;
+
+        /// Timer cannot be assigned
+        Timer &operator=(const Timer &) = delete;
+
+        /**
+         * @brief Increment the system counter
+         * @details Increment TIMA for the falling edges of the span, reload it and set the interrupt flag if it overflows
          *
          * @param cycles The number of cycles to increment the timer by
          */
-        void cycle(uint8_t cycles);
+        void cycle(uint32_t cycles);
+
+        /**
+         * @brief Read a register of the timer
+         *
+         * @param address The address of the register (0xFF04-0xFF07)
+         * @return The value of the register (the unused bits of TAC read as 1)
+         */
+        [[nodiscard]] uint8_t readRegister(uint16_t address) const;
+
+        /**
+         * @brief Write a register of the timer
+         * @details Writing DIV resets the system counter
+         *
+         * @param address The address of the register (0xFF04-0xFF07)
+         * @param value The value to write
+         */
+        void writeRegister(uint16_t address, uint8_t value);
+
+        /**
+         * @brief Save the state of the timer (system counter and registers)
+         *
+         * @param writer The state writer
+         */
+        void saveState(StateWriter &writer) const;
+
+        /**
+         * @brief Restore the state of the timer
+         *
+         * @param reader The state reader
+         * @see saveState
+         */
+        void loadState(StateReader &reader);
 
     private:
         Memory &m_memory; ///< The memory
 
         /**
-         * @brief This register is incremented 16384 times a second.
-         *        Writing any value sets it to $00.
+         * @brief This counter is incremented every cycle.
+         *        Its upper byte is the Divider Register (0xFF04), incremented 16384 times a second.
+         *        Writing any value to DIV sets it to $0000.
          */
-        uint8_t m_div = 0; ///< Divider register (0xFF04)
+        uint16_t m_counter = 0; ///< System counter
 
         /**
          * @brief This register is incremented at the rate (clock
@@ -85,21 +137,44 @@ namespace gameboy
          */
         uint8_t m_tac = 0; ///< Timer control register (0xFF07)
 
-        uint16_t m_divCycles = 0; ///< Divider register cycles
-        uint16_t m_timaCycles = 0; ///< Timer counter cycles
+        uint8_t m_reloadDelay = 0; ///< The number of cycles until TIMA is reloaded with TMA after an overflow (0 for none)
 
         static constexpr uint8_t TIMER_OVERFLOW_INTERRUPT_FLAG_VALUE = 0x04; ///< The bitmask of the Timer Interrupt Flag
+        static constexpr uint8_t RELOAD_DELAY = 4; ///< The number of cycles between the overflow of TIMA and its reload
+        static constexpr uint8_t TIMER_ENABLE_BIT = 0x04; ///< The bit of TAC that starts the timer
+        static constexpr uint8_t TAC_UNUSED_BITS = 0xF8; ///< The bits of TAC that read as 1
 
         /**
-         * @brief Get the current value of the timer registers
-         * @details Save the current value of the registers in the member variables of this class
+         * @brief Get the period of TIMA
+         * @details TIMA is incremented when the selected bit of the counter goes from 1 to 0,
+         *          i.e. every 2 * (selected bit) cycles (1024, 16, 64 or 256 cycles)
+         *
+         * @param tac The value of TAC
+         * @return The number of cycles between two increments of TIMA
+         */
+        [[nodiscard]] static uint32_t getPeriod(uint8_t tac);
+
+        /**
+         * @brief Get the input of TIMA: the selected bit of the counter, if the timer is enabled
+         * @details TIMA is incremented on the falling edges of this signal
+         *
+         * @param counter The system counter
+         * @param tac The value of TAC
+         * @return True if the input is 1, false otherwise
+         */
+        [[nodiscard]] static bool getSignal(uint16_t counter, uint8_t tac);
+
+        /**
+         * @brief Increment TIMA
+         * @details Start the reload delay if it overflows
+         *
+         * @param increments The number of increments (the overflow must be the last one)
          */
-        void getRegisters();
+        void incrementTIMA(uint32_t increments);
 
         /**
-         * @brief Set the value of the timer registers
-         * @details Set the value of the timer registers in the memory
+         * @brief Reload TIMA with TMA and request the timer interrupt
          */
-        void setRegisters();
+        void reloadTIMA();
     };
-} // namespace gameboy
\ No newline at end of file
+} // namespace gameboy
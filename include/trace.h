@@ -0,0 +1,238 @@
+/**
+ * @file trace.h
+ * @brief This file contains the instruction trace: the state of the CPU before each instruction, written to
+ *        a compact binary file while the emulator runs, and read back to print it or to find where two traces
+ *        diverge (e.g. before and after a change of the CPU).
+ */
+
+#pragma once
+
+#include "ring_buffer.h" // RingBuffer
+
+#include <atomic> // std::atomic
+#include <cstdint> // uint8_t, uint16_t, uint64_t
+#include <fstream> // std::ofstream
+#include <istream> // std::istream
+#include <ostream> // std::ostream
+#include <string> // std::string
+#include <thread> // std::thread
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The state of the CPU before an instruction
+     */
+    struct TraceRecord
+    {
+        uint64_t cycles = 0; ///< The number of cycles emulated before the instruction
+        uint16_t pc = 0; ///< The program counter (address of the instruction)
+        uint16_t sp = 0; ///< The stack pointer
+        uint8_t opcode = 0; ///< The first byte of the instruction
+        uint8_t a = 0; ///< The A register
+        uint8_t f = 0; ///< The F register
+        uint8_t b = 0; ///< The B register
+        uint8_t c = 0; ///< The C register
+        uint8_t d = 0; ///< The D register
+        uint8_t e = 0; ///< The E register
+        uint8_t h = 0; ///< The H register
+        uint8_t l = 0; ///< The L register
+
+        /// Compare all the fields
+        [[nodiscard]] bool operator==(const TraceRecord &other) const;
+
+        /// Compare all the fields
+        [[nodiscard]] bool operator!=(const TraceRecord &other) const;
+    };
+
+    /**
+     * @brief Format a record on one line (e.g. "PC=0150 OP=3E A=01 F=B0 ... SP=FFFE CY=123456")
+     *
+     * @param record The record
+     * @return The line, without end of line
+     */
+    [[nodiscard]] std::string formatTraceRecord(const TraceRecord &record);
+
+    namespace trace_format
+    {
+        constexpr uint32_t TRACE_MAGIC = 0x31544247; ///< The first bytes of a trace file ("GBT1")
+        constexpr size_t MAX_RECORD_SIZE = 25; ///< The maximum size of an encoded record in bytes
+    } // namespace trace_format
+
+    /**
+     * @brief The TraceSink class receives the state of the CPU before each instruction (see Emulator::setTracer).
+     */
+    class TraceSink
+    {
+    public:
+        virtual ~TraceSink() = default;
+
+        /**
+         * @brief Append a record to the trace
+         *
+         * @param record The state of the CPU before the instruction
+         */
+        virtual void record(const TraceRecord &record) = 0;
+    };
+
+    /**
+     * @brief TraceWriter encodes the records and writes them to a file from a background thread.
+     * @details Each record is encoded as the difference with the previous one (the first one with a record
+     *          set to 0), usually 4 or 5 bytes:
+     *              - the mask of the 8 bit registers that changed (bit 0 = A, ..., bit 7 = L)
+     *              - a varint: the zigzag encoded PC delta shifted left by 1, bit 0 set if SP changed
+     *              - the opcode
+     *              - a varint: the number of cycles since the previous record
+     *              - SP (little endian) if it changed, then the registers that changed, in the order of the mask
+     *
+     *          The emulator thread only encodes the records into a lock-free ring buffer (it waits only if the
+     *          writer thread falls behind by the whole buffer, so no record is lost).
+     */
+    class TraceWriter : public TraceSink
+    {
+    public:
+        TraceWriter();
+
+        /// Close the file (see close)
+        ~TraceWriter() override;
+
+        /// TraceWriter cannot be copied
+        TraceWriter(const TraceWriter &) = delete;
+
+        /// TraceWriter cannot be assigned
+        TraceWriter &operator=(const TraceWriter &) = delete;
+
+        /**
+         * @brief Create the trace file and start the writer thread
+         *
+         * @param filename The name of the file
+         * @return True if the file has been created, false otherwise
+         */
+        bool open(const std::string &filename);
+
+        // The trace sink (see TraceSink)
+        void record(const TraceRecord &record) override;
+
+        /**
+         * @brief Write the records still in the buffer, stop the writer thread and close the file
+         *
+         * @return False if a write failed, true otherwise
+         */
+        bool close();
+
+        /**
+         * @brief Get the number of records appended since open
+         *
+         * @return The number of records
+         */
+        [[nodiscard]] uint64_t getRecordCount() const
+        {
+            return m_count;
+        }
+
+    private:
+        RingBuffer<uint8_t> m_buffer; ///< The encoded records not written yet
+        std::ofstream m_file; ///< The trace file
+        std::thread m_thread; ///< The writer thread
+        std::atomic<bool> m_running{false}; ///< True while the writer thread must wait for more records
+        std::atomic<bool> m_failed{false}; ///< True if a write failed
+        TraceRecord m_previous; ///< The last record appended (the reference of the next delta)
+        uint64_t m_count = 0; ///< The number of records appended
+
+        static constexpr size_t BUFFER_SIZE = 1 << 20; ///< The size of the ring buffer in bytes
+        static constexpr size_t CHUNK_SIZE = 1 << 16; ///< The maximum number of bytes written at once
+
+        /**
+         * @brief The loop of the writer thread: move the bytes of the ring buffer to the file
+         */
+        void writeLoop();
+    };
+
+    /**
+     * @brief TraceReader decodes the records of a trace one by one.
+     */
+    class TraceReader
+    {
+    public:
+        /**
+         * @brief Construct a reader and check the header of the trace
+         *
+         * @param stream The trace (opened in binary mode)
+         */
+        explicit TraceReader(std::istream &stream);
+
+        /**
+         * @brief Decode the next record
+         *
+         * @param record The record decoded
+         * @return False at the end of the trace or if the trace is not valid, true otherwise
+         */
+        bool next(TraceRecord &record);
+
+        /**
+         * @brief Check whether the trace is valid (header, no truncated record)
+         *
+         * @return False if the trace is not valid, true otherwise
+         */
+        [[nodiscard]] bool isValid() const
+        {
+            return m_valid;
+        }
+
+    private:
+        std::istream &m_stream; ///< The trace
+        TraceRecord m_previous; ///< The last record decoded
+        bool m_valid = true; ///< False if the trace is not valid
+
+        /**
+         * @brief Read a varint
+         *
+         * @param value The value read
+         * @return False if the trace ended, true otherwise
+         */
+        bool readVarint(uint64_t &value);
+    };
+
+    /**
+     * @brief The first difference between two traces
+     */
+    struct TraceDiff
+    {
+        bool diverged = false; ///< True if the traces differ
+        bool valid = true; ///< False if one of the traces is not valid
+        uint64_t index = 0; ///< The index of the first different record (or the number of records if identical)
+        bool firstEnded = false; ///< True if the first trace ended before the divergence
+        bool secondEnded = false; ///< True if the second trace ended before the divergence
+        TraceRecord first; ///< The record of the first trace at the divergence
+        TraceRecord second; ///< The record of the second trace at the divergence
+        std::vector<TraceRecord> context; ///< The last records before the divergence (same in both traces)
+    };
+
+    /**
+     * @brief Find the first record that differs between two traces
+     *
+     * @param first The first trace
+     * @param second The second trace
+     * @param contextSize The number of records kept before the divergence
+     * @return The difference
+     */
+    [[nodiscard]] TraceDiff diffTraces(TraceReader &first, TraceReader &second, size_t contextSize = 8);
+
+    /**
+     * @brief Print all the records of a trace file
+     *
+     * @param filename The name of the trace file
+     * @param output The stream that receives the records, one per line
+     * @return The exit code (0 if the trace is valid, 1 otherwise)
+     */
+    int printTraceFile(const std::string &filename, std::ostream &output);
+
+    /**
+     * @brief Print the first difference between two trace files, with the records before it
+     *
+     * @param firstFile The name of the first trace file
+     * @param secondFile The name of the second trace file
+     * @return The exit code (0 if the traces are identical, 1 otherwise)
+     */
+    int diffTraceFiles(const std::string &firstFile, const std::string &secondFile);
+} // namespace gameboy
@@ -0,0 +1,143 @@
+/**
+ * @file tracing_bus.h
+ * @brief This file contains the declaration of the TracingBus class.
+ *        It records the accesses of the CPU to another memory bus (e.g. to debug or to compare two buses).
+ */
+
+#pragma once
+
+#include "bus.h" // is_bus_v
+
+#include <cstdint> // uint8_t, uint16_t, uint64_t
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The types of the accesses to a bus
+     */
+    enum class BusAccessType : uint8_t
+    {
+        READ = 0, ///< A byte has been read
+        WRITE = 1 ///< A byte has been written
+    };
+
+    /**
+     * @brief An access to a bus
+     */
+    struct BusAccess
+    {
+        uint64_t cycle; ///< The number of machine cycles ticked before the access
+        uint16_t address; ///< The address
+        uint8_t value; ///< The byte read or written
+        BusAccessType type; ///< Read or write
+    };
+
+    /**
+     * @brief TracingBus forwards the accesses to another bus and records them.
+     * @details The words are recorded as two bytes (low byte first), like the accesses of the hardware.
+     *          The recording can be disabled, then the bus only counts the machine cycles.
+     *
+     * @tparam Bus The bus that receives the accesses
+     */
+    template <typename Bus>
+    class TracingBus
+    {
+        static_assert(is_bus_v<Bus>, "TracingBus needs a bus (see is_bus)");
+
+    public:
+        /**
+         * @brief Construct a tracing bus
+         *
+         * @param bus The bus that receives the accesses
+         */
+        explicit TracingBus(Bus &bus)
+            : m_bus(bus)
+        {}
+
+        // The bus (see is_bus)
+        uint8_t read(const uint16_t address)
+        {
+            uint8_t value = m_bus.read(address);
+            record(address, value, BusAccessType::READ);
+            return value;
+        }
+
+        void write(const uint16_t address, const uint8_t value)
+        {
+            m_bus.write(address, value);
+            record(address, value, BusAccessType::WRITE);
+        }
+
+        uint16_t readWord(const uint16_t address)
+        {
+            uint8_t low = read(address);
+            return static_cast<uint16_t>(low | (read(static_cast<uint16_t>(address + 1)) << 8));
+        }
+
+        void writeWord(const uint16_t address, const uint16_t value)
+        {
+            write(address, static_cast<uint8_t>(value & 0xFF));
+            write(static_cast<uint16_t>(address + 1), static_cast<uint8_t>(value >> 8));
+        }
+
+        void tick(const uint8_t cycles)
+        {
+            m_bus.tick(cycles);
+            m_cycles += cycles;
+        }
+
+        /**
+         * @brief Enable/Disable the recording of the accesses
+         *
+         * @param enabled True to record the accesses, false otherwise
+         */
+        void setRecording(const bool enabled)
+        {
+            m_recording = enabled;
+        }
+
+        /**
+         * @brief Get the accesses recorded since the last call of clear
+         *
+         * @return The accesses, in order
+         */
+        [[nodiscard]] const std::vector<BusAccess> &getAccesses() const
+        {
+            return m_accesses;
+        }
+
+        /**
+         * @brief Get the number of machine cycles ticked since the construction
+         *
+         * @return The number of machine cycles
+         */
+        [[nodiscard]] uint64_t getCycles() const
+        {
+            return m_cycles;
+        }
+
+        /**
+         * @brief Forget the accesses recorded
+         */
+        void clear()
+        {
+            m_accesses.clear();
+        }
+
+    private:
+        Bus &m_bus; ///< The bus that receives the accesses
+        std::vector<BusAccess> m_accesses; ///< The accesses recorded
+        uint64_t m_cycles = 0; ///< The number of machine cycles ticked
+        bool m_recording = true; ///< True if the accesses are recorded
+
+        /**
+         * @brief Record an access
+         */
+        void record(const uint16_t address, const uint8_t value, const BusAccessType type)
+        {
+            if (m_recording)
+                m_accesses.push_back({m_cycles, address, value, type});
+        }
+    };
+} // namespace gameboy
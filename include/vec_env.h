@@ -0,0 +1,130 @@
+/**
+ * @file vec_env.h
+ * @brief This file contains the declaration of the VecEnv class.
+ *        It steps many emulators in lock-step batches (vectorised environment for reinforcement learning).
+ */
+
+#pragma once
+
+#include "emulator.h" // Emulator
+#include "thread_pool.h" // ThreadPool
+
+#include <memory> // std::unique_ptr
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    /**
+     * @brief The content of the observations returned by a VecEnv
+     */
+    enum class ObservationType : uint8_t
+    {
+        FRAME = 0, ///< The greyscale frame, downsampled (one byte per pixel, 0 = black, 255 = white)
+        RAM = 1 ///< The bytes of memory at the selected addresses (one byte per address)
+    };
+
+    /**
+     * @brief The options of a VecEnv
+     */
+    struct VecEnvOptions
+    {
+        size_t environments = 1; ///< The number of emulators
+        size_t threads = 1; ///< The number of threads stepping the emulators (including the calling thread)
+        uint32_t frameSkip = 4; ///< The number of frames emulated by a step (with the same action, only the last one is rendered)
+        ObservationType observation = ObservationType::FRAME; ///< The content of the observations
+        uint32_t downsample = 2; ///< The factor by which the frame is downsampled on each axis (1, 2, 4, ...)
+        std::vector<uint16_t> ramAddresses; ///< The addresses read for ObservationType::RAM
+    };
+
+    /**
+     * @brief The VecEnv class steps many emulators in lock-step batches.
+     * @details Each step applies one action per emulator (a bitwise or of JoypadButton values), emulates frameSkip
+     *          frames on all the emulators in parallel, and writes the observations in a contiguous array provided
+     *          by the caller (environment i writes getObservationSize() bytes at offset i * getObservationSize()).
+     *          Nothing is allocated while stepping.
+     *
+     *          All the emulators start from the same state, saved once when the VecEnv is created, so a reset
+     *          only restores that state (no reload of the ROM, no boot).
+     */
+    class VecEnv
+    {
+    public:
+        /**
+         * @brief Create the emulators and save their initial state
+         *
+         * @param rom The content of the ROM
+         * @param options The options
+         * @return The VecEnv, nullptr if the ROM or the options are not valid
+         */
+        static std::unique_ptr<VecEnv> create(const std::vector<uint8_t> &rom, const VecEnvOptions &options);
+
+        /**
+         * @brief Restore the initial state of all the emulators
+         *
+         * @param observations The observations of all the emulators (getEnvironmentCount() * getObservationSize() bytes)
+         */
+        void reset(uint8_t *observations);
+
+        /**
+         * @brief Restore the initial state of one emulator (e.g. at the end of its episode)
+         *
+         * @param index The index of the emulator
+         * @param observation The observation of the emulator (getObservationSize() bytes)
+         */
+        void reset(size_t index, uint8_t *observation);
+
+        /**
+         * @brief Apply the actions and emulate frameSkip frames on all the emulators
+         *
+         * @param actions The action of each emulator (pressed buttons, see JoypadButton)
+         * @param observations The observations of all the emulators (getEnvironmentCount() * getObservationSize() bytes)
+         * @return False if an emulator encountered an error (unexpected opcode), true otherwise
+         */
+        bool step(const uint8_t *actions, uint8_t *observations);
+
+        /**
+         * @brief Get the number of emulators
+         *
+         * @return The number of emulators
+         */
+        [[nodiscard]] size_t getEnvironmentCount() const;
+
+        /**
+         * @brief Get the size of the observation of an emulator
+         *
+         * @return The size in bytes
+         */
+        [[nodiscard]] size_t getObservationSize() const;
+
+        /**
+         * @brief Get the emulator of an environment (e.g. to read the memory to compute a reward)
+         *
+         * @param index The index of the emulator
+         * @return The emulator
+         */
+        [[nodiscard]] const Emulator &getEmulator(size_t index) const;
+
+    private:
+        VecEnvOptions m_options; ///< The options
+        std::vector<std::unique_ptr<Emulator>> m_emulators; ///< The emulators
+        std::vector<uint8_t> m_initialState; ///< The state restored by reset
+        ThreadPool m_pool; ///< The threads stepping the emulators
+        uint32_t m_observationWidth; ///< The width of the downsampled frame
+        uint32_t m_observationHeight; ///< The height of the downsampled frame
+
+        /**
+         * @brief Construct a new VecEnv object (the emulators are created by create)
+         *
+         * @param options The options
+         */
+        explicit VecEnv(const VecEnvOptions &options);
+
+        /**
+         * @brief Write the observation of an emulator
+         *
+         * @param index The index of the emulator
+         * @param observation The observation (getObservationSize() bytes)
+         */
+        void observe(size_t index, uint8_t *observation) const;
+    };
+} // namespace gameboy
@@ -0,0 +1,541 @@
+/*
+ * See https://gbdev.io/pandocs/Audio.html
+ * See https://gbdev.gg8.se/wiki/articles/Gameboy_sound_hardware
+ */
+
+#include "apu.h" // APU
+#include "cpu.h" // CLOCK_FREQUENCY
+
+#include <algorithm> // std::min
+#include <initializer_list> // std::initializer_list
+#include <iterator> // std::size
+
+namespace gameboy
+{
+    namespace
+    {
+        constexpr uint8_t DUTY_CYCLES[4] = {0b00000001, 0b10000001, 0b10000111, 0b01111110}; ///< 12.5%, 25%, 50%, 75%
+
+        /// The bits that are always read as 1 (write-only or unused bits) for the registers 0xFF10-0xFF2F
+        constexpr uint8_t READ_MASKS[0x20] = {
+                0x80, 0x3F, 0x00, 0xFF, 0xBF, // NR10-NR14
+                0xFF, 0x3F, 0x00, 0xFF, 0xBF, // NR20-NR24
+                0x7F, 0xFF, 0x9F, 0xFF, 0xBF, // NR30-NR34
+                0xFF, 0xFF, 0x00, 0x00, 0xBF, // NR40-NR44
+                0x00, 0x00, 0x70, // NR50-NR52
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF // Unused
+        };
+
+        constexpr uint32_t squarePeriod(uint16_t frequency)
+        {
+            return (2048 - frequency) * 4;
+        }
+
+        constexpr uint32_t wavePeriod(uint16_t frequency)
+        {
+            return (2048 - frequency) * 2;
+        }
+    } // namespace
+
+    APU::APU(Memory &memory)
+        : m_memory(memory)
+    {
+        for (uint16_t address = apu_registers::FIRST_REGISTER_ADDRESS; address <= apu_registers::LAST_REGISTER_ADDRESS; address++)
+            reg(address) = memory[address];
+
+        m_powered = reg(apu_registers::NR52_ADDRESS) & 0x80;
+        m_channel1.dacEnabled = reg(0xFF12) & 0xF8;
+        m_channel2.dacEnabled = reg(0xFF17) & 0xF8;
+        m_channel3.dacEnabled = reg(0xFF1A) & 0x80;
+        m_channel4.dacEnabled = reg(0xFF21) & 0xF8;
+
+        m_memory.setAPU(this);
+    }
+
+    APU::~APU()
+    {
+        m_memory.setAPU(nullptr);
+    }
+
+    void APU::setOutput(RingBuffer<int16_t> *output, const uint32_t sampleRate)
+    {
+        flush();
+
+        m_output = output;
+        m_sampleRate = sampleRate;
+        m_left.reset();
+        m_right.reset();
+        m_amplitudes = {};
+        if (m_output)
+        {
+            // A batch can be a bit longer than BATCH_CYCLES (the last instruction)
+            m_left = std::make_unique<BlipBuffer>(cpu_cycles::CLOCK_FREQUENCY, sampleRate, BATCH_CYCLES * 2);
+            m_right = std::make_unique<BlipBuffer>(cpu_cycles::CLOCK_FREQUENCY, sampleRate, BATCH_CYCLES * 2);
+        }
+    }
+
+    void APU::setRateAdjustment(const double ratio)
+    {
+        if (!m_output)
+            return;
+
+        // The samples of the pending cycles use the previous sample rate
+        flush();
+        m_left->setSampleRate(m_sampleRate * ratio);
+        m_right->setSampleRate(m_sampleRate * ratio);
+    }
+
+    void APU::setMuted(const bool muted)
+    {
+        flush();
+        m_muted = muted;
+    }
+
+    void APU::cycle(const uint8_t cycles)
+    {
+        m_pendingCycles += cycles;
+        if (m_pendingCycles >= BATCH_CYCLES)
+            flush();
+    }
+
+    void APU::flush()
+    {
+        catchUp();
+        if (!m_output || m_muted)
+            return;
+
+        // Move the samples from the synthesizers to the output
+        int16_t samples[512];
+        size_t count;
+        do
+        {
+            count = m_left->readSamples(samples, std::size(samples) / 2, 2);
+            m_right->readSamples(samples + 1, count, 2);
+            m_output->push(samples, count * 2); // If the output is full, the samples are dropped
+        } while (count > 0);
+    }
+
+    void APU::catchUp()
+    {
+        bool output = m_output && !m_muted;
+        if (output)
+            updateAmplitudes(0); // The amplitudes may be out of date after unmuting the output or loading a state
+
+        uint32_t time = 0;
+        while (time < m_pendingCycles)
+        {
+            uint32_t next = std::min(m_pendingCycles, time + m_frameSequencerTimer);
+            runChannels(time, next);
+            m_frameSequencerTimer -= next - time;
+            time = next;
+
+            if (m_frameSequencerTimer == 0)
+            {
+                m_frameSequencerTimer = FRAME_SEQUENCER_CYCLES;
+                clockFrameSequencer();
+                if (output)
+                    updateAmplitudes(time);
+            }
+        }
+
+        if (output)
+        {
+            m_left->endFrame(m_pendingCycles);
+            m_right->endFrame(m_pendingCycles);
+        }
+        m_pendingCycles = 0;
+    }
+
+    void APU::runChannels(const uint32_t start, const uint32_t end)
+    {
+        bool output = m_output && !m_muted;
+
+        // Square channels
+        int index = 0;
+        for (SquareChannel *channel : {&m_channel1, &m_channel2})
+        {
+            if (channel->enabled)
+            {
+                uint32_t time = start + channel->timer;
+                for (; time <= end; time += squarePeriod(channel->frequency))
+                {
+                    channel->dutyStep = (channel->dutyStep + 1) & 0x07;
+                    if (output)
+                        updateAmplitude(index, time);
+                }
+                channel->timer = time - end;
+            }
+            index++;
+        }
+
+        // Wave channel
+        if (m_channel3.enabled)
+        {
+            uint32_t time = start + m_channel3.timer;
+            for (; time <= end; time += wavePeriod(m_channel3.frequency))
+            {
+                m_channel3.position = (m_channel3.position + 1) & 0x1F;
+                uint8_t waveByte = reg(apu_registers::WAVE_RAM_ADDRESS + m_channel3.position / 2);
+                m_channel3.sample = m_channel3.position & 1 ? waveByte & 0x0F : waveByte >> 4;
+                if (output)
+                    updateAmplitude(2, time);
+            }
+            m_channel3.timer = time - end;
+        }
+
+        // Noise channel (no clock with a shift of 14 or 15)
+        uint8_t nr43 = reg(0xFF22);
+        if (m_channel4.enabled && (nr43 >> 4) < 14)
+        {
+            uint8_t divisorCode = nr43 & 0x07;
+            uint32_t period = (divisorCode == 0 ? 8 : divisorCode * 16) << (nr43 >> 4);
+            uint32_t time = start + m_channel4.timer;
+            for (; time <= end; time += period)
+            {
+                uint16_t bit = (m_channel4.lfsr ^ (m_channel4.lfsr >> 1)) & 0x01;
+                m_channel4.lfsr = (m_channel4.lfsr >> 1) | (bit << 14);
+                if (nr43 & 0x08) // 7 bit mode
+                    m_channel4.lfsr = (m_channel4.lfsr & ~0x40) | (bit << 6);
+                if (output)
+                    updateAmplitude(3, time);
+            }
+            m_channel4.timer = time - end;
+        }
+    }
+
+    void APU::clockFrameSequencer()
+    {
+        // Length counters (steps 0, 2, 4 and 6)
+        if ((m_frameSequencerStep & 1) == 0)
+        {
+            auto clockLength = [](auto &channel) {
+                if (channel.lengthEnabled && channel.length > 0 && --channel.length == 0)
+                    channel.enabled = false;
+            };
+            clockLength(m_channel1);
+            clockLength(m_channel2);
+            clockLength(m_channel3);
+            clockLength(m_channel4);
+        }
+
+        // Frequency sweep (steps 2 and 6)
+        if (m_frameSequencerStep == 2 || m_frameSequencerStep == 6)
+        {
+            if (m_channel1.sweepTimer > 0 && --m_channel1.sweepTimer == 0)
+            {
+                m_channel1.sweepTimer = m_channel1.sweepPeriod ? m_channel1.sweepPeriod : 8;
+                if (m_channel1.sweepEnabled && m_channel1.sweepPeriod)
+                {
+                    uint16_t frequency = computeSweepFrequency();
+                    if (frequency <= 2047 && m_channel1.sweepShift)
+                    {
+                        m_channel1.shadowFrequency = frequency;
+                        m_channel1.frequency = frequency;
+                        reg(0xFF13) = frequency & 0xFF;
+                        reg(0xFF14) = (reg(0xFF14) & 0xF8) | (frequency >> 8);
+                        computeSweepFrequency(); // Overflow check with the new frequency
+                    }
+                }
+            }
+        }
+
+        // Volume envelopes (step 7)
+        if (m_frameSequencerStep == 7)
+        {
+            clockEnvelope(m_channel1.envelope);
+            clockEnvelope(m_channel2.envelope);
+            clockEnvelope(m_channel4.envelope);
+        }
+
+        m_frameSequencerStep = (m_frameSequencerStep + 1) & 0x07;
+    }
+
+    uint8_t APU::getChannelOutput(const int channel) const
+    {
+        switch (channel)
+        {
+            case 0:
+                return m_channel1.enabled && (DUTY_CYCLES[m_channel1.duty] >> m_channel1.dutyStep) & 1 ? m_channel1.envelope.volume : 0;
+            case 1:
+                return m_channel2.enabled && (DUTY_CYCLES[m_channel2.duty] >> m_channel2.dutyStep) & 1 ? m_channel2.envelope.volume : 0;
+            case 2:
+                return m_channel3.enabled ? m_channel3.sample >> m_channel3.volumeShift : 0;
+            default:
+                return m_channel4.enabled && !(m_channel4.lfsr & 1) ? m_channel4.envelope.volume : 0;
+        }
+    }
+
+    void APU::updateAmplitude(const int channel, const uint32_t time)
+    {
+        // NR50: bits 4-6 left volume, bits 0-2 right volume
+        // NR51: bits 4-7 channels sent to the left output, bits 0-3 channels sent to the right output
+        uint8_t nr50 = reg(0xFF24);
+        uint8_t nr51 = reg(0xFF25);
+        int32_t output = getChannelOutput(channel) * AMPLITUDE_SCALE;
+
+        int32_t left = nr51 & (0x10 << channel) ? output * (((nr50 >> 4) & 0x07) + 1) : 0;
+        if (left != m_amplitudes[channel][0])
+        {
+            m_left->addDelta(time, left - m_amplitudes[channel][0]);
+            m_amplitudes[channel][0] = left;
+        }
+
+        int32_t right = nr51 & (0x01 << channel) ? output * ((nr50 & 0x07) + 1) : 0;
+        if (right != m_amplitudes[channel][1])
+        {
+            m_right->addDelta(time, right - m_amplitudes[channel][1]);
+            m_amplitudes[channel][1] = right;
+        }
+    }
+
+    void APU::updateAmplitudes(const uint32_t time)
+    {
+        for (int channel = 0; channel < 4; channel++)
+            updateAmplitude(channel, time);
+    }
+
+    uint16_t APU::computeSweepFrequency()
+    {
+        uint16_t delta = m_channel1.shadowFrequency >> m_channel1.sweepShift;
+        uint16_t frequency = m_channel1.sweepDecrease ? m_channel1.shadowFrequency - delta : m_channel1.shadowFrequency + delta;
+        if (frequency > 2047)
+            m_channel1.enabled = false;
+        return frequency;
+    }
+
+    void APU::trigger(const int channel)
+    {
+        switch (channel)
+        {
+            case 0:
+            case 1:
+            {
+                SquareChannel &square = channel == 0 ? m_channel1 : m_channel2;
+                square.enabled = square.dacEnabled;
+                if (square.length == 0)
+                    square.length = 64;
+                square.timer = squarePeriod(square.frequency);
+                loadEnvelope(square.envelope, reg(channel == 0 ? 0xFF12 : 0xFF17));
+
+                if (channel == 0)
+                {
+                    m_channel1.shadowFrequency = m_channel1.frequency;
+                    m_channel1.sweepTimer = m_channel1.sweepPeriod ? m_channel1.sweepPeriod : 8;
+                    m_channel1.sweepEnabled = m_channel1.sweepPeriod || m_channel1.sweepShift;
+                    if (m_channel1.sweepShift)
+                        computeSweepFrequency();
+                }
+                break;
+            }
+            case 2:
+                m_channel3.enabled = m_channel3.dacEnabled;
+                if (m_channel3.length == 0)
+                    m_channel3.length = 256;
+                m_channel3.timer = wavePeriod(m_channel3.frequency);
+                m_channel3.position = 0;
+                break;
+            default:
+                m_channel4.enabled = m_channel4.dacEnabled;
+                if (m_channel4.length == 0)
+                    m_channel4.length = 64;
+                m_channel4.timer = 0;
+                m_channel4.lfsr = 0x7FFF;
+                loadEnvelope(m_channel4.envelope, reg(0xFF21));
+                break;
+        }
+    }
+
+    void APU::clockEnvelope(Envelope &envelope)
+    {
+        if (envelope.period == 0 || --envelope.timer > 0)
+            return;
+
+        envelope.timer = envelope.period;
+        if (envelope.increase && envelope.volume < 15)
+            envelope.volume++;
+        else if (!envelope.increase && envelope.volume > 0)
+            envelope.volume--;
+    }
+
+    void APU::loadEnvelope(Envelope &envelope, const uint8_t value)
+    {
+        envelope.volume = value >> 4;
+        envelope.increase = value & 0x08;
+        envelope.period = value & 0x07;
+        envelope.timer = envelope.period;
+    }
+
+    uint8_t APU::readRegister(const uint16_t address)
+    {
+        if (address >= apu_registers::WAVE_RAM_ADDRESS)
+            return reg(address);
+
+        if (address == apu_registers::NR52_ADDRESS)
+        {
+            flush(); // The length counters may have disabled a channel
+            return (m_powered ? 0x80 : 0x00) | READ_MASKS[address - apu_registers::FIRST_REGISTER_ADDRESS] |
+                   (m_channel1.enabled ? 0x01 : 0x00) | (m_channel2.enabled ? 0x02 : 0x00) |
+                   (m_channel3.enabled ? 0x04 : 0x00) | (m_channel4.enabled ? 0x08 : 0x00);
+        }
+
+        return reg(address) | READ_MASKS[address - apu_registers::FIRST_REGISTER_ADDRESS];
+    }
+
+    void APU::writeRegister(const uint16_t address, const uint8_t value)
+    {
+        // Emulate the cycles before the write, so that the new value is applied at the current time
+        flush();
+
+        if (address >= apu_registers::WAVE_RAM_ADDRESS)
+        {
+            reg(address) = value;
+            return;
+        }
+
+        if (address == apu_registers::NR52_ADDRESS)
+        {
+            bool powered = value & 0x80;
+            if (m_powered && !powered)
+            {
+                // Turning the APU off clears all its registers (except the wave RAM)
+                for (uint16_t i = apu_registers::FIRST_REGISTER_ADDRESS; i < apu_registers::NR52_ADDRESS; i++)
+                    reg(i) = 0;
+                m_channel1 = {};
+                m_channel2 = {};
+                m_channel3 = {};
+                m_channel4 = {};
+            }
+            else if (!m_powered && powered)
+                m_frameSequencerStep = 0;
+            m_powered = powered;
+        }
+        else if (!m_powered)
+            return; // The registers are read-only while the APU is off
+        else
+        {
+            reg(address) = value;
+
+            switch (address)
+            {
+                // Channel 1
+                case 0xFF10:
+                    m_channel1.sweepPeriod = (value >> 4) & 0x07;
+                    m_channel1.sweepDecrease = value & 0x08;
+                    m_channel1.sweepShift = value & 0x07;
+                    break;
+                case 0xFF11:
+                    m_channel1.duty = value >> 6;
+                    m_channel1.length = 64 - (value & 0x3F);
+                    break;
+                case 0xFF12:
+                    m_channel1.dacEnabled = value & 0xF8;
+                    m_channel1.enabled &= m_channel1.dacEnabled;
+                    break;
+                case 0xFF13:
+                    m_channel1.frequency = (m_channel1.frequency & 0x700) | value;
+                    break;
+                case 0xFF14:
+                    m_channel1.frequency = (m_channel1.frequency & 0xFF) | ((value & 0x07) << 8);
+                    m_channel1.lengthEnabled = value & 0x40;
+                    if (value & 0x80)
+                        trigger(0);
+                    break;
+
+                // Channel 2
+                case 0xFF16:
+                    m_channel2.duty = value >> 6;
+                    m_channel2.length = 64 - (value & 0x3F);
+                    break;
+                case 0xFF17:
+                    m_channel2.dacEnabled = value & 0xF8;
+                    m_channel2.enabled &= m_channel2.dacEnabled;
+                    break;
+                case 0xFF18:
+                    m_channel2.frequency = (m_channel2.frequency & 0x700) | value;
+                    break;
+                case 0xFF19:
+                    m_channel2.frequency = (m_channel2.frequency & 0xFF) | ((value & 0x07) << 8);
+                    m_channel2.lengthEnabled = value & 0x40;
+                    if (value & 0x80)
+                        trigger(1);
+                    break;
+
+                // Channel 3
+                case 0xFF1A:
+                    m_channel3.dacEnabled = value & 0x80;
+                    m_channel3.enabled &= m_channel3.dacEnabled;
+                    break;
+                case 0xFF1B:
+                    m_channel3.length = 256 - value;
+                    break;
+                case 0xFF1C:
+                {
+                    // 0: mute, 1: 100%, 2: 50%, 3: 25%
+                    uint8_t volumeCode = (value >> 5) & 0x03;
+                    m_channel3.volumeShift = volumeCode == 0 ? 4 : volumeCode - 1;
+                    break;
+                }
+                case 0xFF1D:
+                    m_channel3.frequency = (m_channel3.frequency & 0x700) | value;
+                    break;
+                case 0xFF1E:
+                    m_channel3.frequency = (m_channel3.frequency & 0xFF) | ((value & 0x07) << 8);
+                    m_channel3.lengthEnabled = value & 0x40;
+                    if (value & 0x80)
+                        trigger(2);
+                    break;
+
+                // Channel 4
+                case 0xFF20:
+                    m_channel4.length = 64 - (value & 0x3F);
+                    break;
+                case 0xFF21:
+                    m_channel4.dacEnabled = value & 0xF8;
+                    m_channel4.enabled &= m_channel4.dacEnabled;
+                    break;
+                case 0xFF23:
+                    m_channel4.lengthEnabled = value & 0x40;
+                    if (value & 0x80)
+                        trigger(3);
+                    break;
+
+                default: // NR43, NR50 and NR51 are read when needed
+                    break;
+            }
+        }
+
+        if (m_output && !m_muted)
+            updateAmplitudes(0);
+    }
+
+    void APU::saveState(StateWriter &writer) const
+    {
+        writer.write(m_registers);
+        writer.write(m_powered);
+        writer.write(m_channel1);
+        writer.write(m_channel2);
+        writer.write(m_channel3);
+        writer.write(m_channel4);
+        writer.write(m_frameSequencerTimer);
+        writer.write(m_frameSequencerStep);
+        writer.write(m_pendingCycles);
+    }
+
+    void APU::loadState(StateReader &reader)
+    {
+        reader.read(m_registers);
+        reader.read(m_powered);
+        reader.read(m_channel1);
+        reader.read(m_channel2);
+        reader.read(m_channel3);
+        reader.read(m_channel4);
+        reader.read(m_frameSequencerTimer);
+        reader.read(m_frameSequencerStep);
+        reader.read(m_pendingCycles);
+    }
+
+    uint8_t &APU::reg(const uint16_t address)
+    {
+        return m_registers[address - apu_registers::FIRST_REGISTER_ADDRESS];
+    }
+} // namespace gameboy
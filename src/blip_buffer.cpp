@@ -0,0 +1,106 @@
+#include "blip_buffer.h" // BlipBuffer
+
+#include <algorithm> // std::clamp, std::fill, std::min, std::move
+#include <cmath> // std::cos, std::ldexp, std::sin, std::lround
+
+namespace gameboy
+{
+    const std::array<std::array<int32_t, BlipBuffer::KERNEL_WIDTH>, BlipBuffer::PHASE_COUNT> BlipBuffer::KERNEL = BlipBuffer::createKernel();
+
+    BlipBuffer::BlipBuffer(const uint32_t clockRate, const uint32_t sampleRate, const uint32_t maxFrameCycles)
+        : m_clockRate(clockRate),
+          m_factor((static_cast<uint64_t>(sampleRate) << TIME_BITS) / clockRate)
+    {
+        // The samples of a frame (with 1% more for the adjustments of the sample rate),
+        // the fractional sample of the previous frame and the tail of the last step
+        size_t maxFrameSamples = static_cast<size_t>(maxFrameCycles) * sampleRate / clockRate * 101 / 100 + 2;
+        m_samples.resize(maxFrameSamples + KERNEL_WIDTH);
+    }
+
+    void BlipBuffer::setSampleRate(const double sampleRate)
+    {
+        m_factor = static_cast<uint64_t>(std::ldexp(sampleRate, TIME_BITS) / m_clockRate);
+    }
+
+    void BlipBuffer::addDelta(const uint32_t time, const int32_t delta)
+    {
+        uint64_t position = m_offset + time * m_factor;
+        size_t index = position >> TIME_BITS;
+        if (index + KERNEL_WIDTH > m_samples.size())
+            return; // The frame is longer than expected, the delta cannot be added
+
+        const auto &kernel = KERNEL[(position >> (TIME_BITS - PHASE_BITS)) & (PHASE_COUNT - 1)];
+        for (int i = 0; i < KERNEL_WIDTH; i++)
+            m_samples[index + i] += delta * kernel[i];
+    }
+
+    void BlipBuffer::endFrame(const uint32_t duration)
+    {
+        m_offset += duration * m_factor;
+        // The deltas of the next frames cannot modify the samples before the current position
+        m_available = std::min<size_t>(m_offset >> TIME_BITS, m_samples.size() - KERNEL_WIDTH);
+    }
+
+    size_t BlipBuffer::samplesAvailable() const
+    {
+        return m_available;
+    }
+
+    size_t BlipBuffer::readSamples(int16_t *out, size_t count, const size_t stride)
+    {
+        count = std::min(count, m_available);
+        for (size_t i = 0; i < count; i++)
+        {
+            m_integrator += m_samples[i];
+            int64_t sample = m_integrator >> KERNEL_BITS;
+            out[i * stride] = static_cast<int16_t>(std::clamp<int64_t>(sample, INT16_MIN, INT16_MAX));
+            m_integrator -= m_integrator >> HIGH_PASS_SHIFT;
+        }
+
+        // Remove the samples that have been read
+        size_t used = m_available + KERNEL_WIDTH;
+        std::move(m_samples.begin() + count, m_samples.begin() + used, m_samples.begin());
+        std::fill(m_samples.begin() + used - count, m_samples.begin() + used, 0);
+        m_available -= count;
+        m_offset -= static_cast<uint64_t>(count) << TIME_BITS;
+
+        return count;
+    }
+
+    std::array<std::array<int32_t, BlipBuffer::KERNEL_WIDTH>, BlipBuffer::PHASE_COUNT> BlipBuffer::createKernel()
+    {
+        constexpr double pi = 3.14159265358979323846;
+        constexpr double cutoff = 0.9; // Relative to the Nyquist frequency, to attenuate the frequencies near it
+        constexpr double halfWidth = KERNEL_WIDTH / 2.0;
+
+        std::array<std::array<int32_t, KERNEL_WIDTH>, PHASE_COUNT> kernel{};
+        for (int phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            // The impulse is centered between the taps KERNEL_WIDTH / 2 - 1 and KERNEL_WIDTH / 2
+            std::array<double, KERNEL_WIDTH> taps{};
+            double sum = 0;
+            for (int i = 0; i < KERNEL_WIDTH; i++)
+            {
+                double x = i - (halfWidth - 1) - static_cast<double>(phase) / PHASE_COUNT;
+                double sinc = x == 0 ? 1 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+                double window = 0.42 + 0.5 * std::cos(pi * x / halfWidth) + 0.08 * std::cos(2 * pi * x / halfWidth);
+                taps[i] = sinc * window;
+                sum += taps[i];
+            }
+
+            // Normalize the taps, so that a step has exactly the amplitude of the delta
+            int32_t total = 0;
+            int largest = 0;
+            for (int i = 0; i < KERNEL_WIDTH; i++)
+            {
+                kernel[phase][i] = static_cast<int32_t>(std::lround(taps[i] / sum * (1 << KERNEL_BITS)));
+                total += kernel[phase][i];
+                if (kernel[phase][i] > kernel[phase][largest])
+                    largest = i;
+            }
+            kernel[phase][largest] += (1 << KERNEL_BITS) - total;
+        }
+
+        return kernel;
+    }
+} // namespace gameboy
@@ -4,7 +4,9 @@
  */
 
 #include "cartridge.h" // Cartridge
+#include "hash.h" // hash64
 
+#include <cctype> // std::isxdigit, std::isdigit, std::toupper
 #include <fstream> // std::ifstream
 #include <iostream> // std::cout, std::endl
 #include <iterator> // std::istreambuf_iterator
@@ -14,9 +16,6 @@ namespace gameboy
 {
     bool Cartridge::loadROM(const std::string &filename)
     {
-        // Save the filename without the extension
-        m_ROMFilename = filename.substr(0, filename.find_last_of('.'));
-
         // Open the file
         std::ifstream romFile(filename, std::ios::binary);
         if (!romFile.is_open())
@@ -25,24 +24,47 @@ namespace gameboy
             return false;
         }
 
-        // Initialize ROM
-        m_rom = std::vector<uint8_t>(std::istreambuf_iterator<char>(romFile), {});
+        // Read the ROM
+        std::vector<uint8_t> rom(std::istreambuf_iterator<char>(romFile), {});
         romFile.close();
 
         // Check if there is a save file to initialize the RAM
         // If there is no save file, the RAM will be initialized to 0
-        std::ifstream ramFile(m_ROMFilename + ".sav", std::ios::binary);
-        if (!ramFile.is_open())
-            m_ram = std::vector<uint8_t>(getRAMSize().first, 0x00);
-        else
-            m_ram = std::vector<uint8_t>(std::istreambuf_iterator<char>(ramFile), {});
+        std::string romFilename = filename.substr(0, filename.find_last_of('.'));
+        std::vector<uint8_t> ram;
+        std::ifstream ramFile(romFilename + ".sav", std::ios::binary);
+        if (ramFile.is_open())
+            ram = std::vector<uint8_t>(std::istreambuf_iterator<char>(ramFile), {});
         ramFile.close();
 
-        checkCartridge();
+        if (!loadROMData(std::move(rom), std::move(ram)))
+            return false;
+
+        // Save the filename without the extension
+        m_ROMFilename = romFilename;
         printCartridgeInfo();
         return true;
     }
 
+    bool Cartridge::loadROMData(std::vector<uint8_t> rom, std::vector<uint8_t> ram)
+    {
+        m_ROMFilename.clear();
+        m_MBC.reset();
+
+        if (rom.size() <= cartridge_info::CARTRIDGE_HEADER_END_ADDRESS)
+        {
+            std::cout << "\x1B[31mError!\033[0m The ROM is too small to contain the cartridge header" << std::endl;
+            return false;
+        }
+
+        m_ROMHash = hash64(rom.data(), rom.size());
+        m_rom = std::move(rom);
+        m_ram = ram.empty() ? std::vector<uint8_t>(getRAMSize().first, 0x00) : std::move(ram);
+
+        checkCartridge();
+        return m_MBC != nullptr;
+    }
+
     void Cartridge::checkCartridge()
     {
         // Get the information from the header
@@ -102,21 +124,48 @@ namespace gameboy
         }
     }
 
+    uint64_t Cartridge::getROMHash() const
+    {
+        return m_ROMHash;
+    }
+
     uint8_t Cartridge::read(uint16_t address) const
     {
+        // No cartridge (or an unsupported one): nothing drives the bus
+        if (!m_MBC)
+            return 0xFF;
         return m_MBC->read(address);
     }
 
     void Cartridge::write(uint16_t address, uint8_t value)
     {
-        m_MBC->write(address, value);
+        if (m_MBC)
+            m_MBC->write(address, value);
     }
 
     void Cartridge::saveRAMData() const
     {
+        if (m_ROMFilename.empty() || !m_MBC)
+            return;
         m_MBC->saveRAMData(m_ROMFilename + ".sav");
     }
 
+    void Cartridge::saveState(StateWriter &writer) const
+    {
+        if (m_MBC)
+            m_MBC->saveState(writer);
+    }
+
+    void Cartridge::loadState(StateReader &reader)
+    {
+        if (!m_MBC)
+        {
+            reader.invalidate();
+            return;
+        }
+        m_MBC->loadState(reader);
+    }
+
     void Cartridge::printCartridgeInfo()
     {
         std::cout << "--------------- Cartridge info ----------------\n";
@@ -294,12 +343,19 @@ namespace gameboy
 
     std::string Cartridge::getNewLicensee() const
     {
-        // Read addresses 0x0144 and 0x0145 as ascii
-        std::string newLicenseeCode;
-        newLicenseeCode += static_cast<char>(m_rom[cartridge_info::CARTRIDGE_NEW_LICENSEE_CODE_ADDRESS]);
-        newLicenseeCode += static_cast<char>(m_rom[cartridge_info::CARTRIDGE_NEW_LICENSEE_CODE_ADDRESS + 1]);
+        // Read addresses 0x0144 and 0x0145 as ascii: two hexadecimal digits (e.g. "A4" is 0xA4)
+        int newLicenseeCode = 0;
+        for (uint16_t address = cartridge_info::CARTRIDGE_NEW_LICENSEE_CODE_ADDRESS;
+             address <= cartridge_info::CARTRIDGE_NEW_LICENSEE_CODE_ADDRESS + 1; address++)
+        {
+            // Any byte can be found in a malformed header
+            char digit = static_cast<char>(m_rom[address]);
+            if (!std::isxdigit(static_cast<unsigned char>(digit)))
+                return "Unknown";
+            newLicenseeCode = newLicenseeCode * 16 + (std::isdigit(static_cast<unsigned char>(digit)) ? digit - '0' : std::toupper(digit) - 'A' + 10);
+        }
 
-        switch (std::stoi(newLicenseeCode))
+        switch (newLicenseeCode)
         {
             case 0x00: return "None";
             case 0x01: return "Nintendo R&D1";
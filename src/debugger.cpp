@@ -0,0 +1,103 @@
+#include "debugger.h" // Debugger
+
+#include <algorithm> // std::find_if, std::max
+
+namespace gameboy
+{
+    void Debugger::addBreakpoint(const uint16_t address)
+    {
+        m_breakpoints.set(address);
+    }
+
+    bool Debugger::removeBreakpoint(const uint16_t address)
+    {
+        bool found = m_breakpoints.test(address);
+        m_breakpoints.reset(address);
+        return found;
+    }
+
+    bool Debugger::hasBreakpoint(const uint16_t address) const
+    {
+        return m_breakpoints.test(address);
+    }
+
+    void Debugger::addWatchpoint(const uint16_t address, const uint16_t length, const WatchType type)
+    {
+        m_watchpoints.push_back({address, std::max<uint16_t>(length, 1), type});
+        updatePages();
+    }
+
+    bool Debugger::removeWatchpoint(const uint16_t address, const uint16_t length, const WatchType type)
+    {
+        auto it = std::find_if(m_watchpoints.begin(), m_watchpoints.end(), [&](const Watchpoint &watchpoint) {
+            return watchpoint.address == address && watchpoint.length == std::max<uint16_t>(length, 1) &&
+                   watchpoint.type == type;
+        });
+        if (it == m_watchpoints.end())
+            return false;
+
+        m_watchpoints.erase(it);
+        updatePages();
+        return true;
+    }
+
+    void Debugger::resume(const bool singleStep)
+    {
+        m_running = true;
+        m_singleStep = singleStep;
+        m_firstStep = true;
+        m_stopReason = StopReason::NONE;
+    }
+
+    void Debugger::stop(const StopReason reason)
+    {
+        m_running = false;
+        m_stopReason = reason;
+    }
+
+    bool Debugger::isRunning() const
+    {
+        return m_running;
+    }
+
+    StopReason Debugger::getStopReason() const
+    {
+        return m_stopReason;
+    }
+
+    WatchHit Debugger::getWatchHit() const
+    {
+        return m_watchHit;
+    }
+
+    void Debugger::onAccess(const uint16_t address, const WatchType access)
+    {
+        // Only the first hit of an instruction is reported
+        if (!m_running)
+            return;
+
+        for (const Watchpoint &watchpoint : m_watchpoints)
+        {
+            // The ranges can wrap around the end of the address space
+            if ((static_cast<uint8_t>(watchpoint.type) & static_cast<uint8_t>(access)) && static_cast<uint16_t>(address - watchpoint.address) < watchpoint.length)
+            {
+                m_watchHit = {address, watchpoint.type};
+                stop(StopReason::WATCHPOINT);
+                return;
+            }
+        }
+    }
+
+    void Debugger::updatePages()
+    {
+        m_pages.fill(0);
+        for (const Watchpoint &watchpoint : m_watchpoints)
+        {
+            for (uint32_t offset = 0; offset < watchpoint.length; offset += 0x100)
+                m_pages[static_cast<uint16_t>(watchpoint.address + offset) >> 8] |= static_cast<uint8_t>(watchpoint.type);
+
+            // The last byte can be on the next page
+            m_pages[static_cast<uint16_t>(watchpoint.address + watchpoint.length - 1) >> 8] |= static_cast<uint8_t>(watchpoint.type);
+        }
+    }
+} // namespace gameboy
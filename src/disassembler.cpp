@@ -0,0 +1,471 @@
+#include "disassembler.h" // SymbolTable, Instruction, Disassembler
+#include "opcodes.h" // cpu_opcodes::OPCODE_MNEMONICS, cpu_opcodes::OPCODE_CB_MNEMONICS, cpu_cycles::OPCODE_CYCLES
+#include "trace.h" // TraceReader, TraceRecord
+
+#include <algorithm> // std::max, std::min, std::stable_sort
+#include <cstdlib> // std::strtoul
+#include <fstream> // std::ifstream
+#include <iomanip> // std::hex, std::dec, std::uppercase, std::setw, std::setfill, std::fixed, std::setprecision
+#include <iostream> // std::cout, std::endl
+#include <iterator> // std::istreambuf_iterator
+#include <sstream> // std::ostringstream, std::istringstream
+#include <utility> // std::move
+
+namespace gameboy
+{
+    namespace
+    {
+        /**
+         * @brief Format a value in hexadecimal, RGBDS style (e.g. "$0150")
+         *
+         * @param value The value
+         * @param digits The number of digits
+         * @return The value formatted
+         */
+        std::string formatHex(const uint32_t value, const int digits)
+        {
+            std::ostringstream stream;
+            stream << "$" << std::hex << std::uppercase << std::setfill('0') << std::setw(digits) << value;
+            return stream.str();
+        }
+
+        /**
+         * @brief Check whether an opcode is a relative jump (its operand is a signed offset)
+         */
+        bool isRelativeJump(const uint8_t opcode)
+        {
+            return opcode == 0x18 || opcode == 0x20 || opcode == 0x28 || opcode == 0x30 || opcode == 0x38;
+        }
+
+        /**
+         * @brief Get the target of a CALL or RST instruction
+         *
+         * @param instruction The instruction
+         * @param target The address called
+         * @return True if the instruction is a CALL or a RST, false otherwise
+         */
+        bool getCallTarget(const Instruction &instruction, uint16_t &target)
+        {
+            uint8_t opcode = instruction.bytes[0];
+            if (opcode == 0xC4 || opcode == 0xCC || opcode == 0xCD || opcode == 0xD4 || opcode == 0xDC)
+            {
+                target = static_cast<uint16_t>(instruction.bytes[1] | instruction.bytes[2] << 8);
+                return true;
+            }
+            if ((opcode & 0xC7) == 0xC7) // RST
+            {
+                target = opcode & 0x38;
+                return true;
+            }
+            return false;
+        }
+    } // namespace
+
+    size_t SymbolTable::load(std::istream &stream)
+    {
+        size_t skipped = 0;
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            line = line.substr(0, line.find(';'));
+            std::istringstream fields(line);
+            std::string location;
+            std::string name;
+            if (!(fields >> location))
+                continue; // Empty line or comment
+
+            size_t colon = location.find(':');
+            if (colon == std::string::npos || colon == 0 || colon + 1 == location.size() || !(fields >> name))
+            {
+                skipped++;
+                continue;
+            }
+
+            // Both fields are hexadecimal numbers of at most 4 digits
+            std::string bankField = location.substr(0, colon);
+            std::string addressField = location.substr(colon + 1);
+            char *bankEnd = nullptr;
+            char *addressEnd = nullptr;
+            unsigned long bank = std::strtoul(bankField.c_str(), &bankEnd, 16);
+            unsigned long address = std::strtoul(addressField.c_str(), &addressEnd, 16);
+            if (*bankEnd != '\0' || *addressEnd != '\0' || bankField.size() > 4 || addressField.size() > 4)
+            {
+                skipped++;
+                continue;
+            }
+            add(static_cast<uint16_t>(bank), static_cast<uint16_t>(address), name);
+        }
+        return skipped;
+    }
+
+    void SymbolTable::add(const uint16_t bank, const uint16_t address, const std::string &name)
+    {
+        uint32_t key = makeKey(bank, address);
+        if (!m_symbols.emplace(key, name).second)
+            return;
+        m_byAddress.emplace(address, key);
+    }
+
+    const std::string *SymbolTable::find(const uint16_t bank, const uint16_t address) const
+    {
+        if (address >= rom_banks::SWITCHABLE_BANK_START && address < rom_banks::ROM_END)
+        {
+            auto symbol = m_symbols.find(makeKey(bank, address));
+            return symbol != m_symbols.end() ? &symbol->second : nullptr;
+        }
+
+        auto key = m_byAddress.find(address);
+        return key != m_byAddress.end() ? &m_symbols.at(key->second) : nullptr;
+    }
+
+    const std::string *SymbolTable::findContaining(const uint16_t bank, const uint16_t address, uint16_t &symbolAddress) const
+    {
+        // The first address of the area of the ROM that contains the address
+        uint16_t start = address < rom_banks::SWITCHABLE_BANK_START ? 0 : rom_banks::SWITCHABLE_BANK_START;
+
+        auto symbol = m_symbols.upper_bound(makeKey(bank, address));
+        if (symbol == m_symbols.begin())
+            return nullptr;
+        --symbol;
+        if (symbol->first < makeKey(bank, start))
+            return nullptr;
+
+        symbolAddress = static_cast<uint16_t>(symbol->first & 0xFFFF);
+        return &symbol->second;
+    }
+
+    Disassembler::Disassembler(std::vector<uint8_t> rom, const SymbolTable *symbols)
+        : m_rom(std::move(rom)),
+          m_symbols(symbols)
+    {
+        m_cache.resize(getBankCount());
+        m_hits.resize(static_cast<size_t>(getBankCount()) * rom_banks::BANK_SIZE);
+    }
+
+    uint16_t Disassembler::getBankCount() const
+    {
+        size_t banks = (m_rom.size() + rom_banks::BANK_SIZE - 1) / rom_banks::BANK_SIZE;
+        return static_cast<uint16_t>(std::max<size_t>(banks, 2));
+    }
+
+    size_t Disassembler::getOffset(uint16_t bank, const uint16_t address) const
+    {
+        if (address < rom_banks::SWITCHABLE_BANK_START)
+            return address;
+
+        // Bank 0 cannot be selected in the switchable area, and the bank numbers wrap around like in the MBCs
+        bank = bank % getBankCount();
+        if (bank == 0)
+            bank = 1;
+        return static_cast<size_t>(bank) * rom_banks::BANK_SIZE + (address - rom_banks::SWITCHABLE_BANK_START);
+    }
+
+    uint8_t Disassembler::readROM(const size_t offset) const
+    {
+        return offset < m_rom.size() ? m_rom[offset] : 0xFF;
+    }
+
+    const Instruction &Disassembler::decode(const uint16_t bank, const uint16_t address)
+    {
+        size_t offset = getOffset(bank, address % rom_banks::ROM_END);
+        std::vector<Instruction> &lines = m_cache[offset / rom_banks::BANK_SIZE];
+        if (lines.empty())
+            lines.resize(rom_banks::BANK_SIZE);
+
+        Instruction &instruction = lines[offset % rom_banks::BANK_SIZE];
+        if (instruction.length != 0)
+            return instruction;
+
+        instruction.bank = static_cast<uint16_t>(offset / rom_banks::BANK_SIZE);
+        instruction.address = static_cast<uint16_t>(address % rom_banks::ROM_END);
+        instruction.length = cpu_opcodes::getOpcodeLength(readROM(offset));
+        for (size_t i = 0; i < instruction.length; i++)
+            instruction.bytes[i] = readROM(offset + i);
+        instruction.text = format(instruction);
+        return instruction;
+    }
+
+    std::string Disassembler::formatAddress(const uint16_t bank, const uint16_t address) const
+    {
+        // A jump from the bank 0 to the switchable bank most likely targets the bank 1
+        const std::string *name = m_symbols ? m_symbols->find(std::max<uint16_t>(bank, 1), address) : nullptr;
+        return name ? *name : formatHex(address, 4);
+    }
+
+    std::string Disassembler::format(const Instruction &instruction) const
+    {
+        uint8_t opcode = instruction.bytes[0];
+        if (opcode == cpu_opcodes::CB_PREFIX)
+            return cpu_opcodes::OPCODE_CB_MNEMONICS[instruction.bytes[1]];
+        if (!cpu_opcodes::OPCODE_MNEMONICS[opcode])
+            return "DB " + formatHex(opcode, 2);
+
+        std::string text = cpu_opcodes::OPCODE_MNEMONICS[opcode];
+        if (instruction.length == 1)
+            return text;
+
+        // The operand is the last "n" or "nn" of the mnemonic (the registers are uppercase)
+        size_t operand = text.find_last_of('n');
+        if (instruction.length == 3)
+            operand--;
+        uint8_t byte = instruction.bytes[1];
+        uint16_t word = static_cast<uint16_t>(byte | instruction.bytes[2] << 8);
+        std::string value;
+
+        if (instruction.length == 3)
+            value = formatAddress(instruction.bank, word);
+        else if (isRelativeJump(opcode))
+            value = formatAddress(instruction.bank, static_cast<uint16_t>(instruction.address + 2 + static_cast<int8_t>(byte)));
+        else if (opcode == 0xE0 || opcode == 0xF0) // LDH
+            value = formatAddress(0, static_cast<uint16_t>(0xFF00 + byte));
+        else if (opcode == 0xE8 || opcode == 0xF8) // ADD SP, n and LD HL, SP+n (signed)
+        {
+            int offset = static_cast<int8_t>(byte);
+            value = (offset < 0 ? "-" : (opcode == 0xE8 ? "" : "+")) + formatHex(static_cast<uint32_t>(offset < 0 ? -offset : offset), 2);
+            if (opcode == 0xF8)
+                operand--; // Replace the '+' too
+            return text.replace(operand, opcode == 0xF8 ? 2 : 1, value);
+        }
+        else
+            value = formatHex(byte, 2);
+
+        return text.replace(operand, instruction.length - 1, value);
+    }
+
+    void Disassembler::addHit(const uint16_t pc, const uint8_t opcode)
+    {
+        m_totalHits++;
+        if (pc < rom_banks::SWITCHABLE_BANK_START)
+        {
+            m_hits[pc]++;
+            return;
+        }
+        if (pc < rom_banks::ROM_END)
+        {
+            for (uint16_t bank = 1; bank < getBankCount(); bank++)
+            {
+                size_t offset = getOffset(bank, pc);
+                if (readROM(offset) == opcode)
+                {
+                    m_hits[offset]++;
+                    return;
+                }
+            }
+        }
+        m_outsideHits++;
+    }
+
+    bool Disassembler::loadHits(std::istream &stream)
+    {
+        TraceReader reader(stream);
+        TraceRecord record;
+        while (reader.next(record))
+            addHit(record.pc, record.opcode);
+        return reader.isValid();
+    }
+
+    uint64_t Disassembler::getHits(const uint16_t bank, const uint16_t address) const
+    {
+        return m_hits[getOffset(bank, address % rom_banks::ROM_END)];
+    }
+
+    void Disassembler::writeInstruction(std::ostream &output, const Instruction &instruction, const uint64_t hits) const
+    {
+        std::ostringstream bytes;
+        bytes << std::hex << std::uppercase << std::setfill('0');
+        for (size_t i = 0; i < instruction.length; i++)
+            bytes << std::setw(2) << +instruction.bytes[i] << " ";
+
+        // The machine cycles (not taken/taken for the conditional branches)
+        uint8_t opcode = instruction.bytes[0];
+        std::string cycles;
+        if (opcode == cpu_opcodes::CB_PREFIX)
+            cycles = std::to_string(cpu_cycles::OPCODE_CB_CYCLES[instruction.bytes[1]]);
+        else if (cpu_cycles::OPCODE_CYCLES[opcode] != cpu_cycles::OPCODE_CYCLES_BRANCHED[opcode])
+            cycles = std::to_string(cpu_cycles::OPCODE_CYCLES[opcode]) + "/" + std::to_string(cpu_cycles::OPCODE_CYCLES_BRANCHED[opcode]);
+        else
+            cycles = std::to_string(cpu_cycles::OPCODE_CYCLES[opcode]);
+
+        std::ostringstream line;
+        line << std::hex << std::uppercase << std::setfill('0') << "    " << std::setw(2) << instruction.bank << ":"
+             << std::setw(4) << instruction.address << "  " << std::setfill(' ') << std::left << std::setw(10) << bytes.str()
+             << std::setw(24) << instruction.text << "; ";
+        if (!hits)
+            line << cycles;
+        else
+            line << std::setw(4) << cycles << std::right << std::dec << std::setw(12) << hits << std::fixed << std::setprecision(2) << std::setw(8)
+                 << 100.0 * static_cast<double>(hits) / static_cast<double>(m_totalHits) << "%";
+        output << line.str() << "\n";
+    }
+
+    void Disassembler::writeListing(std::ostream &output)
+    {
+        for (uint16_t bank = 0; bank < getBankCount(); bank++)
+        {
+            output << "; ROM bank " << bank << "\n";
+            uint32_t address = bank == 0 ? 0 : rom_banks::SWITCHABLE_BANK_START;
+            uint32_t end = address + rom_banks::BANK_SIZE;
+            while (address < end)
+            {
+                const Instruction &instruction = decode(bank, static_cast<uint16_t>(address));
+                const std::string *name = m_symbols ? m_symbols->find(bank, instruction.address) : nullptr;
+                if (name)
+                    output << *name << ":\n";
+                writeInstruction(output, instruction, 0);
+                address += instruction.length;
+            }
+            output << "\n";
+        }
+        output << std::flush;
+    }
+
+    void Disassembler::writeHotListing(std::ostream &output, const size_t routines)
+    {
+        // The executed instructions, in the order of the ROM
+        std::vector<size_t> executed;
+        for (size_t offset = 0; offset < m_hits.size(); offset++)
+            if (m_hits[offset])
+                executed.push_back(offset);
+
+        auto getAddress = [](const size_t offset) {
+            return static_cast<uint16_t>(offset < rom_banks::BANK_SIZE ? offset : rom_banks::SWITCHABLE_BANK_START + offset % rom_banks::BANK_SIZE);
+        };
+
+        // The routines without symbol start at the targets of the executed calls
+        std::map<size_t, std::string> calls;
+        for (size_t offset : executed)
+        {
+            const Instruction &instruction = decode(static_cast<uint16_t>(offset / rom_banks::BANK_SIZE), getAddress(offset));
+            uint16_t target = 0;
+            if (!getCallTarget(instruction, target) || target >= rom_banks::ROM_END)
+                continue;
+            uint16_t bank = target < rom_banks::SWITCHABLE_BANK_START ? 0 : std::max<uint16_t>(instruction.bank, 1);
+            if (m_symbols && m_symbols->find(bank, target))
+                continue;
+            std::ostringstream name;
+            name << "Call_" << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << bank << "_" << std::setw(4) << target;
+            calls.emplace(getOffset(bank, target), name.str());
+        }
+
+        // The routine of each executed instruction: the closest symbol or call target before it, in the same area
+        struct Routine
+        {
+            size_t offset; ///< The offset in the ROM of the first instruction
+            std::string name; ///< The name of the routine
+            uint64_t hits; ///< The number of instructions executed in the routine
+        };
+        std::vector<Routine> hotRoutines;
+        std::map<size_t, size_t> routineIndexes; // Offset of the start -> index in hotRoutines
+        size_t outsideRoutines = 0;
+        for (size_t offset : executed)
+        {
+            uint16_t bank = static_cast<uint16_t>(offset / rom_banks::BANK_SIZE);
+            uint16_t address = getAddress(offset);
+            size_t areaStart = offset - address % rom_banks::BANK_SIZE;
+
+            size_t start = 0;
+            const std::string *name = nullptr;
+            uint16_t symbolAddress = 0;
+            if (m_symbols && (name = m_symbols->findContaining(bank, address, symbolAddress)))
+                start = getOffset(bank, symbolAddress);
+            auto call = calls.upper_bound(offset);
+            if (call != calls.begin() && (--call)->first >= areaStart && (!name || call->first > start))
+            {
+                start = call->first;
+                name = &call->second;
+            }
+            if (!name)
+            {
+                outsideRoutines += m_hits[offset];
+                continue;
+            }
+
+            auto index = routineIndexes.emplace(start, hotRoutines.size());
+            if (index.second)
+                hotRoutines.push_back({start, *name, 0});
+            hotRoutines[index.first->second].hits += m_hits[offset];
+        }
+        std::stable_sort(hotRoutines.begin(), hotRoutines.end(), [](const Routine &a, const Routine &b) { return a.hits > b.hits; });
+
+        // Summary
+        output << "; " << m_totalHits << " instructions executed, " << m_outsideHits << " outside the ROM";
+        if (outsideRoutines)
+            output << ", " << outsideRoutines << " before the first routine of their bank";
+        output << "\n; Hottest routines:\n";
+        for (size_t i = 0; i < std::min(routines, hotRoutines.size()); i++)
+        {
+            const Routine &routine = hotRoutines[i];
+            output << ";   " << std::setw(12) << routine.hits << std::fixed << std::setprecision(2) << std::setw(8)
+                   << 100.0 * static_cast<double>(routine.hits) / static_cast<double>(m_totalHits) << "%  "
+                   << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << routine.offset / rom_banks::BANK_SIZE
+                   << ":" << std::setw(4) << getAddress(routine.offset) << std::dec << std::setfill(' ') << " " << routine.name << "\n";
+        }
+
+        // Listing of the executed instructions (a blank line between two blocks that do not follow each other)
+        size_t next = 0;
+        for (size_t offset : executed)
+        {
+            uint16_t bank = static_cast<uint16_t>(offset / rom_banks::BANK_SIZE);
+            const Instruction &instruction = decode(bank, getAddress(offset));
+            const std::string *name = m_symbols ? m_symbols->find(bank, instruction.address) : nullptr;
+            auto call = calls.find(offset);
+            if (!name && call != calls.end())
+                name = &call->second;
+
+            if (offset != next)
+                output << "\n";
+            if (name)
+                output << *name << ":\n";
+            writeInstruction(output, instruction, m_hits[offset]);
+            next = offset + instruction.length;
+        }
+        output << std::flush;
+    }
+
+    int disassembleFile(const std::string &romFile, const std::string &symbolFile, const std::string &traceFile,
+                        std::ostream &output)
+    {
+        std::ifstream file(romFile, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Cannot read the ROM file " << romFile << std::endl;
+            return 1;
+        }
+        std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        SymbolTable symbols;
+        if (!symbolFile.empty())
+        {
+            std::ifstream symbolStream(symbolFile);
+            if (!symbolStream.is_open())
+            {
+                std::cout << "\x1B[31mError!\033[0m Cannot read the symbol file " << symbolFile << std::endl;
+                return 1;
+            }
+            size_t skipped = symbols.load(symbolStream);
+            if (skipped)
+                std::cout << "\x1B[33m!!!\033[0m " << skipped << " lines of " << symbolFile << " are not symbols" << std::endl;
+        }
+
+        Disassembler disassembler(std::move(rom), &symbols);
+        if (traceFile.empty())
+        {
+            disassembler.writeListing(output);
+            return 0;
+        }
+
+        std::ifstream traceStream(traceFile, std::ios::binary);
+        if (!traceStream.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Cannot read the trace file " << traceFile << std::endl;
+            return 1;
+        }
+        if (!disassembler.loadHits(traceStream))
+        {
+            std::cout << "\x1B[31mError!\033[0m " << traceFile << " is not a valid trace (or is truncated)" << std::endl;
+            return 1;
+        }
+        disassembler.writeHotListing(output, 20);
+        return 0;
+    }
+} // namespace gameboy
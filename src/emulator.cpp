@@ -0,0 +1,255 @@
+#include "emulator.h" // Emulator
+#include "emulator_impl.h" // Emulator::emulate
+#include "profiler.h" // GBEMU_PROFILE_SCOPE
+
+#include <utility> // std::move
+
+namespace gameboy
+{
+    Emulator::Emulator()
+        : m_memory(m_cartridge),
+          m_cpu(m_memory),
+          m_debugBus(m_memory),
+          m_debugCPU(m_debugBus),
+          m_ppu(m_memory),
+          m_timer(m_memory),
+          m_apu(m_memory),
+          m_serial(m_memory),
+          m_input(m_memory),
+          m_timedBus(m_memory, *this),
+          m_timedCPU(m_timedBus),
+          m_timedDebugBus(m_timedBus),
+          m_timedDebugCPU(m_timedDebugBus)
+    {}
+
+    std::unique_ptr<Emulator> Emulator::create(std::vector<uint8_t> rom)
+    {
+        std::unique_ptr<Emulator> emulator(new Emulator());
+        if (!emulator->m_cartridge.loadROMData(std::move(rom)))
+            return nullptr;
+        return emulator;
+    }
+
+    std::unique_ptr<Emulator> Emulator::createFromFile(const std::string &filename)
+    {
+        std::unique_ptr<Emulator> emulator(new Emulator());
+        if (!emulator->m_cartridge.loadROM(filename))
+            return nullptr;
+        return emulator;
+    }
+
+    // Instantiated in emulator_timed.cpp
+    extern template bool Emulator::emulate<false, false, true>(uint64_t, bool);
+    extern template bool Emulator::emulate<true, false, true>(uint64_t, bool);
+    extern template bool Emulator::emulate<false, true, true>(uint64_t, bool);
+    extern template bool Emulator::emulate<true, true, true>(uint64_t, bool);
+
+    bool Emulator::dispatch(const uint64_t maxCycles, const bool untilFrame)
+    {
+        if (m_accuracy == Accuracy::MACHINE_CYCLE)
+        {
+            if (m_debugger)
+                return m_tracer ? emulate<true, true, true>(maxCycles, untilFrame) : emulate<false, true, true>(maxCycles, untilFrame);
+            return m_tracer ? emulate<true, false, true>(maxCycles, untilFrame) : emulate<false, false, true>(maxCycles, untilFrame);
+        }
+        if (m_debugger)
+            return m_tracer ? emulate<true, true, false>(maxCycles, untilFrame) : emulate<false, true, false>(maxCycles, untilFrame);
+        return m_tracer ? emulate<true, false, false>(maxCycles, untilFrame) : emulate<false, false, false>(maxCycles, untilFrame);
+    }
+
+    bool Emulator::runFrame()
+    {
+        GBEMU_PROFILE_SCOPE("Emulator::runFrame");
+        // A bit more than a frame, since the last instruction can end after the start of the VBLANK
+        constexpr uint32_t maxCycles = ppu_timing::CYCLES_PER_FRAME + ppu_timing::CYCLES_PER_SCANLINE;
+
+        m_ppu.setRenderingEnabled(false);
+        if (!m_perfCounters)
+            return dispatch(maxCycles, true);
+
+        PerfSample start = m_perfCounters->read();
+        bool result = dispatch(maxCycles, true);
+        m_perfCounters->add(PerfSubsystem::FRAME, m_perfCounters->read() - start);
+        return result;
+    }
+
+    bool Emulator::runCycles(const uint64_t cycles)
+    {
+        return dispatch(cycles, false);
+    }
+
+    void Emulator::setInput(const uint8_t mask)
+    {
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            auto button = static_cast<JoypadButton>(1 << bit);
+            m_input.setButton(button, (mask & (1 << bit)) != 0);
+        }
+        m_input.sendInterrupt();
+    }
+
+    uint8_t Emulator::getInputMask() const
+    {
+        // The joypad state is inverted (0 = pressed, 1 = not pressed)
+        return static_cast<uint8_t>(~m_memory.getJoypadState());
+    }
+
+    bool Emulator::isFrameReady() const
+    {
+        return m_ppu.isRenderingEnabled();
+    }
+
+    FrameBufferView Emulator::frameBuffer() const
+    {
+        return {m_ppu.getFrameBuffer(), screen_size::SCREEN_WIDTH, screen_size::SCREEN_HEIGHT};
+    }
+
+    uint8_t Emulator::readMemory(const uint16_t address) const
+    {
+        return m_memory.read(address);
+    }
+
+    void Emulator::writeMemory(const uint16_t address, const uint8_t value)
+    {
+        m_memory.write(address, value);
+    }
+
+    Registers &Emulator::getRegisters()
+    {
+        return m_cpu.getRegisters();
+    }
+
+    uint64_t Emulator::getROMHash() const
+    {
+        return m_cartridge.getROMHash();
+    }
+
+    uint64_t Emulator::getCycles() const
+    {
+        return m_cycles;
+    }
+
+    uint64_t Emulator::getInstructions() const
+    {
+        return m_instructions;
+    }
+
+    void Emulator::saveState(std::vector<uint8_t> &state) const
+    {
+        StateWriter writer(state);
+        writer.write(STATE_MAGIC);
+        writer.write(m_cycles);
+        m_cpu.saveState(writer);
+        m_memory.saveState(writer);
+        m_cartridge.saveState(writer);
+        m_ppu.saveState(writer);
+        m_timer.saveState(writer);
+        m_apu.saveState(writer);
+        m_serial.saveState(writer);
+        m_input.saveState(writer);
+    }
+
+    bool Emulator::loadState(const std::vector<uint8_t> &state)
+    {
+        StateReader reader(state);
+        uint32_t magic = 0;
+        reader.read(magic);
+        if (!reader.isValid() || magic != STATE_MAGIC)
+            return false;
+
+        // Keep the current state, to restore it if the new one is not valid
+        std::vector<uint8_t> backup;
+        saveState(backup);
+
+        reader.read(m_cycles);
+        m_cpu.loadState(reader);
+        m_memory.loadState(reader);
+        m_cartridge.loadState(reader);
+        m_ppu.loadState(reader);
+        m_timer.loadState(reader);
+        m_apu.loadState(reader);
+        m_serial.loadState(reader);
+        m_input.loadState(reader);
+        if (reader.isValid())
+            return true;
+
+        loadState(backup);
+        return false;
+    }
+
+    void Emulator::setSerialSink(SerialSink *sink)
+    {
+        m_serial.setSink(sink);
+    }
+
+    void Emulator::setTracer(TraceSink *tracer)
+    {
+        m_tracer = tracer;
+    }
+
+    void Emulator::setPerfCounters(PerfCounters *counters)
+    {
+        m_perfCounters = counters;
+        m_ppu.setPerfCounters(counters);
+    }
+
+    void Emulator::setDebugger(Debugger *debugger)
+    {
+        m_debugger = debugger;
+        m_debugBus.setDebugger(debugger);
+        m_timedDebugBus.setDebugger(debugger);
+    }
+
+    void Emulator::setAccuracy(const Accuracy accuracy)
+    {
+        m_accuracy = accuracy;
+    }
+
+    Accuracy Emulator::getAccuracy() const
+    {
+        return m_accuracy;
+    }
+
+    TraceRecord Emulator::getCPUState() const
+    {
+        return makeTraceRecord(m_cpu.getRegisters());
+    }
+
+    TraceRecord Emulator::makeTraceRecord(const Registers &registers) const
+    {
+        TraceRecord record;
+        record.cycles = m_cycles;
+        record.pc = registers.pc;
+        record.sp = registers.sp;
+        record.opcode = m_memory.read(registers.pc);
+        record.a = registers.a;
+        record.f = registers.f;
+        record.b = registers.b;
+        record.c = registers.c;
+        record.d = registers.d;
+        record.e = registers.e;
+        record.h = registers.h;
+        record.l = registers.l;
+        return record;
+    }
+
+    void Emulator::setSkipRendering(const bool skip)
+    {
+        m_ppu.setSkipRendering(skip);
+    }
+
+    void Emulator::saveRAMData() const
+    {
+        m_cartridge.saveRAMData();
+    }
+
+    APU &Emulator::getAPU()
+    {
+        return m_apu;
+    }
+
+    Input &Emulator::getInput()
+    {
+        return m_input;
+    }
+} // namespace gameboy
@@ -0,0 +1,19 @@
+/*
+ * The emulation loop with Accuracy::MACHINE_CYCLE (see emulator_impl.h).
+ * It is compiled on its own, so the timed CPU does not change the code of the fast loop in emulator.cpp.
+ */
+
+#include "cpu_impl.h" // BasicCPU
+#include "emulator_impl.h" // Emulator::emulate
+
+namespace gameboy
+{
+    // The buses of the timed CPU (see emulator.h)
+    template class BasicCPU<TimedBus<Memory, Emulator>>;
+    template class BasicCPU<DebugBus<TimedBus<Memory, Emulator>>>;
+
+    template bool Emulator::emulate<false, false, true>(uint64_t, bool);
+    template bool Emulator::emulate<true, false, true>(uint64_t, bool);
+    template bool Emulator::emulate<false, true, true>(uint64_t, bool);
+    template bool Emulator::emulate<true, true, true>(uint64_t, bool);
+} // namespace gameboy
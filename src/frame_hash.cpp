@@ -0,0 +1,89 @@
+#include "frame_hash.h" // FrameHash, hashFrame, hashFrames
+#include "hash.h" // hash64
+
+#include <fstream> // std::ifstream, std::ofstream
+#include <iomanip> // std::setw, std::setfill
+#include <iostream> // std::cout, std::endl
+#include <sstream> // std::istringstream
+
+namespace gameboy
+{
+    uint64_t hashFrame(const Emulator &emulator)
+    {
+        FrameBufferView frame = emulator.frameBuffer();
+        return hash64(frame.pixels, frame.width * frame.height * sizeof(Colour));
+    }
+
+    bool hashFrames(Emulator &emulator, const Movie *movie, const uint32_t frames, const uint32_t interval,
+                    std::vector<FrameHash> &hashes)
+    {
+        hashes.clear();
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            if (movie && frame < movie->getFrameCount())
+                emulator.setInput(movie->getFrameInput(frame));
+
+            // Only the hashed frames are rendered
+            bool hashed = interval <= 1 || (frame + 1) % interval == 0;
+            emulator.setSkipRendering(!hashed);
+            if (!emulator.runFrame())
+                return false;
+
+            if (hashed)
+                hashes.push_back({frame, hashFrame(emulator)});
+        }
+
+        emulator.setSkipRendering(false);
+        return true;
+    }
+
+    bool saveFrameHashes(const std::string &filename, const std::vector<FrameHash> &hashes)
+    {
+        std::ofstream file;
+        if (filename != "-")
+        {
+            file.open(filename);
+            if (!file.is_open())
+            {
+                std::cout << "\x1B[31mError!\033[0m Could not write the hash file " << filename << std::endl;
+                return false;
+            }
+        }
+        std::ostream &output = filename == "-" ? std::cout : file;
+
+        output << "# frame hash\n";
+        for (const FrameHash &hash : hashes)
+            output << std::dec << hash.frame << " " << std::hex << std::setw(16) << std::setfill('0') << hash.hash << "\n";
+        output << std::dec << std::flush;
+        return static_cast<bool>(output);
+    }
+
+    bool loadFrameHashes(const std::string &filename, std::vector<FrameHash> &hashes)
+    {
+        std::ifstream file(filename);
+        if (!file.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not open the hash file " << filename << std::endl;
+            return false;
+        }
+
+        hashes.clear();
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); lineNumber++)
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream stream(line);
+            FrameHash hash{};
+            if (!(stream >> std::dec >> hash.frame >> std::hex >> hash.hash))
+            {
+                std::cout << "\x1B[31mError!\033[0m Invalid line " << lineNumber << " in " << filename << ": " << line << std::endl;
+                return false;
+            }
+            hashes.push_back(hash);
+        }
+
+        return true;
+    }
+} // namespace gameboy
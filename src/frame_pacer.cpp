@@ -0,0 +1,133 @@
+/*
+ * See https://gbdev.io/pandocs/Rendering.html
+ */
+
+#include "frame_pacer.h" // FramePacer
+#include "profiler.h" // GBEMU_PROFILE_SCOPE
+
+#include <algorithm> // std::clamp, std::max
+#include <cmath> // std::sqrt, std::abs
+#include <thread> // std::this_thread::sleep_for, std::this_thread::yield
+
+namespace gameboy
+{
+    FramePacer::FramePacer(const uint64_t clockFrequency, const uint64_t cyclesPerFrame, const PacingMode mode)
+        : m_mode(mode),
+          m_periodNs(cyclesPerFrame * 1'000'000'000 / clockFrequency),
+          m_periodRemainder(cyclesPerFrame * 1'000'000'000 % clockFrequency),
+          m_clockFrequency(clockFrequency)
+    {
+        m_lastFrame = Clock::now();
+        m_deadline = m_lastFrame;
+        advanceDeadline();
+    }
+
+    void FramePacer::waitForNextFrame()
+    {
+        GBEMU_PROFILE_SCOPE("FramePacer::waitForNextFrame");
+        auto now = Clock::now();
+
+        if (m_mode == PacingMode::TIMER)
+        {
+            // Too late, start again from now instead of running fast to recover the lost frames
+            if (now > m_deadline + std::chrono::nanoseconds(m_periodNs * MAX_LATE_FRAMES))
+                m_deadline = now;
+
+            // Sleep coarsely (the sleep can last longer than requested)...
+            if (m_deadline - now > SPIN_THRESHOLD)
+                std::this_thread::sleep_for(m_deadline - now - SPIN_THRESHOLD);
+
+            // ...and spin for the remaining time
+            while ((now = Clock::now()) < m_deadline)
+                std::this_thread::yield();
+        }
+        else if (m_mode == PacingMode::AUDIO)
+        {
+            // The further the buffer is from the target, the more the sample rate is corrected
+            double fill = static_cast<double>(m_audioBuffer->size());
+            double target = static_cast<double>(m_audioTarget);
+            double deviation = std::clamp((fill - target) / target, -1.0, 1.0);
+            m_rateAdjustment = 1 - MAX_RATE_ADJUSTMENT * deviation;
+
+            // Wait for the audio device, but do not block forever if it stopped consuming the samples
+            auto timeout = now + std::chrono::nanoseconds(m_periodNs * MAX_LATE_FRAMES);
+            while (m_audioBuffer->size() > m_audioTarget && now < timeout)
+            {
+                std::this_thread::sleep_for(AUDIO_POLL_INTERVAL);
+                now = Clock::now();
+            }
+        }
+
+        recordFrameTime(now);
+        advanceDeadline();
+    }
+
+    FrameTimeStats FramePacer::getStats() const
+    {
+        FrameTimeStats stats;
+        if (m_frameTimesCount == 0)
+            return stats;
+
+        double sum = 0;
+        for (size_t i = 0; i < m_frameTimesCount; i++)
+            sum += static_cast<double>(m_frameTimes[i]);
+        double mean = sum / static_cast<double>(m_frameTimesCount);
+
+        double target = static_cast<double>(m_periodNs) + static_cast<double>(m_periodRemainder) / static_cast<double>(m_clockFrequency);
+        double variance = 0;
+        double maxError = 0;
+        for (size_t i = 0; i < m_frameTimesCount; i++)
+        {
+            auto frameTime = static_cast<double>(m_frameTimes[i]);
+            variance += (frameTime - mean) * (frameTime - mean);
+            maxError = std::max(maxError, std::abs(frameTime - target));
+        }
+        variance /= static_cast<double>(m_frameTimesCount);
+
+        stats.fps = mean > 0 ? 1e9 / mean : 0;
+        stats.meanMs = mean / 1e6;
+        stats.jitterMs = std::sqrt(variance) / 1e6;
+        stats.maxErrorMs = maxError / 1e6;
+        stats.rateAdjustment = m_rateAdjustment;
+        return stats;
+    }
+
+    void FramePacer::setAudioSync(const RingBuffer<int16_t> *buffer, const size_t targetSize)
+    {
+        m_mode = PacingMode::AUDIO;
+        m_audioBuffer = buffer;
+        m_audioTarget = targetSize;
+    }
+
+    double FramePacer::getRateAdjustment() const
+    {
+        return m_rateAdjustment;
+    }
+
+    PacingMode FramePacer::getMode() const
+    {
+        return m_mode;
+    }
+
+    void FramePacer::advanceDeadline()
+    {
+        m_deadline += std::chrono::nanoseconds(m_periodNs);
+
+        // Carry the fractional nanoseconds, so that after clockFrequency frames the error is exactly 0
+        m_remainder += m_periodRemainder;
+        if (m_remainder >= m_clockFrequency)
+        {
+            m_remainder -= m_clockFrequency;
+            m_deadline += std::chrono::nanoseconds(1);
+        }
+    }
+
+    void FramePacer::recordFrameTime(const Clock::time_point now)
+    {
+        m_frameTimes[m_frameTimesIndex] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastFrame).count();
+        m_frameTimesIndex = (m_frameTimesIndex + 1) % FRAME_TIMES_SIZE;
+        if (m_frameTimesCount < FRAME_TIMES_SIZE)
+            m_frameTimesCount++;
+        m_lastFrame = now;
+    }
+} // namespace gameboy
@@ -1,59 +1,473 @@
 #include "gb.h" // GB
+#include "gdb_stub.h" // GDBStub
+#include "hash.h" // hash64
+#include "lockstep.h" // runLockstep
 
-#include <SDL2/SDL_timer.h> // SDL_GetTicks64, SDL_Delay
+#include <algorithm> // std::max
+#include <chrono> // std::chrono::steady_clock, std::chrono::duration
+#include <cstdio> // std::snprintf
+#include <iomanip> // std::setw, std::setfill
+#include <iostream> // std::cout
+#include <utility> // std::move
 
 namespace gameboy
 {
-    GB::GB(const int scale, const bool maximize)
-        : m_platform(scale, maximize)
-    {}
+    GB::GB(const GBOptions &options)
+        : m_platform(options.scale, options.maximize, options.vsync),
+          m_pacer(cpu_cycles::CLOCK_FREQUENCY, ppu_timing::CYCLES_PER_FRAME, options.vsync ? PacingMode::VSYNC : PacingMode::TIMER),
+          m_showStats(options.showStats),
+          m_accuracy(options.accuracy),
+          m_measureLatency(options.measureLatency),
+          m_runAhead(options.runAhead),
+          m_recordFile(options.recordFile),
+          m_statsInterval(std::max(1u, options.statsInterval))
+    {
+        if (!options.inputMappingFile.empty())
+        {
+            InputMapping mapping;
+            if (mapping.loadFromFile(options.inputMappingFile))
+                m_platform.setInputMapping(std::move(mapping));
+        }
+
+        if ((options.audio || options.audioSync) && m_platform.openAudio(AUDIO_SAMPLE_RATE) && options.audioSync)
+            m_pacer.setAudioSync(m_platform.getAudioBuffer(), AUDIO_SYNC_TARGET);
+
+        if (!options.linkListen.empty())
+            m_link.listen(options.linkListen);
+        else if (!options.linkConnect.empty())
+            m_link.connect(options.linkConnect);
+
+        // The frames emulated ahead would exchange bytes with the other emulator, and they cannot be rolled back
+        if (m_link.isConnected() && m_runAhead > 0)
+        {
+            std::cout << "\x1B[33m!!!\033[0m The run-ahead is disabled while the link cable is connected" << std::endl;
+            m_runAhead = 0;
+        }
+
+        if (!options.statsFile.empty())
+        {
+            m_statsFile.open(options.statsFile);
+            if (!m_statsFile.is_open())
+                std::cout << "\x1B[33m!!!\033[0m Cannot create the statistics file " << options.statsFile << std::endl;
+        }
+    }
 
     int GB::run(const std::string &filename)
     {
-        Cartridge cartridge;
-        bool cartridgeLoaded = cartridge.loadROM(filename);
-        if (!cartridgeLoaded)
+        auto emulator = Emulator::createFromFile(filename);
+        if (!emulator)
             return 1;
 
-        Memory m_memory(cartridge);
-        CPU cpu(m_memory);
-        PPU ppu(m_memory);
-        Timer timer(m_memory);
-        Input input(m_memory);
+        emulator->setAccuracy(m_accuracy);
+        emulator->getAPU().setOutput(m_platform.getAudioBuffer(), m_platform.getAudioSampleRate());
+        if (m_link.isConnected())
+            emulator->setSerialSink(&m_link);
+        if (!m_recordFile.empty())
+        {
+            // The cartridge RAM comes from the .sav file (rewritten at exit): the movie starts from the state
+            // with this RAM, so that it is played with the same RAM whatever the .sav file is then
+            m_movie = Movie(emulator->getROMHash());
+            std::vector<uint8_t> startState;
+            emulator->saveState(startState);
+            m_movie.setStartState(std::move(startState));
+        }
+
+        bool running = true;
+        while (running)
+        {
+            updateStats(*emulator);
+
+            // The input applied to the frame (the run-ahead frames are not recorded, they are emulated again later)
+            if (!m_recordFile.empty())
+                m_movie.addFrame(emulator->getInputMask());
+
+            // With the run-ahead, the frame of the current state is never displayed
+            emulator->setSkipRendering(m_runAhead > 0);
+            auto emulateStart = std::chrono::steady_clock::now();
+            if (!emulator->runFrame())
+                return 1;
+            m_emulateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - emulateStart).count();
+
+            if (!emulator->isFrameReady()) // The LCD is disabled, there is nothing to display
+                continue;
+
+            // Produce a bit more or less samples to keep the audio buffer filled at the target level
+            if (m_pacer.getMode() == PacingMode::AUDIO)
+                emulator->getAPU().setRateAdjustment(m_pacer.getRateAdjustment());
+
+            if (m_runAhead == 0)
+            {
+                presentFrame(*emulator);
+                running = processInput(*emulator);
+                continue;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            emulator->getAPU().setMuted(true); // The run-ahead frames are played again later, their sound is not played
+            emulator->saveState(m_snapshot);
+            for (int frame = 1; frame <= m_runAhead; frame++)
+            {
+                emulator->setSkipRendering(frame < m_runAhead);
+                if (!emulator->runFrame())
+                    return 1;
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            if (emulator->isFrameReady())
+                presentFrame(*emulator);
+
+            auto restoreStart = std::chrono::steady_clock::now();
+            emulator->loadState(m_snapshot);
+            emulator->getAPU().setMuted(false);
+            end += std::chrono::steady_clock::now() - restoreStart;
+
+            m_runAheadLastMs = std::chrono::duration<double, std::milli>(end - start).count();
+            m_emulateSeconds += m_runAheadLastMs / 1000.0;
+            m_runAheadTotalMs += m_runAheadLastMs;
+            m_runAheadCount++;
+
+            // The input is handled after the restore, so that it is applied to the real state
+            running = processInput(*emulator);
+        }
+
+        if (m_measureLatency)
+            printLatencyStats();
+        if (m_runAhead > 0)
+            printRunAheadStats();
+
+        if (!m_recordFile.empty() && m_movie.saveToFile(m_recordFile))
+            std::cout << "Movie of " << std::dec << m_movie.getFrameCount() << " frames written to " << m_recordFile << std::endl;
+
+        emulator->saveRAMData();
+        return 0;
+    }
+
+    int GB::playMovie(const std::string &filename, const std::string &movieFile, const std::string &traceFile,
+                      const std::string &statsFile, uint32_t statsInterval, const Accuracy accuracy)
+    {
+        auto emulator = Emulator::createFromFile(filename);
+        if (!emulator)
+            return 1;
+        emulator->setAccuracy(accuracy);
+
+        TraceWriter tracer;
+        if (!traceFile.empty())
+        {
+            if (!tracer.open(traceFile))
+                return 1;
+            emulator->setTracer(&tracer);
+        }
+
+        Movie movie;
+        if (!movie.loadFromFile(movieFile) || !movie.start(*emulator))
+            return 1;
 
-        auto lastCycleTime = SDL_GetTicks();
+        // Without window nothing waits: the frame time is the emulation time
+        StatsCollector stats;
+        std::ofstream statsStream;
+        if (!statsFile.empty())
+        {
+            statsStream.open(statsFile);
+            if (!statsStream.is_open())
+            {
+                std::cout << "\x1B[31mError!\033[0m Cannot create the statistics file " << statsFile << std::endl;
+                return 1;
+            }
+        }
+        statsInterval = std::max(1u, statsInterval);
 
-        do
+        uint64_t hash = 0;
+        for (size_t frame = 0; frame < movie.getFrameCount(); frame++)
         {
-            uint8_t cycles = cpu.cycle() * 4;
-            if (cycles == 0) // An unexpected opcode was encountered
+            uint64_t cycles = emulator->getCycles();
+            uint64_t instructions = emulator->getInstructions();
+            auto start = std::chrono::steady_clock::now();
+
+            emulator->setInput(movie.getFrameInput(frame));
+            if (!emulator->runFrame())
                 return 1;
-            timer.cycle(cycles);
-            ppu.cycle(cycles);
-        } while (updatePlatform(lastCycleTime, ppu, input));
 
-        saveRAMData(cartridge);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            stats.addFrame(emulator->getCycles() - cycles, emulator->getInstructions() - instructions, seconds, seconds, 0);
+            bool last = frame + 1 == movie.getFrameCount();
+            if (statsStream.is_open() && ((frame + 1) % statsInterval == 0 || last))
+                statsStream << formatStatsJSON(stats.takeSnapshot()) << std::endl;
+
+            hash = hash64(&hash, sizeof(hash), hashFrame(*emulator));
+        }
+
+        std::cout << "Frames: " << std::dec << movie.getFrameCount() << "\n";
+        std::cout << "Hash: " << std::hex << std::setw(16) << std::setfill('0') << hash << std::endl;
         return 0;
     }
 
-    bool GB::updatePlatform(uint32_t &lastCycleTime, PPU &ppu, Input &input)
+    int GB::runTest(const std::string &filename, const uint64_t maxCycles, const std::string &traceFile, const Accuracy accuracy)
     {
-        if (!ppu.isRenderingEnabled())
-            return true;
+        auto emulator = Emulator::createFromFile(filename);
+        if (!emulator)
+            return 1;
+        emulator->setAccuracy(accuracy);
 
-        if (SDL_GetTicks() - lastCycleTime < FRAMERATE)
-            SDL_Delay(FRAMERATE - SDL_GetTicks() + lastCycleTime);
+        TraceWriter tracer;
+        if (!traceFile.empty())
+        {
+            if (!tracer.open(traceFile))
+                return 1;
+            emulator->setTracer(&tracer);
+        }
+
+        CaptureSink capture;
+        emulator->setSerialSink(&capture);
+
+        size_t printed = 0;
+        while (emulator->getCycles() < maxCycles)
+        {
+            // Emulate a scanline at a time (a few hundred cycles after the verdict do not change it):
+            // each call to runCycles has a fixed cost, which is high with the machine cycle accuracy
+            if (!emulator->runCycles(ppu_timing::CYCLES_PER_SCANLINE))
+                return 1;
 
-        m_platform.update(ppu.getFrameBuffer());
-        ppu.setRenderingEnabled(false);
+            const std::string &output = capture.getData();
+            if (output.size() == printed)
+                continue;
 
-        lastCycleTime = SDL_GetTicks();
+            std::cout << output.substr(printed) << std::flush;
+            printed = output.size();
+
+            // Check if the completed lines contain the verdict (the chunk may end in the middle of a line)
+            const std::string lines = output.substr(0, output.rfind('\n') + 1);
+            if (lines.find("Passed") != std::string::npos)
+                return 0;
+            if (lines.find("Failed") != std::string::npos)
+                return 1;
+        }
 
-        return Platform::processInput(input);
+        std::cout << "\n\x1B[31mError!\033[0m " << filename << " did not print a verdict in " << std::dec << maxCycles << " cycles" << std::endl;
+        return 1;
+    }
+
+    int GB::printFrameHashes(const std::string &filename, const std::string &movieFile, uint32_t frames,
+                             const uint32_t interval, const std::string &output)
+    {
+        auto emulator = Emulator::createFromFile(filename);
+        if (!emulator)
+            return 1;
+
+        Movie movie;
+        if (!movieFile.empty() && (!movie.loadFromFile(movieFile) || !movie.start(*emulator)))
+            return 1;
+        if (frames == 0)
+            frames = movieFile.empty() ? DEFAULT_HASH_FRAMES : static_cast<uint32_t>(movie.getFrameCount());
+
+        std::vector<FrameHash> hashes;
+        if (!hashFrames(*emulator, movieFile.empty() ? nullptr : &movie, frames, interval, hashes))
+            return 1;
+        return saveFrameHashes(output, hashes) ? 0 : 1;
+    }
+
+    int GB::verifyFrameHashes(const std::string &filename, const std::string &movieFile, const std::string &goldenFile)
+    {
+        std::vector<FrameHash> golden;
+        if (!loadFrameHashes(goldenFile, golden))
+            return 1;
+        if (golden.empty())
+        {
+            std::cout << "\x1B[31mError!\033[0m The hash file " << goldenFile << " is empty" << std::endl;
+            return 1;
+        }
+
+        auto emulator = Emulator::createFromFile(filename);
+        if (!emulator)
+            return 1;
+
+        Movie movie;
+        if (!movieFile.empty() && (!movie.loadFromFile(movieFile) || !movie.start(*emulator)))
+            return 1;
+
+        // The golden file keeps one frame every interval frames
+        uint32_t interval = golden.front().frame + 1;
+        std::vector<FrameHash> hashes;
+        if (!hashFrames(*emulator, movieFile.empty() ? nullptr : &movie, golden.back().frame + 1, interval, hashes))
+            return 1;
+
+        for (size_t i = 0; i < golden.size(); i++)
+        {
+            if (i < hashes.size() && hashes[i] == golden[i])
+                continue;
+
+            std::cout << "\x1B[31mError!\033[0m Frame " << std::dec << golden[i].frame << ": expected hash "
+                      << std::hex << std::setw(16) << std::setfill('0') << golden[i].hash;
+            if (i < hashes.size())
+                std::cout << ", got " << std::setw(16) << std::setfill('0') << hashes[i].hash << " (frame " << std::dec << hashes[i].frame << ")";
+            std::cout << std::endl;
+            return 1;
+        }
+
+        std::cout << std::dec << golden.size() << " frame hashes match " << goldenFile << std::endl;
+        return 0;
+    }
+
+    int GB::runLockstep(const std::string &filename, const std::string &movieFile, uint32_t frames)
+    {
+        auto reference = Emulator::createFromFile(filename);
+        auto candidate = Emulator::createFromFile(filename);
+        if (!reference || !candidate)
+            return 1;
+
+        Movie movie;
+        if (!movieFile.empty() && (!movie.loadFromFile(movieFile) || !movie.start(*reference) || !movie.start(*candidate)))
+            return 1;
+        if (frames == 0)
+            frames = movieFile.empty() ? DEFAULT_HASH_FRAMES : static_cast<uint32_t>(movie.getFrameCount());
+
+        LockstepResult result = gameboy::runLockstep(*reference, *candidate, movieFile.empty() ? nullptr : &movie, frames);
+        if (result.diverged)
+        {
+            std::cout << "\x1B[31mError!\033[0m The cores diverge after " << std::dec << result.frames << " frames\n"
+                      << result.report << std::flush;
+            return 1;
+        }
+        if (result.error)
+        {
+            std::cout << "\x1B[31mError!\033[0m Both cores stopped on an unexpected opcode after " << std::dec
+                      << result.frames << " frames" << std::endl;
+            return 1;
+        }
+
+        std::cout << "No divergence in " << std::dec << result.frames << " frames (" << result.instructions
+                  << " instructions)" << std::endl;
+        return 0;
+    }
+
+    int GB::runDebugger(const std::string &filename, const uint16_t port, const Accuracy accuracy)
+    {
+        auto emulator = Emulator::createFromFile(filename);
+        if (!emulator)
+            return 1;
+        emulator->setAccuracy(accuracy);
+
+        GDBStub stub(*emulator);
+        if (!stub.listen(port) || !stub.serve())
+            return 1;
+
+        std::cout << "The debugger has detached" << std::endl;
+        return 0;
+    }
+
+    void GB::presentFrame(const Emulator &emulator)
+    {
+        auto sleepStart = std::chrono::steady_clock::now();
+        m_pacer.waitForNextFrame();
+        m_sleepSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - sleepStart).count();
+
+        if (m_showStats && ++m_frames % STATS_REFRESH_FRAMES == 0)
+            updateStatsOverlay();
+
+        FrameBufferView frame = emulator.frameBuffer();
+        m_platform.update(frame.pixels);
+
+        if (m_measureLatency)
+            m_latencyMeter.framePresented(frame.pixels, frame.width * frame.height * sizeof(Colour), LatencyMeter::Clock::now());
+    }
+
+    bool GB::processInput(Emulator &emulator)
+    {
+        bool running = m_platform.processInput(emulator.getInput());
+
+        if (m_measureLatency)
+            if (auto pressTime = m_platform.getFirstPressTime())
+                m_latencyMeter.buttonPressed(*pressTime);
+
+        return running;
+    }
+
+    void GB::updateStats(const Emulator &emulator)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (m_statsTime == std::chrono::steady_clock::time_point()) // First frame: nothing to add yet
+        {
+            m_statsTime = now;
+            m_statsCycles = emulator.getCycles();
+            m_statsInstructions = emulator.getInstructions();
+            return;
+        }
+
+        m_stats.addFrame(emulator.getCycles() - m_statsCycles, emulator.getInstructions() - m_statsInstructions,
+                         std::chrono::duration<double>(now - m_statsTime).count(), m_emulateSeconds, m_sleepSeconds);
+        m_statsTime = now;
+        m_statsCycles = emulator.getCycles();
+        m_statsInstructions = emulator.getInstructions();
+        m_emulateSeconds = 0;
+        m_sleepSeconds = 0;
+
+        if (++m_statsFrames % m_statsInterval != 0)
+            return;
+
+        m_statsSnapshot = m_stats.takeSnapshot();
+        if (m_statsFile.is_open())
+            m_statsFile << formatStatsJSON(m_statsSnapshot) << std::endl;
+    }
+
+    void GB::updateStatsOverlay()
+    {
+        FrameTimeStats stats = m_pacer.getStats();
+
+        char text[128];
+        const char *mode = m_pacer.getMode() == PacingMode::VSYNC ? "VSYNC" : m_pacer.getMode() == PacingMode::AUDIO ? "AUDIO" : "TIMER";
+        std::snprintf(text, sizeof(text), "%.2f FPS %s\nFRAME %.2f MS\nJITTER %.3f MS\nMAX ERR %.3f MS",
+                      stats.fps, mode, stats.meanMs, stats.jitterMs, stats.maxErrorMs);
+        std::string overlay = text;
+
+        if (m_pacer.getMode() == PacingMode::AUDIO)
+        {
+            std::snprintf(text, sizeof(text), "\nAUDIO RATE %.4f", stats.rateAdjustment);
+            overlay += text;
+        }
+
+        // Runtime statistics of the last interval
+        std::snprintf(text, sizeof(text), "\nSPEED %.1f%% %.2f MIPS\nP50 %.2f P99 %.2f MS\nEMU %.0f%% SLEEP %.0f%%",
+                      m_statsSnapshot.speed * 100.0, m_statsSnapshot.instructionsPerSecond / 1e6, m_statsSnapshot.frameP50Ms,
+                      m_statsSnapshot.frameP99Ms, m_statsSnapshot.emulateRatio * 100.0, m_statsSnapshot.sleepRatio * 100.0);
+        overlay += text;
+
+        if (m_measureLatency)
+        {
+            LatencyStats latency = m_latencyMeter.getStats();
+            std::snprintf(text, sizeof(text), "\nLATENCY %.1f MS AVG %.1f", latency.lastMs, latency.meanMs);
+            overlay += text;
+        }
+
+        if (m_runAhead > 0)
+        {
+            std::snprintf(text, sizeof(text), "\nRUN-AHEAD %d +%.2f MS", m_runAhead, m_runAheadLastMs);
+            overlay += text;
+        }
+
+        m_platform.setOverlayText(overlay);
+    }
+
+    void GB::printLatencyStats() const
+    {
+        LatencyStats stats = m_latencyMeter.getStats();
+        std::cout << "------------ Input-to-photon latency ------------\n";
+        std::cout << "Samples: " << std::dec << stats.samples << "\n";
+        if (stats.samples > 0)
+        {
+            std::cout << "Mean: " << stats.meanMs << " ms\n";
+            std::cout << "Min: " << stats.minMs << " ms\n";
+            std::cout << "Max: " << stats.maxMs << " ms\n";
+        }
+        std::cout << "-------------------------------------------------\n";
     }
 
-    void GB::saveRAMData(const Cartridge &cartridge)
+    void GB::printRunAheadStats() const
     {
-        cartridge.saveRAMData();
+        double meanMs = m_runAheadCount == 0 ? 0 : m_runAheadTotalMs / static_cast<double>(m_runAheadCount);
+        double frameMs = 1000.0 * ppu_timing::CYCLES_PER_FRAME / cpu_cycles::CLOCK_FREQUENCY;
+        std::cout << "------------------- Run-ahead -------------------\n";
+        std::cout << "Frames ahead: " << std::dec << m_runAhead << "\n";
+        std::cout << "Extra CPU time per frame: " << meanMs << " ms (" << 100.0 * meanMs / frameMs << "% of a frame)\n";
+        std::cout << "State size: " << m_snapshot.size() << " bytes\n";
+        std::cout << "-------------------------------------------------\n";
     }
 } // namespace gameboy
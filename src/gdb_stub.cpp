@@ -0,0 +1,582 @@
+/*
+ * See https://sourceware.org/gdb/current/onlinedocs/gdb.html/Remote-Protocol.html
+ */
+
+#include "gdb_stub.h" // GDBStub
+
+#include <algorithm> // std::min
+#include <arpa/inet.h> // htonl, htons, ntohs
+#include <cerrno> // errno, EINTR
+#include <cstdio> // std::snprintf
+#include <cstring> // std::strerror
+#include <iostream> // std::cout, std::endl
+#include <netinet/in.h> // sockaddr_in, INADDR_LOOPBACK
+#include <netinet/tcp.h> // TCP_NODELAY
+#include <sys/socket.h> // socket, bind, listen, accept, send, recv
+#include <unistd.h> // close
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    namespace
+    {
+        /// The registers presented to the debugger, in the order of the g packet
+        const char *const TARGET_XML =
+            "<?xml version=\"1.0\"?>"
+            "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+            "<target version=\"1.0\">"
+            "<architecture>z80</architecture>"
+            "<feature name=\"org.gnu.gdb.z80.cpu\">"
+            "<reg name=\"af\" bitsize=\"16\" type=\"int\"/>"
+            "<reg name=\"bc\" bitsize=\"16\" type=\"int\"/>"
+            "<reg name=\"de\" bitsize=\"16\" type=\"int\"/>"
+            "<reg name=\"hl\" bitsize=\"16\" type=\"int\"/>"
+            "<reg name=\"sp\" bitsize=\"16\" type=\"data_ptr\"/>"
+            "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+            "</feature>"
+            "</target>";
+
+        constexpr size_t REGISTER_COUNT = 6; ///< The number of registers of TARGET_XML
+
+        /**
+         * @brief Parse a hexadecimal number
+         *
+         * @param text The digits
+         * @param value The number
+         * @return False if the text is empty, too long or not hexadecimal, true otherwise
+         */
+        bool parseHex(const std::string &text, uint32_t &value)
+        {
+            if (text.empty() || text.size() > 8)
+                return false;
+
+            value = 0;
+            for (char digit : text)
+            {
+                value <<= 4;
+                if (digit >= '0' && digit <= '9')
+                    value |= digit - '0';
+                else if (digit >= 'a' && digit <= 'f')
+                    value |= digit - 'a' + 10;
+                else if (digit >= 'A' && digit <= 'F')
+                    value |= digit - 'A' + 10;
+                else
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Parse bytes written as pairs of hexadecimal digits
+         *
+         * @param text The digits
+         * @param bytes The bytes
+         * @return False if the text is not made of pairs of hexadecimal digits, true otherwise
+         */
+        bool parseBytes(const std::string &text, std::vector<uint8_t> &bytes)
+        {
+            if (text.size() % 2 != 0)
+                return false;
+
+            bytes.clear();
+            for (size_t i = 0; i < text.size(); i += 2)
+            {
+                uint32_t value = 0;
+                if (!parseHex(text.substr(i, 2), value))
+                    return false;
+                bytes.push_back(static_cast<uint8_t>(value));
+            }
+            return true;
+        }
+
+        /**
+         * @brief Write a byte as two hexadecimal digits
+         *
+         * @param text The destination
+         * @param byte The byte
+         */
+        void appendByte(std::string &text, const uint8_t byte)
+        {
+            constexpr char digits[] = "0123456789abcdef";
+            text += digits[byte >> 4];
+            text += digits[byte & 0x0F];
+        }
+
+        /**
+         * @brief Get a register in the order of TARGET_XML
+         *
+         * @param registers The registers of the CPU
+         * @param index The index of the register
+         * @return The value of the register
+         */
+        uint16_t getRegister(const Registers &registers, const size_t index)
+        {
+            switch (index)
+            {
+                case 0:
+                    return registers.getAF();
+                case 1:
+                    return registers.getBC();
+                case 2:
+                    return registers.getDE();
+                case 3:
+                    return registers.getHL();
+                case 4:
+                    return registers.sp;
+                default:
+                    return registers.pc;
+            }
+        }
+
+        /**
+         * @brief Set a register in the order of TARGET_XML
+         *
+         * @param registers The registers of the CPU
+         * @param index The index of the register
+         * @param value The new value of the register
+         */
+        void setRegister(Registers &registers, const size_t index, const uint16_t value)
+        {
+            switch (index)
+            {
+                case 0:
+                    registers.setAF(value & 0xFFF0); // The low nibble of F is always 0
+                    break;
+                case 1:
+                    registers.setBC(value);
+                    break;
+                case 2:
+                    registers.setDE(value);
+                    break;
+                case 3:
+                    registers.setHL(value);
+                    break;
+                case 4:
+                    registers.sp = value;
+                    break;
+                default:
+                    registers.pc = value;
+                    break;
+            }
+        }
+
+        /**
+         * @brief Split a packet on a separator
+         *
+         * @param text The text to split
+         * @param separator The separator
+         * @return The parts
+         */
+        std::vector<std::string> split(const std::string &text, const char separator)
+        {
+            std::vector<std::string> parts;
+            size_t start = 0;
+            while (true)
+            {
+                size_t end = text.find(separator, start);
+                parts.push_back(text.substr(start, end - start));
+                if (end == std::string::npos)
+                    return parts;
+                start = end + 1;
+            }
+        }
+    } // namespace
+
+    GDBStub::GDBStub(Emulator &emulator)
+        : m_emulator(emulator)
+    {
+        m_emulator.setDebugger(&m_debugger);
+    }
+
+    GDBStub::~GDBStub()
+    {
+        m_emulator.setDebugger(nullptr);
+        if (m_socket >= 0)
+            close(m_socket);
+        if (m_listener >= 0)
+            close(m_listener);
+    }
+
+    bool GDBStub::listen(const uint16_t port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+
+        m_listener = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        socklen_t size = sizeof(address);
+        if (m_listener < 0 || setsockopt(m_listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+            bind(m_listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(m_listener, 1) != 0 ||
+            getsockname(m_listener, reinterpret_cast<sockaddr *>(&address), &size) != 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not listen on the port " << std::dec << port << ": "
+                      << std::strerror(errno) << std::endl;
+            if (m_listener >= 0)
+                close(m_listener);
+            m_listener = -1;
+            return false;
+        }
+
+        m_port = ntohs(address.sin_port);
+        return true;
+    }
+
+    uint16_t GDBStub::getPort() const
+    {
+        return m_port;
+    }
+
+    bool GDBStub::serve()
+    {
+        if (m_listener < 0)
+            return false;
+
+        std::cout << "Waiting for the debugger on 127.0.0.1:" << std::dec << m_port << "..." << std::endl;
+        m_socket = accept(m_listener, nullptr, nullptr);
+        if (m_socket < 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not accept the debugger: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        // The packets are small and each one waits for a reply
+        int noDelay = 1;
+        setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        m_attached = true;
+        m_noAck = false;
+        m_received.clear();
+        std::string packet;
+        while (m_attached && receivePacket(packet))
+        {
+            std::string reply = handlePacket(packet);
+            if (packet == "k" || !sendPacket(reply))
+                break; // No reply to a kill
+        }
+
+        close(m_socket);
+        m_socket = -1;
+        m_attached = false;
+        return true;
+    }
+
+    std::string GDBStub::handlePacket(const std::string &packet)
+    {
+        if (packet.empty())
+            return "";
+
+        Registers &registers = m_emulator.getRegisters();
+        std::string reply;
+        switch (packet[0])
+        {
+            case '?':
+                return stopReply();
+
+            case 'g':
+                for (size_t i = 0; i < REGISTER_COUNT; i++)
+                {
+                    uint16_t value = getRegister(registers, i);
+                    appendByte(reply, value & 0xFF);
+                    appendByte(reply, value >> 8);
+                }
+                return reply;
+
+            case 'G':
+            {
+                std::vector<uint8_t> bytes;
+                if (!parseBytes(packet.substr(1), bytes) || bytes.size() < REGISTER_COUNT * 2)
+                    return "E01";
+                for (size_t i = 0; i < REGISTER_COUNT; i++)
+                    setRegister(registers, i, static_cast<uint16_t>(bytes[i * 2] | (bytes[i * 2 + 1] << 8)));
+                return "OK";
+            }
+
+            case 'p':
+            {
+                uint32_t index = 0;
+                if (!parseHex(packet.substr(1), index) || index >= REGISTER_COUNT)
+                    return "E01";
+                uint16_t value = getRegister(registers, index);
+                appendByte(reply, value & 0xFF);
+                appendByte(reply, value >> 8);
+                return reply;
+            }
+
+            case 'P':
+            {
+                size_t equal = packet.find('=');
+                uint32_t index = 0;
+                std::vector<uint8_t> bytes;
+                if (equal == std::string::npos || !parseHex(packet.substr(1, equal - 1), index) || index >= REGISTER_COUNT ||
+                    !parseBytes(packet.substr(equal + 1), bytes) || bytes.size() != 2)
+                    return "E01";
+                setRegister(registers, index, static_cast<uint16_t>(bytes[0] | (bytes[1] << 8)));
+                return "OK";
+            }
+
+            case 'm':
+            {
+                std::vector<std::string> parts = split(packet.substr(1), ',');
+                uint32_t address = 0;
+                uint32_t length = 0;
+                if (parts.size() != 2 || !parseHex(parts[0], address) || !parseHex(parts[1], length))
+                    return "E01";
+                length = std::min(length, MAX_PACKET_SIZE / 2 - 4);
+                for (uint32_t i = 0; i < length; i++)
+                    appendByte(reply, m_emulator.readMemory(static_cast<uint16_t>(address + i)));
+                return reply;
+            }
+
+            case 'M':
+            {
+                size_t colon = packet.find(':');
+                std::vector<std::string> parts = split(packet.substr(1, colon - 1), ',');
+                uint32_t address = 0;
+                uint32_t length = 0;
+                std::vector<uint8_t> bytes;
+                if (colon == std::string::npos || parts.size() != 2 || !parseHex(parts[0], address) ||
+                    !parseHex(parts[1], length) || !parseBytes(packet.substr(colon + 1), bytes) || bytes.size() != length)
+                    return "E01";
+                for (uint32_t i = 0; i < length; i++)
+                    m_emulator.writeMemory(static_cast<uint16_t>(address + i), bytes[i]);
+                return "OK";
+            }
+
+            case 'c':
+            case 's':
+            {
+                // Optional address to resume at
+                uint32_t address = 0;
+                if (packet.size() > 1)
+                {
+                    if (!parseHex(packet.substr(1), address))
+                        return "E01";
+                    registers.pc = static_cast<uint16_t>(address);
+                }
+                return resume(packet[0] == 's');
+            }
+
+            case 'Z':
+            case 'z':
+                return handleBreakpoint(packet);
+
+            case 'H': // Select a thread: there is only one
+            case 'T': // Is a thread alive
+                return "OK";
+
+            case 'D':
+                m_attached = false;
+                return "OK";
+
+            case 'k':
+                m_attached = false;
+                return "";
+
+            default:
+                break;
+        }
+
+        if (packet.rfind("qSupported", 0) == 0)
+        {
+            char text[96];
+            std::snprintf(text, sizeof(text), "PacketSize=%x;qXfer:features:read+;swbreak+;QStartNoAckMode+", MAX_PACKET_SIZE);
+            return text;
+        }
+        if (packet.rfind("qXfer:features:read:target.xml:", 0) == 0)
+        {
+            std::vector<std::string> parts = split(packet.substr(31), ',');
+            uint32_t offset = 0;
+            uint32_t length = 0;
+            if (parts.size() != 2 || !parseHex(parts[0], offset) || !parseHex(parts[1], length))
+                return "E01";
+
+            // m: more data follows, l: last chunk
+            std::string xml = TARGET_XML;
+            if (offset >= xml.size())
+                return "l";
+            std::string chunk = xml.substr(offset, std::min<uint32_t>(length, MAX_PACKET_SIZE - 8));
+            return (offset + chunk.size() < xml.size() ? "m" : "l") + chunk;
+        }
+        if (packet == "QStartNoAckMode")
+        {
+            m_noAck = true;
+            return "OK";
+        }
+        if (packet == "qAttached")
+            return "1";
+        if (packet == "qC")
+            return "QC1";
+        if (packet == "qfThreadInfo")
+            return "m1";
+        if (packet == "qsThreadInfo")
+            return "l";
+        if (packet.rfind("qSymbol", 0) == 0)
+            return "OK";
+
+        return ""; // Not supported
+    }
+
+    bool GDBStub::receivePacket(std::string &packet)
+    {
+        while (true)
+        {
+            // $content#checksum, anything else (acknowledgments, Ctrl-C while stopped) is skipped
+            size_t start = m_received.find('$');
+            if (start == std::string::npos)
+                m_received.clear();
+            else
+            {
+                m_received.erase(0, start);
+                size_t end = m_received.find('#');
+                if (end != std::string::npos && end + 2 < m_received.size())
+                {
+                    std::string content = m_received.substr(1, end - 1);
+                    uint32_t checksum = 0;
+                    bool valid = parseHex(m_received.substr(end + 1, 2), checksum);
+                    m_received.erase(0, end + 3);
+
+                    uint8_t sum = 0;
+                    for (char c : content)
+                        sum += static_cast<uint8_t>(c);
+                    valid = valid && sum == checksum;
+
+                    if (!m_noAck && !sendRaw(valid ? "+" : "-"))
+                        return false;
+                    if (valid)
+                    {
+                        packet = content;
+                        return true;
+                    }
+                    continue;
+                }
+            }
+
+            char buffer[1024];
+            ssize_t received = recv(m_socket, buffer, sizeof(buffer), 0);
+            if (received < 0 && errno == EINTR)
+                continue;
+            if (received <= 0)
+                return false;
+            m_received.append(buffer, static_cast<size_t>(received));
+        }
+    }
+
+    bool GDBStub::sendPacket(const std::string &data)
+    {
+        uint8_t sum = 0;
+        for (char c : data)
+            sum += static_cast<uint8_t>(c);
+
+        std::string packet = "$" + data + "#";
+        appendByte(packet, sum);
+        return sendRaw(packet);
+    }
+
+    bool GDBStub::sendRaw(const std::string &data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t result = ::send(m_socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+                return false;
+            sent += static_cast<size_t>(result);
+        }
+        return true;
+    }
+
+    bool GDBStub::interruptReceived()
+    {
+        char buffer[256];
+        ssize_t received = recv(m_socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received == 0)
+            return true; // The debugger is gone: stop running
+        if (received > 0)
+            m_received.append(buffer, static_cast<size_t>(received));
+
+        size_t position = m_received.find('\x03');
+        if (position == std::string::npos)
+            return false;
+        m_received.erase(position, 1);
+        return true;
+    }
+
+    std::string GDBStub::resume(const bool singleStep)
+    {
+        m_debugger.resume(singleStep);
+        while (m_debugger.isRunning())
+        {
+            // On an unexpected opcode the debugger stops with StopReason::ERROR
+            m_emulator.runCycles(CYCLES_PER_POLL);
+            if (m_debugger.isRunning() && m_socket >= 0 && interruptReceived())
+                m_debugger.stop(StopReason::INTERRUPT);
+        }
+        return stopReply();
+    }
+
+    std::string GDBStub::stopReply() const
+    {
+        // The signals are the ones of GDB: SIGINT (2), SIGILL (4) and SIGTRAP (5)
+        switch (m_debugger.getStopReason())
+        {
+            case StopReason::BREAKPOINT:
+                return "T05swbreak:;";
+            case StopReason::WATCHPOINT:
+            {
+                WatchHit hit = m_debugger.getWatchHit();
+                const char *kind = hit.type == WatchType::WRITE ? "watch" : hit.type == WatchType::READ ? "rwatch" : "awatch";
+                char text[32];
+                std::snprintf(text, sizeof(text), "T05%s:%04x;", kind, hit.address);
+                return text;
+            }
+            case StopReason::INTERRUPT:
+                return "S02";
+            case StopReason::ERROR:
+                return "S04";
+            default:
+                return "S05";
+        }
+    }
+
+    std::string GDBStub::handleBreakpoint(const std::string &packet)
+    {
+        // Z type,address,kind (the kind is the length of a watchpoint)
+        std::vector<std::string> parts = split(packet.substr(1), ',');
+        uint32_t type = 0;
+        uint32_t address = 0;
+        uint32_t kind = 0;
+        if (parts.size() < 3 || !parseHex(parts[0], type) || !parseHex(parts[1], address) || !parseHex(split(parts[2], ';')[0], kind))
+            return "E01";
+
+        bool insert = packet[0] == 'Z';
+        auto target = static_cast<uint16_t>(address);
+        switch (type)
+        {
+            case 0: // Software breakpoint
+            case 1: // Hardware breakpoint (the same, there is nothing to patch)
+                if (insert)
+                    m_debugger.addBreakpoint(target);
+                else
+                    m_debugger.removeBreakpoint(target);
+                return "OK";
+            case 2:
+            case 3:
+            case 4:
+            {
+                WatchType watchType = type == 2 ? WatchType::WRITE : type == 3 ? WatchType::READ : WatchType::ACCESS;
+                auto length = static_cast<uint16_t>(std::min<uint32_t>(kind, 0x10000 - 1));
+                if (insert)
+                    m_debugger.addWatchpoint(target, length, watchType);
+                else if (!m_debugger.removeWatchpoint(target, length, watchType))
+                    return "E01";
+                return "OK";
+            }
+            default:
+                return ""; // Not supported
+        }
+    }
+} // namespace gameboy
@@ -0,0 +1,106 @@
+/*
+ * See https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+ */
+
+#include "hash.h" // hash64
+
+#include <cstring> // std::memcpy
+
+namespace gameboy
+{
+    namespace
+    {
+        constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+        constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+        constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+        uint64_t rotateLeft(const uint64_t value, const int bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        uint64_t read64(const uint8_t *data)
+        {
+            uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        uint32_t read32(const uint8_t *data)
+        {
+            uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        uint64_t round(uint64_t accumulator, const uint64_t input)
+        {
+            accumulator += input * PRIME_2;
+            accumulator = rotateLeft(accumulator, 31);
+            return accumulator * PRIME_1;
+        }
+
+        uint64_t mergeAccumulator(uint64_t hash, const uint64_t accumulator)
+        {
+            hash ^= round(0, accumulator);
+            return hash * PRIME_1 + PRIME_4;
+        }
+    } // namespace
+
+    uint64_t hash64(const void *data, const size_t size, const uint64_t seed)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        const uint8_t *end = bytes + size;
+        uint64_t hash;
+
+        if (size >= 32)
+        {
+            // 4 independent accumulators, each one consumes 8 bytes of each stripe of 32 bytes
+            uint64_t accumulators[4] = {seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1};
+            const uint8_t *lastStripe = end - 32;
+            do
+            {
+                for (int i = 0; i < 4; i++)
+                    accumulators[i] = round(accumulators[i], read64(bytes + i * 8));
+                bytes += 32;
+            } while (bytes <= lastStripe);
+
+            hash = rotateLeft(accumulators[0], 1) + rotateLeft(accumulators[1], 7) +
+                   rotateLeft(accumulators[2], 12) + rotateLeft(accumulators[3], 18);
+            for (uint64_t accumulator : accumulators)
+                hash = mergeAccumulator(hash, accumulator);
+        }
+        else
+            hash = seed + PRIME_5;
+
+        hash += size;
+
+        // Remaining bytes
+        for (; bytes + 8 <= end; bytes += 8)
+        {
+            hash ^= round(0, read64(bytes));
+            hash = rotateLeft(hash, 27) * PRIME_1 + PRIME_4;
+        }
+        if (bytes + 4 <= end)
+        {
+            hash ^= static_cast<uint64_t>(read32(bytes)) * PRIME_1;
+            hash = rotateLeft(hash, 23) * PRIME_2 + PRIME_3;
+            bytes += 4;
+        }
+        for (; bytes < end; bytes++)
+        {
+            hash ^= *bytes * PRIME_5;
+            hash = rotateLeft(hash, 11) * PRIME_1;
+        }
+
+        // Avalanche
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        hash *= PRIME_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+} // namespace gameboy
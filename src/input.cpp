@@ -17,7 +17,12 @@ namespace gameboy
 
         // Remember that the joypad state is inverted (0 = pressed, 1 = not pressed)
         if (pressed)
+        {
+            // Released to pressed: the interrupt is sent even if the button is released before sendInterrupt
+            if (currentJoypadState & static_cast<uint8_t>(button))
+                m_pressedButtons |= static_cast<uint8_t>(button);
             currentJoypadState &= ~(static_cast<uint8_t>(button));
+        }
         else
             currentJoypadState |= static_cast<uint8_t>(button);
 
@@ -25,8 +30,24 @@ namespace gameboy
         m_memory.setJoypadState(currentJoypadState);
     }
 
+    void Input::saveState(StateWriter &writer) const
+    {
+        writer.write(m_pressedButtons);
+    }
+
+    void Input::loadState(StateReader &reader)
+    {
+        reader.read(m_pressedButtons);
+    }
+
     void Input::sendInterrupt()
     {
+        // The buttons that went from released to pressed since the last call (see setButton)
+        uint8_t pressedButtons = m_pressedButtons;
+        m_pressedButtons = 0;
+        if (pressedButtons == 0)
+            return;
+
         // Set the interrupt
         uint8_t interruptFlag = m_memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS);
         interruptFlag |= JOYPAD_INTERRUPT_FLAG_VALUE;
@@ -0,0 +1,148 @@
+#include "input_mapping.h" // InputMapping
+
+#include <algorithm> // std::transform
+#include <cctype> // std::toupper
+#include <fstream> // std::ifstream
+#include <iostream> // std::cout, std::endl
+#include <iterator> // std::next
+#include <sstream> // std::istringstream
+
+namespace gameboy
+{
+    namespace
+    {
+        /**
+         * @brief Remove the spaces at the beginning and at the end of a string
+         *
+         * @param s The string
+         * @return The trimmed string
+         */
+        std::string trim(const std::string &s)
+        {
+            auto start = s.find_first_not_of(" \t\r");
+            if (start == std::string::npos)
+                return "";
+            auto end = s.find_last_not_of(" \t\r");
+            return s.substr(start, end - start + 1);
+        }
+    } // namespace
+
+    InputMapping::InputMapping()
+    {
+        m_keys = {
+                {SDLK_a, JoypadButton::BUTTON_A},
+                {SDLK_s, JoypadButton::BUTTON_B},
+                {SDLK_RETURN, JoypadButton::BUTTON_SELECT},
+                {SDLK_SPACE, JoypadButton::BUTTON_START},
+                {SDLK_RIGHT, JoypadButton::DIRECTION_RIGHT},
+                {SDLK_LEFT, JoypadButton::DIRECTION_LEFT},
+                {SDLK_UP, JoypadButton::DIRECTION_UP},
+                {SDLK_DOWN, JoypadButton::DIRECTION_DOWN},
+        };
+
+        m_gamepadButtons = {
+                {SDL_CONTROLLER_BUTTON_A, JoypadButton::BUTTON_A},
+                {SDL_CONTROLLER_BUTTON_B, JoypadButton::BUTTON_B},
+                {SDL_CONTROLLER_BUTTON_BACK, JoypadButton::BUTTON_SELECT},
+                {SDL_CONTROLLER_BUTTON_START, JoypadButton::BUTTON_START},
+                {SDL_CONTROLLER_BUTTON_DPAD_RIGHT, JoypadButton::DIRECTION_RIGHT},
+                {SDL_CONTROLLER_BUTTON_DPAD_LEFT, JoypadButton::DIRECTION_LEFT},
+                {SDL_CONTROLLER_BUTTON_DPAD_UP, JoypadButton::DIRECTION_UP},
+                {SDL_CONTROLLER_BUTTON_DPAD_DOWN, JoypadButton::DIRECTION_DOWN},
+        };
+    }
+
+    bool InputMapping::loadFromFile(const std::string &filename)
+    {
+        std::ifstream file(filename);
+        if (!file.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not open the input mapping file " << filename << std::endl;
+            return false;
+        }
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            line = trim(line);
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            auto separator = line.find('=');
+            auto button = separator == std::string::npos ? std::nullopt : getButtonFromName(trim(line.substr(0, separator)));
+            if (!button)
+            {
+                std::cout << "\x1B[33m!!!\033[0m " << filename << ":" << lineNumber << ": invalid mapping \"" << line << "\"\n";
+                continue;
+            }
+
+            // Remove the default mapping of the button
+            for (auto it = m_keys.begin(); it != m_keys.end();)
+                it = it->second == *button ? m_keys.erase(it) : std::next(it);
+            for (auto it = m_gamepadButtons.begin(); it != m_gamepadButtons.end();)
+                it = it->second == *button ? m_gamepadButtons.erase(it) : std::next(it);
+
+            std::istringstream names(line.substr(separator + 1));
+            std::string name;
+            while (std::getline(names, name, ','))
+            {
+                name = trim(name);
+                if (name.rfind("pad:", 0) == 0)
+                {
+                    SDL_GameControllerButton gamepadButton = SDL_GameControllerGetButtonFromString(name.substr(4).c_str());
+                    if (gamepadButton != SDL_CONTROLLER_BUTTON_INVALID)
+                    {
+                        m_gamepadButtons[static_cast<uint8_t>(gamepadButton)] = *button;
+                        continue;
+                    }
+                }
+                else
+                {
+                    SDL_Keycode key = SDL_GetKeyFromName(name.c_str());
+                    if (key != SDLK_UNKNOWN)
+                    {
+                        m_keys[key] = *button;
+                        continue;
+                    }
+                }
+                std::cout << "\x1B[33m!!!\033[0m " << filename << ":" << lineNumber << ": unknown key \"" << name << "\"\n";
+            }
+        }
+
+        return true;
+    }
+
+    std::optional<JoypadButton> InputMapping::getKeyButton(const SDL_Keycode key) const
+    {
+        auto it = m_keys.find(key);
+        if (it == m_keys.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+    std::optional<JoypadButton> InputMapping::getGamepadButton(const uint8_t button) const
+    {
+        auto it = m_gamepadButtons.find(button);
+        if (it == m_gamepadButtons.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+    std::optional<JoypadButton> InputMapping::getButtonFromName(const std::string &name)
+    {
+        std::string upperName = name;
+        std::transform(upperName.begin(), upperName.end(), upperName.begin(), [](unsigned char c) { return std::toupper(c); });
+
+        if (upperName == "A") return JoypadButton::BUTTON_A;
+        if (upperName == "B") return JoypadButton::BUTTON_B;
+        if (upperName == "SELECT") return JoypadButton::BUTTON_SELECT;
+        if (upperName == "START") return JoypadButton::BUTTON_START;
+        if (upperName == "RIGHT") return JoypadButton::DIRECTION_RIGHT;
+        if (upperName == "LEFT") return JoypadButton::DIRECTION_LEFT;
+        if (upperName == "UP") return JoypadButton::DIRECTION_UP;
+        if (upperName == "DOWN") return JoypadButton::DIRECTION_DOWN;
+        return std::nullopt;
+    }
+} // namespace gameboy
@@ -0,0 +1,55 @@
+#include "latency_meter.h" // LatencyMeter
+
+#include <algorithm> // std::min, std::max
+
+namespace gameboy
+{
+    void LatencyMeter::buttonPressed(const Clock::time_point time)
+    {
+        if (m_pressTime)
+            return;
+
+        m_pressTime = time;
+        m_pressFrameHash = m_lastFrameHash;
+    }
+
+    void LatencyMeter::framePresented(const void *buffer, const size_t size, const Clock::time_point time)
+    {
+        m_lastFrameHash = hashFrame(buffer, size);
+
+        if (!m_pressTime || m_lastFrameHash == m_pressFrameHash)
+            return;
+
+        double latencyMs = std::chrono::duration<double, std::milli>(time - *m_pressTime).count();
+        m_pressTime.reset();
+
+        m_minMs = m_samples == 0 ? latencyMs : std::min(m_minMs, latencyMs);
+        m_maxMs = m_samples == 0 ? latencyMs : std::max(m_maxMs, latencyMs);
+        m_totalMs += latencyMs;
+        m_lastMs = latencyMs;
+        m_samples++;
+    }
+
+    LatencyStats LatencyMeter::getStats() const
+    {
+        LatencyStats stats;
+        stats.samples = m_samples;
+        stats.meanMs = m_samples == 0 ? 0 : m_totalMs / static_cast<double>(m_samples);
+        stats.minMs = m_minMs;
+        stats.maxMs = m_maxMs;
+        stats.lastMs = m_lastMs;
+        return stats;
+    }
+
+    uint64_t LatencyMeter::hashFrame(const void *buffer, const size_t size)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(buffer);
+        uint64_t hash = 0xCBF29CE484222325;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3;
+        }
+        return hash;
+    }
+} // namespace gameboy
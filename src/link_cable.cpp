@@ -0,0 +1,296 @@
+/*
+ * See https://gbdev.io/pandocs/Serial_Data_Transfer_(Link_Cable).html
+ */
+
+#include "link_cable.h" // LinkCable
+
+#include <algorithm> // std::max
+#include <cerrno> // errno, EAGAIN, EWOULDBLOCK, EINTR
+#include <cstring> // std::memset, std::strerror, std::strncpy
+#include <iostream> // std::cout, std::endl
+#include <sys/socket.h> // socket, socketpair, bind, listen, accept, connect, send, recv
+#include <sys/un.h> // sockaddr_un
+#include <unistd.h> // close, unlink
+
+namespace gameboy
+{
+    namespace
+    {
+        /**
+         * @brief Create the address of a Unix socket
+         *
+         * @param path The path of the socket
+         * @param address The address to fill
+         * @return True if the path fits in the address, false otherwise
+         */
+        bool makeAddress(const std::string &path, sockaddr_un &address)
+        {
+            if (path.size() >= sizeof(address.sun_path))
+            {
+                std::cout << "\x1B[31mError!\033[0m The path of the link cable socket is too long: " << path << std::endl;
+                return false;
+            }
+
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+            return true;
+        }
+
+        /**
+         * @brief Write a 64-bit value of a message (little endian)
+         *
+         * @param bytes The 8 bytes to write to
+         * @param value The value
+         */
+        void writeUint64(uint8_t *bytes, const uint64_t value)
+        {
+            for (int i = 0; i < 8; i++)
+                bytes[i] = static_cast<uint8_t>(value >> (i * 8));
+        }
+
+        /**
+         * @brief Read a 64-bit value of a message (little endian)
+         *
+         * @param bytes The 8 bytes to read
+         * @return The value
+         */
+        uint64_t readUint64(const uint8_t *bytes)
+        {
+            uint64_t value = 0;
+            for (int i = 0; i < 8; i++)
+                value |= static_cast<uint64_t>(bytes[i]) << (i * 8);
+            return value;
+        }
+    } // namespace
+
+    LinkCable::~LinkCable()
+    {
+        disconnect();
+    }
+
+    bool LinkCable::connectPair(LinkCable &first, LinkCable &second)
+    {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not create the link cable: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        first.disconnect();
+        second.disconnect();
+        first.m_socket = sockets[0];
+        second.m_socket = sockets[1];
+        return true;
+    }
+
+    bool LinkCable::listen(const std::string &path)
+    {
+        sockaddr_un address{};
+        if (!makeAddress(path, address))
+            return false;
+
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(path.c_str()); // Remove the socket of a previous run
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listener, 1) != 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not listen on " << path << ": " << std::strerror(errno) << std::endl;
+            if (listener >= 0)
+                close(listener);
+            return false;
+        }
+
+        std::cout << "Waiting for the other emulator on " << path << "..." << std::endl;
+        disconnect();
+        m_socket = accept(listener, nullptr, nullptr);
+        close(listener);
+        unlink(path.c_str());
+
+        if (m_socket < 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not accept the connection on " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool LinkCable::connect(const std::string &path)
+    {
+        sockaddr_un address{};
+        if (!makeAddress(path, address))
+            return false;
+
+        disconnect();
+        m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_socket < 0 || ::connect(m_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not connect to " << path << ": " << std::strerror(errno) << std::endl;
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    bool LinkCable::isConnected() const
+    {
+        return m_socket >= 0;
+    }
+
+    LinkStats LinkCable::getStats() const
+    {
+        return m_stats;
+    }
+
+    uint8_t LinkCable::transfer(const uint8_t byte)
+    {
+        // Wait for the byte of the other end
+        while (!m_reply && m_socket >= 0)
+        {
+            // Both ends started a transfer: reply, so that the other end does not wait forever
+            if (m_incoming)
+            {
+                send(MessageType::REPLY, byte);
+                m_incoming.reset();
+            }
+            else
+                waitForPeer();
+        }
+
+        uint8_t received = m_reply.value_or(0xFF);
+        m_reply.reset();
+        m_stats.transfers++;
+        return received;
+    }
+
+    void LinkCable::transferStarted(const uint8_t byte, const uint64_t completionTime)
+    {
+        if (m_socket >= 0)
+            send(MessageType::DATA, byte, completionTime);
+    }
+
+    std::optional<uint8_t> LinkCable::update(const uint64_t time, const uint8_t data)
+    {
+        m_time = time;
+        if (m_socket < 0)
+            return std::nullopt;
+
+        if (m_time - m_lastSentTime >= SYNC_QUANTUM)
+        {
+            send(MessageType::TIME);
+            receive(false);
+        }
+
+        // Bounded lookahead: do not run too far ahead of the other end
+        while (m_socket >= 0 && m_time > m_peerTime + LOOKAHEAD)
+            waitForPeer();
+
+        // Complete the transfer clocked by the other end
+        if (m_incoming && m_time >= m_incoming->completionTime)
+        {
+            uint8_t received = m_incoming->data;
+            m_incoming.reset();
+            send(MessageType::REPLY, data);
+            m_stats.transfers++;
+            return received;
+        }
+
+        return std::nullopt;
+    }
+
+    void LinkCable::send(const MessageType type, const uint8_t data, const uint64_t completionTime)
+    {
+        // The fields one after the other: time, completion time, type, data
+        uint8_t bytes[MESSAGE_SIZE];
+        writeUint64(bytes, m_time);
+        writeUint64(bytes + 8, completionTime);
+        bytes[16] = static_cast<uint8_t>(type);
+        bytes[17] = data;
+
+        size_t sent = 0;
+        while (sent < MESSAGE_SIZE)
+        {
+            ssize_t result = ::send(m_socket, bytes + sent, MESSAGE_SIZE - sent, MSG_NOSIGNAL);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+            {
+                disconnect();
+                return;
+            }
+            sent += static_cast<size_t>(result);
+        }
+
+        m_lastSentTime = m_time;
+        m_stats.messagesSent++;
+    }
+
+    void LinkCable::receive(bool wait)
+    {
+        uint8_t buffer[64 * MESSAGE_SIZE];
+        while (m_socket >= 0)
+        {
+            ssize_t result = recv(m_socket, buffer, sizeof(buffer), wait ? 0 : MSG_DONTWAIT);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return; // No more pending messages
+            if (result <= 0)
+            {
+                std::cout << "\x1B[33m!!!\033[0m The link cable has been disconnected" << std::endl;
+                disconnect();
+                return;
+            }
+
+            m_received.insert(m_received.end(), buffer, buffer + result);
+            size_t count = m_received.size() / MESSAGE_SIZE;
+            for (size_t i = 0; i < count; i++)
+            {
+                // The layout written by send
+                const uint8_t *bytes = m_received.data() + i * MESSAGE_SIZE;
+                handleMessage({readUint64(bytes), readUint64(bytes + 8), static_cast<MessageType>(bytes[16]), bytes[17]});
+            }
+            m_received.erase(m_received.begin(), m_received.begin() + static_cast<std::ptrdiff_t>(count * MESSAGE_SIZE));
+
+            // At least a message has been received, only read the remaining pending messages
+            if (count > 0)
+                wait = false;
+        }
+    }
+
+    void LinkCable::handleMessage(const Message &message)
+    {
+        m_stats.messagesReceived++;
+        m_peerTime = std::max(m_peerTime, message.time);
+
+        switch (message.type)
+        {
+            case MessageType::TIME:
+                break;
+            case MessageType::DATA:
+                m_incoming = message;
+                break;
+            case MessageType::REPLY:
+                m_reply = message.data;
+                break;
+        }
+    }
+
+    void LinkCable::waitForPeer()
+    {
+        // The other end may be waiting for the time of this end
+        if (m_lastSentTime != m_time)
+            send(MessageType::TIME);
+
+        auto start = std::chrono::steady_clock::now();
+        receive(true);
+        m_stats.waitTime += std::chrono::steady_clock::now() - start;
+    }
+
+    void LinkCable::disconnect()
+    {
+        if (m_socket >= 0)
+            close(m_socket);
+        m_socket = -1;
+    }
+} // namespace gameboy
@@ -0,0 +1,167 @@
+#include "lockstep.h" // LockstepResult, runLockstep
+
+#include "frame_hash.h" // hashFrame
+
+#include <iomanip> // std::hex, std::uppercase, std::setw, std::setfill
+#include <sstream> // std::ostringstream
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    namespace
+    {
+        constexpr size_t CONTEXT_RECORDS = 8; ///< The number of instructions printed before a divergence
+        constexpr size_t ADDRESS_SPACE = 0x10000; ///< The size of the address space of the CPU
+
+        /**
+         * @brief Keep the records of a frame in memory
+         */
+        class RecordBuffer : public TraceSink
+        {
+        public:
+            std::vector<TraceRecord> records; ///< The records since the last clear
+
+            void record(const TraceRecord &record) override
+            {
+                records.push_back(record);
+            }
+        };
+
+        /**
+         * @brief Read the whole address space of an emulator
+         * @details The echo RAM (a mirror of the WRAM) and the unusable area are not read (they are left to 0),
+         *          since the reads print a warning
+         *
+         * @param emulator The emulator
+         * @param memory The bytes read
+         */
+        void readAddressSpace(const Emulator &emulator, std::vector<uint8_t> &memory)
+        {
+            for (size_t address = 0; address < ADDRESS_SPACE; address++)
+            {
+                bool echo = address >= 0xE000 && address < 0xFE00;
+                bool unusable = address >= 0xFEA0 && address < 0xFF00;
+                memory[address] = echo || unusable ? 0 : emulator.readMemory(static_cast<uint16_t>(address));
+            }
+        }
+
+        /**
+         * @brief Print a line of 16 bytes of memory
+         *
+         * @param stream The destination
+         * @param name The name of the core
+         * @param memory The address space of the core
+         * @param start The address of the first byte
+         */
+        void dumpMemory(std::ostream &stream, const char *name, const std::vector<uint8_t> &memory,
+                        const size_t start)
+        {
+            stream << name << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << start << ":";
+            for (size_t address = start; address < start + 16; address++)
+                stream << " " << std::setw(2) << +memory[address];
+            stream << std::dec << "\n";
+        }
+    } // namespace
+
+    LockstepResult runLockstep(Emulator &reference, Emulator &candidate, const Movie *movie, const uint32_t frames)
+    {
+        LockstepResult result;
+        RecordBuffer referenceTrace;
+        RecordBuffer candidateTrace;
+        reference.setTracer(&referenceTrace);
+        candidate.setTracer(&candidateTrace);
+
+        std::vector<uint8_t> referenceMemory(ADDRESS_SPACE);
+        std::vector<uint8_t> candidateMemory(ADDRESS_SPACE);
+        std::ostringstream report;
+        for (uint32_t frame = 0; frame < frames && !result.diverged && !result.error; frame++)
+        {
+            if (movie && frame < movie->getFrameCount())
+            {
+                reference.setInput(movie->getFrameInput(frame));
+                candidate.setInput(movie->getFrameInput(frame));
+            }
+
+            referenceTrace.records.clear();
+            candidateTrace.records.clear();
+            bool referenceRan = reference.runFrame();
+            bool candidateRan = candidate.runFrame();
+
+            // The state of the CPU before each instruction
+            const std::vector<TraceRecord> &expected = referenceTrace.records;
+            const std::vector<TraceRecord> &actual = candidateTrace.records;
+            size_t index = 0;
+            while (index < expected.size() && index < actual.size() && expected[index] == actual[index])
+                index++;
+            result.instructions += index;
+            if (index < expected.size() || index < actual.size())
+            {
+                result.diverged = true;
+                report << "Frame " << frame << ", instruction " << result.instructions << ": the CPUs differ\n";
+                for (size_t i = index > CONTEXT_RECORDS ? index - CONTEXT_RECORDS : 0; i < index; i++)
+                    report << "            " << formatTraceRecord(expected[i]) << "\n";
+                report << "reference:  " << (index < expected.size() ? formatTraceRecord(expected[index]) : "(end of the frame)") << "\n";
+                report << "candidate:  " << (index < actual.size() ? formatTraceRecord(actual[index]) : "(end of the frame)") << "\n";
+            }
+
+            if (referenceRan != candidateRan)
+            {
+                result.diverged = true;
+                report << "Frame " << frame << ": only the " << (referenceRan ? "candidate" : "reference")
+                       << " encountered an unexpected opcode\n";
+            }
+            else if (!referenceRan)
+            {
+                result.error = true;
+                break;
+            }
+
+            // The state at the end of the frame (e.g. the CPU halted during the whole frame)
+            TraceRecord referenceState = reference.getCPUState();
+            TraceRecord candidateState = candidate.getCPUState();
+            if (!result.diverged && referenceState != candidateState)
+            {
+                result.diverged = true;
+                report << "End of frame " << frame << ": the CPUs differ\n";
+                report << "reference:  " << formatTraceRecord(referenceState) << "\n";
+                report << "candidate:  " << formatTraceRecord(candidateState) << "\n";
+            }
+
+            readAddressSpace(reference, referenceMemory);
+            readAddressSpace(candidate, candidateMemory);
+            if (referenceMemory != candidateMemory)
+            {
+                size_t first = 0;
+                size_t count = 0;
+                for (size_t address = ADDRESS_SPACE; address-- > 0;)
+                {
+                    if (referenceMemory[address] != candidateMemory[address])
+                    {
+                        first = address;
+                        count++;
+                    }
+                }
+
+                result.diverged = true;
+                report << "End of frame " << frame << ": " << count << " bytes of memory differ, the first one at 0x"
+                       << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << first << std::dec << "\n";
+                dumpMemory(report, "reference:  ", referenceMemory, first & ~size_t(0xF));
+                dumpMemory(report, "candidate:  ", candidateMemory, first & ~size_t(0xF));
+            }
+
+            if (hashFrame(reference) != hashFrame(candidate))
+            {
+                result.diverged = true;
+                report << "End of frame " << frame << ": the frame buffers differ\n";
+            }
+
+            if (!result.diverged)
+                result.frames++;
+        }
+
+        reference.setTracer(nullptr);
+        candidate.setTracer(nullptr);
+        result.report = report.str();
+        return result;
+    }
+} // namespace gameboy
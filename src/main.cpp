@@ -1,8 +1,14 @@
+#include "disassembler.h" // disassembleFile
 #include "gb.h" // GB
+#include "profiler.h" // profiler::Session, GBEMU_PROFILE_THREAD
+#include "sm83_tests.h" // runSM83TestFiles
+#include "trace.h" // printTraceFile, diffTraceFiles
 
 #include <boost/program_options.hpp> // boost::program_options
 #include <iostream> // std::cout, std::endl
 #include <optional> // std::optional
+#include <string> // std::string
+#include <vector> // std::vector
 
 std::optional<boost::program_options::variables_map> handleArguments(int argc, char *argv[])
 {
@@ -13,7 +19,37 @@ std::optional<boost::program_options::variables_map> handleArguments(int argc, c
         ("help,h", "produce this help message")
         ("rom,r", po::value<std::string>(), "path to the ROM file")
         ("scale,s", po::value<int>()->default_value(1), "initial scale of the window (default: 1)")
-        ("maximize,m", "maximize the window on startup");
+        ("maximize,m", "maximize the window on startup")
+        ("vsync", "pace the frames with the display refresh rate instead of the timer")
+        ("stats", "show the frame time statistics on top of the screen")
+        ("input-mapping", po::value<std::string>(), "file containing the mapping of the keys and gamepad buttons")
+        ("latency", "measure the input-to-photon latency (printed at exit, and shown with --stats)")
+        ("audio", "play the sound")
+        ("audio-sync", "play the sound and pace the frames with the audio device instead of the timer")
+        ("link-listen", po::value<std::string>(), "wait for another emulator to connect with the link cable on this Unix socket")
+        ("link-connect", po::value<std::string>(), "connect with the link cable to another emulator waiting on this Unix socket")
+        ("run-ahead", po::value<int>()->default_value(0), "number of frames emulated ahead of the displayed one to reduce the input latency (default: 0)")
+        ("record", po::value<std::string>(), "record the inputs of each frame in a movie file (written at exit)")
+        ("play", po::value<std::string>(), "play a movie file without a window and print the hash of its frames")
+        ("hashes", po::value<std::string>(), "write the hash of each frame to a file (- for the standard output), without a window (the inputs are given by --play)")
+        ("hash-frames", po::value<uint32_t>()->default_value(0), "number of frames hashed with --hashes (default: the length of the movie, or 600)")
+        ("hash-interval", po::value<uint32_t>()->default_value(1), "hash one frame every N frames with --hashes (default: 1)")
+        ("verify-hashes", po::value<std::string>(), "check the hashes of the frames against a file written by --hashes, without a window (exit code 0 if they match)")
+        ("lockstep", po::value<uint32_t>(), "run a reference core and a candidate core side by side for N frames without a window (0: the length of the movie, or 600), and stop at the first divergence (exit code 0 if none; the inputs are given by --play)")
+        ("gdb", po::value<uint16_t>(), "wait for a debugger (GDB remote serial protocol) on this TCP port of 127.0.0.1, and run the ROM under its control without a window")
+        ("m-cycle", "emulate each memory access of the CPU at its machine cycle instead of at the start of the instruction (slower), also with --test, --play and --gdb")
+        ("test", "run a test ROM without a window until it prints its verdict on the serial port (exit code 0 if passed)")
+        ("max-cycles", po::value<uint64_t>()->default_value(1'000'000'000), "maximum number of cycles emulated with --test (default: 1000000000)")
+        ("sm83-tests", po::value<std::string>(), "run the SM83 single-step tests of a JSON file, or of all the JSON files of a directory (no ROM needed)")
+        ("profile", po::value<std::string>(), "write the durations of the emulation steps to a Chrome trace file (JSON), if built with the PROFILE option")
+        ("stats-file", po::value<std::string>(), "write the runtime statistics (speed, frame time percentiles, time emulating and sleeping) to a file as JSON lines, also with --play")
+        ("stats-interval", po::value<uint32_t>()->default_value(60), "number of frames between two lines of --stats-file (default: 60)")
+        ("trace", po::value<std::string>(), "write the state of the CPU before each instruction to a binary trace file, with --test or --play")
+        ("trace-print", po::value<std::string>(), "print the instructions of a trace file (no ROM needed)")
+        ("trace-diff", po::value<std::vector<std::string>>()->multitoken(), "print the first instruction that differs between two trace files (no ROM needed, exit code 0 if identical)")
+        ("disassemble", "print the instructions of the ROM, or with --hits only the executed ones and the hottest routines")
+        ("symbols", po::value<std::string>(), "RGBDS symbol file (.sym) whose names label the addresses printed by --disassemble")
+        ("hits", po::value<std::string>(), "trace file (see --trace) whose instructions are counted by --disassemble");
     po::positional_options_description p;
     p.add("rom", 1);
     p.add("scale", 2);
@@ -31,7 +67,12 @@ std::optional<boost::program_options::variables_map> handleArguments(int argc, c
         std::cout << desc << std::endl;
         return {};
     }
-    if (!vm.count("rom"))
+    if (vm.count("trace-diff") && vm["trace-diff"].as<std::vector<std::string>>().size() != 2)
+    {
+        std::cout << "--trace-diff needs two trace files" << std::endl;
+        return {};
+    }
+    if (!vm.count("rom") && !vm.count("sm83-tests") && !vm.count("trace-print") && !vm.count("trace-diff"))
     {
         std::cout << "No ROM file specified" << std::endl;
         return {};
@@ -41,6 +82,11 @@ std::optional<boost::program_options::variables_map> handleArguments(int argc, c
         std::cout << "Scale must be greater than 0" << std::endl;
         return {};
     }
+    if (vm["run-ahead"].as<int>() < 0)
+    {
+        std::cout << "Run-ahead must be greater than or equal to 0" << std::endl;
+        return {};
+    }
 
     return vm;
 }
@@ -51,12 +97,87 @@ int main(int argc, char *argv[])
     if (!vm)
         return 0;
 
-    auto scale = vm.value()["scale"].as<int>();
+    // Instrumentation of the whole run (the trace is written at exit)
+    std::string profile = vm->count("profile") ? vm.value()["profile"].as<std::string>() : "";
+#ifndef GBEMU_PROFILE
+    if (!profile.empty())
+        std::cout << "\x1B[33m!!!\033[0m The emulator has been built without the PROFILE option, the profile will be empty" << std::endl;
+#endif
+    gameboy::profiler::Session session(profile);
+    GBEMU_PROFILE_THREAD("main");
+
+    // CPU tests (no ROM)
+    if (vm->count("sm83-tests"))
+        return gameboy::runSM83TestFiles(vm.value()["sm83-tests"].as<std::string>());
+
+    // Trace tools (no ROM)
+    if (vm->count("trace-print"))
+        return gameboy::printTraceFile(vm.value()["trace-print"].as<std::string>(), std::cout);
+    if (vm->count("trace-diff"))
+    {
+        const auto &files = vm.value()["trace-diff"].as<std::vector<std::string>>();
+        return gameboy::diffTraceFiles(files[0], files[1]);
+    }
+
     auto rom = vm.value()["rom"].as<std::string>();
-    bool maximize = vm->count("maximize") > 0;
+
+    // Disassembly (no emulation)
+    if (vm->count("disassemble"))
+        return gameboy::disassembleFile(rom, vm->count("symbols") ? vm.value()["symbols"].as<std::string>() : "",
+                                        vm->count("hits") ? vm.value()["hits"].as<std::string>() : "", std::cout);
+
+    std::string trace = vm->count("trace") ? vm.value()["trace"].as<std::string>() : "";
+    std::string statsFile = vm->count("stats-file") ? vm.value()["stats-file"].as<std::string>() : "";
+    uint32_t statsInterval = vm.value()["stats-interval"].as<uint32_t>();
+    gameboy::Accuracy accuracy = vm->count("m-cycle") ? gameboy::Accuracy::MACHINE_CYCLE : gameboy::Accuracy::INSTRUCTION;
+
+    // Headless test mode
+    if (vm->count("test"))
+        return gameboy::GB::runTest(rom, vm.value()["max-cycles"].as<uint64_t>(), trace, accuracy);
+
+    // Headless debugging session
+    if (vm->count("gdb"))
+        return gameboy::GB::runDebugger(rom, vm.value()["gdb"].as<uint16_t>(), accuracy);
+
+    // Headless differential execution (the movie, if any, gives the inputs)
+    std::string movie = vm->count("play") ? vm.value()["play"].as<std::string>() : "";
+    if (vm->count("lockstep"))
+        return gameboy::GB::runLockstep(rom, movie, vm.value()["lockstep"].as<uint32_t>());
+
+    // Headless frame hashes (the movie, if any, gives the inputs)
+    if (vm->count("verify-hashes"))
+        return gameboy::GB::verifyFrameHashes(rom, movie, vm.value()["verify-hashes"].as<std::string>());
+    if (vm->count("hashes"))
+        return gameboy::GB::printFrameHashes(rom, movie, vm.value()["hash-frames"].as<uint32_t>(),
+                                             vm.value()["hash-interval"].as<uint32_t>(), vm.value()["hashes"].as<std::string>());
+
+    // Headless movie playback
+    if (vm->count("play"))
+        return gameboy::GB::playMovie(rom, vm.value()["play"].as<std::string>(), trace, statsFile, statsInterval, accuracy);
+
+    gameboy::GBOptions options;
+    options.scale = vm.value()["scale"].as<int>();
+    options.maximize = vm->count("maximize") > 0;
+    options.vsync = vm->count("vsync") > 0;
+    options.showStats = vm->count("stats") > 0;
+    if (vm->count("input-mapping"))
+        options.inputMappingFile = vm.value()["input-mapping"].as<std::string>();
+    options.measureLatency = vm->count("latency") > 0;
+    options.runAhead = vm.value()["run-ahead"].as<int>();
+    options.audio = vm->count("audio") > 0;
+    options.audioSync = vm->count("audio-sync") > 0;
+    if (vm->count("link-listen"))
+        options.linkListen = vm.value()["link-listen"].as<std::string>();
+    if (vm->count("link-connect"))
+        options.linkConnect = vm.value()["link-connect"].as<std::string>();
+    if (vm->count("record"))
+        options.recordFile = vm.value()["record"].as<std::string>();
+    options.statsFile = statsFile;
+    options.statsInterval = statsInterval;
+    options.accuracy = accuracy;
 
     // Run the emulator
-    gameboy::GB gameboy(scale, maximize);
+    gameboy::GB gameboy(options);
     if (gameboy.run(rom) == 1)
         return 1; // An error occurred
     return 0;
@@ -4,6 +4,7 @@
  */
 
 #include "mbc.h" // MBC
+#include "profiler.h" // GBEMU_PROFILE_SCOPE
 
 #include <fstream> // std::ofstream
 #include <iostream> // std::cout
@@ -22,11 +23,51 @@ namespace gameboy
         if (m_ram.empty())
             return;
 
+        GBEMU_PROFILE_SCOPE("MBC::saveRAMData");
         std::ofstream ramFile(filename);
         std::copy(m_ram.begin(), m_ram.end(), std::ostreambuf_iterator<char>(ramFile));
         ramFile.close();
     }
 
+    void MBC::saveState(StateWriter &writer) const
+    {
+        writer.write(static_cast<uint32_t>(m_ram.size()));
+        writer.writeBytes(m_ram.data(), m_ram.size());
+    }
+
+    void MBC::loadState(StateReader &reader)
+    {
+        // The RAM of the state must have the size of the RAM of the cartridge
+        uint32_t ramSize = 0;
+        reader.read(ramSize);
+        if (ramSize != m_ram.size())
+        {
+            reader.invalidate();
+            return;
+        }
+        reader.readBytes(m_ram.data(), m_ram.size());
+    }
+
+    uint8_t MBC::readROM(const size_t offset) const
+    {
+        if (m_rom.empty())
+            return 0xFF;
+        return m_rom[offset % m_rom.size()];
+    }
+
+    uint8_t MBC::readRAM(const size_t offset) const
+    {
+        if (m_ram.empty())
+            return 0xFF;
+        return m_ram[offset % m_ram.size()];
+    }
+
+    void MBC::writeRAM(const size_t offset, const uint8_t value)
+    {
+        if (!m_ram.empty())
+            m_ram[offset % m_ram.size()] = value;
+    }
+
     ROMOnly::ROMOnly(std::vector<uint8_t> rom, std::vector<uint8_t> ram)
         : MBC(std::move(rom), std::move(ram)) {}
 
@@ -34,7 +75,7 @@ namespace gameboy
     {
         // Check if the address is in the ROM
         if (address < 0x8000)
-            return m_rom[address];
+            return readROM(address);
         return 0;
     }
 
@@ -51,7 +92,7 @@ namespace gameboy
     {
         if (address <= 0x3FFF) // https://gbdev.io/pandocs/MBC1.html#00003fff--rom-bank-x0-read-only
         {
-            return m_rom[address];
+            return readROM(address);
         }
         else if (address <= 0x7FFF) // https://gbdev.io/pandocs/MBC1.html#40007fff--rom-bank-01-7f-read-only
         {
@@ -110,25 +151,43 @@ namespace gameboy
         }
     }
 
+    void MBC1::saveState(StateWriter &writer) const
+    {
+        MBC::saveState(writer);
+        writer.write(m_ramEnabled);
+        writer.write(m_romBank);
+        writer.write(m_ramBank);
+        writer.write(m_mode);
+    }
+
+    void MBC1::loadState(StateReader &reader)
+    {
+        MBC::loadState(reader);
+        reader.read(m_ramEnabled);
+        reader.read(m_romBank);
+        reader.read(m_ramBank);
+        reader.read(m_mode);
+    }
+
     uint8_t MBC1::readROMBank(uint16_t address) const
     {
         auto relativeAddress = address - 0x4000;
         auto bankAddress = m_romBank * 0x4000;
-        return m_rom[bankAddress + relativeAddress];
+        return readROM(bankAddress + relativeAddress);
     }
 
     uint8_t MBC1::readRAMBank(uint16_t address) const
     {
         auto relativeAddress = address - 0xA000;
         auto bankAddress = m_ramBank * 0x2000;
-        return m_ram[bankAddress + relativeAddress];
+        return readRAM(bankAddress + relativeAddress);
     }
 
     void MBC1::writeRAMBank(uint16_t address, uint8_t value)
     {
         auto relativeAddress = address - 0xA000;
         auto bankAddress = m_ramBank * 0x2000;
-        m_ram[bankAddress + relativeAddress] = value;
+        writeRAM(bankAddress + relativeAddress, value);
     }
 
     MBC2::MBC2(std::vector<uint8_t> rom, std::vector<uint8_t> ram)
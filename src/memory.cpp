@@ -4,6 +4,9 @@
  */
 
 #include "memory.h" // Memory
+#include "apu.h" // APU
+#include "ppu.h" // ppu_registers::LY_REG_ADDRESS
+#include "timer.h" // Timer
 
 #include <iostream> // std::cout
 
@@ -69,6 +72,14 @@ namespace gameboy
         else if (address >= 0xFEA0 && address < 0xFF00)
             logInvalidReadOperation(address, "Unusable memory");
 
+        // Sound registers
+        else if (m_apu && address >= apu_registers::FIRST_REGISTER_ADDRESS && address <= apu_registers::LAST_REGISTER_ADDRESS)
+            return m_apu->readRegister(address);
+
+        // Timer registers
+        else if (m_timer && address >= timer_registers::DIV_REG_ADDRESS && address <= timer_registers::TAC_REG_ADDRESS)
+            return m_timer->readRegister(address);
+
         // Joypad
         else if (address == JOYPAD_ADDRESS)
         {
@@ -102,6 +113,10 @@ namespace gameboy
             else if (address >= 0xFEA0 && address < 0xFF00)
                 logInvalidWriteOperation(address, value, "Unusable memory");
 
+            // LY is read-only (only the PPU changes it, and it renders the scanline LY)
+            else if (address == ppu_registers::LY_REG_ADDRESS)
+                return;
+
             // Valid address, write the value to the memory
             else
                 m_memory[address] = value;
@@ -127,6 +142,14 @@ namespace gameboy
                 }
             }
 
+            // Sound registers
+            else if (m_apu && address >= apu_registers::FIRST_REGISTER_ADDRESS && address <= apu_registers::LAST_REGISTER_ADDRESS)
+                m_apu->writeRegister(address, value);
+
+            // Timer registers
+            else if (m_timer && address >= timer_registers::DIV_REG_ADDRESS && address <= timer_registers::TAC_REG_ADDRESS)
+                m_timer->writeRegister(address, value);
+
             // Update colour palette
             else if (address == 0xFF47)
                 UpdatePalette(m_paletteBGP, value); // BG and Window palette
@@ -168,6 +191,36 @@ namespace gameboy
         return m_memory[address];
     }
 
+    void Memory::setAPU(APU *apu)
+    {
+        m_apu = apu;
+    }
+
+    void Memory::setTimer(Timer *timer)
+    {
+        m_timer = timer;
+    }
+
+    void Memory::saveState(StateWriter &writer) const
+    {
+        writer.writeBytes(&m_memory[0x8000], 0x2000); // VRAM
+        writer.writeBytes(&m_memory[0xC000], 0x4000); // WRAM, Echo RAM, OAM, I/O registers, HRAM, IE
+        writer.write(m_paletteBGP);
+        writer.write(m_paletteOBP0);
+        writer.write(m_paletteOBP1);
+        writer.write(m_joypadState);
+    }
+
+    void Memory::loadState(StateReader &reader)
+    {
+        reader.readBytes(&m_memory[0x8000], 0x2000); // VRAM
+        reader.readBytes(&m_memory[0xC000], 0x4000); // WRAM, Echo RAM, OAM, I/O registers, HRAM, IE
+        reader.read(m_paletteBGP);
+        reader.read(m_paletteOBP0);
+        reader.read(m_paletteOBP1);
+        reader.read(m_joypadState);
+    }
+
     void Memory::logInvalidWriteOperation(uint16_t address, uint8_t value, const std::string &memorySection)
     {
         std::cout << std::hex << "\x1B[33m!!!\033[0m " << "Writing value 0x" << +value << " to address 0x" << address << " (" << memorySection << ")\n";
@@ -0,0 +1,128 @@
+#include "movie.h" // Movie
+#include "profiler.h" // GBEMU_PROFILE_SCOPE
+
+#include <fstream> // std::ifstream, std::ofstream
+#include <iostream> // std::cout, std::endl
+#include <iterator> // std::istreambuf_iterator
+#include <utility> // std::move
+
+namespace gameboy
+{
+    Movie::Movie(const uint64_t romHash)
+        : m_romHash(romHash)
+    {}
+
+    void Movie::setStartState(std::vector<uint8_t> state)
+    {
+        m_startState = std::move(state);
+    }
+
+    void Movie::addFrame(const uint8_t input)
+    {
+        m_inputs.push_back(input);
+    }
+
+    size_t Movie::getFrameCount() const
+    {
+        return m_inputs.size();
+    }
+
+    uint8_t Movie::getFrameInput(const size_t frame) const
+    {
+        return m_inputs[frame];
+    }
+
+    uint64_t Movie::getROMHash() const
+    {
+        return m_romHash;
+    }
+
+    bool Movie::start(Emulator &emulator) const
+    {
+        if (emulator.getROMHash() != m_romHash)
+        {
+            std::cout << "\x1B[31mError!\033[0m The movie has been recorded with another ROM" << std::endl;
+            return false;
+        }
+
+        if (!m_startState.empty() && !emulator.loadState(m_startState))
+        {
+            std::cout << "\x1B[31mError!\033[0m The start state of the movie is not valid" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Movie::saveToFile(const std::string &filename) const
+    {
+        GBEMU_PROFILE_SCOPE("Movie::saveToFile");
+        std::vector<uint8_t> buffer;
+        StateWriter writer(buffer);
+        writer.write(MAGIC);
+        writer.write(VERSION);
+        writer.write(m_romHash);
+        writer.write(static_cast<uint32_t>(m_startState.size()));
+        writer.writeBytes(m_startState.data(), m_startState.size());
+        writer.write(static_cast<uint32_t>(m_inputs.size()));
+        writer.writeBytes(m_inputs.data(), m_inputs.size());
+
+        std::ofstream file(filename, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        if (!file)
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not write the movie file " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool Movie::loadFromFile(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Could not open the movie file " << filename << std::endl;
+            return false;
+        }
+        std::vector<uint8_t> buffer(std::istreambuf_iterator<char>(file), {});
+
+        StateReader reader(buffer);
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        reader.read(magic);
+        reader.read(version);
+        if (!reader.isValid() || magic != MAGIC || version != VERSION)
+        {
+            std::cout << "\x1B[31mError!\033[0m " << filename << " is not a movie file (or its version is not supported)" << std::endl;
+            return false;
+        }
+
+        uint64_t romHash = 0;
+        uint32_t stateSize = 0;
+        reader.read(romHash);
+        reader.read(stateSize);
+        std::vector<uint8_t> startState(stateSize <= buffer.size() ? stateSize : 0);
+        if (startState.size() != stateSize)
+            reader.invalidate();
+        reader.readBytes(startState.data(), startState.size());
+
+        uint32_t frames = 0;
+        reader.read(frames);
+        std::vector<uint8_t> inputs(frames <= buffer.size() ? frames : 0);
+        if (inputs.size() != frames)
+            reader.invalidate();
+        reader.readBytes(inputs.data(), inputs.size());
+
+        if (!reader.isValid())
+        {
+            std::cout << "\x1B[31mError!\033[0m The movie file " << filename << " is truncated" << std::endl;
+            return false;
+        }
+
+        m_romHash = romHash;
+        m_startState = std::move(startState);
+        m_inputs = std::move(inputs);
+        return true;
+    }
+} // namespace gameboy
@@ -0,0 +1,96 @@
+/**
+ * @file overlay_font.h
+ * @brief This file contains a tiny 3x5 bitmap font used to draw the overlay on top of the screen.
+ */
+
+#pragma once
+
+#include <cstdint> // uint8_t
+
+namespace gameboy::overlay_font
+{
+    constexpr int GLYPH_WIDTH = 3; ///< The width of a glyph in pixels
+    constexpr int GLYPH_HEIGHT = 5; ///< The height of a glyph in pixels
+
+    // clang-format off
+    /*
+     * Each glyph is made of 5 rows of 3 bits (bit 2 is the leftmost pixel)
+     */
+    constexpr uint8_t DIGITS[10][GLYPH_HEIGHT] =
+    {
+        {7, 5, 5, 5, 7}, // 0
+        {2, 6, 2, 2, 7}, // 1
+        {7, 1, 7, 4, 7}, // 2
+        {7, 1, 7, 1, 7}, // 3
+        {5, 5, 7, 1, 1}, // 4
+        {7, 4, 7, 1, 7}, // 5
+        {7, 4, 7, 5, 7}, // 6
+        {7, 1, 1, 1, 1}, // 7
+        {7, 5, 7, 5, 7}, // 8
+        {7, 5, 7, 1, 7}, // 9
+    }; ///< The glyphs of the digits
+
+    constexpr uint8_t LETTERS[26][GLYPH_HEIGHT] =
+    {
+        {2, 5, 7, 5, 5}, // A
+        {6, 5, 6, 5, 6}, // B
+        {3, 4, 4, 4, 3}, // C
+        {6, 5, 5, 5, 6}, // D
+        {7, 4, 6, 4, 7}, // E
+        {7, 4, 6, 4, 4}, // F
+        {3, 4, 5, 5, 3}, // G
+        {5, 5, 7, 5, 5}, // H
+        {7, 2, 2, 2, 7}, // I
+        {1, 1, 1, 5, 2}, // J
+        {5, 5, 6, 5, 5}, // K
+        {4, 4, 4, 4, 7}, // L
+        {5, 7, 7, 5, 5}, // M
+        {6, 5, 5, 5, 5}, // N
+        {2, 5, 5, 5, 2}, // O
+        {6, 5, 6, 4, 4}, // P
+        {2, 5, 5, 6, 3}, // Q
+        {6, 5, 6, 5, 5}, // R
+        {3, 4, 2, 1, 6}, // S
+        {7, 2, 2, 2, 2}, // T
+        {5, 5, 5, 5, 7}, // U
+        {5, 5, 5, 5, 2}, // V
+        {5, 5, 7, 7, 5}, // W
+        {5, 5, 2, 5, 5}, // X
+        {5, 5, 2, 2, 2}, // Y
+        {7, 1, 2, 4, 7}, // Z
+    }; ///< The glyphs of the letters (lower case letters are drawn as upper case letters)
+
+    constexpr uint8_t DOT[GLYPH_HEIGHT] = {0, 0, 0, 0, 2}; ///< The glyph of '.'
+    constexpr uint8_t COLON[GLYPH_HEIGHT] = {0, 2, 0, 2, 0}; ///< The glyph of ':'
+    constexpr uint8_t MINUS[GLYPH_HEIGHT] = {0, 0, 7, 0, 0}; ///< The glyph of '-'
+    constexpr uint8_t SLASH[GLYPH_HEIGHT] = {1, 1, 2, 4, 4}; ///< The glyph of '/'
+    constexpr uint8_t PERCENT[GLYPH_HEIGHT] = {5, 1, 2, 4, 5}; ///< The glyph of '%'
+    constexpr uint8_t SPACE[GLYPH_HEIGHT] = {0, 0, 0, 0, 0}; ///< The glyph of ' ' (and of the unknown characters)
+    // clang-format on
+
+    /**
+     * @brief Get the glyph of a character
+     *
+     * @param c The character
+     * @return The 5 rows of the glyph
+     */
+    constexpr const uint8_t *getGlyph(const char c)
+    {
+        if (c >= '0' && c <= '9')
+            return DIGITS[c - '0'];
+        if (c >= 'A' && c <= 'Z')
+            return LETTERS[c - 'A'];
+        if (c >= 'a' && c <= 'z')
+            return LETTERS[c - 'a'];
+
+        switch (c)
+        {
+            case '.': return DOT;
+            case ':': return COLON;
+            case '-': return MINUS;
+            case '/': return SLASH;
+            case '%': return PERCENT;
+            default: return SPACE;
+        }
+    }
+} // namespace gameboy::overlay_font
@@ -0,0 +1,160 @@
+#include "perf_counters.h" // PerfCounters, PerfSample
+
+#include <cstring> // std::strerror
+#include <iostream> // std::cout, std::endl
+
+#ifdef __linux__
+#include <cerrno> // errno
+#include <linux/perf_event.h> // perf_event_attr, PERF_*
+#include <sys/ioctl.h> // ioctl
+#include <sys/syscall.h> // SYS_perf_event_open
+#include <unistd.h> // syscall, read, close
+#endif
+
+namespace gameboy
+{
+    uint64_t PerfSample::operator[](const PerfEvent event) const
+    {
+        return values[static_cast<size_t>(event)];
+    }
+
+    PerfSample &PerfSample::operator+=(const PerfSample &other)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+            values[i] += other.values[i];
+        return *this;
+    }
+
+    PerfSample &PerfSample::operator-=(const PerfSample &other)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+            values[i] -= other.values[i];
+        return *this;
+    }
+
+    PerfSample operator+(PerfSample a, const PerfSample &b)
+    {
+        return a += b;
+    }
+
+    PerfSample operator-(PerfSample a, const PerfSample &b)
+    {
+        return a -= b;
+    }
+
+    PerfCounters::~PerfCounters()
+    {
+#ifdef __linux__
+        // The leader is closed last, after the other events of its group
+        for (size_t i = EVENTS; i-- > 0;)
+        {
+            if (m_fds[i] >= 0)
+                close(m_fds[i]);
+        }
+#endif
+    }
+
+    bool PerfCounters::open()
+    {
+        if (isOpen())
+            return true;
+
+#ifdef __linux__
+        constexpr uint64_t configs[EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                              PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+
+        for (size_t i = 0; i < EVENTS; i++)
+        {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = m_leader < 0; // The whole group is started by the leader
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            // The calling thread (pid 0) on any CPU (-1)
+            auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0));
+            if (fd < 0)
+            {
+                if (m_leader < 0)
+                {
+                    // ENOENT: the host has no hardware counters (e.g. a virtual machine), EACCES/EPERM: not allowed
+                    const char *hint = (errno == ENOENT || errno == EOPNOTSUPP) ? " (no counters on this host)"
+                                                                                : " (see /proc/sys/kernel/perf_event_paranoid)";
+                    std::cout << "\x1B[31mError!\033[0m Cannot open the hardware performance counters: "
+                              << std::strerror(errno) << hint << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            if (m_leader < 0)
+                m_leader = fd;
+            m_fds[i] = fd;
+            m_slots[i] = m_opened++;
+        }
+
+        ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+#else
+        std::cout << "\x1B[31mError!\033[0m The hardware performance counters are only available on Linux" << std::endl;
+        return false;
+#endif
+    }
+
+    bool PerfCounters::isOpen() const
+    {
+        return m_leader >= 0;
+    }
+
+    bool PerfCounters::isAvailable(const PerfEvent event) const
+    {
+        return m_fds[static_cast<size_t>(event)] >= 0;
+    }
+
+    PerfSample PerfCounters::read() const
+    {
+        PerfSample sample;
+#ifdef __linux__
+        if (!isOpen())
+            return sample;
+
+        // PERF_FORMAT_GROUP: the number of events, then the value of each event in the order they were opened
+        uint64_t buffer[1 + EVENTS];
+        if (::read(m_leader, buffer, sizeof(buffer)) < static_cast<ssize_t>((1 + m_opened) * sizeof(uint64_t)))
+            return sample;
+
+        for (size_t i = 0; i < EVENTS; i++)
+        {
+            if (m_fds[i] >= 0)
+                sample.values[i] = buffer[1 + m_slots[i]];
+        }
+#endif
+        return sample;
+    }
+
+    void PerfCounters::add(const PerfSubsystem subsystem, const PerfSample &sample)
+    {
+        m_totals[static_cast<size_t>(subsystem)] += sample;
+        m_counts[static_cast<size_t>(subsystem)]++;
+    }
+
+    const PerfSample &PerfCounters::getTotal(const PerfSubsystem subsystem) const
+    {
+        return m_totals[static_cast<size_t>(subsystem)];
+    }
+
+    uint64_t PerfCounters::getCount(const PerfSubsystem subsystem) const
+    {
+        return m_counts[static_cast<size_t>(subsystem)];
+    }
+
+    void PerfCounters::reset()
+    {
+        m_totals = {};
+        m_counts = {};
+    }
+} // namespace gameboy
@@ -1,12 +1,18 @@
 #include "platform.h" // Platform
+#include "overlay_font.h" // overlay_font::getGlyph
 #include "ppu.h" // SCREEN_WIDTH, SCREEN_HEIGHT
+#include "profiler.h" // GBEMU_PROFILE_SCOPE
+
+#include <algorithm> // std::fill, std::max
 #include <iostream>
+#include <utility> // std::move
+#include <vector> // std::vector
 
 namespace gameboy
 {
-    Platform::Platform(const int scale, const bool maximize)
+    Platform::Platform(const int scale, const bool maximize, const bool vsync)
     {
-        SDL_Init(SDL_INIT_VIDEO);
+        SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER);
 
         window = SDL_CreateWindow("GBEmu",
                                   SDL_WINDOWPOS_CENTERED,
@@ -17,7 +23,7 @@ namespace gameboy
         if (maximize)
             SDL_MaximizeWindow(window);
 
-        renderer = SDL_CreateRenderer(window, -1, 0);
+        renderer = SDL_CreateRenderer(window, -1, vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
         SDL_RenderSetLogicalSize(renderer, screen_size::SCREEN_WIDTH, screen_size::SCREEN_HEIGHT);
 
         texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, screen_size::SCREEN_WIDTH, screen_size::SCREEN_HEIGHT);
@@ -25,6 +31,10 @@ namespace gameboy
 
     Platform::~Platform()
     {
+        if (m_audioDevice != 0)
+            SDL_CloseAudioDevice(m_audioDevice);
+        for (auto &[id, gamepad] : m_gamepads)
+            SDL_GameControllerClose(gamepad);
         SDL_DestroyTexture(texture);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
@@ -33,49 +43,199 @@ namespace gameboy
 
     void Platform::update(const void *buffer)
     {
+        GBEMU_PROFILE_SCOPE("Platform::update");
         SDL_RenderClear(renderer);
         SDL_UpdateTexture(texture, nullptr, buffer, screen_size::SCREEN_WIDTH * 4);
         SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+        if (!m_overlayText.empty())
+            drawOverlay();
         SDL_RenderPresent(renderer);
     }
 
+    void Platform::setOverlayText(const std::string &text)
+    {
+        m_overlayText = text;
+    }
+
+    void Platform::drawOverlay()
+    {
+        constexpr int charWidth = overlay_font::GLYPH_WIDTH + 1;
+        constexpr int lineHeight = overlay_font::GLYPH_HEIGHT + 1;
+
+        // Collect all the pixels of the text, so that they can be drawn with a single call
+        std::vector<SDL_Rect> pixels;
+        int lines = 0;
+        int columns = 0;
+        int column = 0;
+        for (char c : m_overlayText)
+        {
+            if (c == '\n')
+            {
+                lines++;
+                column = 0;
+                continue;
+            }
+
+            const uint8_t *glyph = overlay_font::getGlyph(c);
+            for (int row = 0; row < overlay_font::GLYPH_HEIGHT; row++)
+                for (int bit = 0; bit < overlay_font::GLYPH_WIDTH; bit++)
+                    if (glyph[row] & (0x04 >> bit))
+                        pixels.push_back({1 + column * charWidth + bit, 1 + lines * lineHeight + row, 1, 1});
+
+            column++;
+            columns = std::max(columns, column);
+        }
+        if (column > 0)
+            lines++;
+
+        // Translucent background
+        SDL_Rect background = {0, 0, columns * charWidth + 1, lines * lineHeight + 1};
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+        SDL_RenderFillRect(renderer, &background);
+
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderFillRects(renderer, pixels.data(), static_cast<int>(pixels.size()));
+    }
+
+    void Platform::setInputMapping(InputMapping mapping)
+    {
+        m_inputMapping = std::move(mapping);
+    }
+
     bool Platform::processInput(Input &input)
     {
+        m_firstPressTime.reset();
+        bool running = true;
+
+        // The buttons tapped during the last call have been pressed for a frame
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            if (m_tappedButtons & (1 << bit))
+                input.setButton(static_cast<JoypadButton>(1 << bit), false);
+        }
+        m_tappedButtons = 0;
+        m_pressedButtons = 0;
+
         SDL_Event event;
-        SDL_PollEvent(&event);
-        switch (event.type)
+        while (SDL_PollEvent(&event))
         {
-            case SDL_KEYDOWN: // Key pressed
-                switch (event.key.keysym.sym)
-                {
-                    case SDLK_a: input.setButton(JoypadButton::BUTTON_A, true); break;
-                    case SDLK_s: input.setButton(JoypadButton::BUTTON_B, true); break;
-                    case SDLK_RETURN: input.setButton(JoypadButton::BUTTON_SELECT, true); break;
-                    case SDLK_SPACE: input.setButton(JoypadButton::BUTTON_START, true); break;
-                    case SDLK_RIGHT: input.setButton(JoypadButton::DIRECTION_RIGHT, true); break;
-                    case SDLK_LEFT: input.setButton(JoypadButton::DIRECTION_LEFT, true); break;
-                    case SDLK_UP: input.setButton(JoypadButton::DIRECTION_UP, true); break;
-                    case SDLK_DOWN: input.setButton(JoypadButton::DIRECTION_DOWN, true); break;
-                }
-                break;
-            case SDL_KEYUP: // Key released
-                switch (event.key.keysym.sym)
-                {
-                    case SDLK_a: input.setButton(JoypadButton::BUTTON_A, false); break;
-                    case SDLK_s: input.setButton(JoypadButton::BUTTON_B, false); break;
-                    case SDLK_RETURN: input.setButton(JoypadButton::BUTTON_SELECT, false); break;
-                    case SDLK_SPACE: input.setButton(JoypadButton::BUTTON_START, false); break;
-                    case SDLK_RIGHT: input.setButton(JoypadButton::DIRECTION_RIGHT, false); break;
-                    case SDLK_LEFT: input.setButton(JoypadButton::DIRECTION_LEFT, false); break;
-                    case SDLK_UP: input.setButton(JoypadButton::DIRECTION_UP, false); break;
-                    case SDLK_DOWN: input.setButton(JoypadButton::DIRECTION_DOWN, false); break;
-                }
-                break;
-            case SDL_QUIT:
-                return false;
+            switch (event.type)
+            {
+                case SDL_KEYDOWN: // Key pressed
+                case SDL_KEYUP: // Key released
+                    // Ignore the events generated by the key repeat
+                    if (event.key.repeat == 0)
+                        handleButton(input, m_inputMapping.getKeyButton(event.key.keysym.sym), event.type == SDL_KEYDOWN, event.key.timestamp);
+                    break;
+                case SDL_CONTROLLERBUTTONDOWN: // Gamepad button pressed
+                case SDL_CONTROLLERBUTTONUP: // Gamepad button released
+                    handleButton(input, m_inputMapping.getGamepadButton(event.cbutton.button), event.type == SDL_CONTROLLERBUTTONDOWN, event.cbutton.timestamp);
+                    break;
+                case SDL_CONTROLLERDEVICEADDED: // Gamepad connected (also sent for the gamepads connected at startup)
+                    if (SDL_GameController *gamepad = SDL_GameControllerOpen(event.cdevice.which))
+                        m_gamepads[SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(gamepad))] = gamepad;
+                    break;
+                case SDL_CONTROLLERDEVICEREMOVED: // Gamepad disconnected
+                    if (auto it = m_gamepads.find(event.cdevice.which); it != m_gamepads.end())
+                    {
+                        SDL_GameControllerClose(it->second);
+                        m_gamepads.erase(it);
+                    }
+                    break;
+                case SDL_QUIT:
+                    running = false;
+                    break;
+            }
         }
 
         input.sendInterrupt();
+        return running;
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> Platform::getFirstPressTime() const
+    {
+        return m_firstPressTime;
+    }
+
+    void Platform::handleButton(Input &input, const std::optional<JoypadButton> button, const bool pressed, const uint32_t timestamp)
+    {
+        if (!button)
+            return;
+
+        auto bit = static_cast<uint8_t>(*button);
+        if (pressed)
+        {
+            m_pressedButtons |= bit;
+            m_tappedButtons &= ~bit;
+        }
+        else if (m_pressedButtons & bit)
+        {
+            // Pressed and released before the game has run: release it at the next call
+            m_tappedButtons |= bit;
+            return;
+        }
+        input.setButton(*button, pressed);
+
+        if (pressed && !m_firstPressTime)
+        {
+            // Convert the timestamp of the event to the steady clock
+            uint32_t age = SDL_GetTicks() - timestamp;
+            m_firstPressTime = std::chrono::steady_clock::now() - std::chrono::milliseconds(age);
+        }
+    }
+
+    bool Platform::openAudio(const int sampleRate)
+    {
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+        {
+            std::cout << "\x1B[33m!!!\033[0m Could not initialize the audio: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        m_audioBuffer = std::make_unique<RingBuffer<int16_t>>(AUDIO_BUFFER_SAMPLES);
+
+        SDL_AudioSpec desired{};
+        desired.freq = sampleRate;
+        desired.format = AUDIO_S16SYS;
+        desired.channels = 2;
+        desired.samples = AUDIO_DEVICE_SAMPLES;
+        desired.callback = audioCallback;
+        desired.userdata = this;
+
+        SDL_AudioSpec obtained{};
+        m_audioDevice = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+        if (m_audioDevice == 0)
+        {
+            std::cout << "\x1B[33m!!!\033[0m Could not open the audio device: " << SDL_GetError() << std::endl;
+            m_audioBuffer.reset();
+            return false;
+        }
+
+        m_audioSampleRate = obtained.freq;
+        SDL_PauseAudioDevice(m_audioDevice, 0);
         return true;
     }
+
+    RingBuffer<int16_t> *Platform::getAudioBuffer()
+    {
+        return m_audioBuffer.get();
+    }
+
+    int Platform::getAudioSampleRate() const
+    {
+        return m_audioSampleRate;
+    }
+
+    void Platform::audioCallback(void *userdata, Uint8 *stream, const int length)
+    {
+        GBEMU_PROFILE_SCOPE("Platform::audioCallback");
+        auto *platform = static_cast<Platform *>(userdata);
+        auto *samples = reinterpret_cast<int16_t *>(stream);
+        size_t count = static_cast<size_t>(length) / sizeof(int16_t);
+
+        // Underrun: play silence instead of the missing samples
+        size_t read = platform->m_audioBuffer->pop(samples, count);
+        std::fill(samples + read, samples + count, 0);
+    }
 } // namespace gameboy
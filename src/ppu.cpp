@@ -6,6 +6,7 @@
  */
 
 #include "ppu.h" // PPU
+#include "profiler.h" // GBEMU_PROFILE_SCOPE
 
 #include <any> // std::any
 
@@ -153,6 +154,11 @@ namespace gameboy
         return m_frameBuffer.data();
     }
 
+    const Colour *PPU::getFrameBuffer() const
+    {
+        return m_frameBuffer.data();
+    }
+
     bool PPU::isRenderingEnabled() const
     {
         return m_renderingEnabled;
@@ -163,6 +169,32 @@ namespace gameboy
         m_renderingEnabled = enabled;
     }
 
+    void PPU::setSkipRendering(bool skip)
+    {
+        m_skipRendering = skip;
+    }
+
+    void PPU::setPerfCounters(PerfCounters *counters)
+    {
+        m_perfCounters = counters;
+    }
+
+    void PPU::saveState(StateWriter &writer) const
+    {
+        writer.writeBytes(m_frameBuffer.data(), screen_size::SCREEN_WIDTH * screen_size::SCREEN_HEIGHT * sizeof(Colour));
+        writer.write(m_renderingEnabled);
+        writer.write(m_cycles);
+        writer.write(m_mode);
+    }
+
+    void PPU::loadState(StateReader &reader)
+    {
+        reader.readBytes(m_frameBuffer.data(), screen_size::SCREEN_WIDTH * screen_size::SCREEN_HEIGHT * sizeof(Colour));
+        reader.read(m_renderingEnabled);
+        reader.read(m_cycles);
+        reader.read(m_mode);
+    }
+
     void PPU::setCoincidenceFlag()
     {
         uint8_t lyc = m_memory.read(ppu_registers::LYC_REG_ADDRESS);
@@ -187,12 +219,20 @@ namespace gameboy
 
     void PPU::draw()
     {
-        // Render only if the LCD is enabled (bit 7 of the LCDC register)
-        if (*m_lcdc & 0x80)
+        GBEMU_PROFILE_SCOPE("PPU::draw");
+        // Render only if the LCD is enabled (bit 7 of the LCDC register) and the frame will be displayed
+        if ((*m_lcdc & 0x80) && !m_skipRendering)
         {
+            PerfSample start;
+            if (m_perfCounters)
+                start = m_perfCounters->read();
+
             renderBackground();
             renderWindow();
             renderSprites();
+
+            if (m_perfCounters)
+                m_perfCounters->add(PerfSubsystem::PPU_RENDERING, m_perfCounters->read() - start);
         }
     }
 
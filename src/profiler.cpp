@@ -0,0 +1,193 @@
+#include "profiler.h" // profiler::start, profiler::stop, profiler::Scope
+
+#include <atomic> // std::atomic
+#include <cstdint> // uint32_t
+#include <fstream> // std::ofstream
+#include <iomanip> // std::fixed, std::setprecision
+#include <iostream> // std::cout, std::endl
+#include <memory> // std::unique_ptr
+#include <mutex> // std::mutex, std::lock_guard
+#include <vector> // std::vector
+
+namespace gameboy
+{
+    namespace profiler
+    {
+        namespace
+        {
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * @brief A complete event (a scope that has been left)
+             */
+            struct Event
+            {
+                const char *name; ///< The name of the scope
+                Clock::time_point start; ///< The time at which the scope has been entered
+                Clock::time_point end; ///< The time at which the scope has been left
+            };
+
+            /**
+             * @brief The events of a thread
+             * @details The mutex is only taken by the thread itself and by stop, so it is never contended while recording
+             */
+            struct ThreadBuffer
+            {
+                uint32_t id; ///< The identifier of the thread in the trace
+                const char *name = nullptr; ///< The name of the thread (nullptr if not named)
+                std::vector<Event> events; ///< The events of the thread
+                std::mutex mutex; ///< Protects the events and the name
+            };
+
+            std::atomic<bool> s_recording{false}; ///< True between start and stop
+            std::mutex s_mutex; ///< Protects the list of buffers and the file name
+            std::vector<std::unique_ptr<ThreadBuffer>> s_buffers; ///< The buffers of all the threads (kept after the threads exit)
+            std::string s_filename; ///< The file in which the trace is written
+            Clock::time_point s_start; ///< The time of start (the origin of the timestamps)
+
+            /**
+             * @brief Get the buffer of the current thread (created and registered on the first call)
+             *
+             * @return The buffer
+             */
+            ThreadBuffer &threadBuffer()
+            {
+                thread_local ThreadBuffer *buffer = nullptr;
+                if (!buffer)
+                {
+                    std::lock_guard<std::mutex> lock(s_mutex);
+                    s_buffers.push_back(std::make_unique<ThreadBuffer>());
+                    buffer = s_buffers.back().get();
+                    buffer->id = static_cast<uint32_t>(s_buffers.size());
+                }
+                return *buffer;
+            }
+
+            /**
+             * @brief Write a string as a JSON string
+             *
+             * @param file The destination
+             * @param text The string
+             */
+            void writeString(std::ostream &file, const char *text)
+            {
+                file << '"';
+                for (; *text; text++)
+                {
+                    if (*text == '"' || *text == '\\')
+                        file << '\\';
+                    file << *text;
+                }
+                file << '"';
+            }
+        } // namespace
+
+        bool start(const std::string &filename)
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (s_recording)
+                return false;
+
+            for (auto &buffer : s_buffers)
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                buffer->events.clear();
+            }
+            s_filename = filename;
+            s_start = Clock::now();
+            s_recording = true;
+            return true;
+        }
+
+        bool stop()
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (!s_recording)
+                return false;
+            s_recording = false;
+
+            std::ofstream file(s_filename);
+            if (!file.is_open())
+            {
+                std::cout << "\x1B[31mError!\033[0m Cannot create the profile file " << s_filename << std::endl;
+                return false;
+            }
+
+            // The timestamps are in microseconds
+            file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            bool first = true;
+            for (auto &buffer : s_buffers)
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                if (buffer->name)
+                {
+                    file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+                         << ",\"args\":{\"name\":";
+                    writeString(file, buffer->name);
+                    file << "}}";
+                    first = false;
+                }
+
+                for (const Event &event : buffer->events)
+                {
+                    std::chrono::duration<double, std::micro> start = event.start - s_start;
+                    std::chrono::duration<double, std::micro> duration = event.end - event.start;
+                    file << (first ? "\n" : ",\n") << "{\"name\":";
+                    writeString(file, event.name);
+                    file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << start.count()
+                         << ",\"dur\":" << duration.count() << "}";
+                    first = false;
+                }
+                buffer->events.clear();
+            }
+            file << "\n]}\n";
+
+            if (!file)
+            {
+                std::cout << "\x1B[31mError!\033[0m Cannot write the profile file " << s_filename << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        bool isRecording()
+        {
+            return s_recording.load(std::memory_order_relaxed);
+        }
+
+        void setThreadName(const char *name)
+        {
+            ThreadBuffer &buffer = threadBuffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.name = name;
+        }
+
+        Session::Session(const std::string &filename)
+            : m_started(!filename.empty() && start(filename))
+        {}
+
+        Session::~Session()
+        {
+            if (m_started)
+                stop();
+        }
+
+        Scope::Scope(const char *name)
+            : m_name(isRecording() ? name : nullptr)
+        {
+            if (m_name)
+                m_start = Clock::now();
+        }
+
+        Scope::~Scope()
+        {
+            if (!m_name || !isRecording())
+                return;
+
+            Clock::time_point end = Clock::now();
+            ThreadBuffer &buffer = threadBuffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.events.push_back({m_name, m_start, end});
+        }
+    } // namespace profiler
+} // namespace gameboy
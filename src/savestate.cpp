@@ -0,0 +1,47 @@
+#include "savestate.h" // StateWriter, StateReader
+
+#include <cstring> // std::memcpy
+
+namespace gameboy
+{
+    StateWriter::StateWriter(std::vector<uint8_t> &buffer)
+        : m_buffer(buffer)
+    {
+        m_buffer.clear();
+    }
+
+    void StateWriter::writeBytes(const void *data, const size_t size)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+
+    StateReader::StateReader(const std::vector<uint8_t> &buffer)
+        : m_buffer(buffer)
+    {}
+
+    void StateReader::readBytes(void *data, const size_t size)
+    {
+        if (!m_valid || size > m_buffer.size() - m_position)
+        {
+            m_valid = false;
+            return;
+        }
+
+        // An empty block may have no storage (e.g. the start state of a movie), and memcpy takes no null pointer
+        if (size == 0)
+            return;
+        std::memcpy(data, m_buffer.data() + m_position, size);
+        m_position += size;
+    }
+
+    void StateReader::invalidate()
+    {
+        m_valid = false;
+    }
+
+    bool StateReader::isValid() const
+    {
+        return m_valid;
+    }
+} // namespace gameboy
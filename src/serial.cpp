@@ -0,0 +1,114 @@
+/*
+ * See https://gbdev.io/pandocs/Serial_Data_Transfer_(Link_Cable).html
+ */
+
+#include "serial.h" // Serial, CaptureSink
+
+namespace gameboy
+{
+    void SerialSink::transferStarted(const uint8_t byte, const uint64_t completionTime)
+    {
+        (void) byte;
+        (void) completionTime;
+    }
+
+    std::optional<uint8_t> SerialSink::update(const uint64_t time, const uint8_t data)
+    {
+        (void) time;
+        (void) data;
+        return std::nullopt;
+    }
+
+    uint8_t CaptureSink::transfer(const uint8_t byte)
+    {
+        m_data += static_cast<char>(byte);
+        return 0xFF;
+    }
+
+    const std::string &CaptureSink::getData() const
+    {
+        return m_data;
+    }
+
+    void CaptureSink::clear()
+    {
+        m_data.clear();
+    }
+
+    Serial::Serial(Memory &memory)
+        : m_memory(memory)
+    {}
+
+    void Serial::setSink(SerialSink *sink)
+    {
+        m_sink = sink;
+    }
+
+    void Serial::cycle(const uint8_t cycles)
+    {
+        m_time += cycles;
+        uint8_t control = m_memory.read(serial_registers::SC_ADDRESS);
+
+        // Transfer clocked by the other end: the bits are shifted even if no transfer has been requested,
+        // but the interrupt is requested only if the Game Boy was waiting for the transfer
+        if (m_sink)
+        {
+            if (auto received = m_sink->update(m_time, m_memory.read(serial_registers::SB_ADDRESS)))
+            {
+                m_memory.write(serial_registers::SB_ADDRESS, *received);
+                if ((control & 0x81) == 0x80)
+                {
+                    m_memory.write(serial_registers::SC_ADDRESS, control & 0x7F);
+                    requestInterrupt();
+                }
+                return;
+            }
+        }
+
+        // Transfer requested (bit 7) with the internal clock (bit 0)
+        if ((control & 0x81) != 0x81)
+        {
+            m_transferring = false;
+            return;
+        }
+
+        if (!m_transferring)
+        {
+            m_transferring = true;
+            m_transferCycles = 0;
+            if (m_sink)
+                m_sink->transferStarted(m_memory.read(serial_registers::SB_ADDRESS), m_time + TRANSFER_CYCLES);
+        }
+
+        m_transferCycles += cycles;
+        if (m_transferCycles < TRANSFER_CYCLES)
+            return;
+
+        // Transfer completed
+        uint8_t data = m_memory.read(serial_registers::SB_ADDRESS);
+        m_memory.write(serial_registers::SB_ADDRESS, m_sink ? m_sink->transfer(data) : 0xFF);
+        m_memory.write(serial_registers::SC_ADDRESS, control & 0x7F);
+        m_transferring = false;
+        requestInterrupt();
+    }
+
+    void Serial::requestInterrupt()
+    {
+        uint8_t interruptFlag = m_memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS);
+        m_memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, interruptFlag | SERIAL_INTERRUPT_FLAG_VALUE);
+    }
+
+    void Serial::saveState(StateWriter &writer) const
+    {
+        writer.write(m_time);
+        writer.write(m_transferring);
+        writer.write(m_transferCycles);
+    }
+
+    void Serial::loadState(StateReader &reader)
+    {
+        reader.read(m_time);
+        reader.read(m_transferring);
+        reader.read(m_transferCycles);
+    }
+} // namespace gameboy
@@ -0,0 +1,428 @@
+/*
+ * See https://github.com/SingleStepTests/sm83
+ */
+
+#include "sm83_tests.h" // SM83TestReader, SM83Test, SM83Results
+
+#include "thread_pool.h" // ThreadPool
+
+#include <algorithm> // std::sort
+#include <cctype> // std::isspace, std::isdigit, std::isalnum
+#include <filesystem> // std::filesystem
+#include <fstream> // std::ifstream
+#include <iomanip> // std::hex, std::setw, std::setfill
+#include <iostream> // std::cout, std::endl
+#include <memory> // std::make_unique
+#include <sstream> // std::ostringstream
+#include <thread> // std::thread::hardware_concurrency
+
+namespace gameboy
+{
+    namespace
+    {
+        /**
+         * @brief Compare a value with the expected one
+         *
+         * @param name The name of the value (register, address, ...)
+         * @param value The value
+         * @param expected The expected value
+         * @param error The description of the difference, if any
+         * @return True if the values are equal, false otherwise
+         */
+        bool check(const std::string &name, const unsigned value, const unsigned expected, std::string &error)
+        {
+            if (value == expected)
+                return true;
+
+            std::ostringstream stream;
+            stream << std::hex << std::setfill('0') << name << " = 0x" << std::setw(2) << value << " (expected 0x"
+                   << std::setw(2) << expected << ")";
+            error = stream.str();
+            return false;
+        }
+    } // namespace
+
+    void SM83Results::add(const SM83Results &other)
+    {
+        passed += other.passed;
+        failed += other.failed;
+        valid = valid && other.valid;
+        for (const std::string &failure : other.failures)
+            if (failures.size() < MAX_FAILURES)
+                failures.push_back(failure);
+    }
+
+    SM83TestReader::SM83TestReader(std::istream &stream)
+        : m_stream(stream)
+    {}
+
+    bool SM83TestReader::next(SM83Test &test)
+    {
+        if (!m_valid || m_finished)
+            return false;
+
+        // The array starts with a bracket, and the tests are separated by commas
+        if (peek() == ']' && m_started)
+        {
+            m_stream.get();
+            m_finished = true;
+            return false;
+        }
+        if (!expect(m_started ? ',' : '['))
+            return false;
+        if (!m_started && peek() == ']') // Empty array
+        {
+            m_stream.get();
+            m_finished = true;
+            return false;
+        }
+        m_started = true;
+
+        test = SM83Test();
+        if (!expect('{'))
+            return false;
+        while (peek() != '}')
+        {
+            std::string key;
+            if (!readString(key) || !expect(':'))
+                return false;
+
+            bool read;
+            if (key == "name")
+                read = readString(test.name);
+            else if (key == "initial")
+                read = readState(test.initial);
+            else if (key == "final")
+                read = readState(test.final);
+            else if (key == "cycles")
+                read = readArrayLength(test.cycles);
+            else
+                read = skipValue();
+            if (!read || (peek() == ',' && !expect(',')))
+                return false;
+        }
+        m_stream.get();
+        return true;
+    }
+
+    bool SM83TestReader::isValid() const
+    {
+        return m_valid;
+    }
+
+    int SM83TestReader::peek()
+    {
+        while (std::isspace(m_stream.peek()))
+            m_stream.get();
+        return m_stream.peek();
+    }
+
+    bool SM83TestReader::expect(const char expected)
+    {
+        if (peek() != expected)
+        {
+            m_valid = false;
+            return false;
+        }
+        m_stream.get();
+        return true;
+    }
+
+    bool SM83TestReader::readString(std::string &value)
+    {
+        if (!expect('"'))
+            return false;
+
+        value.clear();
+        int c;
+        while ((c = m_stream.get()) != '"')
+        {
+            if (c == EOF)
+                return m_valid = false;
+            if (c == '\\')
+            {
+                c = m_stream.get();
+                if (c == EOF)
+                    return m_valid = false;
+            }
+            value += static_cast<char>(c);
+        }
+        return true;
+    }
+
+    bool SM83TestReader::readNumber(uint64_t &value)
+    {
+        if (!std::isdigit(peek()))
+            return m_valid = false;
+
+        value = 0;
+        while (std::isdigit(m_stream.peek()))
+            value = value * 10 + static_cast<uint64_t>(m_stream.get() - '0');
+        return true;
+    }
+
+    bool SM83TestReader::readState(SM83State &state)
+    {
+        if (!expect('{'))
+            return false;
+
+        while (peek() != '}')
+        {
+            std::string key;
+            uint64_t value = 0;
+            if (!readString(key) || !expect(':'))
+                return false;
+
+            if (key == "ram")
+            {
+                if (!readRAM(state.ram))
+                    return false;
+            }
+            else if (peek() == '"' || peek() == '[' || peek() == '{' || peek() == 'n')
+            {
+                if (!skipValue())
+                    return false;
+            }
+            else if (!readNumber(value))
+                return false;
+
+            auto byte = static_cast<uint8_t>(value);
+            if (key == "pc")
+                state.pc = static_cast<uint16_t>(value);
+            else if (key == "sp")
+                state.sp = static_cast<uint16_t>(value);
+            else if (key == "a")
+                state.a = byte;
+            else if (key == "f")
+                state.f = byte;
+            else if (key == "b")
+                state.b = byte;
+            else if (key == "c")
+                state.c = byte;
+            else if (key == "d")
+                state.d = byte;
+            else if (key == "e")
+                state.e = byte;
+            else if (key == "h")
+                state.h = byte;
+            else if (key == "l")
+                state.l = byte;
+            else if (key == "ime")
+                state.ime = value != 0;
+            else if (key == "ie") // The Interrupt Enable Register is at the end of the memory
+                state.ram.emplace_back(interrupt_registers::INTERRUPT_ENABLE_ADDRESS, byte);
+
+            if (peek() == ',' && !expect(','))
+                return false;
+        }
+        m_stream.get();
+        return true;
+    }
+
+    bool SM83TestReader::readRAM(std::vector<std::pair<uint16_t, uint8_t>> &ram)
+    {
+        if (!expect('['))
+            return false;
+
+        while (peek() != ']')
+        {
+            uint64_t address = 0;
+            uint64_t value = 0;
+            if (!expect('[') || !readNumber(address) || !expect(',') || !readNumber(value) || !expect(']'))
+                return false;
+            ram.emplace_back(static_cast<uint16_t>(address), static_cast<uint8_t>(value));
+
+            if (peek() == ',' && !expect(','))
+                return false;
+        }
+        m_stream.get();
+        return true;
+    }
+
+    bool SM83TestReader::readArrayLength(size_t &length)
+    {
+        if (!expect('['))
+            return false;
+
+        length = 0;
+        while (peek() != ']')
+        {
+            if (!skipValue())
+                return false;
+            length++;
+
+            if (peek() == ',' && !expect(','))
+                return false;
+        }
+        m_stream.get();
+        return true;
+    }
+
+    bool SM83TestReader::skipValue()
+    {
+        int c = peek();
+        if (c == '"')
+        {
+            std::string ignored;
+            return readString(ignored);
+        }
+        if (c == '[' || c == '{')
+        {
+            char closing = c == '[' ? ']' : '}';
+            m_stream.get();
+            while (peek() != closing)
+            {
+                if (c == '{')
+                {
+                    std::string key;
+                    if (!readString(key) || !expect(':'))
+                        return false;
+                }
+                if (!skipValue())
+                    return false;
+                if (peek() == ',' && !expect(','))
+                    return false;
+            }
+            m_stream.get();
+            return true;
+        }
+
+        // A number or a literal (null, true, false)
+        bool read = false;
+        while (std::isalnum(peek()) || peek() == '-' || peek() == '.' || peek() == '+')
+        {
+            m_stream.get();
+            read = true;
+        }
+        return read || (m_valid = false);
+    }
+
+    bool runSM83Test(const SM83Test &test, FlatMemory &memory, std::string &error)
+    {
+        memory.clear();
+        for (const auto &[address, value] : test.initial.ram)
+            memory.write(address, value);
+
+        BasicCPU<FlatMemory> cpu(memory);
+        Registers &registers = cpu.getRegisters();
+        const SM83State &initial = test.initial;
+        registers.pc = initial.pc;
+        registers.sp = initial.sp;
+        registers.a = initial.a;
+        registers.f = initial.f;
+        registers.b = initial.b;
+        registers.c = initial.c;
+        registers.d = initial.d;
+        registers.e = initial.e;
+        registers.h = initial.h;
+        registers.l = initial.l;
+        cpu.setIME(initial.ime);
+
+        uint8_t cycles = cpu.cycle();
+        if (cycles == 0)
+        {
+            error = "unexpected opcode";
+            return false;
+        }
+
+        const SM83State &expected = test.final;
+        if (!check("pc", registers.pc, expected.pc, error) || !check("sp", registers.sp, expected.sp, error) ||
+            !check("a", registers.a, expected.a, error) || !check("f", registers.f, expected.f, error) ||
+            !check("b", registers.b, expected.b, error) || !check("c", registers.c, expected.c, error) ||
+            !check("d", registers.d, expected.d, error) || !check("e", registers.e, expected.e, error) ||
+            !check("h", registers.h, expected.h, error) || !check("l", registers.l, expected.l, error) ||
+            !check("ime", cpu.getIME(), expected.ime, error) || !check("cycles", cycles, static_cast<unsigned>(test.cycles), error))
+            return false;
+
+        for (const auto &[address, value] : expected.ram)
+        {
+            std::ostringstream name;
+            name << "[0x" << std::hex << std::setfill('0') << std::setw(4) << address << "]";
+            if (!check(name.str(), memory.read(address), value, error))
+                return false;
+        }
+        return true;
+    }
+
+    SM83Results runSM83Tests(std::istream &stream, const std::string &source)
+    {
+        SM83Results results;
+        auto memory = std::make_unique<FlatMemory>();
+        SM83TestReader reader(stream);
+        SM83Test test;
+        while (reader.next(test))
+        {
+            std::string error;
+            if (runSM83Test(test, *memory, error))
+            {
+                results.passed++;
+                continue;
+            }
+
+            results.failed++;
+            if (results.failures.size() < SM83Results::MAX_FAILURES)
+                results.failures.push_back(source + ": " + test.name + ": " + error);
+        }
+
+        if (!reader.isValid())
+        {
+            results.valid = false;
+            results.failures.push_back(source + ": not a valid JSON array of tests");
+        }
+        return results;
+    }
+
+    int runSM83TestFiles(const std::string &path, size_t threads)
+    {
+        namespace fs = std::filesystem;
+
+        std::vector<std::string> files;
+        std::error_code error;
+        if (fs::is_directory(path, error))
+        {
+            for (const fs::directory_entry &entry : fs::directory_iterator(path, error))
+                if (entry.path().extension() == ".json")
+                    files.push_back(entry.path().string());
+            std::sort(files.begin(), files.end());
+        }
+        else
+            files.push_back(path);
+
+        if (files.empty())
+        {
+            std::cout << "\x1B[31mError!\033[0m No test file in " << path << std::endl;
+            return 1;
+        }
+
+        // One file per iteration: the files are read and run in parallel, each file by a single thread
+        std::vector<SM83Results> fileResults(files.size());
+        ThreadPool pool(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency()));
+        pool.run(files.size(), [&files, &fileResults](size_t index) {
+            std::ifstream file(files[index]);
+            if (!file.is_open())
+            {
+                fileResults[index].valid = false;
+                fileResults[index].failures.push_back(files[index] + ": cannot be read");
+                return;
+            }
+            fileResults[index] = runSM83Tests(file, fs::path(files[index]).filename().string());
+        });
+
+        SM83Results total;
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            const SM83Results &results = fileResults[i];
+            if (results.failed > 0 || !results.valid)
+            {
+                std::cout << "\x1B[31mFailed\033[0m " << files[i] << ": " << results.failed << "/"
+                          << results.passed + results.failed << " tests failed" << std::endl;
+                for (const std::string &failure : results.failures)
+                    std::cout << "    " << failure << std::endl;
+            }
+            total.add(results);
+        }
+
+        std::cout << total.passed << "/" << total.passed + total.failed << " tests passed (" << files.size() << " files)" << std::endl;
+        return total.failed == 0 && total.valid && total.passed > 0 ? 0 : 1;
+    }
+} // namespace gameboy
@@ -0,0 +1,100 @@
+#include "stats.h" // StatsCollector, StatsSnapshot
+
+#include "cpu.h" // cpu_cycles::CLOCK_FREQUENCY
+
+#include <algorithm> // std::min
+#include <cstdio> // std::snprintf
+
+namespace gameboy
+{
+    std::string formatStatsJSON(const StatsSnapshot &snapshot)
+    {
+        char text[512];
+        std::snprintf(text, sizeof(text),
+                      "{\"frame\":%llu,\"seconds\":%.3f,\"frames\":%u,\"cycles_per_second\":%.0f,"
+                      "\"instructions_per_second\":%.0f,\"speed\":%.4f,\"frame_ms_p50\":%.3f,\"frame_ms_p95\":%.3f,"
+                      "\"frame_ms_p99\":%.3f,\"emulate_ratio\":%.4f,\"sleep_ratio\":%.4f}",
+                      static_cast<unsigned long long>(snapshot.frame), snapshot.seconds, snapshot.frames,
+                      snapshot.cyclesPerSecond, snapshot.instructionsPerSecond, snapshot.speed, snapshot.frameP50Ms,
+                      snapshot.frameP95Ms, snapshot.frameP99Ms, snapshot.emulateRatio, snapshot.sleepRatio);
+        return text;
+    }
+
+    StatsCollector::StatsCollector()
+        : m_lastSnapshot(Clock::now())
+    {}
+
+    void StatsCollector::addFrame(const uint64_t cycles, const uint64_t instructions, const double frameSeconds,
+                                  const double emulateSeconds, const double sleepSeconds)
+    {
+        m_cycles.fetch_add(cycles, std::memory_order_relaxed);
+        m_instructions.fetch_add(instructions, std::memory_order_relaxed);
+        m_emulateNs.fetch_add(static_cast<uint64_t>(emulateSeconds * 1e9), std::memory_order_relaxed);
+        m_sleepNs.fetch_add(static_cast<uint64_t>(sleepSeconds * 1e9), std::memory_order_relaxed);
+
+        auto bucket = static_cast<size_t>(frameSeconds * 1000.0 / BUCKET_MS);
+        m_histogram[std::min(bucket, HISTOGRAM_BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+
+        // Last, so that a snapshot that sees the frame also sees its counters
+        m_frames.fetch_add(1, std::memory_order_release);
+    }
+
+    StatsSnapshot StatsCollector::takeSnapshot()
+    {
+        StatsSnapshot snapshot;
+        Clock::time_point now = Clock::now();
+        snapshot.seconds = std::chrono::duration<double>(now - m_lastSnapshot).count();
+        m_lastSnapshot = now;
+
+        uint64_t frames = m_frames.load(std::memory_order_acquire);
+        uint64_t cycles = m_cycles.load(std::memory_order_relaxed);
+        uint64_t instructions = m_instructions.load(std::memory_order_relaxed);
+        uint64_t emulateNs = m_emulateNs.load(std::memory_order_relaxed);
+        uint64_t sleepNs = m_sleepNs.load(std::memory_order_relaxed);
+
+        snapshot.frame = frames;
+        snapshot.frames = static_cast<uint32_t>(frames - m_lastFrames);
+        if (snapshot.seconds > 0)
+        {
+            snapshot.cyclesPerSecond = static_cast<double>(cycles - m_lastCycles) / snapshot.seconds;
+            snapshot.instructionsPerSecond = static_cast<double>(instructions - m_lastInstructions) / snapshot.seconds;
+            snapshot.speed = snapshot.cyclesPerSecond / cpu_cycles::CLOCK_FREQUENCY;
+            snapshot.emulateRatio = static_cast<double>(emulateNs - m_lastEmulateNs) / 1e9 / snapshot.seconds;
+            snapshot.sleepRatio = static_cast<double>(sleepNs - m_lastSleepNs) / 1e9 / snapshot.seconds;
+        }
+
+        m_lastFrames = frames;
+        m_lastCycles = cycles;
+        m_lastInstructions = instructions;
+        m_lastEmulateNs = emulateNs;
+        m_lastSleepNs = sleepNs;
+
+        // Percentiles of the histogram (the upper bound of the bucket), which is emptied for the next interval
+        std::array<uint32_t, HISTOGRAM_BUCKETS> histogram;
+        uint64_t count = 0;
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            histogram[i] = m_histogram[i].exchange(0, std::memory_order_relaxed);
+            count += histogram[i];
+        }
+
+        double *percentiles[] = {&snapshot.frameP50Ms, &snapshot.frameP95Ms, &snapshot.frameP99Ms};
+        const double ranks[] = {0.50, 0.95, 0.99};
+        for (size_t p = 0; p < 3 && count > 0; p++)
+        {
+            auto rank = static_cast<uint64_t>(ranks[p] * static_cast<double>(count - 1));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+            {
+                seen += histogram[i];
+                if (seen > rank)
+                {
+                    *percentiles[p] = static_cast<double>(i + 1) * BUCKET_MS;
+                    break;
+                }
+            }
+        }
+
+        return snapshot;
+    }
+} // namespace gameboy
@@ -0,0 +1,85 @@
+#include "thread_pool.h" // ThreadPool
+
+#include <algorithm> // std::max
+
+namespace gameboy
+{
+    ThreadPool::ThreadPool(const size_t threads)
+    {
+        for (size_t i = 1; i < std::max<size_t>(threads, 1); i++)
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+
+        for (auto &worker : m_workers)
+            worker.join();
+    }
+
+    void ThreadPool::run(const size_t count, const std::function<void(size_t)> &function)
+    {
+        if (m_workers.empty() || count <= 1)
+        {
+            for (size_t i = 0; i < count; i++)
+                function(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_function = &function;
+            m_count = count;
+            m_next = 0;
+            m_busyWorkers = m_workers.size();
+            m_generation++;
+        }
+        m_start.notify_all();
+
+        runIterations();
+
+        // Wait for the workers, the function must stay alive until they stop using it
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_busyWorkers == 0; });
+        m_function = nullptr;
+    }
+
+    size_t ThreadPool::getThreadCount() const
+    {
+        return m_workers.size() + 1;
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        size_t generation = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_start.wait(lock, [this, generation]() { return m_stop || m_generation != generation; });
+                if (m_stop)
+                    return;
+                generation = m_generation;
+            }
+
+            runIterations();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_busyWorkers--;
+            }
+            m_done.notify_one();
+        }
+    }
+
+    void ThreadPool::runIterations()
+    {
+        for (size_t i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1))
+            (*m_function)(i);
+    }
+} // namespace gameboy
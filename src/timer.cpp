@@ -1,91 +1,173 @@
 /*
  * See pages 30 to 40 of the documentation (PanDocs/GB.pdf)
  * See https://gbdev.io/pandocs/Timer_and_Divider_Registers.html
+ * See https://gbdev.io/pandocs/Timer_Obscure_Behaviour.html
  */
 
 #include "timer.h" // Timer
 
+#include <algorithm> // std::min
+
 namespace gameboy
 {
     Timer::Timer(Memory &memory)
         : m_memory(memory)
     {
-        getRegisters();
+        m_counter = static_cast<uint16_t>(memory[timer_registers::DIV_REG_ADDRESS] << 8);
+        m_tima = memory[timer_registers::TIMA_REG_ADDRESS];
+        m_tma = memory[timer_registers::TMA_REG_ADDRESS];
+        m_tac = memory[timer_registers::TAC_REG_ADDRESS] & 0x07;
+
+        m_memory.setTimer(this);
     }
 
-    void Timer::getRegisters()
+    Timer::~Timer()
     {
-        m_div = m_memory.read(timer_registers::DIV_REG_ADDRESS);
-        m_tima = m_memory.read(timer_registers::TIMA_REG_ADDRESS);
-        m_tma = m_memory.read(timer_registers::TMA_REG_ADDRESS);
-        m_tac = m_memory.read(timer_registers::TAC_REG_ADDRESS);
+        m_memory.setTimer(nullptr);
     }
 
-    void Timer::setRegisters()
+    uint32_t Timer::getPeriod(const uint8_t tac)
     {
-        m_memory.write(timer_registers::DIV_REG_ADDRESS, m_div);
-        m_memory.write(timer_registers::TIMA_REG_ADDRESS, m_tima);
-        m_memory.write(timer_registers::TMA_REG_ADDRESS, m_tma);
-        m_memory.write(timer_registers::TAC_REG_ADDRESS, m_tac);
+        // The frequency is represented by the bits 0-1 of the TAC register (the selected bit of the counter is 9, 3, 5 or 7)
+        constexpr uint32_t periods[4] = {1024, 16, 64, 256};
+        return periods[tac & 0x03];
     }
 
-    void Timer::cycle(uint8_t cycles)
+    bool Timer::getSignal(const uint16_t counter, const uint8_t tac)
     {
-        getRegisters();
+        return (tac & TIMER_ENABLE_BIT) && (counter & (getPeriod(tac) >> 1));
+    }
 
-        m_divCycles += cycles;
-        if (m_divCycles >= 256)
+    void Timer::incrementTIMA(const uint32_t increments)
+    {
+        uint32_t tima = m_tima + increments;
+        if (tima > 0xFF)
         {
-            m_divCycles -= 256;
-            m_div++;
+            // TIMA reads 0 until it is reloaded
+            m_tima = 0;
+            m_reloadDelay = RELOAD_DELAY;
         }
+        else
+            m_tima = static_cast<uint8_t>(tima);
+    }
+
+    void Timer::reloadTIMA()
+    {
+        m_tima = m_tma;
 
-        // Start the timer
-        if (m_tac & 0x04)
+        // Set the interrupt flag
+        uint8_t interruptFlag = m_memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS);
+        interruptFlag |= TIMER_OVERFLOW_INTERRUPT_FLAG_VALUE;
+        m_memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, interruptFlag);
+    }
+
+    void Timer::cycle(uint32_t cycles)
+    {
+        const bool enabled = m_tac & TIMER_ENABLE_BIT;
+        const uint32_t period = getPeriod(m_tac);
+
+        while (cycles > 0)
         {
-            m_timaCycles += cycles;
-
-            /*
-             * TIMA is incremented at the clock frequency specified by the TAC register ($FF07).
-             * When the value overflows (exceeds $FF) it is reset to the value specified in TMA (FF06)
-             * and an interrupt is requested.
-             */
-            uint16_t clockFrequencyThreshold = 0;
-            // The frequency is represented by the bits 0-1 of the TAC register
-            switch (m_tac & 0x03)
+            // The span ends at the next event: the reload of TIMA or its overflow
+            const bool reloading = m_reloadDelay > 0;
+            uint32_t span = cycles;
+            if (reloading)
+                span = std::min<uint32_t>(span, m_reloadDelay);
+            else if (enabled)
             {
-                case 0:
-                    clockFrequencyThreshold = 1024;
-                    break;
-                case 1:
-                    clockFrequencyThreshold = 16;
-                    break;
-                case 2:
-                    clockFrequencyThreshold = 64;
-                    break;
-                case 3:
-                    clockFrequencyThreshold = 256;
-                    break;
+                // The first falling edge is at the next multiple of the period, the overflow 0xFF - TIMA periods later
+                uint32_t overflow = period - (m_counter & (period - 1)) + (0xFF - m_tima) * period;
+                span = std::min(span, overflow);
             }
 
-            while (m_timaCycles >= clockFrequencyThreshold)
-            {
-                m_timaCycles -= clockFrequencyThreshold;
+            // The falling edges of the span are the multiples of the period crossed by the counter
+            uint32_t edges = enabled ? ((m_counter & (period - 1)) + span) / period : 0;
+            m_counter = static_cast<uint16_t>(m_counter + span);
+            cycles -= span;
 
-                if (m_tima == 0xFF)
+            if (edges > 0)
+                incrementTIMA(edges);
+            if (reloading)
+            {
+                m_reloadDelay = static_cast<uint8_t>(m_reloadDelay - span);
+                if (m_reloadDelay == 0)
                 {
-                    m_tima = m_tma;
+                    reloadTIMA();
 
-                    // Set the interrupt flag
-                    uint8_t interruptFlag = m_memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS);
-                    interruptFlag |= TIMER_OVERFLOW_INTERRUPT_FLAG_VALUE;
-                    m_memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, interruptFlag);
+                    // TIMA then overflows every 0x100 - TMA periods: the whole ones end in the same state
+                    if (enabled)
+                    {
+                        uint32_t overflowPeriod = (0x100 - m_tma) * period;
+                        uint32_t skipped = cycles / overflowPeriod * overflowPeriod;
+                        m_counter = static_cast<uint16_t>(m_counter + skipped);
+                        cycles -= skipped;
+                    }
                 }
-                else
-                    m_tima++;
             }
         }
+    }
+
+    uint8_t Timer::readRegister(const uint16_t address) const
+    {
+        switch (address)
+        {
+            case timer_registers::DIV_REG_ADDRESS:
+                return static_cast<uint8_t>(m_counter >> 8);
+            case timer_registers::TIMA_REG_ADDRESS:
+                return m_tima;
+            case timer_registers::TMA_REG_ADDRESS:
+                return m_tma;
+            case timer_registers::TAC_REG_ADDRESS:
+                return m_tac | TAC_UNUSED_BITS;
+            default:
+                return 0xFF;
+        }
+    }
+
+    void Timer::writeRegister(const uint16_t address, const uint8_t value)
+    {
+        switch (address)
+        {
+            case timer_registers::DIV_REG_ADDRESS:
+                // Resetting the counter is a falling edge if the selected bit was 1
+                if (getSignal(m_counter, m_tac))
+                    incrementTIMA(1);
+                m_counter = 0;
+                break;
+            case timer_registers::TIMA_REG_ADDRESS:
+                // Writing TIMA cancels the pending reload (and its interrupt)
+                m_tima = value;
+                m_reloadDelay = 0;
+                break;
+            case timer_registers::TMA_REG_ADDRESS:
+                m_tma = value;
+                break;
+            case timer_registers::TAC_REG_ADDRESS:
+                // Disabling the timer or selecting another bit is a falling edge if the input goes from 1 to 0
+                if (getSignal(m_counter, m_tac) && !getSignal(m_counter, value))
+                    incrementTIMA(1);
+                m_tac = value & 0x07;
+                break;
+            default:
+                break;
+        }
+    }
 
-        setRegisters();
+    void Timer::saveState(StateWriter &writer) const
+    {
+        writer.write(m_counter);
+        writer.write(m_tima);
+        writer.write(m_tma);
+        writer.write(m_tac);
+        writer.write(m_reloadDelay);
+    }
+
+    void Timer::loadState(StateReader &reader)
+    {
+        reader.read(m_counter);
+        reader.read(m_tima);
+        reader.read(m_tma);
+        reader.read(m_tac);
+        reader.read(m_reloadDelay);
     }
 } // namespace gameboy
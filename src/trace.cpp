@@ -0,0 +1,352 @@
+#include "trace.h" // TraceRecord, TraceWriter, TraceReader, TraceDiff
+
+#include <chrono> // std::chrono::milliseconds
+#include <iomanip> // std::hex, std::uppercase, std::setw, std::setfill
+#include <iostream> // std::cout, std::endl
+#include <sstream> // std::ostringstream
+
+namespace gameboy
+{
+    namespace
+    {
+        /// The 8 bit registers, in the order of the mask of the encoded records
+        constexpr uint8_t TraceRecord::*REGISTERS[] = {&TraceRecord::a, &TraceRecord::f, &TraceRecord::b, &TraceRecord::c,
+                                                       &TraceRecord::d, &TraceRecord::e, &TraceRecord::h, &TraceRecord::l};
+
+        /**
+         * @brief Encode a varint (7 bits per byte, low bits first, bit 7 set if more bytes follow)
+         *
+         * @param bytes The destination of the bytes (at least 10 bytes)
+         * @param value The value to encode
+         * @return The number of bytes written
+         */
+        size_t writeVarint(uint8_t *bytes, uint64_t value)
+        {
+            size_t size = 0;
+            while (value >= 0x80)
+            {
+                bytes[size++] = static_cast<uint8_t>(value | 0x80);
+                value >>= 7;
+            }
+            bytes[size++] = static_cast<uint8_t>(value);
+            return size;
+        }
+    } // namespace
+
+    bool TraceRecord::operator==(const TraceRecord &other) const
+    {
+        for (uint8_t TraceRecord::*reg : REGISTERS)
+            if (this->*reg != other.*reg)
+                return false;
+        return cycles == other.cycles && pc == other.pc && sp == other.sp && opcode == other.opcode;
+    }
+
+    bool TraceRecord::operator!=(const TraceRecord &other) const
+    {
+        return !(*this == other);
+    }
+
+    std::string formatTraceRecord(const TraceRecord &record)
+    {
+        std::ostringstream stream;
+        stream << std::hex << std::uppercase << std::setfill('0');
+        stream << "PC=" << std::setw(4) << record.pc << " OP=" << std::setw(2) << +record.opcode;
+        const char *names = "AFBCDEHL";
+        for (size_t i = 0; i < 8; i++)
+            stream << " " << names[i] << "=" << std::setw(2) << +(record.*REGISTERS[i]);
+        stream << " SP=" << std::setw(4) << record.sp << " CY=" << std::dec << record.cycles;
+        return stream.str();
+    }
+
+    TraceWriter::TraceWriter()
+        : m_buffer(BUFFER_SIZE)
+    {}
+
+    TraceWriter::~TraceWriter()
+    {
+        close();
+    }
+
+    bool TraceWriter::open(const std::string &filename)
+    {
+        close();
+
+        m_file.open(filename, std::ios::binary | std::ios::trunc);
+        if (!m_file.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Cannot create the trace file " << filename << std::endl;
+            return false;
+        }
+
+        uint8_t header[4];
+        for (size_t i = 0; i < sizeof(header); i++)
+            header[i] = static_cast<uint8_t>(trace_format::TRACE_MAGIC >> (i * 8));
+        m_file.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+        m_previous = TraceRecord();
+        m_count = 0;
+        m_failed = false;
+        m_running = true;
+        m_thread = std::thread(&TraceWriter::writeLoop, this);
+        return true;
+    }
+
+    void TraceWriter::record(const TraceRecord &record)
+    {
+        if (!m_running.load(std::memory_order_relaxed))
+            return;
+
+        uint8_t bytes[trace_format::MAX_RECORD_SIZE];
+        uint8_t mask = 0;
+        for (size_t i = 0; i < 8; i++)
+            if (record.*REGISTERS[i] != m_previous.*REGISTERS[i])
+                mask |= static_cast<uint8_t>(1 << i);
+        bool spChanged = record.sp != m_previous.sp;
+
+        // Zigzag encoding: the small negative deltas (e.g. loops) are small values too.
+        // Computed on the unsigned value, the left shift of a negative value being undefined
+        auto delta = static_cast<uint16_t>(record.pc - m_previous.pc);
+        auto zigzag = static_cast<uint16_t>((delta << 1) ^ ((delta & 0x8000) ? 0xFFFF : 0x0000));
+
+        size_t size = 0;
+        bytes[size++] = mask;
+        size += writeVarint(bytes + size, (static_cast<uint64_t>(zigzag) << 1) | (spChanged ? 1 : 0));
+        bytes[size++] = record.opcode;
+        size += writeVarint(bytes + size, record.cycles - m_previous.cycles);
+        if (spChanged)
+        {
+            bytes[size++] = static_cast<uint8_t>(record.sp & 0xFF);
+            bytes[size++] = static_cast<uint8_t>(record.sp >> 8);
+        }
+        for (size_t i = 0; i < 8; i++)
+            if (mask & (1 << i))
+                bytes[size++] = record.*REGISTERS[i];
+
+        // Wait for the writer thread only if the whole buffer is full
+        size_t written = m_buffer.push(bytes, size);
+        while (written < size)
+        {
+            std::this_thread::yield();
+            written += m_buffer.push(bytes + written, size - written);
+        }
+
+        m_previous = record;
+        m_count++;
+    }
+
+    bool TraceWriter::close()
+    {
+        if (!m_thread.joinable())
+            return !m_failed;
+
+        m_running = false;
+        m_thread.join();
+        m_file.close();
+        if (m_failed || m_file.fail())
+        {
+            m_failed = true;
+            std::cout << "\x1B[31mError!\033[0m Cannot write the trace file" << std::endl;
+        }
+        return !m_failed;
+    }
+
+    void TraceWriter::writeLoop()
+    {
+        std::vector<uint8_t> chunk(CHUNK_SIZE);
+        while (true)
+        {
+            // Read the flag before the buffer, so that the records appended before close are written
+            bool running = m_running.load(std::memory_order_acquire);
+            size_t count = m_buffer.pop(chunk.data(), chunk.size());
+            if (count > 0)
+            {
+                m_file.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(count));
+                if (!m_file)
+                    m_failed = true;
+                continue;
+            }
+
+            if (!running)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    TraceReader::TraceReader(std::istream &stream)
+        : m_stream(stream)
+    {
+        uint8_t header[4];
+        m_stream.read(reinterpret_cast<char *>(header), sizeof(header));
+        if (m_stream.gcount() != sizeof(header))
+        {
+            m_valid = false;
+            return;
+        }
+
+        uint32_t magic = 0;
+        for (size_t i = 0; i < sizeof(header); i++)
+            magic |= static_cast<uint32_t>(header[i]) << (i * 8);
+        m_valid = magic == trace_format::TRACE_MAGIC;
+    }
+
+    bool TraceReader::next(TraceRecord &record)
+    {
+        if (!m_valid)
+            return false;
+
+        int mask = m_stream.get();
+        if (mask == std::istream::traits_type::eof())
+            return false; // End of the trace
+
+        record = m_previous;
+
+        uint64_t pcField = 0;
+        uint64_t cycleDelta = 0;
+        int opcode = 0;
+        if (!readVarint(pcField) || (opcode = m_stream.get()) == std::istream::traits_type::eof() || !readVarint(cycleDelta))
+        {
+            m_valid = false;
+            return false;
+        }
+
+        auto zigzag = static_cast<uint16_t>(pcField >> 1);
+        auto delta = static_cast<int16_t>((zigzag >> 1) ^ -(zigzag & 1));
+        record.pc = static_cast<uint16_t>(m_previous.pc + delta);
+        record.opcode = static_cast<uint8_t>(opcode);
+        record.cycles = m_previous.cycles + cycleDelta;
+
+        if (pcField & 1)
+        {
+            int low = m_stream.get();
+            int high = m_stream.get();
+            if (high == std::istream::traits_type::eof())
+            {
+                m_valid = false;
+                return false;
+            }
+            record.sp = static_cast<uint16_t>(low | (high << 8));
+        }
+
+        for (size_t i = 0; i < 8; i++)
+        {
+            if ((mask & (1 << i)) == 0)
+                continue;
+
+            int value = m_stream.get();
+            if (value == std::istream::traits_type::eof())
+            {
+                m_valid = false;
+                return false;
+            }
+            record.*REGISTERS[i] = static_cast<uint8_t>(value);
+        }
+
+        m_previous = record;
+        return true;
+    }
+
+    bool TraceReader::readVarint(uint64_t &value)
+    {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            int byte = m_stream.get();
+            if (byte == std::istream::traits_type::eof())
+                return false;
+
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false; // Too long
+    }
+
+    TraceDiff diffTraces(TraceReader &first, TraceReader &second, const size_t contextSize)
+    {
+        TraceDiff diff;
+        while (true)
+        {
+            bool firstRead = first.next(diff.first);
+            bool secondRead = second.next(diff.second);
+            if (!firstRead && !secondRead)
+                break;
+
+            if (firstRead != secondRead || diff.first != diff.second)
+            {
+                diff.diverged = true;
+                diff.firstEnded = !firstRead;
+                diff.secondEnded = !secondRead;
+                break;
+            }
+
+            if (contextSize > 0)
+            {
+                if (diff.context.size() == contextSize)
+                    diff.context.erase(diff.context.begin());
+                diff.context.push_back(diff.first);
+            }
+            diff.index++;
+        }
+
+        diff.valid = first.isValid() && second.isValid();
+        return diff;
+    }
+
+    int printTraceFile(const std::string &filename, std::ostream &output)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Cannot read the trace file " << filename << std::endl;
+            return 1;
+        }
+
+        TraceReader reader(file);
+        TraceRecord record;
+        while (reader.next(record))
+            output << formatTraceRecord(record) << "\n";
+        output << std::flush;
+
+        if (!reader.isValid())
+        {
+            std::cout << "\x1B[31mError!\033[0m " << filename << " is not a valid trace (or is truncated)" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    int diffTraceFiles(const std::string &firstFile, const std::string &secondFile)
+    {
+        std::ifstream firstStream(firstFile, std::ios::binary);
+        std::ifstream secondStream(secondFile, std::ios::binary);
+        if (!firstStream.is_open() || !secondStream.is_open())
+        {
+            std::cout << "\x1B[31mError!\033[0m Cannot read the trace file "
+                      << (firstStream.is_open() ? secondFile : firstFile) << std::endl;
+            return 1;
+        }
+
+        TraceReader first(firstStream);
+        TraceReader second(secondStream);
+        TraceDiff diff = diffTraces(first, second);
+        if (!diff.valid)
+        {
+            std::cout << "\x1B[31mError!\033[0m " << (first.isValid() ? secondFile : firstFile)
+                      << " is not a valid trace (or is truncated)" << std::endl;
+            return 1;
+        }
+
+        if (!diff.diverged)
+        {
+            std::cout << "The traces are identical (" << diff.index << " instructions)" << std::endl;
+            return 0;
+        }
+
+        std::cout << "The traces diverge at instruction " << diff.index << ":\n";
+        for (const TraceRecord &record : diff.context)
+            std::cout << "  " << formatTraceRecord(record) << "\n";
+        std::cout << "< " << (diff.firstEnded ? "(end of " + firstFile + ")" : formatTraceRecord(diff.first)) << "\n";
+        std::cout << "> " << (diff.secondEnded ? "(end of " + secondFile + ")" : formatTraceRecord(diff.second)) << std::endl;
+        return 1;
+    }
+} // namespace gameboy
@@ -0,0 +1,129 @@
+#include "vec_env.h" // VecEnv
+
+#include <atomic> // std::atomic
+#include <iostream> // std::cout, std::endl
+
+namespace gameboy
+{
+    VecEnv::VecEnv(const VecEnvOptions &options)
+        : m_options(options),
+          m_pool(options.threads),
+          m_observationWidth(screen_size::SCREEN_WIDTH / options.downsample),
+          m_observationHeight(screen_size::SCREEN_HEIGHT / options.downsample)
+    {}
+
+    std::unique_ptr<VecEnv> VecEnv::create(const std::vector<uint8_t> &rom, const VecEnvOptions &options)
+    {
+        if (options.environments == 0 || options.frameSkip == 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m The number of environments and the frame skip must be greater than 0" << std::endl;
+            return nullptr;
+        }
+        if (options.downsample == 0 || screen_size::SCREEN_WIDTH % options.downsample != 0 ||
+            screen_size::SCREEN_HEIGHT % options.downsample != 0)
+        {
+            std::cout << "\x1B[31mError!\033[0m The downsampling factor must divide the size of the screen (160x144)" << std::endl;
+            return nullptr;
+        }
+
+        std::unique_ptr<VecEnv> env(new VecEnv(options));
+        env->m_emulators.reserve(options.environments);
+        for (size_t i = 0; i < options.environments; i++)
+        {
+            auto emulator = Emulator::create(rom);
+            if (!emulator)
+                return nullptr;
+            // The observations of RAM never need the frame
+            emulator->setSkipRendering(options.observation == ObservationType::RAM);
+            env->m_emulators.push_back(std::move(emulator));
+        }
+
+        env->m_emulators.front()->saveState(env->m_initialState);
+        return env;
+    }
+
+    void VecEnv::reset(uint8_t *observations)
+    {
+        m_pool.run(m_emulators.size(), [this, observations](size_t index) {
+            reset(index, observations + index * getObservationSize());
+        });
+    }
+
+    void VecEnv::reset(const size_t index, uint8_t *observation)
+    {
+        m_emulators[index]->loadState(m_initialState);
+        observe(index, observation);
+    }
+
+    bool VecEnv::step(const uint8_t *actions, uint8_t *observations)
+    {
+        std::atomic<bool> success{true};
+        m_pool.run(m_emulators.size(), [this, actions, observations, &success](size_t index) {
+            Emulator &emulator = *m_emulators[index];
+            emulator.setInput(actions[index]);
+
+            bool render = m_options.observation == ObservationType::FRAME;
+            for (uint32_t frame = 0; frame < m_options.frameSkip; frame++)
+            {
+                // Only the observed frame is rendered
+                if (render)
+                    emulator.setSkipRendering(frame + 1 < m_options.frameSkip);
+                if (!emulator.runFrame())
+                {
+                    success = false;
+                    return;
+                }
+            }
+
+            observe(index, observations + index * getObservationSize());
+        });
+        return success;
+    }
+
+    size_t VecEnv::getEnvironmentCount() const
+    {
+        return m_emulators.size();
+    }
+
+    size_t VecEnv::getObservationSize() const
+    {
+        if (m_options.observation == ObservationType::RAM)
+            return m_options.ramAddresses.size();
+        return static_cast<size_t>(m_observationWidth) * m_observationHeight;
+    }
+
+    const Emulator &VecEnv::getEmulator(const size_t index) const
+    {
+        return *m_emulators[index];
+    }
+
+    void VecEnv::observe(const size_t index, uint8_t *observation) const
+    {
+        const Emulator &emulator = *m_emulators[index];
+        if (m_options.observation == ObservationType::RAM)
+        {
+            for (size_t i = 0; i < m_options.ramAddresses.size(); i++)
+                observation[i] = emulator.readMemory(m_options.ramAddresses[i]);
+            return;
+        }
+
+        // Average the luminance of each block of downsample x downsample pixels
+        FrameBufferView frame = emulator.frameBuffer();
+        const uint32_t factor = m_options.downsample;
+        const uint32_t blockSize = factor * factor;
+        for (uint32_t y = 0; y < m_observationHeight; y++)
+        {
+            for (uint32_t x = 0; x < m_observationWidth; x++)
+            {
+                uint32_t sum = 0;
+                for (uint32_t dy = 0; dy < factor; dy++)
+                {
+                    const Colour *pixel = &frame.at(x * factor, y * factor + dy);
+                    for (uint32_t dx = 0; dx < factor; dx++, pixel++)
+                        sum += (77 * pixel->colours[0] + 150 * pixel->colours[1] + 29 * pixel->colours[2]) >> 8;
+                }
+                *observation++ = static_cast<uint8_t>(sum / blockSize);
+            }
+        }
+    }
+} // namespace gameboy
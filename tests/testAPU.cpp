@@ -0,0 +1,94 @@
+#include "catch.hpp"
+#include "apu.h"
+
+#include <algorithm> // std::any_of
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    TEST_CASE("RingBuffer push and pop", "[apu]")
+    {
+        RingBuffer<int16_t> buffer(6);
+        REQUIRE(buffer.capacity() == 8);
+
+        int16_t values[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        REQUIRE(buffer.push(values, 5) == 5);
+
+        int16_t read[10] = {};
+        REQUIRE(buffer.pop(read, 3) == 3);
+        REQUIRE(read[2] == 3);
+
+        // Wrap around the end of the buffer, only the elements that fit are written
+        REQUIRE(buffer.push(values, 10) == 6);
+        REQUIRE(buffer.size() == 8);
+        REQUIRE(buffer.pop(read, 10) == 8);
+        REQUIRE(read[0] == 4);
+        REQUIRE(read[2] == 1);
+        REQUIRE(read[7] == 6);
+        REQUIRE(buffer.size() == 0);
+    }
+
+    TEST_CASE("APU registers", "[apu]")
+    {
+        Cartridge cartridge;
+        Memory memory(cartridge);
+        APU apu(memory);
+
+        // The write-only bits are read as 1
+        memory.write(0xFF11, 0x80);
+        REQUIRE(memory.read(0xFF11) == 0xBF);
+
+        // Trigger the channel 2 with a length of 1 (1/256 s)
+        memory.write(0xFF17, 0xF0);
+        memory.write(0xFF16, 0x3F);
+        memory.write(0xFF19, 0xC0);
+        REQUIRE((memory.read(apu_registers::NR52_ADDRESS) & 0x02) == 0x02);
+
+        for (int i = 0; i < 5 * 8192 / 4; i++)
+            apu.cycle(4);
+        REQUIRE((memory.read(apu_registers::NR52_ADDRESS) & 0x02) == 0x00);
+
+        // Turning off the APU clears the registers
+        memory.write(apu_registers::NR52_ADDRESS, 0x00);
+        REQUIRE(memory.read(0xFF17) == 0x00);
+        REQUIRE(memory.read(apu_registers::NR52_ADDRESS) == 0x70);
+    }
+
+    TEST_CASE("APU output", "[apu]")
+    {
+        Cartridge cartridge;
+        Memory memory(cartridge);
+        APU apu(memory);
+        RingBuffer<int16_t> output(8192);
+        apu.setOutput(&output, 48000);
+
+        // Play a 1 kHz square wave on both outputs for 1/64 s
+        uint16_t frequency = 2048 - 131072 / 1000;
+        memory.write(0xFF24, 0x77);
+        memory.write(0xFF25, 0x22);
+        memory.write(0xFF16, 0x80);
+        memory.write(0xFF17, 0xF0);
+        memory.write(0xFF18, frequency & 0xFF);
+        memory.write(0xFF19, 0x80 | (frequency >> 8));
+        for (int i = 0; i < 65536 / 4; i++)
+            apu.cycle(4);
+        apu.flush();
+
+        // 48000 / 64 stereo samples
+        REQUIRE(output.size() >= 2 * 740);
+        REQUIRE(output.size() <= 2 * 760);
+
+        std::vector<int16_t> samples(output.size());
+        output.pop(samples.data(), samples.size());
+        REQUIRE(std::any_of(samples.begin(), samples.end(), [](int16_t sample) { return sample > 1000; }));
+        REQUIRE(std::any_of(samples.begin(), samples.end(), [](int16_t sample) { return sample < -1000; }));
+
+        // Nothing is produced while muted
+        apu.setMuted(true);
+        for (int i = 0; i < 65536 / 4; i++)
+            apu.cycle(4);
+        apu.flush();
+        REQUIRE(output.size() == 0);
+    }
+} // namespace gameboyTest
@@ -0,0 +1,120 @@
+#include "catch.hpp"
+#include "cpu.h"
+#include "timed_bus.h"
+#include "tracing_bus.h"
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    static_assert(is_bus_v<Memory>);
+    static_assert(is_bus_v<FlatMemory>);
+    static_assert(is_bus_v<TracingBus<FlatMemory>>);
+    static_assert(!is_bus_v<int>);
+    static_assert(!is_bus_v<Cartridge>);
+
+    TEST_CASE("Tracing bus", "[bus]")
+    {
+        FlatMemory memory;
+        TracingBus<FlatMemory> bus(memory);
+        BasicCPU<TracingBus<FlatMemory>> cpu(bus);
+        cpu.setIME(false);
+
+        // PUSH BC; NOP
+        Registers &registers = cpu.getRegisters();
+        registers.pc = 0x0100;
+        registers.sp = 0xD000;
+        registers.setBC(0x1234);
+        memory.write(0x0100, 0xC5);
+
+        REQUIRE(cpu.cycle() == 4);
+        REQUIRE(bus.getCycles() == 4);
+        REQUIRE(memory.getCycles() == 4);
+        REQUIRE(memory.read(0xCFFF) == 0x12);
+        REQUIRE(memory.read(0xCFFE) == 0x34);
+
+        // Interrupt registers, opcode, then the two bytes pushed
+        const std::vector<BusAccess> &accesses = bus.getAccesses();
+        REQUIRE(accesses.size() == 5);
+        REQUIRE(accesses[2].address == 0x0100);
+        REQUIRE(accesses[2].value == 0xC5);
+        REQUIRE(accesses[2].type == BusAccessType::READ);
+        for (size_t i = 3; i < 5; i++)
+        {
+            REQUIRE(accesses[i].type == BusAccessType::WRITE);
+            REQUIRE(accesses[i].cycle == 0);
+        }
+
+        bus.clear();
+        REQUIRE(cpu.cycle() == 1);
+        REQUIRE(bus.getCycles() == 5);
+        REQUIRE(bus.getAccesses().front().cycle == 4);
+
+        bus.clear();
+        bus.setRecording(false);
+        REQUIRE(cpu.cycle() == 1);
+        REQUIRE(bus.getAccesses().empty());
+        REQUIRE(bus.getCycles() == 6);
+    }
+
+    /**
+     * A clock that records the cycles and a byte of the memory each time it is advanced
+     */
+    struct RecordingClock
+    {
+        explicit RecordingClock(FlatMemory &memory)
+            : memory(memory)
+        {}
+
+        void advance(uint8_t cycles)
+        {
+            total += cycles;
+            values.push_back(memory.read(0xCFFF));
+        }
+
+        FlatMemory &memory;
+        uint32_t total = 0;
+        std::vector<uint8_t> values; ///< The byte at 0xCFFF before each advance
+    };
+
+    static_assert(is_bus_v<TimedBus<FlatMemory, RecordingClock>>);
+
+    TEST_CASE("Timed bus", "[bus]")
+    {
+        FlatMemory memory;
+        RecordingClock clock(memory);
+        TimedBus<FlatMemory, RecordingClock> bus(memory, clock);
+
+        SECTION("Instruction")
+        {
+            // The accesses of the CPU for PUSH BC: interrupt registers, fetch, then the two bytes pushed
+            (void) bus.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS);
+            (void) bus.read(interrupt_registers::INTERRUPT_ENABLE_ADDRESS);
+            (void) bus.read(0x0100);
+            bus.write(0xCFFF, 0x12);
+            bus.write(0xCFFE, 0x34);
+            REQUIRE(clock.total == 12);
+
+            // The internal cycle
+            bus.tick(4);
+            REQUIRE(clock.total == 16);
+            REQUIRE(memory.getCycles() == 4);
+
+            // The interrupt registers are not clocked, the accesses are clocked before they happen
+            REQUIRE(clock.values == std::vector<uint8_t>{0x00, 0x00, 0x12, 0x12});
+        }
+
+        SECTION("More accesses than cycles")
+        {
+            for (int i = 0; i < 3; i++)
+                (void) bus.read(0xC000);
+            REQUIRE(clock.total == 12);
+            bus.tick(2);
+            REQUIRE(clock.total == 12);
+            bus.tick(2); // The extra cycle has been clocked by the previous instruction
+            REQUIRE(clock.total == 16);
+            (void) bus.read(interrupt_registers::INTERRUPT_ENABLE_ADDRESS);
+            REQUIRE(clock.total == 16);
+        }
+    }
+} // namespace gameboyTest
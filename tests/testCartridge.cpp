@@ -24,4 +24,46 @@ namespace gameboyTest
 
         REQUIRE(title == "CPU_INSTRS");
     }
+
+    TEST_CASE("Malformed cartridges", "[cartridge]")
+    {
+        Cartridge cartridge;
+
+        // No ROM loaded yet: nothing drives the bus
+        REQUIRE(cartridge.read(0x0100) == 0xFF);
+        cartridge.write(0x2000, 0x01);
+
+        // New licensee code (0x33) that is not made of hexadecimal digits
+        std::vector<uint8_t> rom(0x150, 0x00);
+        rom[cartridge_info::CARTRIDGE_OLD_LICENSEE_CODE_ADDRESS] = 0x33;
+        rom[0x0144] = 'Z';
+        rom[0x0145] = 0xFF;
+        REQUIRE(cartridge.loadROMData(rom));
+
+        // The ROM is shorter than a bank: the reads wrap around
+        REQUIRE(cartridge.read(0x0000) == 0x00);
+        REQUIRE(cartridge.read(0x7FFF) == rom[0x7FFF % rom.size()]);
+
+        // MBC1 with 2 banks: the banks past the end of the ROM wrap around, and there is no RAM
+        rom.assign(0x8000, 0x00);
+        rom[cartridge_info::CARTRIDGE_TYPE_ADDRESS] = 0x03;
+        rom[0x4000] = 0x42;
+        REQUIRE(cartridge.loadROMData(rom));
+        cartridge.write(0x2000, 0x1F);
+        REQUIRE(cartridge.read(0x4000) == 0x42);
+        cartridge.write(0x0000, 0x0A);
+        cartridge.write(0xA000, 0x12);
+        REQUIRE(cartridge.read(0xA000) == 0xFF);
+
+        // Unsupported cartridge type
+        rom[cartridge_info::CARTRIDGE_TYPE_ADDRESS] = 0xFC;
+        REQUIRE_FALSE(cartridge.loadROMData(rom));
+        REQUIRE(cartridge.read(0x0100) == 0xFF);
+        std::vector<uint8_t> state;
+        StateWriter writer(state);
+        cartridge.saveState(writer);
+        StateReader reader(state);
+        cartridge.loadState(reader);
+        REQUIRE_FALSE(reader.isValid());
+    }
 } // namespace gameboyTest
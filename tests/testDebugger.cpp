@@ -0,0 +1,218 @@
+#include "catch.hpp"
+#include "debugger.h"
+#include "emulator.h"
+#include "gdb_stub.h"
+
+#include <arpa/inet.h>
+#include <cstdio>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    /**
+     * LD A,0x42; LD (0xC000),A; LD A,(0xC010); JR -2 (loops on itself) at the entry point of a ROM without MBC
+     */
+    std::unique_ptr<Emulator> createDebuggerROM()
+    {
+        std::vector<uint8_t> rom(0x8000, 0x00);
+        const uint8_t program[] = {0x3E, 0x42, 0xEA, 0x00, 0xC0, 0xFA, 0x10, 0xC0, 0x18, 0xFE};
+        std::copy(std::begin(program), std::end(program), rom.begin() + 0x100);
+        return Emulator::create(rom);
+    }
+
+    TEST_CASE("Debugger breakpoints and watchpoints", "[debugger]")
+    {
+        auto emulator = createDebuggerROM();
+        REQUIRE(emulator);
+        Debugger debugger;
+        emulator->setDebugger(&debugger);
+
+        // Stopped until resumed
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(emulator->getCycles() == 0);
+
+        debugger.resume(true);
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(debugger.getStopReason() == StopReason::STEP);
+        REQUIRE(emulator->getRegisters().pc == 0x102);
+
+        // Only the watched pages are routed to the debugger
+        debugger.addWatchpoint(0xC000, 1, WatchType::WRITE);
+        debugger.addWatchpoint(0xC010, 1, WatchType::READ);
+        REQUIRE(debugger.getPageFlags(0xC0FF) == static_cast<uint8_t>(WatchType::ACCESS));
+        REQUIRE(debugger.getPageFlags(0xC100) == 0);
+
+        // The watchpoints stop after the instruction
+        debugger.resume(false);
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(debugger.getStopReason() == StopReason::WATCHPOINT);
+        REQUIRE(debugger.getWatchHit().address == 0xC000);
+        REQUIRE(debugger.getWatchHit().type == WatchType::WRITE);
+        REQUIRE(emulator->getRegisters().pc == 0x105);
+        REQUIRE(emulator->readMemory(0xC000) == 0x42);
+
+        // Not triggered by the reads of the front end
+        REQUIRE(emulator->readMemory(0xC010) == 0x00);
+        REQUIRE(debugger.getWatchHit().address == 0xC000);
+
+        debugger.resume(false);
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(debugger.getStopReason() == StopReason::WATCHPOINT);
+        REQUIRE(debugger.getWatchHit().address == 0xC010);
+        REQUIRE(emulator->getRegisters().pc == 0x108);
+
+        // The instruction on the breakpoint is executed when resuming from it
+        REQUIRE(debugger.removeWatchpoint(0xC010, 1, WatchType::READ));
+        REQUIRE_FALSE(debugger.removeWatchpoint(0xC010, 1, WatchType::READ));
+        debugger.addBreakpoint(0x108);
+        debugger.resume(false);
+        uint64_t cycles = emulator->getCycles();
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(debugger.getStopReason() == StopReason::BREAKPOINT);
+        REQUIRE(emulator->getRegisters().pc == 0x108);
+        REQUIRE(emulator->getCycles() == cycles + 12); // JR
+
+        // Without breakpoint, the loop runs until interrupted
+        REQUIRE(debugger.removeBreakpoint(0x108));
+        REQUIRE_FALSE(debugger.hasBreakpoint(0x108));
+        debugger.resume(false);
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(debugger.isRunning());
+        debugger.stop(StopReason::INTERRUPT);
+        cycles = emulator->getCycles();
+        REQUIRE(emulator->runFrame());
+        REQUIRE(emulator->getCycles() == cycles);
+
+        // Detached: the emulator runs freely
+        emulator->setDebugger(nullptr);
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(emulator->getCycles() >= cycles + 1000);
+    }
+
+    TEST_CASE("Debugger with the machine cycle accuracy", "[debugger]")
+    {
+        auto emulator = createDebuggerROM();
+        REQUIRE(emulator);
+        emulator->setAccuracy(Accuracy::MACHINE_CYCLE);
+        Debugger debugger;
+        emulator->setDebugger(&debugger);
+
+        // The watchpoints are checked on the timed bus
+        debugger.addWatchpoint(0xC000, 1, WatchType::WRITE);
+        debugger.resume(false);
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(debugger.getStopReason() == StopReason::WATCHPOINT);
+        REQUIRE(debugger.getWatchHit().address == 0xC000);
+        REQUIRE(emulator->getRegisters().pc == 0x105);
+        REQUIRE(emulator->getCycles() == 24); // LD A,n; LD (nn),A
+        REQUIRE(emulator->readMemory(0xC000) == 0x42);
+
+        debugger.addBreakpoint(0x108);
+        debugger.resume(false);
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(debugger.getStopReason() == StopReason::BREAKPOINT);
+        REQUIRE(emulator->getRegisters().pc == 0x108);
+        REQUIRE(emulator->getAccuracy() == Accuracy::MACHINE_CYCLE);
+    }
+
+    /**
+     * Frame a GDB packet
+     */
+    std::string framePacket(const std::string &content)
+    {
+        uint8_t sum = 0;
+        for (char c : content)
+            sum += static_cast<uint8_t>(c);
+        char checksum[3];
+        std::snprintf(checksum, sizeof(checksum), "%02x", sum);
+        return "$" + content + "#" + checksum;
+    }
+
+    /**
+     * Send a packet and return the reply (with its acknowledgment)
+     */
+    std::string exchange(int socket, const std::string &content)
+    {
+        std::string packet = framePacket(content);
+        REQUIRE(send(socket, packet.data(), packet.size(), 0) == static_cast<ssize_t>(packet.size()));
+
+        std::string reply;
+        while (reply.size() < 3 || reply[reply.size() - 3] != '#')
+        {
+            char buffer[512];
+            ssize_t received = recv(socket, buffer, sizeof(buffer), 0);
+            REQUIRE(received > 0);
+            reply.append(buffer, static_cast<size_t>(received));
+        }
+        return reply;
+    }
+
+    TEST_CASE("GDB stub", "[debugger]")
+    {
+        auto emulator = createDebuggerROM();
+        REQUIRE(emulator);
+
+        SECTION("Packets")
+        {
+            GDBStub stub(*emulator);
+            REQUIRE(stub.handlePacket("?") == "S05");
+            REQUIRE(stub.handlePacket("g") == "b0011300d8004d01feff0001");
+            REQUIRE(stub.handlePacket("p5") == "0001");
+            REQUIRE(stub.handlePacket("p6") == "E01");
+            REQUIRE(stub.handlePacket("m100,3") == "3e42ea");
+            REQUIRE(stub.handlePacket("MC000,2:beef") == "OK");
+            REQUIRE(stub.handlePacket("mc000,2") == "beef");
+            REQUIRE(stub.handlePacket("P3=3412") == "OK");
+            REQUIRE(emulator->getRegisters().getHL() == 0x1234);
+            REQUIRE(stub.handlePacket("qXfer:features:read:target.xml:0,20").substr(0, 6) == "m<?xml");
+            REQUIRE(stub.handlePacket("vMustReplyEmpty").empty());
+
+            REQUIRE(stub.handlePacket("s") == "S05");
+            REQUIRE(stub.handlePacket("Z2,c000,1") == "OK");
+            REQUIRE(stub.handlePacket("c") == "T05watch:c000;");
+            REQUIRE(stub.handlePacket("z2,c000,1") == "OK");
+            REQUIRE(stub.handlePacket("Z0,108,1") == "OK");
+            REQUIRE(stub.handlePacket("c") == "T05swbreak:;");
+            REQUIRE(emulator->getRegisters().pc == 0x108);
+            REQUIRE(stub.handlePacket("Z9,0,1").empty());
+        }
+
+        SECTION("Connection")
+        {
+            GDBStub stub(*emulator);
+            REQUIRE(stub.listen(0));
+            REQUIRE(stub.getPort() != 0);
+            bool served = false;
+            std::thread server([&]() { served = stub.serve(); });
+
+            int client = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(stub.getPort());
+            REQUIRE(connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+
+            REQUIRE(exchange(client, "qSupported:swbreak+") == "+" + framePacket("PacketSize=1000;qXfer:features:read+;swbreak+;QStartNoAckMode+"));
+            REQUIRE(exchange(client, "m100,2") == "+" + framePacket("3e42"));
+
+            // Ctrl-C while running
+            REQUIRE(exchange(client, "QStartNoAckMode") == "+" + framePacket("OK"));
+            std::string cont = framePacket("c");
+            REQUIRE(send(client, cont.data(), cont.size(), 0) == static_cast<ssize_t>(cont.size()));
+            REQUIRE(send(client, "\x03", 1, 0) == 1);
+            char buffer[16] = {};
+            REQUIRE(recv(client, buffer, sizeof(buffer), 0) > 0);
+            REQUIRE(std::string(buffer) == framePacket("S02"));
+
+            REQUIRE(exchange(client, "D") == framePacket("OK"));
+            server.join();
+            close(client);
+            REQUIRE(served);
+        }
+    }
+} // namespace gameboyTest
@@ -0,0 +1,126 @@
+#include "catch.hpp"
+#include "disassembler.h"
+#include "opcodes.h"
+
+#include <sstream>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    /**
+     * A ROM of 4 banks: a CALL to 0x4000 at the entry point, and the same opcode at 0x4000 in the banks 2 and 3
+     */
+    std::vector<uint8_t> createDisassemblerROM()
+    {
+        std::vector<uint8_t> rom(0x10000, 0x00);
+        const uint8_t program[] = {0xCD, 0x00, 0x40, 0x18, 0xFB, 0xE0, 0x44, 0xF8, 0xFE, 0xCB, 0x7C, 0xD3, 0x08, 0x34, 0x12};
+        std::copy(std::begin(program), std::end(program), rom.begin() + 0x100);
+        rom[0x8000] = 0x3C; // INC A in bank 2
+        rom[0xC000] = 0x3C; // INC A in bank 3
+        rom[0x4000] = 0xC9; // RET in bank 1
+        return rom;
+    }
+
+    TEST_CASE("Opcodes metadata", "[disassembler]")
+    {
+        for (size_t opcode = 0; opcode < 256; opcode++)
+        {
+            // The CPU has no cycles for the opcodes that do not exist
+            bool exists = cpu_opcodes::OPCODE_MNEMONICS[opcode] != nullptr;
+            REQUIRE(exists == (cpu_cycles::OPCODE_CYCLES[opcode] != 0 || opcode == cpu_opcodes::CB_PREFIX));
+            REQUIRE(cpu_opcodes::OPCODE_CB_MNEMONICS[opcode] != nullptr);
+        }
+        REQUIRE(cpu_opcodes::getOpcodeLength(0xC3) == 3); // JP nn
+        REQUIRE(cpu_opcodes::getOpcodeLength(0x18) == 2); // JR n
+        REQUIRE(cpu_opcodes::getOpcodeLength(0x7E) == 1); // LD A, (HL)
+    }
+
+    TEST_CASE("Symbol files", "[disassembler]")
+    {
+        std::istringstream file("; File generated by rgblink\n"
+                                "00:0100 Entry\n"
+                                "01:4000 Return ; Comment\n"
+                                "00:ff44 rLY\n"
+                                "01:c000 wCounter\n"
+                                "\n"
+                                "not a symbol\n"
+                                "00:12345 TooLong\n");
+        SymbolTable symbols;
+        REQUIRE(symbols.load(file) == 2);
+        REQUIRE(symbols.size() == 4);
+
+        REQUIRE(*symbols.find(0, 0x100) == "Entry");
+        REQUIRE(*symbols.find(1, 0x4000) == "Return");
+        REQUIRE(symbols.find(2, 0x4000) == nullptr);
+        REQUIRE(*symbols.find(0, 0xC000) == "wCounter"); // The bank only matters for the switchable ROM bank
+
+        uint16_t address = 0;
+        REQUIRE(*symbols.findContaining(0, 0x105, address) == "Entry");
+        REQUIRE(address == 0x100);
+        REQUIRE(symbols.findContaining(0, 0xFF, address) == nullptr);
+        REQUIRE(symbols.findContaining(2, 0x4001, address) == nullptr);
+        REQUIRE(*symbols.findContaining(1, 0x4001, address) == "Return");
+    }
+
+    TEST_CASE("Disassembler", "[disassembler]")
+    {
+        SymbolTable symbols;
+        symbols.add(0, 0x100, "Entry");
+        symbols.add(1, 0x4000, "Return");
+        symbols.add(2, 0x4000, "Increment");
+        symbols.add(0, 0xFF44, "rLY");
+        Disassembler disassembler(createDisassemblerROM(), &symbols);
+        REQUIRE(disassembler.getBankCount() == 4);
+
+        SECTION("Decoding")
+        {
+            const Instruction &call = disassembler.decode(0, 0x100);
+            REQUIRE(call.length == 3);
+            REQUIRE(call.text == "CALL Return");
+            REQUIRE(disassembler.decode(0, 0x103).text == "JR Entry");
+            REQUIRE(disassembler.decode(0, 0x105).text == "LDH (rLY), A");
+            REQUIRE(disassembler.decode(0, 0x107).text == "LD HL, SP-$02");
+            REQUIRE(disassembler.decode(0, 0x109).text == "BIT 7, H");
+            REQUIRE(disassembler.decode(0, 0x10B).text == "DB $D3");
+            REQUIRE(disassembler.decode(0, 0x10C).text == "LD ($1234), SP");
+            REQUIRE(disassembler.decode(3, 0x4000).text == "INC A");
+            REQUIRE(disassembler.decode(1, 0x4000).text == "RET");
+
+            // Cached
+            REQUIRE(&disassembler.decode(0, 0x100) == &call);
+        }
+
+        SECTION("Hits")
+        {
+            disassembler.addHit(0x100, 0xCD);
+            disassembler.addHit(0x4000, 0xC9);
+            disassembler.addHit(0x4000, 0x3C); // The first bank with the opcode
+            disassembler.addHit(0x4000, 0x3C);
+            disassembler.addHit(0xFF80, 0x3E); // Outside the ROM
+            REQUIRE(disassembler.getTotalHits() == 5);
+            REQUIRE(disassembler.getHits(0, 0x100) == 1);
+            REQUIRE(disassembler.getHits(1, 0x4000) == 1);
+            REQUIRE(disassembler.getHits(2, 0x4000) == 2);
+            REQUIRE(disassembler.getHits(3, 0x4000) == 0);
+
+            std::ostringstream listing;
+            disassembler.writeHotListing(listing, 10);
+            std::string text = listing.str();
+            REQUIRE(text.find("5 instructions executed, 1 outside the ROM") != std::string::npos);
+            REQUIRE(text.find("02:4000 Increment") < text.find("00:0100 Entry")); // Sorted by hits
+            REQUIRE(text.find("Return:\n    01:4000  C9") != std::string::npos);
+            REQUIRE(text.find("RST") == std::string::npos); // Only the executed instructions
+        }
+
+        SECTION("Listing")
+        {
+            std::ostringstream listing;
+            disassembler.writeListing(listing);
+            std::string text = listing.str();
+            REQUIRE(text.find("Entry:\n    00:0100  CD 00 40  CALL Return") != std::string::npos);
+            REQUIRE(text.find("; ROM bank 3") != std::string::npos);
+            REQUIRE(text.find("JR NZ, ") == std::string::npos);
+        }
+    }
+} // namespace gameboyTest
@@ -0,0 +1,102 @@
+#include "catch.hpp"
+#include "emulator.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    std::vector<uint8_t> readROM(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+    }
+
+    TEST_CASE("Emulator from a ROM buffer", "[emulator]")
+    {
+        REQUIRE(Emulator::create({}) == nullptr);
+        REQUIRE(Emulator::create(std::vector<uint8_t>(0x100, 0x00)) == nullptr);
+
+        auto emulator = Emulator::create(readROM("test_roms/cpu_instrs.gb"));
+        REQUIRE(emulator != nullptr);
+        REQUIRE(emulator->getCycles() == 0);
+
+        REQUIRE(emulator->runCycles(1000));
+        REQUIRE(emulator->getCycles() >= 1000);
+
+        for (int frame = 0; frame < 10; frame++)
+            REQUIRE(emulator->runFrame());
+        REQUIRE(emulator->isFrameReady());
+
+        FrameBufferView frame = emulator->frameBuffer();
+        REQUIRE(frame.width == screen_size::SCREEN_WIDTH);
+        REQUIRE(frame.height == screen_size::SCREEN_HEIGHT);
+        REQUIRE(&frame.at(1, 1) == frame.pixels + screen_size::SCREEN_WIDTH + 1);
+    }
+
+    TEST_CASE("Emulator state", "[emulator]")
+    {
+        auto emulator = Emulator::create(readROM("test_roms/cpu_instrs.gb"));
+        REQUIRE(emulator != nullptr);
+        REQUIRE(emulator->runCycles(1000000));
+
+        std::vector<uint8_t> state;
+        emulator->saveState(state);
+        uint64_t cycles = emulator->getCycles();
+
+        emulator->setInput(static_cast<uint8_t>(JoypadButton::BUTTON_A) | static_cast<uint8_t>(JoypadButton::DIRECTION_UP));
+        REQUIRE(emulator->runCycles(1000000));
+        std::vector<uint8_t> laterState;
+        emulator->saveState(laterState);
+
+        // The emulation from the restored state must be deterministic
+        REQUIRE(emulator->loadState(state));
+        REQUIRE(emulator->getCycles() == cycles);
+        emulator->setInput(static_cast<uint8_t>(JoypadButton::BUTTON_A) | static_cast<uint8_t>(JoypadButton::DIRECTION_UP));
+        REQUIRE(emulator->runCycles(1000000));
+        std::vector<uint8_t> restoredState;
+        emulator->saveState(restoredState);
+        REQUIRE(restoredState == laterState);
+
+        // An invalid state leaves the emulator unchanged
+        std::vector<uint8_t> truncated(state.begin(), state.begin() + static_cast<std::ptrdiff_t>(state.size() / 2));
+        REQUIRE_FALSE(emulator->loadState(truncated));
+        REQUIRE_FALSE(emulator->loadState({0x00, 0x01, 0x02, 0x03}));
+        emulator->saveState(restoredState);
+        REQUIRE(restoredState == laterState);
+    }
+
+    TEST_CASE("Emulator accuracy", "[emulator]")
+    {
+        // LD A,0x06; LDH (TAC),A (TIMA incremented when the counter crosses a multiple of 64); 7 x NOP; LD A,(TIMA);
+        // LD (0xC000),A; JR -2
+        std::vector<uint8_t> rom(0x8000, 0x00);
+        const uint8_t program[] = {0x3E, 0x06, 0xE0, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                   0xFA, 0x05, 0xFF, 0xEA, 0x00, 0xC0, 0x18, 0xFE};
+        std::copy(std::begin(program), std::end(program), rom.begin() + 0x100);
+
+        auto instruction = Emulator::create(rom);
+        auto machineCycle = Emulator::create(rom);
+        REQUIRE(machineCycle->getAccuracy() == Accuracy::INSTRUCTION);
+        machineCycle->setAccuracy(Accuracy::MACHINE_CYCLE);
+        REQUIRE(instruction->runCycles(100));
+        REQUIRE(machineCycle->runCycles(100));
+
+        // The timer is enabled by the last cycle of LDH (counter 20), and read by the last cycle of LD A,(nn)
+        // (counter 64, the first increment): counters 8 and 48 at the start of the instructions
+        REQUIRE(instruction->readMemory(0xC000) == 0);
+        REQUIRE(machineCycle->readMemory(0xC000) == 1);
+
+        // Same duration
+        REQUIRE(machineCycle->getCycles() == instruction->getCycles());
+        REQUIRE(machineCycle->getInstructions() == instruction->getInstructions());
+        REQUIRE(machineCycle->getRegisters().pc == 0x111);
+
+        // The state of the CPU is kept when the accuracy changes
+        machineCycle->setAccuracy(Accuracy::INSTRUCTION);
+        REQUIRE(machineCycle->runCycles(100));
+        REQUIRE(machineCycle->getRegisters().pc == 0x111);
+    }
+} // namespace gameboyTest
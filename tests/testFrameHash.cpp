@@ -0,0 +1,39 @@
+#include "catch.hpp"
+#include "frame_hash.h"
+
+#include <cstdio>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    TEST_CASE("Frame hashes", "[hash]")
+    {
+        auto emulator = Emulator::createFromFile("test_roms/cpu_instrs.gb");
+        REQUIRE(emulator != nullptr);
+
+        std::vector<FrameHash> hashes;
+        REQUIRE(hashFrames(*emulator, nullptr, 120, 30, hashes));
+        REQUIRE(hashes.size() == 4);
+        REQUIRE(hashes[0].frame == 29);
+        REQUIRE(hashes[3].frame == 119);
+        REQUIRE(hashes[3].hash == hashFrame(*emulator));
+
+        // Same sequence with all the frames rendered
+        auto other = Emulator::createFromFile("test_roms/cpu_instrs.gb");
+        REQUIRE(other != nullptr);
+        std::vector<FrameHash> allHashes;
+        REQUIRE(hashFrames(*other, nullptr, 120, 1, allHashes));
+        REQUIRE(allHashes.size() == 120);
+        for (const FrameHash &hash : hashes)
+            REQUIRE(allHashes[hash.frame] == hash);
+
+        // File roundtrip
+        const std::string filename = "test_frames.hashes";
+        REQUIRE(saveFrameHashes(filename, hashes));
+        std::vector<FrameHash> loaded;
+        REQUIRE(loadFrameHashes(filename, loaded));
+        REQUIRE(loaded == hashes);
+        std::remove(filename.c_str());
+    }
+} // namespace gameboyTest
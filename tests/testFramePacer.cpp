@@ -0,0 +1,32 @@
+#include "catch.hpp"
+#include "frame_pacer.h"
+
+#include <vector> // std::vector
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    TEST_CASE("FramePacer audio sync", "[framepacer]")
+    {
+        FramePacer pacer(4194304, 70224, PacingMode::TIMER);
+        REQUIRE(pacer.getRateAdjustment() == 1);
+
+        RingBuffer<int16_t> buffer(4096);
+        pacer.setAudioSync(&buffer, 1000);
+        REQUIRE(pacer.getMode() == PacingMode::AUDIO);
+
+        // Too many samples: produce less samples (the device does not consume them, so the wait times out)
+        std::vector<int16_t> samples(2000);
+        buffer.push(samples.data(), samples.size());
+        pacer.waitForNextFrame();
+        REQUIRE(pacer.getRateAdjustment() < 1);
+        REQUIRE(pacer.getRateAdjustment() >= 0.995);
+
+        // Not enough samples: produce more samples, without waiting
+        buffer.pop(samples.data(), 1500);
+        pacer.waitForNextFrame();
+        REQUIRE(pacer.getRateAdjustment() > 1);
+        REQUIRE(pacer.getRateAdjustment() <= 1.005);
+    }
+} // namespace gameboyTest
@@ -0,0 +1,22 @@
+#include "catch.hpp"
+#include "hash.h"
+
+#include <string>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    TEST_CASE("XXH64 reference values", "[hash]")
+    {
+        REQUIRE(hash64("", 0) == 0xEF46DB3751D8E999ULL);
+        REQUIRE(hash64("a", 1) == 0xD24EC4F1A98C6E5BULL);
+        REQUIRE(hash64("abc", 3) == 0x44BC2CF5AD770999ULL);
+
+        std::string text = "Nobody inspects the spammish repetition";
+        REQUIRE(hash64(text.data(), text.size()) == 0xFBCEA83C8A378BF1ULL);
+
+        // The seed changes the hash
+        REQUIRE(hash64(text.data(), text.size(), 1) != hash64(text.data(), text.size()));
+    }
+} // namespace gameboyTest
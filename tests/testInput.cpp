@@ -51,6 +51,56 @@ namespace gameboyTest
         Cartridge cartridge{};
         Memory memory(cartridge);
         Input input(memory);
+
+        // No button pressed, no interrupt
+        input.sendInterrupt();
+        REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == 0xE1);
+
+        // Button pressed, interrupt
+        input.setButton(JoypadButton::BUTTON_A, true);
+        input.sendInterrupt();
+        REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == (0xE1 | 0x10));
+
+        // Button held, no new interrupt
+        memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0xE1);
+        input.sendInterrupt();
+        REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == 0xE1);
+
+        // Button released, no interrupt
+        input.setButton(JoypadButton::BUTTON_A, false);
+        input.sendInterrupt();
+        REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == 0xE1);
+
+        // Another button pressed while the first one is released, interrupt
+        input.setButton(JoypadButton::DIRECTION_UP, true);
+        input.sendInterrupt();
+        REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == (0xE1 | 0x10));
+    }
+
+    TEST_CASE("Input tap", "[input]")
+    {
+        Cartridge cartridge{};
+        Memory memory(cartridge);
+        Input input(memory);
+
+        // Button pressed and released before sendInterrupt (the events of a single processInput call), interrupt
+        input.setButton(JoypadButton::BUTTON_START, true);
+        input.setButton(JoypadButton::BUTTON_START, false);
+        REQUIRE(memory.getJoypadState() == 0xFF);
+        input.sendInterrupt();
+        REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == (0xE1 | 0x10));
+
+        // The tap has been sent
+        memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0xE1);
+        input.sendInterrupt();
+        REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == 0xE1);
+
+        // Released then pressed again: a new press
+        input.setButton(JoypadButton::BUTTON_A, true);
+        input.sendInterrupt();
+        memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0xE1);
+        input.setButton(JoypadButton::BUTTON_A, false);
+        input.setButton(JoypadButton::BUTTON_A, true);
         input.sendInterrupt();
         REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == (0xE1 | 0x10));
     }
@@ -0,0 +1,86 @@
+#include "catch.hpp"
+#include "link_cable.h"
+
+#include <thread>
+#include <vector>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    // Exchange count bytes through the serial port, return the bytes received
+    std::vector<uint8_t> exchangeBytes(LinkCable &link, bool internalClock, uint8_t first, int count)
+    {
+        Cartridge cartridge;
+        Memory memory(cartridge);
+        Serial serial(memory);
+        serial.setSink(&link);
+        memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0x00);
+
+        std::vector<uint8_t> received;
+        uint8_t sent = first;
+        bool waiting = false;
+        // The loop is bounded so that a broken synchronization fails instead of hanging
+        for (int i = 0; i < 1024 * (count + 1) * 2 && static_cast<int>(received.size()) < count; i++)
+        {
+            if (waiting && (memory.read(serial_registers::SC_ADDRESS) & 0x80) == 0)
+            {
+                received.push_back(memory.read(serial_registers::SB_ADDRESS));
+                if ((memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) & 0x08) == 0)
+                    break; // The serial interrupt has not been requested
+                memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0x00);
+                sent++;
+                waiting = false;
+            }
+            if (!waiting)
+            {
+                memory.write(serial_registers::SB_ADDRESS, sent);
+                memory.write(serial_registers::SC_ADDRESS, internalClock ? 0x81 : 0x80);
+                waiting = true;
+            }
+            serial.cycle(4);
+        }
+
+        link.disconnect();
+        return received;
+    }
+
+    TEST_CASE("Link cable transfers", "[link]")
+    {
+        LinkCable master;
+        LinkCable slave;
+        REQUIRE(LinkCable::connectPair(master, slave));
+        REQUIRE(master.isConnected());
+        REQUIRE(slave.isConnected());
+
+        constexpr int COUNT = 32;
+        std::vector<uint8_t> slaveReceived;
+        std::thread slaveThread([&]() { slaveReceived = exchangeBytes(slave, false, 0x80, COUNT); });
+        std::vector<uint8_t> masterReceived = exchangeBytes(master, true, 0x00, COUNT);
+        slaveThread.join();
+
+        REQUIRE(masterReceived.size() == COUNT);
+        REQUIRE(slaveReceived.size() == COUNT);
+        for (int i = 0; i < COUNT; i++)
+        {
+            REQUIRE(masterReceived[i] == 0x80 + i);
+            REQUIRE(slaveReceived[i] == i);
+        }
+        REQUIRE(master.getStats().transfers == COUNT);
+        REQUIRE(master.getStats().messagesSent > 0);
+        REQUIRE_FALSE(master.isConnected());
+    }
+
+    TEST_CASE("Link cable unplugged", "[link]")
+    {
+        LinkCable master;
+        LinkCable slave;
+        REQUIRE(LinkCable::connectPair(master, slave));
+        slave.disconnect();
+
+        // The other end is gone: the transfer completes with 0xFF
+        std::vector<uint8_t> received = exchangeBytes(master, true, 0x00, 1);
+        REQUIRE(received.size() == 1);
+        REQUIRE(received[0] == 0xFF);
+    }
+} // namespace gameboyTest
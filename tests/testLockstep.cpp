@@ -0,0 +1,51 @@
+#include "catch.hpp"
+#include "lockstep.h"
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    const std::string LOCKSTEP_ROM = "test_roms/cpu_instrs.gb";
+
+    TEST_CASE("Lockstep of identical cores", "[lockstep]")
+    {
+        auto reference = Emulator::createFromFile(LOCKSTEP_ROM);
+        auto candidate = Emulator::createFromFile(LOCKSTEP_ROM);
+        REQUIRE(reference != nullptr);
+        REQUIRE(candidate != nullptr);
+
+        Movie movie(reference->getROMHash());
+        for (int frame = 0; frame < 60; frame++)
+            movie.addFrame(static_cast<uint8_t>(frame * 37));
+
+        LockstepResult result = runLockstep(*reference, *candidate, &movie, 60);
+        INFO(result.report);
+        REQUIRE_FALSE(result.diverged);
+        REQUIRE_FALSE(result.error);
+        REQUIRE(result.frames == 60);
+        REQUIRE(result.instructions > 10000);
+        REQUIRE(result.report.empty());
+    }
+
+    TEST_CASE("Lockstep divergence", "[lockstep]")
+    {
+        auto reference = Emulator::createFromFile(LOCKSTEP_ROM);
+        auto candidate = Emulator::createFromFile(LOCKSTEP_ROM);
+        REQUIRE(reference != nullptr);
+        REQUIRE(candidate != nullptr);
+
+        // The candidate is one instruction ahead
+        REQUIRE(reference->runCycles(100000));
+        std::vector<uint8_t> state;
+        reference->saveState(state);
+        REQUIRE(candidate->loadState(state));
+        REQUIRE(candidate->runCycles(1));
+
+        LockstepResult result = runLockstep(*reference, *candidate, nullptr, 10);
+        REQUIRE(result.diverged);
+        REQUIRE(result.frames == 0);
+        REQUIRE(result.instructions == 0);
+        REQUIRE(result.report.find("reference:  PC=") != std::string::npos);
+        REQUIRE(result.report.find("candidate:  PC=") != std::string::npos);
+    }
+} // namespace gameboyTest
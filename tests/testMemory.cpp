@@ -95,4 +95,14 @@ namespace gameboyTest
             REQUIRE(memory[i] == 0x00);
         }
     }
+
+    TEST_CASE("LY is read-only", "[memory]")
+    {
+        Cartridge cartridge{};
+        Memory memory(cartridge);
+
+        memory[0xFF44] = 0x05;
+        memory.write(0xFF44, 0xF0);
+        REQUIRE(memory.read(0xFF44) == 0x05);
+    }
 } // namespace gameboyTest
@@ -0,0 +1,137 @@
+#include "catch.hpp"
+#include "hash.h"
+#include "movie.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    const std::string MOVIE_ROM = "test_roms/cpu_instrs.gb";
+
+    // Play the movie on a new emulator, return the hash of all the frames
+    uint64_t playMovie(const Movie &movie, const std::string &rom = MOVIE_ROM)
+    {
+        auto emulator = Emulator::createFromFile(rom);
+        REQUIRE(emulator != nullptr);
+        REQUIRE(movie.start(*emulator));
+
+        uint64_t hash = 0;
+        for (size_t frame = 0; frame < movie.getFrameCount(); frame++)
+        {
+            emulator->setInput(movie.getFrameInput(frame));
+            REQUIRE(emulator->runFrame());
+            FrameBufferView view = emulator->frameBuffer();
+            hash = hash64(view.pixels, view.width * view.height * sizeof(Colour), hash);
+        }
+        return hash;
+    }
+
+    TEST_CASE("Movie playback", "[movie]")
+    {
+        auto emulator = Emulator::createFromFile(MOVIE_ROM);
+        REQUIRE(emulator != nullptr);
+
+        Movie movie(emulator->getROMHash());
+        for (int frame = 0; frame < 120; frame++)
+            movie.addFrame(static_cast<uint8_t>(frame * 37));
+        REQUIRE(movie.getFrameCount() == 120);
+        REQUIRE(movie.getFrameInput(1) == 37);
+
+        // Deterministic replay
+        uint64_t hash = playMovie(movie);
+        REQUIRE(playMovie(movie) == hash);
+
+        // File roundtrip
+        const std::string filename = "test_movie.gbm";
+        REQUIRE(movie.saveToFile(filename));
+        Movie loaded;
+        REQUIRE(loaded.loadFromFile(filename));
+        REQUIRE(loaded.getROMHash() == movie.getROMHash());
+        REQUIRE(loaded.getFrameCount() == movie.getFrameCount());
+        REQUIRE(playMovie(loaded) == hash);
+
+        // Truncated file
+        {
+            std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+            file << "GBMV";
+        }
+        REQUIRE_FALSE(loaded.loadFromFile(filename));
+        std::remove(filename.c_str());
+    }
+
+    TEST_CASE("Movie start state and ROM check", "[movie]")
+    {
+        auto emulator = Emulator::createFromFile(MOVIE_ROM);
+        REQUIRE(emulator != nullptr);
+        REQUIRE(emulator->runCycles(500000));
+
+        std::vector<uint8_t> state;
+        emulator->saveState(state);
+        Movie movie(emulator->getROMHash());
+        movie.setStartState(state);
+        movie.addFrame(0x00);
+
+        // The movie starts from the state
+        auto player = Emulator::createFromFile(MOVIE_ROM);
+        REQUIRE(player != nullptr);
+        REQUIRE(movie.start(*player));
+        REQUIRE(player->getCycles() == emulator->getCycles());
+
+        // Another ROM
+        Movie otherROM(emulator->getROMHash() + 1);
+        REQUIRE_FALSE(otherROM.start(*player));
+    }
+
+    // Write the cartridge RAM of the battery ROM
+    void writeSave(const std::string &filename, uint8_t value)
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        std::vector<char> ram(0x2000, static_cast<char>(value));
+        file.write(ram.data(), static_cast<std::streamsize>(ram.size()));
+    }
+
+    TEST_CASE("Movie with a battery save", "[movie]")
+    {
+        // MBC1+RAM+BATTERY, 8 KB of RAM. Enable the RAM, then copy its first byte to the background palette forever:
+        // LD A,0x0A; LD (0x0000),A; LD A,(0xA000); LDH (0x47),A; JR -7
+        std::vector<uint8_t> rom(0x8000, 0x00);
+        const uint8_t program[] = {0x3E, 0x0A, 0xEA, 0x00, 0x00, 0xFA, 0x00, 0xA0, 0xE0, 0x47, 0x18, 0xF9};
+        std::copy(std::begin(program), std::end(program), rom.begin() + 0x100);
+        rom[cartridge_info::CARTRIDGE_TYPE_ADDRESS] = 0x03;
+        rom[cartridge_info::CARTRIDGE_RAM_SIZE_ADDRESS] = 0x02; // 8 KB
+        const std::string romFile = "test_movie_battery.gb";
+        const std::string saveFile = "test_movie_battery.sav";
+        {
+            std::ofstream file(romFile, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(rom.data()), static_cast<std::streamsize>(rom.size()));
+        }
+
+        // Recorded like GB::run: from the state at the power on, with the RAM of the .sav file
+        writeSave(saveFile, 0x1B);
+        auto emulator = Emulator::createFromFile(romFile);
+        REQUIRE(emulator != nullptr);
+        Movie movie(emulator->getROMHash());
+        std::vector<uint8_t> state;
+        emulator->saveState(state);
+        movie.setStartState(state);
+        for (int frame = 0; frame < 10; frame++)
+            movie.addFrame(0x00);
+        uint64_t hash = playMovie(movie, romFile);
+
+        // The .sav file changes (e.g. rewritten at the exit of the recording)
+        writeSave(saveFile, 0xE4);
+        REQUIRE(playMovie(movie, romFile) == hash);
+
+        // Without the start state, the frames depend on the .sav file
+        Movie powerOn(emulator->getROMHash());
+        for (int frame = 0; frame < 10; frame++)
+            powerOn.addFrame(0x00);
+        REQUIRE(playMovie(powerOn, romFile) != hash);
+
+        std::remove(romFile.c_str());
+        std::remove(saveFile.c_str());
+    }
+} // namespace gameboyTest
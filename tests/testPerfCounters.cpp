@@ -0,0 +1,54 @@
+#include "catch.hpp"
+#include "emulator.h"
+#include "perf_counters.h"
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    TEST_CASE("Perf samples", "[perf]")
+    {
+        PerfSample start;
+        start.values = {100, 200, 3, 4};
+        PerfSample end;
+        end.values = {150, 260, 5, 4};
+
+        PerfSample delta = end - start;
+        REQUIRE(delta[PerfEvent::CYCLES] == 50);
+        REQUIRE(delta[PerfEvent::INSTRUCTIONS] == 60);
+        REQUIRE(delta[PerfEvent::BRANCH_MISSES] == 2);
+        REQUIRE(delta[PerfEvent::CACHE_MISSES] == 0);
+        REQUIRE((delta + start).values == end.values);
+    }
+
+    TEST_CASE("Perf counters per subsystem", "[perf]")
+    {
+        PerfCounters counters;
+        REQUIRE_FALSE(counters.isOpen());
+        REQUIRE(counters.read()[PerfEvent::CYCLES] == 0);
+
+        // The measures are accumulated even if the host has no counters (the samples are then 0)
+        std::unique_ptr<Emulator> emulator = Emulator::createFromFile("test_roms/cpu_instrs.gb");
+        REQUIRE(emulator);
+        bool open = counters.open();
+        emulator->setPerfCounters(&counters);
+        for (int i = 0; i < 3; i++)
+            emulator->runFrame();
+        emulator->setPerfCounters(nullptr);
+        emulator->runFrame();
+
+        REQUIRE(counters.getCount(PerfSubsystem::FRAME) == 3);
+        REQUIRE(counters.getCount(PerfSubsystem::PPU_RENDERING) > 0);
+        if (open)
+        {
+            const PerfSample &frame = counters.getTotal(PerfSubsystem::FRAME);
+            const PerfSample &rendering = counters.getTotal(PerfSubsystem::PPU_RENDERING);
+            REQUIRE(frame[PerfEvent::CYCLES] > 0);
+            REQUIRE(frame[PerfEvent::CYCLES] >= rendering[PerfEvent::CYCLES]);
+        }
+
+        counters.reset();
+        REQUIRE(counters.getCount(PerfSubsystem::FRAME) == 0);
+        REQUIRE(counters.getTotal(PerfSubsystem::FRAME)[PerfEvent::CYCLES] == 0);
+    }
+} // namespace gameboyTest
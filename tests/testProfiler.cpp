@@ -0,0 +1,47 @@
+#include "catch.hpp"
+#include "profiler.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    TEST_CASE("Profiler trace events", "[profiler]")
+    {
+        const std::string filename = "test_profile.json";
+
+        // Not recording: nothing to write
+        {
+            profiler::Scope scope("ignored");
+        }
+        REQUIRE_FALSE(profiler::stop());
+
+        REQUIRE(profiler::start(filename));
+        REQUIRE(profiler::isRecording());
+        REQUIRE_FALSE(profiler::start(filename));
+        {
+            profiler::Scope scope("main \"scope\"");
+            std::thread thread([]() {
+                profiler::setThreadName("worker");
+                profiler::Scope workerScope("worker scope");
+            });
+            thread.join();
+        }
+        REQUIRE(profiler::stop());
+        REQUIRE_FALSE(profiler::isRecording());
+
+        std::ifstream file(filename);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        REQUIRE(content.find("\"traceEvents\":[") != std::string::npos);
+        REQUIRE(content.find("{\"name\":\"main \\\"scope\\\"\",\"ph\":\"X\",\"pid\":1,") != std::string::npos);
+        REQUIRE(content.find("{\"name\":\"worker scope\",\"ph\":\"X\"") != std::string::npos);
+        REQUIRE(content.find("\"args\":{\"name\":\"worker\"}") != std::string::npos);
+        REQUIRE(content.find("ignored") == std::string::npos);
+        REQUIRE(content.substr(content.size() - 4) == "\n]}\n");
+        std::remove(filename.c_str());
+    }
+} // namespace gameboyTest
@@ -0,0 +1,118 @@
+#include "catch.hpp"
+#include "sm83_tests.h"
+
+#include <sstream>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    // A few tests in the format of the SM83 single-step tests (the registers that are not listed are 0)
+    const std::string SM83_TESTS = R"([
+        {
+            "name": "00 0000",
+            "initial": {"pc": 256, "sp": 65534, "a": 1, "b": 2, "c": 3, "d": 4, "e": 5, "f": 176, "h": 6, "l": 7, "ime": 0, "ie": 0, "ram": [[256, 0]]},
+            "final": {"pc": 257, "sp": 65534, "a": 1, "b": 2, "c": 3, "d": 4, "e": 5, "f": 176, "h": 6, "l": 7, "ime": 0, "ram": [[256, 0]]},
+            "cycles": [[256, 0, "r-m"]]
+        },
+        {
+            "name": "3c 0000",
+            "initial": {"pc": 512, "sp": 0, "a": 15, "f": 16, "ram": [[512, 60]]},
+            "final": {"pc": 513, "sp": 0, "a": 16, "f": 48, "ram": [[512, 60]]},
+            "cycles": [[512, 60, "r-m"]]
+        },
+        {
+            "name": "77 0000",
+            "initial": {"pc": 768, "sp": 0, "a": 66, "h": 192, "l": 0, "ram": [[768, 119]]},
+            "final": {"pc": 769, "sp": 0, "a": 66, "h": 192, "l": 0, "ram": [[768, 119], [49152, 66]]},
+            "cycles": [[768, 119, "r-m"], [49152, 66, "-wm"]]
+        },
+        {
+            "name": "c5 0000",
+            "initial": {"pc": 1024, "sp": 53248, "b": 18, "c": 52, "ram": [[1024, 197]]},
+            "final": {"pc": 1025, "sp": 53246, "b": 18, "c": 52, "ram": [[53247, 18], [53246, 52]]},
+            "cycles": [[1024, 197, "r-m"], null, [53247, 18, "-wm"], [53246, 52, "-wm"]]
+        },
+        {
+            "name": "20 0000",
+            "initial": {"pc": 256, "sp": 0, "f": 0, "ram": [[256, 32], [257, 5]]},
+            "final": {"pc": 263, "sp": 0, "f": 0, "ram": [[256, 32], [257, 5]]},
+            "cycles": [[256, 32, "r-m"], [257, 5, "r-m"], null]
+        },
+        {
+            "name": "20 0001",
+            "initial": {"pc": 256, "sp": 0, "f": 128, "ram": [[256, 32], [257, 5]]},
+            "final": {"pc": 258, "sp": 0, "f": 128, "ram": [[256, 32], [257, 5]]},
+            "cycles": [[256, 32, "r-m"], [257, 5, "r-m"]]
+        }
+    ])";
+
+    TEST_CASE("SM83 tests reader", "[sm83]")
+    {
+        std::istringstream stream(SM83_TESTS);
+        SM83TestReader reader(stream);
+        SM83Test test;
+
+        REQUIRE(reader.next(test));
+        REQUIRE(test.name == "00 0000");
+        REQUIRE(test.initial.pc == 256);
+        REQUIRE(test.initial.sp == 65534);
+        REQUIRE(test.initial.f == 176);
+        REQUIRE(test.initial.l == 7);
+        REQUIRE(test.initial.ram.size() == 2); // The IE register is part of the memory
+        REQUIRE(test.final.pc == 257);
+        REQUIRE(test.cycles == 1);
+
+        size_t count = 1;
+        while (reader.next(test))
+            count++;
+        REQUIRE(count == 6);
+        REQUIRE(test.name == "20 0001");
+        REQUIRE(test.cycles == 2);
+        REQUIRE(reader.isValid());
+        REQUIRE_FALSE(reader.next(test));
+    }
+
+    TEST_CASE("SM83 tests run on a flat memory", "[sm83]")
+    {
+        std::istringstream stream(SM83_TESTS);
+        SM83Results results = runSM83Tests(stream, "test");
+        for (const std::string &failure : results.failures)
+            INFO(failure);
+        REQUIRE(results.valid);
+        REQUIRE(results.failed == 0);
+        REQUIRE(results.passed == 6);
+    }
+
+    TEST_CASE("SM83 test failure", "[sm83]")
+    {
+        std::istringstream stream(SM83_TESTS);
+        SM83TestReader reader(stream);
+        SM83Test test;
+        REQUIRE(reader.next(test));
+        REQUIRE(reader.next(test));
+
+        FlatMemory memory;
+        std::string error;
+        test.final.f = 0;
+        REQUIRE_FALSE(runSM83Test(test, memory, error));
+        REQUIRE(error == "f = 0x30 (expected 0x00)");
+
+        test.final.f = 48;
+        test.cycles = 2;
+        REQUIRE_FALSE(runSM83Test(test, memory, error));
+        REQUIRE(error == "cycles = 0x01 (expected 0x02)");
+    }
+
+    TEST_CASE("SM83 tests invalid JSON", "[sm83]")
+    {
+        std::istringstream truncated(SM83_TESTS.substr(0, 400));
+        SM83Results results = runSM83Tests(truncated, "truncated");
+        REQUIRE_FALSE(results.valid);
+
+        std::istringstream empty("[]");
+        results = runSM83Tests(empty, "empty");
+        REQUIRE(results.valid);
+        REQUIRE(results.passed == 0);
+    }
+} // namespace gameboyTest
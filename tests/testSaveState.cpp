@@ -0,0 +1,85 @@
+#include "catch.hpp"
+#include "cpu.h"
+#include "ppu.h"
+#include "savestate.h"
+#include "timer.h"
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    const std::string TEST_ROM = "test_roms/cpu_instrs.gb";
+
+    void runCycles(CPU &cpu, PPU &ppu, Timer &timer, uint32_t cycles)
+    {
+        for (uint32_t total = 0; total < cycles;)
+        {
+            uint8_t instructionCycles = cpu.cycle() * 4;
+            REQUIRE(instructionCycles != 0);
+            timer.cycle(instructionCycles);
+            ppu.cycle(instructionCycles);
+            total += instructionCycles;
+        }
+    }
+
+    void saveState(std::vector<uint8_t> &buffer, const CPU &cpu, const Memory &memory, const Cartridge &cartridge,
+                   const PPU &ppu, const Timer &timer)
+    {
+        StateWriter writer(buffer);
+        cpu.saveState(writer);
+        memory.saveState(writer);
+        cartridge.saveState(writer);
+        ppu.saveState(writer);
+        timer.saveState(writer);
+    }
+
+    TEST_CASE("Save state roundtrip", "[savestate]")
+    {
+        Cartridge cartridge;
+        REQUIRE(cartridge.loadROM(TEST_ROM));
+        Memory memory(cartridge);
+        CPU cpu(memory);
+        PPU ppu(memory);
+        Timer timer(memory);
+
+        runCycles(cpu, ppu, timer, 1000000);
+
+        std::vector<uint8_t> state;
+        saveState(state, cpu, memory, cartridge, ppu, timer);
+
+        // Run the emulator, then go back to the saved state
+        runCycles(cpu, ppu, timer, 1000000);
+        std::vector<uint8_t> laterState;
+        saveState(laterState, cpu, memory, cartridge, ppu, timer);
+        REQUIRE(laterState != state);
+
+        StateReader reader(state);
+        cpu.loadState(reader);
+        memory.loadState(reader);
+        cartridge.loadState(reader);
+        ppu.loadState(reader);
+        timer.loadState(reader);
+        REQUIRE(reader.isValid());
+
+        std::vector<uint8_t> restoredState;
+        saveState(restoredState, cpu, memory, cartridge, ppu, timer);
+        REQUIRE(restoredState == state);
+
+        // The emulation from the restored state must be deterministic
+        runCycles(cpu, ppu, timer, 1000000);
+        saveState(restoredState, cpu, memory, cartridge, ppu, timer);
+        REQUIRE(restoredState == laterState);
+    }
+
+    TEST_CASE("Save state truncated", "[savestate]")
+    {
+        std::vector<uint8_t> state = {0x01, 0x02};
+        StateReader reader(state);
+
+        uint32_t value = 0;
+        reader.read(value);
+
+        REQUIRE_FALSE(reader.isValid());
+        REQUIRE(value == 0);
+    }
+} // namespace gameboyTest
@@ -0,0 +1,39 @@
+#include "catch.hpp"
+#include "serial.h"
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    TEST_CASE("Serial transfer", "[serial]")
+    {
+        Cartridge cartridge;
+        Memory memory(cartridge);
+        Serial serial(memory);
+        CaptureSink capture;
+        serial.setSink(&capture);
+        memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0x00);
+
+        // Transfer with the external clock: never completes
+        memory.write(serial_registers::SB_ADDRESS, 'A');
+        memory.write(serial_registers::SC_ADDRESS, 0x80);
+        for (int i = 0; i < 2048; i++)
+            serial.cycle(4);
+        REQUIRE(capture.getData().empty());
+
+        // Transfer with the internal clock: completes after 4096 cycles
+        memory.write(serial_registers::SC_ADDRESS, 0x81);
+        for (int i = 0; i < 1023; i++)
+            serial.cycle(4);
+        REQUIRE(capture.getData().empty());
+
+        serial.cycle(4);
+        REQUIRE(capture.getData() == "A");
+        REQUIRE(memory.read(serial_registers::SB_ADDRESS) == 0xFF);
+        REQUIRE(memory.read(serial_registers::SC_ADDRESS) == 0x01);
+        REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == 0x08);
+
+        capture.clear();
+        REQUIRE(capture.getData().empty());
+    }
+} // namespace gameboyTest
@@ -0,0 +1,53 @@
+#include "catch.hpp"
+#include "emulator.h"
+#include "stats.h"
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    TEST_CASE("Stats collector", "[stats]")
+    {
+        StatsCollector stats;
+
+        // 100 frames: 90 of 16 ms, 10 of 40 ms
+        for (int frame = 0; frame < 100; frame++)
+        {
+            double seconds = frame % 10 == 9 ? 0.040 : 0.016;
+            stats.addFrame(70224, 17000, seconds, seconds / 4, seconds / 2);
+        }
+
+        StatsSnapshot snapshot = stats.takeSnapshot();
+        REQUIRE(snapshot.frame == 100);
+        REQUIRE(snapshot.frames == 100);
+        REQUIRE(snapshot.seconds > 0);
+        REQUIRE(snapshot.cyclesPerSecond == Approx(7022400 / snapshot.seconds));
+        REQUIRE(snapshot.speed == Approx(snapshot.cyclesPerSecond / 4194304));
+        REQUIRE(snapshot.frameP50Ms == Approx(16.25));
+        REQUIRE(snapshot.frameP95Ms == Approx(40.25));
+        REQUIRE(snapshot.frameP99Ms == Approx(40.25));
+
+        // The next snapshot only has the frames added since the previous one (longer than the histogram)
+        stats.addFrame(70224, 17000, 1.0, 0.5, 0.25);
+        snapshot = stats.takeSnapshot();
+        REQUIRE(snapshot.frame == 101);
+        REQUIRE(snapshot.frames == 1);
+        REQUIRE(snapshot.frameP50Ms == Approx(StatsCollector::HISTOGRAM_BUCKETS * StatsCollector::BUCKET_MS));
+
+        std::string json = formatStatsJSON(snapshot);
+        REQUIRE(json.front() == '{');
+        REQUIRE(json.back() == '}');
+        REQUIRE(json.find("\"frame\":101,") != std::string::npos);
+        REQUIRE(json.find("\"frames\":1,") != std::string::npos);
+    }
+
+    TEST_CASE("Emulator instruction count", "[stats]")
+    {
+        auto emulator = Emulator::createFromFile("test_roms/cpu_instrs.gb");
+        REQUIRE(emulator != nullptr);
+        REQUIRE(emulator->getInstructions() == 0);
+        REQUIRE(emulator->runCycles(4000));
+        REQUIRE(emulator->getInstructions() > 4000 / 24);
+        REQUIRE(emulator->getInstructions() <= 4000 / 4 + 1);
+    }
+} // namespace gameboyTest
@@ -0,0 +1,115 @@
+#include "catch.hpp"
+#include "timer.h"
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    constexpr uint8_t TIMER_INTERRUPT = 0x04;
+
+    TEST_CASE("Timer registers", "[timer]")
+    {
+        Cartridge cartridge;
+        Memory memory(cartridge);
+        Timer timer(memory);
+        memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0x00);
+
+        SECTION("DIV")
+        {
+            timer.cycle(255);
+            REQUIRE(memory.read(timer_registers::DIV_REG_ADDRESS) == 0x00);
+            timer.cycle(1);
+            REQUIRE(memory.read(timer_registers::DIV_REG_ADDRESS) == 0x01);
+            timer.cycle(0xFF00);
+            REQUIRE(memory.read(timer_registers::DIV_REG_ADDRESS) == 0x00); // Wraps around
+
+            // Writing any value resets the counter
+            timer.cycle(0x1234);
+            memory.write(timer_registers::DIV_REG_ADDRESS, 0x56);
+            REQUIRE(memory.read(timer_registers::DIV_REG_ADDRESS) == 0x00);
+            timer.cycle(255);
+            REQUIRE(memory.read(timer_registers::DIV_REG_ADDRESS) == 0x00);
+        }
+
+        SECTION("TIMA overflow")
+        {
+            REQUIRE(memory.read(timer_registers::TAC_REG_ADDRESS) == 0xF8); // The unused bits read as 1
+            memory.write(timer_registers::TMA_REG_ADDRESS, 0xF0);
+            memory.write(timer_registers::TIMA_REG_ADDRESS, 0xFE);
+            memory.write(timer_registers::TAC_REG_ADDRESS, 0x05); // Every 16 cycles
+
+            timer.cycle(16);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0xFF);
+
+            // TIMA reads 0 for 4 cycles, then it is reloaded and the interrupt is requested
+            timer.cycle(16);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x00);
+            REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == 0x00);
+            timer.cycle(4);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0xF0);
+            REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == TIMER_INTERRUPT);
+
+            // Writing TIMA before the reload cancels it
+            memory.write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0x00);
+            timer.cycle(16 * 16 - 4);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x00);
+            memory.write(timer_registers::TIMA_REG_ADDRESS, 0x80);
+            timer.cycle(4);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x80);
+            REQUIRE(memory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) == 0x00);
+        }
+
+        SECTION("Falling edges of the writes")
+        {
+            memory.write(timer_registers::TAC_REG_ADDRESS, 0x05); // Bit 3 of the counter
+            timer.cycle(8);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x00);
+
+            // Resetting the counter while the bit is 1
+            memory.write(timer_registers::DIV_REG_ADDRESS, 0x00);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x01);
+            timer.cycle(15);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x01);
+            timer.cycle(1);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x02);
+
+            // Disabling the timer while the bit is 1
+            timer.cycle(8);
+            memory.write(timer_registers::TAC_REG_ADDRESS, 0x01);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x03);
+            timer.cycle(64);
+            REQUIRE(memory.read(timer_registers::TIMA_REG_ADDRESS) == 0x03);
+        }
+    }
+
+    TEST_CASE("Timer spans", "[timer]")
+    {
+        // A long span must give the same state as the same cycles in steps of 4
+        for (uint8_t tac : {0x04, 0x05, 0x06, 0x07, 0x03})
+        {
+            for (uint32_t cycles : {4u, 100u, 4096u, 70224u, 300000u})
+            {
+                Cartridge cartridge;
+                Memory spanMemory(cartridge);
+                Memory stepMemory(cartridge);
+                Timer spanTimer(spanMemory);
+                Timer stepTimer(stepMemory);
+                for (Memory *memory : {&spanMemory, &stepMemory})
+                {
+                    memory->write(interrupt_registers::INTERRUPT_FLAG_ADDRESS, 0x00);
+                    memory->write(timer_registers::TMA_REG_ADDRESS, 0xFA);
+                    memory->write(timer_registers::TAC_REG_ADDRESS, tac);
+                }
+
+                spanTimer.cycle(cycles);
+                for (uint32_t i = 0; i < cycles; i += 4)
+                    stepTimer.cycle(4);
+
+                for (uint16_t address = timer_registers::DIV_REG_ADDRESS; address <= timer_registers::TAC_REG_ADDRESS; address++)
+                    REQUIRE(spanMemory.read(address) == stepMemory.read(address));
+                REQUIRE(spanMemory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS) ==
+                        stepMemory.read(interrupt_registers::INTERRUPT_FLAG_ADDRESS));
+            }
+        }
+    }
+} // namespace gameboyTest
@@ -0,0 +1,187 @@
+#include "catch.hpp"
+#include "emulator.h"
+#include "trace.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    const std::string TRACE_ROM = "test_roms/cpu_instrs.gb";
+
+    // Read all the records of a trace file
+    std::vector<TraceRecord> readTrace(const std::string &filename, bool &valid)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        TraceReader reader(file);
+        std::vector<TraceRecord> records;
+        TraceRecord record;
+        while (reader.next(record))
+            records.push_back(record);
+        valid = reader.isValid();
+        return records;
+    }
+
+    TEST_CASE("Trace roundtrip", "[trace]")
+    {
+        std::vector<TraceRecord> records(4);
+        records[0].pc = 0x0100;
+        records[0].opcode = 0x00;
+        records[0].sp = 0xFFFE;
+        records[0].a = 0x01;
+        records[0].f = 0xB0;
+        records[1] = records[0];
+        records[1].pc = 0x0101;
+        records[1].opcode = 0xC3;
+        records[1].cycles = 4;
+        records[2] = records[1];
+        records[2].pc = 0x0050; // Backward jump
+        records[2].opcode = 0xCD;
+        records[2].cycles = 20;
+        records[2].l = 0x42;
+        records[3] = records[2];
+        records[3].pc = 0xC000;
+        records[3].sp = 0xFFFC;
+        records[3].cycles = 1ull << 40; // Long delta
+
+        const std::string filename = "test_trace.gbt";
+        TraceWriter writer;
+        REQUIRE(writer.open(filename));
+        for (const TraceRecord &record : records)
+            writer.record(record);
+        REQUIRE(writer.getRecordCount() == 4);
+        REQUIRE(writer.close());
+
+        bool valid = false;
+        std::vector<TraceRecord> decoded = readTrace(filename, valid);
+        REQUIRE(valid);
+        REQUIRE(decoded == records);
+        REQUIRE(formatTraceRecord(decoded[0]) ==
+                "PC=0100 OP=00 A=01 F=B0 B=00 C=00 D=00 E=00 H=00 L=00 SP=FFFE CY=0");
+
+        // Truncated file
+        std::ifstream file(filename, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::istringstream truncated(content.substr(0, content.size() - 1));
+        TraceReader reader(truncated);
+        TraceRecord record;
+        while (reader.next(record))
+            ;
+        REQUIRE_FALSE(reader.isValid());
+
+        std::istringstream notTrace("GBS1");
+        TraceReader notTraceReader(notTrace);
+        REQUIRE_FALSE(notTraceReader.next(record));
+        REQUIRE_FALSE(notTraceReader.isValid());
+        std::remove(filename.c_str());
+    }
+
+    TEST_CASE("Trace PC deltas", "[trace]")
+    {
+        // Backward deltas (loops), the extremes of a 16-bit delta and the wrap around of the PC
+        const uint16_t pcs[] = {0x0100, 0x00FC, 0x00FB, 0x00FC, 0x80FC, 0x00FC, 0x80FB, 0xFFFF, 0x0000, 0xFFFF};
+        std::vector<TraceRecord> records;
+        for (uint16_t pc : pcs)
+        {
+            TraceRecord record;
+            record.pc = pc;
+            records.push_back(record);
+        }
+
+        const std::string filename = "test_trace_pc.gbt";
+        TraceWriter writer;
+        REQUIRE(writer.open(filename));
+        for (const TraceRecord &record : records)
+            writer.record(record);
+        REQUIRE(writer.close());
+
+        bool valid = false;
+        REQUIRE(readTrace(filename, valid) == records);
+        REQUIRE(valid);
+        std::remove(filename.c_str());
+    }
+
+    TEST_CASE("Trace of the emulator", "[trace]")
+    {
+        const std::string filename = "test_trace_emulator.gbt";
+        auto emulator = Emulator::createFromFile(TRACE_ROM);
+        REQUIRE(emulator != nullptr);
+
+        TraceWriter writer;
+        REQUIRE(writer.open(filename));
+        emulator->setTracer(&writer);
+        REQUIRE(emulator->runCycles(100000));
+        emulator->setTracer(nullptr);
+        REQUIRE(emulator->runCycles(100000));
+        uint64_t count = writer.getRecordCount();
+        REQUIRE(writer.close());
+
+        bool valid = false;
+        std::vector<TraceRecord> records = readTrace(filename, valid);
+        REQUIRE(valid);
+        REQUIRE(records.size() == count);
+        REQUIRE(records.size() > 1000);
+        REQUIRE(records[0].pc == 0x0100);
+        REQUIRE(records[0].cycles == 0);
+        std::remove(filename.c_str());
+    }
+
+    TEST_CASE("Trace diff", "[trace]")
+    {
+        auto encode = [](const std::vector<TraceRecord> &records, const std::string &filename) {
+            TraceWriter writer;
+            REQUIRE(writer.open(filename));
+            for (const TraceRecord &record : records)
+                writer.record(record);
+            REQUIRE(writer.close());
+        };
+
+        std::vector<TraceRecord> records(20);
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            records[i].pc = static_cast<uint16_t>(0x0100 + i);
+            records[i].cycles = i * 4;
+        }
+        std::vector<TraceRecord> other = records;
+        other[12].a = 0x12;
+        std::vector<TraceRecord> shorter(records.begin(), records.begin() + 15);
+
+        encode(records, "test_trace_a.gbt");
+        encode(other, "test_trace_b.gbt");
+        encode(shorter, "test_trace_c.gbt");
+
+        auto diff = [](const std::string &first, const std::string &second) {
+            std::ifstream firstFile(first, std::ios::binary);
+            std::ifstream secondFile(second, std::ios::binary);
+            TraceReader firstReader(firstFile);
+            TraceReader secondReader(secondFile);
+            return diffTraces(firstReader, secondReader, 4);
+        };
+
+        TraceDiff same = diff("test_trace_a.gbt", "test_trace_a.gbt");
+        REQUIRE(same.valid);
+        REQUIRE_FALSE(same.diverged);
+        REQUIRE(same.index == 20);
+
+        TraceDiff changed = diff("test_trace_a.gbt", "test_trace_b.gbt");
+        REQUIRE(changed.diverged);
+        REQUIRE(changed.index == 12);
+        REQUIRE(changed.second.a == 0x12);
+        REQUIRE(changed.context.size() == 4);
+        REQUIRE(changed.context.back() == records[11]);
+
+        TraceDiff ended = diff("test_trace_a.gbt", "test_trace_c.gbt");
+        REQUIRE(ended.diverged);
+        REQUIRE(ended.index == 15);
+        REQUIRE(ended.secondEnded);
+        REQUIRE_FALSE(ended.firstEnded);
+
+        std::remove("test_trace_a.gbt");
+        std::remove("test_trace_b.gbt");
+        std::remove("test_trace_c.gbt");
+    }
+} // namespace gameboyTest
@@ -0,0 +1,85 @@
+#include "catch.hpp"
+#include "vec_env.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace gameboyTest
+{
+    using namespace gameboy;
+
+    std::vector<uint8_t> readVecEnvROM()
+    {
+        std::ifstream file("test_roms/cpu_instrs.gb", std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+    }
+
+    TEST_CASE("Thread pool", "[vecenv]")
+    {
+        ThreadPool pool(4);
+        REQUIRE(pool.getThreadCount() == 4);
+
+        std::vector<int> values(100, 0);
+        for (int loop = 0; loop < 10; loop++)
+            pool.run(values.size(), [&values](size_t index) { values[index]++; });
+        for (int value : values)
+            REQUIRE(value == 10);
+    }
+
+    TEST_CASE("VecEnv frame observations", "[vecenv]")
+    {
+        std::vector<uint8_t> rom = readVecEnvROM();
+
+        VecEnvOptions options;
+        options.environments = 4;
+        options.threads = 2;
+        options.downsample = 3; // Does not divide 160
+        REQUIRE(VecEnv::create(rom, options) == nullptr);
+
+        options.downsample = 4;
+        auto env = VecEnv::create(rom, options);
+        REQUIRE(env != nullptr);
+        REQUIRE(env->getEnvironmentCount() == 4);
+        REQUIRE(env->getObservationSize() == 40 * 36);
+
+        std::vector<uint8_t> observations(env->getEnvironmentCount() * env->getObservationSize());
+        std::vector<uint8_t> actions(env->getEnvironmentCount(), 0x00);
+        env->reset(observations.data());
+        for (int step = 0; step < 60; step++)
+            REQUIRE(env->step(actions.data(), observations.data()));
+
+        // Same ROM and same actions: the emulators are in lock-step
+        std::vector<uint8_t> first(observations.begin(), observations.begin() + static_cast<std::ptrdiff_t>(env->getObservationSize()));
+        for (size_t i = 1; i < env->getEnvironmentCount(); i++)
+            REQUIRE(std::equal(first.begin(), first.end(), observations.begin() + static_cast<std::ptrdiff_t>(i * env->getObservationSize())));
+        REQUIRE(env->getEmulator(0).getCycles() == env->getEmulator(3).getCycles());
+
+        // The test ROM prints text: the frame is not uniform
+        REQUIRE(std::any_of(first.begin(), first.end(), [&first](uint8_t pixel) { return pixel != first[0]; }));
+
+        // A reset goes back to the initial state
+        env->reset(1, observations.data() + env->getObservationSize());
+        REQUIRE(env->getEmulator(1).getCycles() == 0);
+    }
+
+    TEST_CASE("VecEnv RAM observations", "[vecenv]")
+    {
+        VecEnvOptions options;
+        options.environments = 3;
+        options.threads = 3;
+        options.observation = ObservationType::RAM;
+        options.ramAddresses = {0xFF44, 0xC000, 0xFF40};
+        auto env = VecEnv::create(readVecEnvROM(), options);
+        REQUIRE(env != nullptr);
+        REQUIRE(env->getObservationSize() == 3);
+
+        std::vector<uint8_t> observations(env->getEnvironmentCount() * env->getObservationSize());
+        std::vector<uint8_t> actions = {0x00, 0x01, 0x80};
+        env->reset(observations.data());
+        REQUIRE(env->step(actions.data(), observations.data()));
+        for (size_t i = 0; i < env->getEnvironmentCount(); i++)
+            for (size_t byte = 0; byte < options.ramAddresses.size(); byte++)
+                REQUIRE(observations[i * 3 + byte] == env->getEmulator(i).readMemory(options.ramAddresses[byte]));
+    }
+} // namespace gameboyTest